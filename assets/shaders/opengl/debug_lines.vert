@@ -0,0 +1,16 @@
+//
+#version 460 core
+
+// Fetched through the VertexFormat of DebugLineVertex, in world space
+layout(location = 0) in vec3 in_Position;
+layout(location = 1) in vec4 in_Color;
+
+layout(location = 0) uniform mat4 u_ViewProjection;
+
+layout(location = 0) out vec4 color;
+
+void main()
+{
+	gl_Position = u_ViewProjection * vec4(in_Position, 1.0);
+	color		= in_Color;
+}
\ No newline at end of file
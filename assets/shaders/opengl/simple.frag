@@ -1,21 +1,31 @@
 #version 460 core
+#ifdef FRAGMENT_BARYCENTRICS
+#extension GL_NV_fragment_shader_barycentric : require
+#endif
 
 layout (location=0) in vec2 uvs;
+#if defined(WIREFRAME) && !defined(FRAGMENT_BARYCENTRICS)
 layout (location=1) in vec3 barycoords;
+#endif
 
 layout (location=0) out vec4 out_FragColor;
 
 layout (binding = 0) uniform sampler2D texture0;
 
+#ifdef WIREFRAME
 float edgeFactor(float thickness)
 {
+#ifdef FRAGMENT_BARYCENTRICS
+	vec3 barycoords = gl_BaryCoordNV;
+#endif
 	vec3 a3 = smoothstep( vec3( 0.0 ), fwidth(barycoords) * thickness, barycoords);
 	return min( min( a3.x, a3.y ), a3.z );
 }
+#endif
 
 void main()
 {
-#if 0
+#ifdef WIREFRAME
 	vec4 color = texture(texture0, uvs);
 	out_FragColor = mix( color * vec4(0.8), color, edgeFactor(1.0) );
 #else 
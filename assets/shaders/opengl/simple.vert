@@ -29,10 +29,38 @@ vec2 getTexCoord(int i)
 
 layout (location=0) out vec2 uv;
 
+#ifdef VERTEX_BARYCENTRICS
+#define PULLED_INDICES
+#endif
+
+#ifdef PULLED_INDICES
+// Drawn non-indexed over the index buffer, by the meshlet draws and for the vertex barycentrics
+layout(std430, binding = 2) restrict readonly buffer Indices
+{
+	uint in_Indices[];
+};
+#endif
+
+#ifdef VERTEX_BARYCENTRICS
+// Every triangle gets its own three invocations so gl_VertexID % 3 tells which corner is being shaded, no geometry
+// shader needed
+layout (location=1) out vec3 barycoords;
+#endif
+
 void main()
 {
-	vec3 pos = getPosition(gl_VertexID);
+#ifdef PULLED_INDICES
+	// Drawn from the first index of the mesh or the meshlet, the base vertex is passed as the base instance
+	int index = int(in_Indices[gl_VertexID]) + gl_BaseInstance;
+#else
+	int index = gl_VertexID;
+#endif
+#ifdef VERTEX_BARYCENTRICS
+	barycoords = vec3(equal(ivec3(gl_VertexID % 3), ivec3(0, 1, 2)));
+#endif
+
+	vec3 pos = getPosition(index);
 	gl_Position = MVP * vec4(pos, 1.0);
 
-	uv = getTexCoord(gl_VertexID);
+	uv = getTexCoord(index);
 }
\ No newline at end of file
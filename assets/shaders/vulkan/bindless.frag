@@ -0,0 +1,48 @@
+#version 460
+#extension GL_EXT_nonuniform_qualifier : require
+
+layout (location=0) in vec3 color;
+layout (location=1) in vec2 uv;
+#ifdef WIREFRAME
+layout (location=2) in vec3 barycoords;
+#endif
+
+layout (location=0) out vec4 out_FragColor;
+
+layout (constant_id = 1) const bool MATERIAL_TINT = true;
+
+layout (set=0, binding=0) uniform sampler2D textures[];
+
+layout (std430, set=0, binding=1) readonly buffer Material
+{
+    vec4 tint;
+} materials[];
+
+layout (push_constant) uniform DrawConstants
+{
+    vec2 offset;
+    float scale;
+    uint textureID;
+    uint materialID;
+} draw;
+
+#ifdef WIREFRAME
+float edgeFactor(float thickness)
+{
+	vec3 a3 = smoothstep( vec3( 0.0 ), fwidth(barycoords) * thickness, barycoords);
+	return min( min( a3.x, a3.y ), a3.z );
+}
+#endif
+
+void main()
+{
+    vec4 albedo = texture(textures[draw.textureID], uv);
+    if (MATERIAL_TINT)
+    {
+        albedo *= materials[draw.materialID].tint;
+    }
+    out_FragColor = albedo * vec4(color, 1.0);
+#ifdef WIREFRAME
+    out_FragColor = mix( out_FragColor * vec4(0.8), out_FragColor, edgeFactor(1.0) );
+#endif
+}
\ No newline at end of file
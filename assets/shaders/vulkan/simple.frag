@@ -0,0 +1,25 @@
+#version 460
+
+layout (location=0) in vec3 color;
+#ifdef WIREFRAME
+// Preprocessor variant rather than a specialization constant, it adds an input to the interface
+layout (location=2) in vec3 barycoords;
+#endif
+
+layout (location=0) out vec4 out_FragColor;
+
+#ifdef WIREFRAME
+float edgeFactor(float thickness)
+{
+	vec3 a3 = smoothstep( vec3( 0.0 ), fwidth(barycoords) * thickness, barycoords);
+	return min( min( a3.x, a3.y ), a3.z );
+}
+#endif
+
+void main()
+{
+    out_FragColor = vec4(color, 1.0);
+#ifdef WIREFRAME
+    out_FragColor = mix( out_FragColor * vec4(0.8), out_FragColor, edgeFactor(1.0) );
+#endif
+}
\ No newline at end of file
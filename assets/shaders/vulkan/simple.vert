@@ -1,6 +1,24 @@
 #version 460
 
+layout (location=0) in vec2 position;
+layout (location=1) in vec3 vertexColor;
+
+layout (location=0) out vec3 color;
+layout (location=1) out vec2 uv;
+layout (location=2) out vec3 barycoords;
+
+layout (push_constant) uniform DrawConstants
+{
+    vec2 offset;
+    float scale;
+    uint textureID;
+    uint materialID;
+} draw;
+
 void main()
 {
-    gl_Position = vec4(0.0, 0.0, 0.0, 1.0);
+    gl_Position = vec4(position * draw.scale + draw.offset, 0.0, 1.0);
+    color = vertexColor;
+    uv = position + vec2(0.5);
+    barycoords = vec3(equal(ivec3(gl_VertexIndex % 3), ivec3(0, 1, 2)));
 }
\ No newline at end of file
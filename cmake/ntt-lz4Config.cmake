@@ -0,0 +1,26 @@
+set(LIB_NAME ntt-lz4)
+
+if (TARGET ${LIB_NAME})
+    return()
+endif()
+
+if (NOT TARGET lz4_static)
+    include(FetchContent)
+
+    set(LZ4_BUILD_CLI OFF CACHE BOOL "" FORCE)
+    set(LZ4_BUILD_LEGACY_LZ4C OFF CACHE BOOL "" FORCE)
+    set(BUILD_STATIC_LIBS ON CACHE BOOL "" FORCE)
+
+    FetchContent_Declare(
+        lz4
+        GIT_REPOSITORY https://github.com/lz4/lz4.git
+        GIT_TAG        v1.9.4
+        SOURCE_SUBDIR  build/cmake
+    )
+
+    FetchContent_MakeAvailable(lz4)
+endif()
+
+add_library(${LIB_NAME} INTERFACE)
+target_link_libraries(${LIB_NAME} INTERFACE lz4_static)
+target_include_directories(${LIB_NAME} INTERFACE ${lz4_SOURCE_DIR}/lib)
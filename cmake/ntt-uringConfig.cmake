@@ -0,0 +1,20 @@
+set(LIB_NAME ntt-uring)
+
+if (TARGET ${LIB_NAME})
+    return()
+endif()
+
+# Optional, batched reads fall back to pread without it
+find_path(URING_INCLUDE_DIR liburing.h)
+find_library(URING_LIBRARY uring)
+
+add_library(${LIB_NAME} INTERFACE)
+
+if (URING_INCLUDE_DIR AND URING_LIBRARY)
+    target_include_directories(${LIB_NAME} INTERFACE ${URING_INCLUDE_DIR})
+    target_link_libraries(${LIB_NAME} INTERFACE ${URING_LIBRARY})
+    target_compile_definitions(${LIB_NAME} INTERFACE NTT_IO_URING=1)
+else()
+    message(STATUS "liburing not found, asset archive reads use pread")
+    target_compile_definitions(${LIB_NAME} INTERFACE NTT_IO_URING=0)
+endif()
@@ -14,15 +14,49 @@ target_link_libraries(${LIB_NAME} INTERFACE Vulkan::Vulkan)
 find_program(Vulkan::glslc Vulkan::glslc)
 set(GLSLC_EXECUTABLE Vulkan::glslc)
 
-macro(ntt_vulkan_compile shaderFile outputDir)
-    get_filename_component(FILENAME ${shaderFile} NAME) 
-    get_filename_component(FILENAME_WE ${shaderFile} NAME_WE)
+if (Vulkan_GLSLC_EXECUTABLE)
+    get_filename_component(VULKAN_BIN_DIR ${Vulkan_GLSLC_EXECUTABLE} DIRECTORY)
+endif()
+find_program(SPIRV_OPT_EXECUTABLE spirv-opt HINTS ${VULKAN_BIN_DIR} $ENV{VULKAN_SDK}/bin)
+if (NOT SPIRV_OPT_EXECUTABLE)
+    message(STATUS "spirv-opt not found, shader variants are not optimized")
+endif()
+
+# Compiles every combination of the preprocessor features listed after outputDir, the variant enabling the features
+# of bitmask MASK (bit i = i-th feature) is written to FILENAME.MASK.spv and optimized by spirv-opt when available.
+# A shader without features still gets its FILENAME.0.spv variant.
+macro(ntt_vulkan_compile_variants shaderFile outputDir)
+    get_filename_component(FILENAME ${shaderFile} NAME)
+    string(REPLACE "." "_" SHADER_TARGET ${FILENAME})
+
+    set(VARIANT_FEATURES ${ARGN})
+    list(LENGTH VARIANT_FEATURES VARIANT_FEATURES_COUNT)
+    math(EXPR VARIANT_LAST_MASK "(1 << ${VARIANT_FEATURES_COUNT}) - 1")
+
+    set(VARIANT_COMMANDS)
+    foreach(VARIANT_MASK RANGE ${VARIANT_LAST_MASK})
+        set(VARIANT_DEFINES)
+        set(FEATURE_INDEX 0)
+        foreach(FEATURE ${VARIANT_FEATURES})
+            math(EXPR FEATURE_ENABLED "(${VARIANT_MASK} >> ${FEATURE_INDEX}) & 1")
+            if (FEATURE_ENABLED)
+                list(APPEND VARIANT_DEFINES -D${FEATURE})
+            endif()
+            math(EXPR FEATURE_INDEX "${FEATURE_INDEX} + 1")
+        endforeach()
+
+        set(VARIANT_FILE ${outputDir}/${FILENAME}.${VARIANT_MASK}.spv)
+        list(APPEND VARIANT_COMMANDS COMMAND ${GLSLC_EXECUTABLE} ${VARIANT_DEFINES} -o ${VARIANT_FILE} ${shaderFile})
+        if (SPIRV_OPT_EXECUTABLE)
+            list(APPEND VARIANT_COMMANDS COMMAND ${SPIRV_OPT_EXECUTABLE} -O ${VARIANT_FILE} -o ${VARIANT_FILE})
+        endif()
+    endforeach()
 
     add_custom_target(
-        ${FILENAME_WE} ALL
+        ${SHADER_TARGET} ALL
         COMMAND ${CMAKE_COMMAND} -E make_directory ${outputDir}
-        COMMAND ${GLSLC_EXECUTABLE} -o ${outputDir}/${FILENAME}.spv ${shaderFile}
+        ${VARIANT_COMMANDS}
         DEPENDS ${shaderFile}
-        COMMENT "Compiling Vulkan shader: ${FILENAME} to ${FILENAME}.spv"
+        COMMENT "Compiling Vulkan shader variants: ${FILENAME} (${VARIANT_FEATURES_COUNT} features)"
     )
 endmacro()
@@ -0,0 +1,27 @@
+set(LIB_NAME ntt-zstd)
+
+if (TARGET ${LIB_NAME})
+    return()
+endif()
+
+if (NOT TARGET libzstd_static)
+    include(FetchContent)
+
+    set(ZSTD_BUILD_PROGRAMS OFF CACHE BOOL "" FORCE)
+    set(ZSTD_BUILD_TESTS OFF CACHE BOOL "" FORCE)
+    set(ZSTD_BUILD_SHARED OFF CACHE BOOL "" FORCE)
+    set(ZSTD_BUILD_STATIC ON CACHE BOOL "" FORCE)
+
+    FetchContent_Declare(
+        zstd
+        GIT_REPOSITORY https://github.com/facebook/zstd.git
+        GIT_TAG        v1.5.6
+        SOURCE_SUBDIR  build/cmake
+    )
+
+    FetchContent_MakeAvailable(zstd)
+endif()
+
+add_library(${LIB_NAME} INTERFACE)
+target_link_libraries(${LIB_NAME} INTERFACE libzstd_static)
+target_include_directories(${LIB_NAME} INTERFACE ${zstd_SOURCE_DIR}/lib)
@@ -0,0 +1,65 @@
+#pragma once
+#include <cstdint>
+#include <string_view>
+
+namespace ntt {
+
+/**
+ * On-disk layout of the asset archives, shared by the AssetPacker tool that writes them and the OpenGL application
+ * that reads them (see `AssetArchive` in asset_archive.h). Layout:
+ *  - AssetArchiveHeader,
+ *  - the directory, an open-addressing hash table of `slotsCount` AssetArchiveEntry (linear probing, pathHash 0 for
+ *    empty slots) keyed by the hash of the path relative to the packed directory, e.g. "gltfs/rubber_duck.gltf",
+ *  - the paths of the entries, to tell hash collisions apart,
+ *  - the entries content, each one starting on an ASSET_ARCHIVE_ALIGNMENT boundary and padded up to the next one,
+ *    stored entries can so be mapped in place and every read covers whole blocks.
+ * Entries are stored as is or compressed with LZ4 or zstd, whichever the packer was asked for, when that saves enough.
+ */
+
+#define ASSET_ARCHIVE_MAGIC		0x4B50544Eu // "NTPK"
+#define ASSET_ARCHIVE_VERSION	1u
+#define ASSET_ARCHIVE_ALIGNMENT 4096ull
+
+enum class AssetCodec : uint32_t
+{
+	NONE,
+	LZ4,
+	ZSTD,
+};
+
+struct AssetArchiveHeader
+{
+	uint32_t magic;
+	uint32_t version;
+	uint32_t entriesCount;
+	uint32_t slotsCount; // power of two
+	uint64_t namesSize;
+	uint64_t dataOffset; // first entry, aligned
+};
+
+struct AssetArchiveEntry
+{
+	uint64_t   pathHash;
+	uint64_t   offset; // from the start of the archive, aligned
+	uint64_t   storedSize;
+	uint64_t   size; // once decompressed
+	AssetCodec codec;
+	uint32_t   nameOffset; // in the names blob, null terminated
+};
+
+// Written and read as raw bytes
+static_assert(sizeof(AssetArchiveHeader) == 32 && sizeof(AssetArchiveEntry) == 40, "Unexpected archive layout");
+
+// FNV-1a, never 0 since 0 marks the empty slots of the directory
+inline uint64_t hashAssetPath(std::string_view path)
+{
+	uint64_t hash = 0xcbf29ce484222325ull;
+	for (char c : path)
+	{
+		hash ^= uint8_t(c);
+		hash *= 0x100000001b3ull;
+	}
+	return hash == 0 ? 1 : hash;
+}
+
+} // namespace ntt
\ No newline at end of file
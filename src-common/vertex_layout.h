@@ -0,0 +1,191 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+
+namespace ntt {
+
+/**
+ * Vertex layouts described next to their struct and resolved at compile time, shared by both backends. The description
+ * gives every member its attribute type, in location order, and `VERTEX_LAYOUT` static_asserts that each member has the
+ * size of its type and that the attributes cover the whole struct without overlapping, so a member added, resized,
+ * listed twice or padded without updating the layout does not compile. The backends read `VertexLayout<TVertex>` as
+ * constant data: `VertexFormat::create<TVertex>` in the OpenGL one and `getVertexInputDescription<TVertex>` in the
+ * Vulkan one.
+ *
+ * @example
+ * ```c++
+ * struct MeshVertex
+ * {
+ *     vec3 position;
+ *     u32  normal;
+ *     u16  texCoord[2];
+ * };
+ *
+ * VERTEX_LAYOUT(MeshVertex,
+ *               VERTEX_ATTRIBUTE(position, VEC3),
+ *               VERTEX_ATTRIBUTE(normal, INT_2_10_10_10_NORM),
+ *               VERTEX_ATTRIBUTE(texCoord, HALF2));
+ * ```
+ */
+
+enum class VertexAttributeType
+{
+	FLOAT,
+	VEC2,
+	VEC3,
+	VEC4,
+	HALF2, // 16 bits floats, read as vec2 and vec4
+	HALF4,
+	BYTE4_NORM, // normalized integers, [-1, 1] when signed and [0, 1] otherwise
+	UBYTE4_NORM,
+	SHORT2_NORM,
+	SHORT4_NORM,
+	USHORT2_NORM,
+	USHORT4_NORM,
+	INT_2_10_10_10_NORM, // xyz on 10 bits and w on 2, for normals and tangents
+	UINT_2_10_10_10_NORM,
+	UBYTE4, // integer attributes, read as uvec4
+	USHORT4,
+};
+
+enum class VertexComponentType
+{
+	FLOAT,
+	HALF,
+	BYTE,
+	UNSIGNED_BYTE,
+	SHORT,
+	UNSIGNED_SHORT,
+	INT_2_10_10_10,	 // the whole attribute is one packed component
+	UINT_2_10_10_10,
+};
+
+struct VertexAttributeFormat
+{
+	uint32_t			componentsCount;
+	VertexComponentType componentType;
+	uint32_t			size;
+	bool				normalized;
+	bool				integer;
+};
+
+constexpr VertexAttributeFormat getVertexAttributeFormat(VertexAttributeType type)
+{
+	switch (type)
+	{
+	case VertexAttributeType::FLOAT:
+		return {1, VertexComponentType::FLOAT, 4, false, false};
+	case VertexAttributeType::VEC2:
+		return {2, VertexComponentType::FLOAT, 8, false, false};
+	case VertexAttributeType::VEC3:
+		return {3, VertexComponentType::FLOAT, 12, false, false};
+	case VertexAttributeType::VEC4:
+		return {4, VertexComponentType::FLOAT, 16, false, false};
+	case VertexAttributeType::HALF2:
+		return {2, VertexComponentType::HALF, 4, false, false};
+	case VertexAttributeType::HALF4:
+		return {4, VertexComponentType::HALF, 8, false, false};
+	case VertexAttributeType::BYTE4_NORM:
+		return {4, VertexComponentType::BYTE, 4, true, false};
+	case VertexAttributeType::UBYTE4_NORM:
+		return {4, VertexComponentType::UNSIGNED_BYTE, 4, true, false};
+	case VertexAttributeType::SHORT2_NORM:
+		return {2, VertexComponentType::SHORT, 4, true, false};
+	case VertexAttributeType::SHORT4_NORM:
+		return {4, VertexComponentType::SHORT, 8, true, false};
+	case VertexAttributeType::USHORT2_NORM:
+		return {2, VertexComponentType::UNSIGNED_SHORT, 4, true, false};
+	case VertexAttributeType::USHORT4_NORM:
+		return {4, VertexComponentType::UNSIGNED_SHORT, 8, true, false};
+	case VertexAttributeType::INT_2_10_10_10_NORM:
+		return {4, VertexComponentType::INT_2_10_10_10, 4, true, false};
+	case VertexAttributeType::UINT_2_10_10_10_NORM:
+		return {4, VertexComponentType::UINT_2_10_10_10, 4, true, false};
+	case VertexAttributeType::UBYTE4:
+		return {4, VertexComponentType::UNSIGNED_BYTE, 4, false, true};
+	case VertexAttributeType::USHORT4:
+		return {4, VertexComponentType::UNSIGNED_SHORT, 8, false, true};
+	}
+	return {0, VertexComponentType::FLOAT, 0, false, false};
+}
+
+struct VertexLayoutAttribute
+{
+	VertexAttributeType type;
+	uint32_t			offset;
+	uint32_t			memberSize;
+};
+
+// Specialized by VERTEX_LAYOUT with stride, attributes and attributesCount
+template <typename TVertex>
+struct VertexLayout;
+
+template <typename TVertex>
+constexpr bool hasVertexLayoutMatchingSizes()
+{
+	for (const VertexLayoutAttribute& attribute : VertexLayout<TVertex>::attributes)
+	{
+		if (attribute.memberSize != getVertexAttributeFormat(attribute.type).size)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+template <typename TVertex>
+constexpr bool isVertexLayoutTightlyPacked()
+{
+	uint32_t size = 0;
+	for (const VertexLayoutAttribute& attribute : VertexLayout<TVertex>::attributes)
+	{
+		size += attribute.memberSize;
+	}
+	return size == VertexLayout<TVertex>::stride;
+}
+
+// Together with the sizes adding up to the stride, every byte of the vertex belongs to exactly one attribute
+template <typename TVertex>
+constexpr bool hasVertexLayoutDisjointAttributes()
+{
+	constexpr uint32_t count = VertexLayout<TVertex>::attributesCount;
+	for (uint32_t first = 0; first < count; ++first)
+	{
+		for (uint32_t second = first + 1; second < count; ++second)
+		{
+			const VertexLayoutAttribute& a = VertexLayout<TVertex>::attributes[first];
+			const VertexLayoutAttribute& b = VertexLayout<TVertex>::attributes[second];
+			if (a.offset < b.offset + b.memberSize && b.offset < a.offset + a.memberSize)
+			{
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+// Only valid inside VERTEX_LAYOUT, member of the struct being described
+#define VERTEX_ATTRIBUTE(member, attributeType)                                                                        \
+	ntt::VertexLayoutAttribute                                                                                         \
+	{                                                                                                                  \
+		ntt::VertexAttributeType::attributeType, uint32_t(offsetof(VertexType, member)),                               \
+			uint32_t(sizeof(VertexType::member))                                                                       \
+	}
+
+// At global scope, after the struct
+#define VERTEX_LAYOUT(vertex, ...)                                                                                     \
+	template <>                                                                                                        \
+	struct ntt::VertexLayout<vertex>                                                                                   \
+	{                                                                                                                  \
+		using VertexType = vertex;                                                                                     \
+                                                                                                                       \
+		static constexpr uint32_t                   stride          = sizeof(vertex);                                  \
+		static constexpr ntt::VertexLayoutAttribute attributes[]    = {__VA_ARGS__};                                   \
+		static constexpr uint32_t                   attributesCount = uint32_t(std::size(attributes));                 \
+	};                                                                                                                 \
+	static_assert(ntt::hasVertexLayoutMatchingSizes<vertex>(), "A member of " #vertex " does not fit its type");       \
+	static_assert(ntt::hasVertexLayoutDisjointAttributes<vertex>(), #vertex " lists overlapping members");             \
+	static_assert(ntt::isVertexLayoutTightlyPacked<vertex>(), #vertex " has padding or members outside its layout")
+
+} // namespace ntt
\ No newline at end of file
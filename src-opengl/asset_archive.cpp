@@ -0,0 +1,271 @@
+#include "asset_archive.h"
+#include <algorithm>
+#include <fcntl.h>
+#include <lz4.h>
+#include <unistd.h>
+#include <zstd.h>
+
+#if NTT_IO_URING
+#include <liburing.h>
+#endif
+
+#define ASSET_ARCHIVE_QUEUE_DEPTH 64
+
+namespace ntt {
+
+static bool readAt(i32 fd, void* pBuffer, u64 size, u64 offset)
+{
+	u8* pBytes = (u8*)pBuffer;
+	while (size > 0)
+	{
+		ssize_t readSize = pread(fd, pBytes, size_t(size), off_t(offset));
+		if (readSize <= 0)
+		{
+			return false;
+		}
+		pBytes += readSize;
+		size -= u64(readSize);
+		offset += u64(readSize);
+	}
+	return true;
+}
+
+AssetArchive::AssetArchive(const std::string& path)
+	: m_path(path)
+	, m_fd(-1)
+	, m_header()
+	, m_pRing(nullptr)
+{
+	i32 fd = open(path.c_str(), O_RDONLY);
+	if (fd < 0)
+	{
+		return;
+	}
+
+	if (!readAt(fd, &m_header, sizeof(m_header), 0) || m_header.magic != ASSET_ARCHIVE_MAGIC ||
+		m_header.version != ASSET_ARCHIVE_VERSION || (m_header.slotsCount & (m_header.slotsCount - 1)) != 0)
+	{
+		fprintf(stderr, "Invalid asset archive: %s\n", path.c_str());
+		close(fd);
+		return;
+	}
+
+	m_slots.resize(m_header.slotsCount);
+	m_names.resize(m_header.namesSize);
+	u64 slotsSize = m_slots.size() * sizeof(AssetArchiveEntry);
+	if (!readAt(fd, m_slots.data(), slotsSize, sizeof(m_header)) ||
+		!readAt(fd, m_names.data(), m_names.size(), sizeof(m_header) + slotsSize))
+	{
+		fprintf(stderr, "Truncated asset archive: %s\n", path.c_str());
+		close(fd);
+		return;
+	}
+	m_fd = fd;
+
+#if NTT_IO_URING
+	// Not an error when refused (old kernel, seccomp), the batches go through pread instead
+	io_uring* pRing = new io_uring();
+	if (io_uring_queue_init(ASSET_ARCHIVE_QUEUE_DEPTH, pRing, 0) == 0)
+	{
+		m_pRing = pRing;
+	}
+	else
+	{
+		delete pRing;
+	}
+#endif
+}
+
+AssetArchive::~AssetArchive()
+{
+#if NTT_IO_URING
+	if (m_pRing != nullptr)
+	{
+		io_uring_queue_exit((io_uring*)m_pRing);
+		delete (io_uring*)m_pRing;
+	}
+#endif
+
+	if (m_fd >= 0)
+	{
+		close(m_fd);
+	}
+}
+
+const AssetArchiveEntry* AssetArchive::findEntry(std::string_view path) const
+{
+	if (m_slots.empty())
+	{
+		return nullptr;
+	}
+
+	u64 hash = hashAssetPath(path);
+	u32 mask = u32(m_slots.size()) - 1;
+	for (u32 slot = u32(hash) & mask;; slot = (slot + 1) & mask)
+	{
+		const AssetArchiveEntry& entry = m_slots[slot];
+		if (entry.pathHash == 0)
+		{
+			return nullptr;
+		}
+		if (entry.pathHash == hash && path == &m_names[entry.nameOffset])
+		{
+			return &entry;
+		}
+	}
+}
+
+void AssetArchive::preload()
+{
+	std::vector<const AssetArchiveEntry*> entries;
+	for (const AssetArchiveEntry& entry : m_slots)
+	{
+		if (entry.pathHash != 0 && m_preloaded.find(entry.pathHash) == m_preloaded.end())
+		{
+			entries.push_back(&entry);
+		}
+	}
+
+	// In file order, the device sees one forward sweep over the archive
+	std::sort(entries.begin(), entries.end(), [](const AssetArchiveEntry* pA, const AssetArchiveEntry* pB) {
+		return pA->offset < pB->offset;
+	});
+
+	std::vector<std::vector<u8>> contents(entries.size());
+	readEntries(entries.data(), u32(entries.size()), contents.data());
+
+	for (u32 entryIndex = 0u; entryIndex < u32(entries.size()); ++entryIndex)
+	{
+		m_preloaded[entries[entryIndex]->pathHash] = std::move(contents[entryIndex]);
+	}
+}
+
+bool AssetArchive::readEntry(const AssetArchiveEntry& entry, std::vector<u8>& content)
+{
+	auto preloaded = m_preloaded.find(entry.pathHash);
+	if (preloaded != m_preloaded.end())
+	{
+		content.swap(preloaded->second);
+		m_preloaded.erase(preloaded);
+		return content.size() == entry.size;
+	}
+
+	const AssetArchiveEntry* pEntry = &entry;
+	readEntries(&pEntry, 1, &content);
+	return content.size() == entry.size;
+}
+
+const char* AssetArchive::getReadBackendName() const
+{
+	return m_pRing != nullptr ? "io_uring" : "pread";
+}
+
+// Failed reads leave an empty content behind, which the callers compare against the entry size
+void AssetArchive::readEntries(const AssetArchiveEntry* const* ppEntries, u32 entriesCount, std::vector<u8>* pContents)
+{
+	// Stored entries are read straight into their final buffer, compressed ones into a temporary one
+	std::vector<std::vector<u8>> stored(entriesCount);
+	auto getBuffer = [&](u32 entryIndex) -> std::vector<u8>& {
+		return ppEntries[entryIndex]->codec == AssetCodec::NONE ? pContents[entryIndex] : stored[entryIndex];
+	};
+
+	for (u32 entryIndex = 0u; entryIndex < entriesCount; ++entryIndex)
+	{
+		getBuffer(entryIndex).resize(ppEntries[entryIndex]->storedSize);
+	}
+
+	auto finishEntry = [&](u32 entryIndex, bool success) {
+		const AssetArchiveEntry& entry = *ppEntries[entryIndex];
+		if (!success)
+		{
+			pContents[entryIndex].clear();
+		}
+		else if (entry.codec != AssetCodec::NONE && !decompress(entry, stored[entryIndex], pContents[entryIndex]))
+		{
+			pContents[entryIndex].clear();
+		}
+		stored[entryIndex] = std::vector<u8>();
+	};
+
+#if NTT_IO_URING
+	if (m_pRing != nullptr)
+	{
+		// Keeps up to ASSET_ARCHIVE_QUEUE_DEPTH reads in flight, entries are decompressed as their reads complete
+		io_uring* pRing			= (io_uring*)m_pRing;
+		u32		  submitted		= 0;
+		u32		  completed		= 0;
+		u32		  inFlightCount = 0;
+		while (completed < entriesCount)
+		{
+			while (submitted < entriesCount && inFlightCount < ASSET_ARCHIVE_QUEUE_DEPTH)
+			{
+				io_uring_sqe* pSqe = io_uring_get_sqe(pRing);
+				if (pSqe == nullptr)
+				{
+					break;
+				}
+
+				std::vector<u8>& buffer = getBuffer(submitted);
+				io_uring_prep_read(pSqe, m_fd, buffer.data(), u32(buffer.size()), ppEntries[submitted]->offset);
+				io_uring_sqe_set_data(pSqe, (void*)uintptr_t(submitted));
+				submitted++;
+				inFlightCount++;
+			}
+			ASSERT(io_uring_submit(pRing) >= 0);
+
+			io_uring_cqe* pCqe = nullptr;
+			ASSERT(io_uring_wait_cqe(pRing, &pCqe) == 0);
+			u32 entryIndex = u32(uintptr_t(io_uring_cqe_get_data(pCqe)));
+			i32 result	   = pCqe->res;
+			io_uring_cqe_seen(pRing, pCqe);
+			inFlightCount--;
+			completed++;
+
+			// Short reads are finished synchronously
+			std::vector<u8>& buffer	 = getBuffer(entryIndex);
+			bool			 success = result >= 0;
+			if (success && u64(result) < buffer.size())
+			{
+				success = readAt(m_fd,
+								 buffer.data() + result,
+								 buffer.size() - u64(result),
+								 ppEntries[entryIndex]->offset + u64(result));
+			}
+			finishEntry(entryIndex, success);
+		}
+		return;
+	}
+#endif
+
+	for (u32 entryIndex = 0u; entryIndex < entriesCount; ++entryIndex)
+	{
+		std::vector<u8>& buffer = getBuffer(entryIndex);
+		finishEntry(entryIndex, readAt(m_fd, buffer.data(), buffer.size(), ppEntries[entryIndex]->offset));
+	}
+}
+
+bool AssetArchive::decompress(const AssetArchiveEntry& entry,
+							  const std::vector<u8>&   stored,
+							  std::vector<u8>&		   content) const
+{
+	content.resize(entry.size);
+
+	switch (entry.codec)
+	{
+	case AssetCodec::LZ4:
+	{
+		i32 size = LZ4_decompress_safe(
+			(const char*)stored.data(), (char*)content.data(), i32(stored.size()), i32(content.size()));
+		return size >= 0 && u64(size) == entry.size;
+	}
+	case AssetCodec::ZSTD:
+	{
+		size_t size = ZSTD_decompress(content.data(), content.size(), stored.data(), stored.size());
+		return !ZSTD_isError(size) && size == entry.size;
+	}
+	default:
+		return false;
+	}
+}
+
+} // namespace ntt
\ No newline at end of file
@@ -0,0 +1,78 @@
+#pragma once
+#include "common.h"
+#include "asset_archive_format.h"
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace ntt {
+
+/**
+ * Every asset packed into a single file by the AssetPacker tool, laid out as asset_archive_format.h describes.
+ *
+ * @example
+ * ```c++
+ * AssetArchive archive(STRINGIFY(BUILD_DIR) "/assets.pak");
+ * archive.preload(); // every entry in one batch of reads
+ *
+ * std::vector<u8> content;
+ * const AssetArchiveEntry* pEntry = archive.findEntry("images/meed-logo.png");
+ * if (pEntry != nullptr && archive.readEntry(*pEntry, content)) { ... }
+ * ```
+ */
+
+class AssetArchive
+{
+public:
+	AssetArchive(const std::string& path);
+	AssetArchive(const AssetArchive&) = delete;
+	~AssetArchive();
+
+public:
+	inline bool isOpen() const
+	{
+		return m_fd >= 0;
+	}
+
+	inline u32 getEntriesCount() const
+	{
+		return m_header.entriesCount;
+	}
+
+	inline i32 getFileDescriptor() const
+	{
+		return m_fd;
+	}
+
+	const AssetArchiveEntry* findEntry(std::string_view path) const;
+
+	inline bool isPreloaded(const AssetArchiveEntry& entry) const
+	{
+		return m_preloaded.find(entry.pathHash) != m_preloaded.end();
+	}
+
+	// Reads and decompresses every entry in one batch, io_uring keeps all the reads in flight at once when available,
+	// pread is used otherwise. The contents wait in memory until taken by readEntry
+	void preload();
+
+	// Content of the entry, taken over from the preloaded ones when present, read on the spot otherwise
+	bool readEntry(const AssetArchiveEntry& entry, std::vector<u8>& content);
+
+	const char* getReadBackendName() const;
+
+private:
+	void readEntries(const AssetArchiveEntry* const* ppEntries, u32 entriesCount, std::vector<u8>* pContents);
+	bool decompress(const AssetArchiveEntry& entry, const std::vector<u8>& stored, std::vector<u8>& content) const;
+
+private:
+	std::string					   m_path;
+	i32							   m_fd;
+	AssetArchiveHeader			   m_header;
+	std::vector<AssetArchiveEntry> m_slots;
+	std::vector<char>			   m_names;
+	void*						   m_pRing; // io_uring, nullptr when batched reads use pread
+
+	std::unordered_map<u64, std::vector<u8>> m_preloaded; // keyed by path hash
+};
+
+} // namespace ntt
\ No newline at end of file
@@ -0,0 +1,252 @@
+#include "buffer_arena.h"
+#include <algorithm>
+#include <easy/profiler.h>
+
+namespace ntt {
+
+static u64 alignUp(u64 offset, u64 alignment)
+{
+	return (offset + alignment - 1) / alignment * alignment;
+}
+
+BufferArena::BufferArena(u64 blockSize)
+	: m_blockSize(blockSize)
+	, m_mappedCount(0)
+{
+}
+
+BufferArena::BufferArena(BufferArena&& other) noexcept
+	: m_blocks(std::move(other.m_blocks))
+	, m_allocations(std::move(other.m_allocations))
+	, m_freeHandles(std::move(other.m_freeHandles))
+	, m_blockSize(other.m_blockSize)
+	, m_mappedCount(other.m_mappedCount)
+{
+	other.m_blocks.clear();
+}
+
+BufferArena::~BufferArena()
+{
+	for (Block& block : m_blocks)
+	{
+		GL_ASSERT(glDeleteBuffers(1, &block.bufferId));
+	}
+	m_blocks.clear();
+}
+
+u32 BufferArena::allocate(u64 size, u64 alignment)
+{
+	ASSERT(size > 0 && alignment > 0);
+
+	// Best fit over every block, the least space left over wins
+	u32 bestBlock	 = u32(m_blocks.size());
+	u64 bestRange	 = 0;
+	u64 bestLeftOver = ~0ull;
+	for (u32 blockIndex = 0u; blockIndex < u32(m_blocks.size()); ++blockIndex)
+	{
+		for (const auto& [offset, rangeSize] : m_blocks[blockIndex].freeRanges)
+		{
+			u64 aligned = alignUp(offset, alignment);
+			if (aligned + size <= offset + rangeSize && rangeSize - size < bestLeftOver)
+			{
+				bestBlock	 = blockIndex;
+				bestRange	 = offset;
+				bestLeftOver = rangeSize - size;
+			}
+		}
+	}
+
+	if (bestBlock == m_blocks.size())
+	{
+		bestBlock = createBlock(std::max(m_blockSize, size));
+		bestRange = 0;
+	}
+
+	// The alignment padding and the tail go back to the free ranges
+	Block& block	 = m_blocks[bestBlock];
+	u64	   rangeSize = block.freeRanges[bestRange];
+	u64	   aligned	 = alignUp(bestRange, alignment);
+	block.freeRanges.erase(bestRange);
+	if (aligned > bestRange)
+	{
+		block.freeRanges[bestRange] = aligned - bestRange;
+	}
+	if (aligned + size < bestRange + rangeSize)
+	{
+		block.freeRanges[aligned + size] = bestRange + rangeSize - aligned - size;
+	}
+
+	Allocation allocation = {bestBlock, aligned, size, alignment, true};
+	if (!m_freeHandles.empty())
+	{
+		u32 handle = m_freeHandles.back();
+		m_freeHandles.pop_back();
+		m_allocations[handle] = allocation;
+		return handle;
+	}
+	m_allocations.push_back(allocation);
+	return u32(m_allocations.size()) - 1;
+}
+
+void BufferArena::free(u32 allocation)
+{
+	Allocation& freed = m_allocations[allocation];
+	ASSERT(freed.live);
+
+	releaseRange(m_blocks[freed.block], freed.offset, freed.size);
+	freed.live = false;
+	m_freeHandles.push_back(allocation);
+}
+
+BufferRange BufferArena::getRange(u32 allocation) const
+{
+	const Allocation& range = m_allocations[allocation];
+	ASSERT(range.live);
+	return {m_blocks[range.block].bufferId, range.offset, range.size};
+}
+
+void BufferArena::upload(u32 allocation, const void* pData, u64 size)
+{
+	BufferRange range = getRange(allocation);
+	ASSERT(size <= range.size);
+	GL_ASSERT(glNamedBufferSubData(range.bufferId, range.offset, size, pData));
+}
+
+void* BufferArena::map(u32 allocation)
+{
+	BufferRange range = getRange(allocation);
+	void*		pData = glMapNamedBufferRange(
+		range.bufferId, range.offset, range.size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT);
+	ASSERT(pData != nullptr);
+	m_mappedCount++;
+	return pData;
+}
+
+void BufferArena::unmap(u32 allocation)
+{
+	GL_ASSERT(glUnmapNamedBuffer(getRange(allocation).bufferId));
+	m_mappedCount--;
+}
+
+u64 BufferArena::compact()
+{
+	EASY_FUNCTION();
+	ASSERT(m_mappedCount == 0);
+
+	// Live allocations in their current block and offset order, new blocks are filled one after the other
+	std::vector<u32> order;
+	for (u32 handle = 0u; handle < u32(m_allocations.size()); ++handle)
+	{
+		if (m_allocations[handle].live)
+		{
+			order.push_back(handle);
+		}
+	}
+	std::sort(order.begin(), order.end(), [&](u32 a, u32 b) {
+		const Allocation& allocationA = m_allocations[a];
+		const Allocation& allocationB = m_allocations[b];
+		return allocationA.block != allocationB.block ? allocationA.block < allocationB.block
+													  : allocationA.offset < allocationB.offset;
+	});
+
+	std::vector<Block> oldBlocks;
+	oldBlocks.swap(m_blocks);
+
+	// Only the alignment padding and the end of every block stay free
+	u64	 copiedSize = 0;
+	u64	 tail		= 0;
+	auto closeBlock = [&]() {
+		if (!m_blocks.empty() && tail < m_blocks.back().size)
+		{
+			m_blocks.back().freeRanges[tail] = m_blocks.back().size - tail;
+		}
+	};
+	for (u32 handle : order)
+	{
+		Allocation& allocation = m_allocations[handle];
+		u64			aligned	   = alignUp(tail, allocation.alignment);
+		if (m_blocks.empty() || aligned + allocation.size > m_blocks.back().size)
+		{
+			closeBlock();
+			createBlock(std::max(m_blockSize, allocation.size));
+			m_blocks.back().freeRanges.clear();
+			aligned = 0;
+		}
+		else if (aligned > tail)
+		{
+			m_blocks.back().freeRanges[tail] = aligned - tail;
+		}
+
+		GL_ASSERT(glCopyNamedBufferSubData(oldBlocks[allocation.block].bufferId,
+										   m_blocks.back().bufferId,
+										   allocation.offset,
+										   aligned,
+										   allocation.size));
+		copiedSize += allocation.size;
+		allocation.block  = u32(m_blocks.size()) - 1;
+		allocation.offset = aligned;
+		tail			  = aligned + allocation.size;
+	}
+	closeBlock();
+
+	for (Block& block : oldBlocks)
+	{
+		GL_ASSERT(glDeleteBuffers(1, &block.bufferId));
+	}
+	return copiedSize;
+}
+
+BufferArenaStatistics BufferArena::getStatistics() const
+{
+	BufferArenaStatistics statistics = {};
+	statistics.blocksCount			 = u32(m_blocks.size());
+	statistics.allocationsCount		 = u32(m_allocations.size() - m_freeHandles.size());
+
+	u64 freeSize = 0;
+	for (const Block& block : m_blocks)
+	{
+		statistics.capacity += block.size;
+		for (const auto& [offset, rangeSize] : block.freeRanges)
+		{
+			freeSize += rangeSize;
+			statistics.largestFreeRange = std::max(statistics.largestFreeRange, rangeSize);
+		}
+	}
+
+	statistics.usedSize		 = statistics.capacity - freeSize;
+	statistics.fragmentation = freeSize > 0 ? 1.0f - f32(statistics.largestFreeRange) / f32(freeSize) : 0.0f;
+	return statistics;
+}
+
+u32 BufferArena::createBlock(u64 size)
+{
+	Block block = {0, size, {}};
+	GL_ASSERT(glCreateBuffers(1, &block.bufferId));
+	GL_ASSERT(glNamedBufferStorage(block.bufferId, size, nullptr, GL_DYNAMIC_STORAGE_BIT | GL_MAP_WRITE_BIT));
+	block.freeRanges[0] = size;
+	m_blocks.push_back(std::move(block));
+	return u32(m_blocks.size()) - 1;
+}
+
+void BufferArena::releaseRange(Block& block, u64 offset, u64 size)
+{
+	// Merged with the free range right after, then with the one right before
+	auto next = block.freeRanges.lower_bound(offset);
+	if (next != block.freeRanges.end() && next->first == offset + size)
+	{
+		size += next->second;
+		next = block.freeRanges.erase(next);
+	}
+	if (next != block.freeRanges.begin())
+	{
+		auto previous = std::prev(next);
+		if (previous->first + previous->second == offset)
+		{
+			previous->second += size;
+			return;
+		}
+	}
+	block.freeRanges[offset] = size;
+}
+
+} // namespace ntt
\ No newline at end of file
@@ -0,0 +1,99 @@
+#pragma once
+#include "common.h"
+#include <map>
+#include <vector>
+
+namespace ntt {
+
+/**
+ * Immutable glBufferStorage blocks that static meshes are sub-allocated from, so a scene with thousands of meshes binds
+ * a handful of buffer objects and draws them with base vertex and first index offsets. Every block keeps its free
+ * ranges sorted by offset, allocations take the best fitting range and freed ranges are merged with their neighbours.
+ * Allocations are handles: `compact` repacks the live allocations into as few blocks as possible with GPU copies and
+ * only the ranges the handles resolve to change, which has to be re-read before the next draw.
+ *
+ * @example
+ * ```c++
+ * BufferArena vertexArena(64 * 1024 * 1024);
+ * u32		   vertices = vertexArena.allocate(verticesSize, sizeof(VertexData));
+ * vertexArena.upload(vertices, pVertices, verticesSize);
+ *
+ * BufferRange range = vertexArena.getRange(vertices);
+ * glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, range.bufferId);
+ * glDrawElementsBaseVertex(GL_TRIANGLES, count, GL_UNSIGNED_INT, firstIndexOffset, range.offset / sizeof(VertexData));
+ * ```
+ */
+
+struct BufferRange
+{
+	u32 bufferId;
+	u64 offset;
+	u64 size;
+};
+
+struct BufferArenaStatistics
+{
+	u32 blocksCount;
+	u32 allocationsCount;
+	u64 capacity;
+	u64 usedSize;
+	u64 largestFreeRange;
+	f32 fragmentation; // 1 - largest free range / free bytes, 0 when the free bytes are contiguous
+};
+
+class BufferArena
+{
+public:
+	// Allocations larger than blockSize get a block of their own
+	BufferArena(u64 blockSize);
+	BufferArena(const BufferArena&) = delete;
+	BufferArena(BufferArena&& other) noexcept;
+	~BufferArena();
+
+public:
+	// Handle of size bytes at a multiple of alignment, which does not have to be a power of two
+	u32	 allocate(u64 size, u64 alignment);
+	void free(u32 allocation);
+
+	BufferRange getRange(u32 allocation) const;
+
+	void upload(u32 allocation, const void* pData, u64 size);
+
+	// Write only, one allocation of a block at a time
+	void* map(u32 allocation);
+	void  unmap(u32 allocation);
+
+	// Packs the live allocations into new blocks and releases the old ones, returns the bytes copied
+	u64 compact();
+
+	BufferArenaStatistics getStatistics() const;
+
+private:
+	struct Block
+	{
+		u32				   bufferId;
+		u64				   size;
+		std::map<u64, u64> freeRanges; // offset to size
+	};
+
+	struct Allocation
+	{
+		u32	 block;
+		u64	 offset;
+		u64	 size;
+		u64	 alignment;
+		bool live;
+	};
+
+	u32	 createBlock(u64 size);
+	void releaseRange(Block& block, u64 offset, u64 size);
+
+private:
+	std::vector<Block>		m_blocks;
+	std::vector<Allocation> m_allocations;
+	std::vector<u32>		m_freeHandles;
+	u64						m_blockSize;
+	u32						m_mappedCount;
+};
+
+} // namespace ntt
\ No newline at end of file
@@ -44,6 +44,9 @@ typedef double f64;
 #include <string>
 
 #include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
 typedef glm::vec2 vec2;
 typedef glm::vec3 vec3;
-typedef glm::vec4 vec4;
\ No newline at end of file
+typedef glm::vec4 vec4;
+typedef glm::quat quat;
+typedef glm::mat4 mat4;
\ No newline at end of file
@@ -0,0 +1,105 @@
+#include "dynamic_resolution.h"
+#include <algorithm>
+#include <cmath>
+
+#define DYNAMIC_RESOLUTION_MIN_SCALE 0.5f
+#define DYNAMIC_RESOLUTION_MAX_SCALE 1.0f
+#define DYNAMIC_RESOLUTION_MAX_STEP	 0.05f // per frame, the measures lag behind the scale by a few frames
+#define DYNAMIC_RESOLUTION_HEADROOM	 0.85f // under this share of the target the scale goes back up
+#define DYNAMIC_RESOLUTION_SMOOTHING 0.2f  // weight of the last frame in the smoothed frame time
+
+namespace ntt {
+
+DynamicResolution::DynamicResolution(f32 targetFrameMs)
+	: m_frameScales{}
+	, m_targetFrameMs(targetFrameMs)
+	, m_scale(DYNAMIC_RESOLUTION_MAX_SCALE)
+	, m_frameMs(0.0)
+	, m_enabled(true)
+	, m_framesCount(0)
+	, m_statistics{}
+{
+	ASSERT(targetFrameMs > 0.0f);
+	m_statistics.minScale = DYNAMIC_RESOLUTION_MAX_SCALE;
+	GL_ASSERT(glGenQueries(2 * DYNAMIC_RESOLUTION_FRAMES, m_timestampQueries));
+}
+
+DynamicResolution::DynamicResolution(DynamicResolution&& other) noexcept
+	: m_targetFrameMs(other.m_targetFrameMs)
+	, m_scale(other.m_scale)
+	, m_frameMs(other.m_frameMs)
+	, m_enabled(other.m_enabled)
+	, m_framesCount(other.m_framesCount)
+	, m_statistics(other.m_statistics)
+{
+	std::copy(other.m_timestampQueries, other.m_timestampQueries + 2 * DYNAMIC_RESOLUTION_FRAMES, m_timestampQueries);
+	std::copy(other.m_frameScales, other.m_frameScales + DYNAMIC_RESOLUTION_FRAMES, m_frameScales);
+	other.m_timestampQueries[0] = 0;
+}
+
+DynamicResolution::~DynamicResolution()
+{
+	if (m_timestampQueries[0] != 0)
+	{
+		GL_ASSERT(glDeleteQueries(2 * DYNAMIC_RESOLUTION_FRAMES, m_timestampQueries));
+		m_timestampQueries[0] = 0;
+	}
+}
+
+void DynamicResolution::setEnabled(bool enabled)
+{
+	m_enabled = enabled;
+	m_scale	  = enabled ? m_scale : DYNAMIC_RESOLUTION_MAX_SCALE;
+}
+
+u32 DynamicResolution::getRenderSize(u32 fullSize) const
+{
+	return std::max(1u, u32(std::lround(f32(fullSize) * m_scale)));
+}
+
+void DynamicResolution::beginFrame()
+{
+	// The queries written DYNAMIC_RESOLUTION_FRAMES frames ago are done by now, reading them does not stall
+	u32	 frame	  = u32(m_framesCount % DYNAMIC_RESOLUTION_FRAMES);
+	u32* pQueries = m_timestampQueries + 2 * frame;
+	if (m_framesCount >= DYNAMIC_RESOLUTION_FRAMES)
+	{
+		GLuint64 beginNs = 0;
+		GLuint64 endNs	 = 0;
+		GL_ASSERT(glGetQueryObjectui64v(pQueries[0], GL_QUERY_RESULT, &beginNs));
+		GL_ASSERT(glGetQueryObjectui64v(pQueries[1], GL_QUERY_RESULT, &endNs));
+
+		f64 frameMs = f64(endNs - beginNs) / 1000000.0;
+		f64 weight	= m_statistics.framesCount == 0 ? 1.0 : DYNAMIC_RESOLUTION_SMOOTHING;
+		m_frameMs += (frameMs - m_frameMs) * weight;
+
+		m_statistics.framesCount++;
+		m_statistics.overTargetFramesCount += frameMs > m_targetFrameMs ? 1 : 0;
+		m_statistics.frameMsSum += frameMs;
+		m_statistics.scaleSum += m_frameScales[frame];
+		m_statistics.minScale = std::min(m_statistics.minScale, m_frameScales[frame]);
+
+		// The pixels drawn go with the square of the scale, a frame twice over the target wants about 0.7 of it. The
+		// step is bounded since the frame time read back is a few frames behind the scale
+		bool overTarget = m_frameMs > m_targetFrameMs;
+		bool headroom	= m_frameMs < m_targetFrameMs * DYNAMIC_RESOLUTION_HEADROOM;
+		if (m_enabled && m_frameMs > 0.0 && (overTarget || headroom))
+		{
+			f32 wantedScale = m_scale * f32(std::sqrt(m_targetFrameMs / m_frameMs));
+			f32 step		= std::min(std::max(wantedScale - m_scale, -DYNAMIC_RESOLUTION_MAX_STEP),
+									   DYNAMIC_RESOLUTION_MAX_STEP);
+			m_scale = std::min(std::max(m_scale + step, DYNAMIC_RESOLUTION_MIN_SCALE), DYNAMIC_RESOLUTION_MAX_SCALE);
+		}
+	}
+
+	m_frameScales[frame] = m_scale;
+	GL_ASSERT(glQueryCounter(pQueries[0], GL_TIMESTAMP));
+}
+
+void DynamicResolution::endFrame()
+{
+	GL_ASSERT(glQueryCounter(m_timestampQueries[2 * (m_framesCount % DYNAMIC_RESOLUTION_FRAMES) + 1], GL_TIMESTAMP));
+	m_framesCount++;
+}
+
+} // namespace ntt
\ No newline at end of file
@@ -0,0 +1,93 @@
+#pragma once
+#include "common.h"
+
+namespace ntt {
+
+/**
+ * Render scale that holds a target GPU frame time. Every frame is timed with a pair of timestamp queries, read back
+ * DYNAMIC_RESOLUTION_FRAMES frames later so that it never stalls, and the smoothed frame time moves the scale down
+ * when it is over the target and back up when there is headroom. The scale applies to both sides of the render
+ * target, the GPU time of the draws follows its square.
+ *
+ * @example
+ * ```c++
+ * DynamicResolution resolution(targetFrameMs);
+ * resolution.beginFrame();
+ * target.setRenderSize(resolution.getRenderSize(width), resolution.getRenderSize(height));
+ * target.bind();
+ * drawScene();
+ * target.blitToWindow(width, height);
+ * resolution.endFrame();
+ * ```
+ */
+
+// Frames between the timing of a frame and its read back
+#define DYNAMIC_RESOLUTION_FRAMES 3
+
+// Summed over the frames read back
+struct DynamicResolutionStatistics
+{
+	u32 framesCount;
+	u32 overTargetFramesCount;
+	f64 frameMsSum;
+	f64 scaleSum;
+	f32 minScale;
+};
+
+class DynamicResolution
+{
+public:
+	DynamicResolution(f32 targetFrameMs);
+	DynamicResolution(const DynamicResolution&) = delete;
+	DynamicResolution(DynamicResolution&& other) noexcept;
+	~DynamicResolution();
+
+public:
+	inline f32 getTargetFrameMs() const
+	{
+		return m_targetFrameMs;
+	}
+
+	inline f32 getScale() const
+	{
+		return m_scale;
+	}
+
+	// Smoothed GPU time of the frames read back, 0 before the first one
+	inline f64 getFrameMs() const
+	{
+		return m_frameMs;
+	}
+
+	inline bool isEnabled() const
+	{
+		return m_enabled;
+	}
+
+	inline const DynamicResolutionStatistics& getStatistics() const
+	{
+		return m_statistics;
+	}
+
+	// Disabled, the scale goes back to 1 and stays there, the frames are still timed
+	void setEnabled(bool enabled);
+
+	// Rounded to whole pixels, at least one
+	u32 getRenderSize(u32 fullSize) const;
+
+	// Reads back the frame timed DYNAMIC_RESOLUTION_FRAMES frames ago, updates the scale, then starts timing this one
+	void beginFrame();
+	void endFrame();
+
+private:
+	u32							m_timestampQueries[2 * DYNAMIC_RESOLUTION_FRAMES]; // begin and end of every frame
+	f32							m_frameScales[DYNAMIC_RESOLUTION_FRAMES];
+	f32							m_targetFrameMs;
+	f32							m_scale;
+	f64							m_frameMs;
+	bool						m_enabled;
+	u64							m_framesCount;
+	DynamicResolutionStatistics m_statistics;
+};
+
+} // namespace ntt
\ No newline at end of file
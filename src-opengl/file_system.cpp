@@ -0,0 +1,253 @@
+#include "file_system.h"
+#include "asset_archive.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <mutex>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define NTT_FILE_MAPPING 1
+#else
+#define NTT_FILE_MAPPING 0
+#endif
+
+#define FILE_STREAM_CHUNK_SIZE (64 * 1024)
+
+using Clock = std::chrono::steady_clock;
+
+namespace ntt {
+
+static std::mutex				   s_statisticsMutex;
+static std::vector<FileStatistics> s_statistics;
+
+static std::mutex	 s_archiveMutex;
+static AssetArchive* s_pArchive = nullptr;
+static std::string	 s_mountPoint;
+
+static void recordFileStatistics(const std::string& path, u64 bytesRead, Clock::time_point start, FileSource source)
+{
+	f64 readMs = std::chrono::duration<f64, std::milli>(Clock::now() - start).count();
+
+	std::lock_guard<std::mutex> lock(s_statisticsMutex);
+	s_statistics.push_back({path, bytesRead, readMs, source});
+}
+
+void mountAssetArchive(AssetArchive* pArchive, const std::string& mountPoint)
+{
+	std::lock_guard<std::mutex> lock(s_archiveMutex);
+	s_pArchive	 = pArchive;
+	s_mountPoint = mountPoint;
+}
+
+void unmountAssetArchive()
+{
+	std::lock_guard<std::mutex> lock(s_archiveMutex);
+	s_pArchive = nullptr;
+	s_mountPoint.clear();
+}
+
+FileView::FileView(const std::string& path)
+	: m_pData(nullptr)
+	, m_size(0)
+	, m_open(false)
+	, m_mapped(false)
+{
+	Clock::time_point start = Clock::now();
+
+	if (readArchive(path))
+	{
+		m_open = true;
+		recordFileStatistics(path, m_size, start, FileSource::ARCHIVE);
+		return;
+	}
+
+#if NTT_FILE_MAPPING
+	i32 fd = open(path.c_str(), O_RDONLY);
+	if (fd < 0)
+	{
+		return;
+	}
+
+	struct stat fileStat;
+	if (fstat(fd, &fileStat) == 0 && S_ISREG(fileStat.st_mode) && fileStat.st_size > 0)
+	{
+		i32 flags = MAP_PRIVATE;
+#ifdef MAP_POPULATE
+		flags |= MAP_POPULATE; // fault every page in now rather than on first access
+#endif
+		void* pMapping = mmap(nullptr, size_t(fileStat.st_size), PROT_READ, flags, fd, 0);
+		if (pMapping != MAP_FAILED)
+		{
+			m_pData	 = (const u8*)pMapping;
+			m_size	 = u64(fileStat.st_size);
+			m_open	 = true;
+			m_mapped = true;
+		}
+	}
+	close(fd);
+#endif
+
+	if (!m_open)
+	{
+		m_open = streamFile(path);
+		if (!m_open)
+		{
+			return;
+		}
+	}
+
+	recordFileStatistics(path, m_size, start, m_mapped ? FileSource::MAPPED : FileSource::STREAMED);
+}
+
+bool FileView::readArchive(const std::string& path)
+{
+	std::lock_guard<std::mutex> lock(s_archiveMutex);
+	if (s_pArchive == nullptr || path.compare(0, s_mountPoint.size(), s_mountPoint) != 0)
+	{
+		return false;
+	}
+
+	const AssetArchiveEntry* pEntry = s_pArchive->findEntry(std::string_view(path).substr(s_mountPoint.size()));
+	if (pEntry == nullptr)
+	{
+		return false;
+	}
+
+#if NTT_FILE_MAPPING
+	// Stored entries start on a block boundary, unless already preloaded they are mapped in place like loose files
+	if (pEntry->codec == AssetCodec::NONE && pEntry->size > 0 && !s_pArchive->isPreloaded(*pEntry) &&
+		pEntry->offset % u64(sysconf(_SC_PAGESIZE)) == 0)
+	{
+		i32 flags = MAP_PRIVATE;
+#ifdef MAP_POPULATE
+		flags |= MAP_POPULATE;
+#endif
+		void* pMapping = mmap(
+			nullptr, size_t(pEntry->size), PROT_READ, flags, s_pArchive->getFileDescriptor(), off_t(pEntry->offset));
+		if (pMapping != MAP_FAILED)
+		{
+			m_pData	 = (const u8*)pMapping;
+			m_size	 = pEntry->size;
+			m_mapped = true;
+			return true;
+		}
+	}
+#endif
+
+	if (!s_pArchive->readEntry(*pEntry, m_buffer))
+	{
+		m_buffer.clear();
+		return false;
+	}
+	m_pData = m_buffer.data();
+	m_size	= m_buffer.size();
+	return true;
+}
+
+bool FileView::streamFile(const std::string& path)
+{
+	FILE* pFile = fopen(path.c_str(), "rb");
+	if (pFile == nullptr)
+	{
+		return false;
+	}
+
+	// The size is only a hint, pipes and special files do not have one
+	if (fseek(pFile, 0, SEEK_END) == 0)
+	{
+		long size = ftell(pFile);
+		if (size > 0)
+		{
+			// One byte more than announced, so reaching the end of the file never grows the buffer
+			m_buffer.resize(size_t(size) + 1);
+		}
+		fseek(pFile, 0, SEEK_SET);
+	}
+
+	size_t readSize = 0;
+	while (true)
+	{
+		if (readSize == m_buffer.size())
+		{
+			m_buffer.resize(m_buffer.size() + FILE_STREAM_CHUNK_SIZE);
+		}
+
+		size_t chunkSize = std::min(size_t(FILE_STREAM_CHUNK_SIZE), m_buffer.size() - readSize);
+		size_t chunkRead = fread(m_buffer.data() + readSize, 1, chunkSize, pFile);
+		readSize += chunkRead;
+		if (chunkRead < chunkSize)
+		{
+			break;
+		}
+	}
+
+	bool success = ferror(pFile) == 0;
+	fclose(pFile);
+
+	m_buffer.resize(readSize);
+	m_pData = m_buffer.data();
+	m_size	= readSize;
+	return success;
+}
+
+FileView::FileView(FileView&& other) noexcept
+	: m_pData(other.m_pData)
+	, m_size(other.m_size)
+	, m_open(other.m_open)
+	, m_mapped(other.m_mapped)
+	, m_buffer(std::move(other.m_buffer))
+{
+	if (!m_mapped)
+	{
+		m_pData = m_buffer.data();
+	}
+
+	other.m_pData  = nullptr;
+	other.m_size   = 0;
+	other.m_open   = false;
+	other.m_mapped = false;
+}
+
+FileView::~FileView()
+{
+#if NTT_FILE_MAPPING
+	if (m_mapped)
+	{
+		munmap((void*)m_pData, size_t(m_size));
+	}
+#endif
+	m_pData = nullptr;
+}
+
+std::vector<FileStatistics> getFileStatistics()
+{
+	std::lock_guard<std::mutex> lock(s_statisticsMutex);
+	return s_statistics;
+}
+
+void printFileStatistics()
+{
+	std::vector<FileStatistics> statistics = getFileStatistics();
+
+	const char* sourceNames[] = {"mapped  ", "streamed", "archive "};
+	u64			totalBytes	  = 0;
+	f64			totalMs		  = 0.0;
+	printf("File reads:\n");
+	for (const FileStatistics& file : statistics)
+	{
+		printf(" %8.3f ms %10llu bytes %s %s\n",
+			   file.readMs,
+			   (unsigned long long)file.bytesRead,
+			   sourceNames[u32(file.source)],
+			   file.path.c_str());
+		totalBytes += file.bytesRead;
+		totalMs += file.readMs;
+	}
+	printf(" %8.3f ms %10llu bytes in %u files\n", totalMs, (unsigned long long)totalBytes, u32(statistics.size()));
+}
+
+} // namespace ntt
\ No newline at end of file
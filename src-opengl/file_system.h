@@ -0,0 +1,93 @@
+#pragma once
+#include "common.h"
+#include <string_view>
+#include <vector>
+
+namespace ntt {
+
+class AssetArchive;
+
+/**
+ * Read-only content of a whole file. Regular files are memory mapped and prefaulted, so opening is the actual read,
+ * anything the mapping refuses is streamed into a heap buffer in fixed-size chunks instead. Paths under the mount point
+ * of an asset archive are served from it, see `mountAssetArchive`. Every open is recorded with its size, duration and
+ * path, see `printFileStatistics`.
+ *
+ * @example
+ * ```c++
+ * FileView file(STRINGIFY(SOURCE_DIR) "/assets/images/meed-logo.png");
+ * ASSERT(file.isOpen());
+ * u8* pixels = stbi_load_from_memory(file.getData(), i32(file.getSize()), &width, &height, &channels, 0);
+ * ```
+ */
+
+class FileView
+{
+public:
+	FileView(const std::string& path);
+	FileView(const FileView&) = delete;
+	FileView(FileView&& other) noexcept;
+	~FileView();
+
+public:
+	inline bool isOpen() const
+	{
+		return m_open;
+	}
+
+	inline bool isMapped() const
+	{
+		return m_mapped;
+	}
+
+	inline const u8* getData() const
+	{
+		return m_pData;
+	}
+
+	inline u64 getSize() const
+	{
+		return m_size;
+	}
+
+	inline std::string_view getText() const
+	{
+		return std::string_view((const char*)m_pData, m_size);
+	}
+
+private:
+	bool readArchive(const std::string& path);
+	bool streamFile(const std::string& path);
+
+private:
+	const u8*		m_pData;
+	u64				m_size;
+	bool			m_open;
+	bool			m_mapped;
+	std::vector<u8> m_buffer; // content of streamed files and of archive entries that are not mapped
+};
+
+enum class FileSource
+{
+	MAPPED,
+	STREAMED,
+	ARCHIVE,
+};
+
+struct FileStatistics
+{
+	std::string path;
+	u64			bytesRead;
+	f64			readMs;
+	FileSource	source;
+};
+
+std::vector<FileStatistics> getFileStatistics();
+void						printFileStatistics();
+
+// Serves the FileViews opened under mountPoint, e.g. STRINGIFY(SOURCE_DIR) "/assets/", from the archive, paths it does
+// not contain still go to the file system. One archive at a time, it must stay alive until unmounted
+void mountAssetArchive(AssetArchive* pArchive, const std::string& mountPoint);
+void unmountAssetArchive();
+
+} // namespace ntt
@@ -0,0 +1,764 @@
+#include "gltf_model.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <utility>
+
+namespace ntt {
+
+// Parsed once into a tree, strings stay views into the glTF text, escapes are kept as is since glTF keys never have
+// any and the URIs this loader accepts are relative paths
+struct JsonValue
+{
+	enum Type
+	{
+		NONE,
+		BOOLEAN,
+		NUMBER,
+		STRING,
+		ARRAY,
+		OBJECT,
+	};
+
+	Type												 type;
+	f64													 number;
+	std::string_view									 string;
+	std::vector<JsonValue>								 items;
+	std::vector<std::pair<std::string_view, JsonValue>> members;
+
+	const JsonValue* find(std::string_view key) const
+	{
+		for (const auto& [name, value] : members)
+		{
+			if (name == key)
+			{
+				return &value;
+			}
+		}
+		return nullptr;
+	}
+
+	i64 getInteger(std::string_view key, i64 fallback) const
+	{
+		const JsonValue* pValue = find(key);
+		return pValue != nullptr && pValue->type == NUMBER ? i64(pValue->number) : fallback;
+	}
+
+	const std::vector<JsonValue>& getItems(std::string_view key) const
+	{
+		static const std::vector<JsonValue> empty;
+		const JsonValue*					pValue = find(key);
+		return pValue != nullptr && pValue->type == ARRAY ? pValue->items : empty;
+	}
+};
+
+class JsonParser
+{
+public:
+	JsonParser(std::string_view text)
+		: m_text(text)
+		, m_position(0)
+	{
+	}
+
+public:
+	bool parse(JsonValue& value)
+	{
+		return parseValue(value) && (skipWhitespace(), m_position == m_text.size());
+	}
+
+private:
+	void skipWhitespace()
+	{
+		while (m_position < m_text.size() && (m_text[m_position] == ' ' || m_text[m_position] == '\t' ||
+											  m_text[m_position] == '\n' || m_text[m_position] == '\r'))
+		{
+			m_position++;
+		}
+	}
+
+	bool consume(char c)
+	{
+		skipWhitespace();
+		if (m_position < m_text.size() && m_text[m_position] == c)
+		{
+			m_position++;
+			return true;
+		}
+		return false;
+	}
+
+	bool consumeWord(std::string_view word)
+	{
+		if (m_text.substr(m_position, word.size()) != word)
+		{
+			return false;
+		}
+		m_position += word.size();
+		return true;
+	}
+
+	bool parseString(std::string_view& string)
+	{
+		if (!consume('"'))
+		{
+			return false;
+		}
+
+		u64 start = m_position;
+		while (m_position < m_text.size() && m_text[m_position] != '"')
+		{
+			m_position += m_text[m_position] == '\\' ? 2 : 1;
+		}
+		if (m_position >= m_text.size())
+		{
+			return false;
+		}
+
+		string = m_text.substr(start, m_position - start);
+		m_position++;
+		return true;
+	}
+
+	bool parseValue(JsonValue& value)
+	{
+		skipWhitespace();
+		if (m_position >= m_text.size())
+		{
+			return false;
+		}
+
+		char c = m_text[m_position];
+		if (c == '{')
+		{
+			value.type = JsonValue::OBJECT;
+			m_position++;
+			if (consume('}'))
+			{
+				return true;
+			}
+			do
+			{
+				value.members.emplace_back();
+				if (!parseString(value.members.back().first) || !consume(':') ||
+					!parseValue(value.members.back().second))
+				{
+					return false;
+				}
+			} while (consume(','));
+			return consume('}');
+		}
+		if (c == '[')
+		{
+			value.type = JsonValue::ARRAY;
+			m_position++;
+			if (consume(']'))
+			{
+				return true;
+			}
+			do
+			{
+				value.items.emplace_back();
+				if (!parseValue(value.items.back()))
+				{
+					return false;
+				}
+			} while (consume(','));
+			return consume(']');
+		}
+		if (c == '"')
+		{
+			value.type = JsonValue::STRING;
+			return parseString(value.string);
+		}
+		if (c == 't' || c == 'f')
+		{
+			value.type	 = JsonValue::BOOLEAN;
+			value.number = c == 't' ? 1.0 : 0.0;
+			return consumeWord(c == 't' ? "true" : "false");
+		}
+		if (c == 'n')
+		{
+			return consumeWord("null");
+		}
+
+		// The text is not null terminated, numbers are copied out before strtod
+		u64 start = m_position;
+		while (m_position < m_text.size() && strchr("+-0123456789.eE", m_text[m_position]) != nullptr)
+		{
+			m_position++;
+		}
+		std::string number(m_text.substr(start, m_position - start));
+		char*		pEnd = nullptr;
+		value.type		 = JsonValue::NUMBER;
+		value.number	 = strtod(number.c_str(), &pEnd);
+		return !number.empty() && pEnd == number.c_str() + number.size();
+	}
+
+private:
+	std::string_view m_text;
+	u64				 m_position;
+};
+
+static u32 getComponentsCount(std::string_view type)
+{
+	const std::pair<std::string_view, u32> types[] = {
+		{"SCALAR", 1}, {"VEC2", 2}, {"VEC3", 3}, {"VEC4", 4}, {"MAT2", 4}, {"MAT3", 9}, {"MAT4", 16}};
+	for (const auto& [name, componentsCount] : types)
+	{
+		if (name == type)
+		{
+			return componentsCount;
+		}
+	}
+	return 0;
+}
+
+// Exactly count numbers, or false
+static bool readFloats(const JsonValue* pValue, f32* pFloats, u32 count)
+{
+	if (pValue == nullptr || pValue->type != JsonValue::ARRAY || pValue->items.size() != count)
+	{
+		return false;
+	}
+
+	for (u32 index = 0u; index < count; ++index)
+	{
+		pFloats[index] = f32(pValue->items[index].number);
+	}
+	return true;
+}
+
+// Column-major TRS matrix back into translation, rotation and scale, glTF forbids skew and shear in node matrices
+static void decomposeMatrix(const f32* pMatrix, GltfNode& node)
+{
+	node.translation = vec3(pMatrix[12], pMatrix[13], pMatrix[14]);
+
+	f32 r[3][3]; // r[column][row]
+	for (u32 column = 0u; column < 3u; ++column)
+	{
+		const f32* pColumn = &pMatrix[column * 4];
+		f32		   length  = std::sqrt(pColumn[0] * pColumn[0] + pColumn[1] * pColumn[1] + pColumn[2] * pColumn[2]);
+		node.scale[column] = length;
+		for (u32 row = 0u; row < 3u; ++row)
+		{
+			r[column][row] = length > 0.0f ? pColumn[row] / length : 0.0f;
+		}
+	}
+
+	f32 trace = r[0][0] + r[1][1] + r[2][2];
+	if (trace > 0.0f)
+	{
+		f32 s		  = 0.5f / std::sqrt(trace + 1.0f);
+		node.rotation = quat(0.25f / s, (r[1][2] - r[2][1]) * s, (r[2][0] - r[0][2]) * s, (r[0][1] - r[1][0]) * s);
+	}
+	else if (r[0][0] > r[1][1] && r[0][0] > r[2][2])
+	{
+		f32 s		  = 2.0f * std::sqrt(1.0f + r[0][0] - r[1][1] - r[2][2]);
+		node.rotation = quat((r[1][2] - r[2][1]) / s, 0.25f * s, (r[1][0] + r[0][1]) / s, (r[2][0] + r[0][2]) / s);
+	}
+	else if (r[1][1] > r[2][2])
+	{
+		f32 s		  = 2.0f * std::sqrt(1.0f + r[1][1] - r[0][0] - r[2][2]);
+		node.rotation = quat((r[2][0] - r[0][2]) / s, (r[1][0] + r[0][1]) / s, 0.25f * s, (r[2][1] + r[1][2]) / s);
+	}
+	else
+	{
+		f32 s		  = 2.0f * std::sqrt(1.0f + r[2][2] - r[0][0] - r[1][1]);
+		node.rotation = quat((r[0][1] - r[1][0]) / s, (r[2][0] + r[0][2]) / s, (r[2][1] + r[1][2]) / s, 0.25f * s);
+	}
+}
+
+u32 getGltfComponentSize(GltfComponentType componentType)
+{
+	switch (componentType)
+	{
+	case GltfComponentType::BYTE:
+	case GltfComponentType::UNSIGNED_BYTE:
+		return 1;
+	case GltfComponentType::SHORT:
+	case GltfComponentType::UNSIGNED_SHORT:
+		return 2;
+	case GltfComponentType::UNSIGNED_INT:
+	case GltfComponentType::FLOAT:
+		return 4;
+	}
+	return 0;
+}
+
+GltfModel::GltfModel(const std::string& path)
+	: m_loaded(false)
+{
+	FileView file(path);
+	if (!file.isOpen())
+	{
+		fprintf(stderr, "glTF not found: %s\n", path.c_str());
+		return;
+	}
+
+	std::string directory = path.substr(0, path.find_last_of('/') + 1);
+	m_loaded			  = parse(file.getText(), directory);
+	if (!m_loaded)
+	{
+		fprintf(stderr, "Unsupported or invalid glTF: %s\n", path.c_str());
+		m_buffers.clear();
+		m_accessors.clear();
+		m_meshes.clear();
+		m_nodes.clear();
+		m_skins.clear();
+		m_animations.clear();
+		m_sceneRoots.clear();
+	}
+}
+
+GltfModel::GltfModel(GltfModel&& other) noexcept
+	: m_loaded(other.m_loaded)
+	, m_buffers(std::move(other.m_buffers))
+	, m_accessors(std::move(other.m_accessors))
+	, m_meshes(std::move(other.m_meshes))
+	, m_nodes(std::move(other.m_nodes))
+	, m_skins(std::move(other.m_skins))
+	, m_animations(std::move(other.m_animations))
+	, m_sceneRoots(std::move(other.m_sceneRoots))
+{
+	other.m_loaded = false;
+}
+
+bool GltfModel::parse(std::string_view json, const std::string& directory)
+{
+	JsonValue root = {};
+	if (!JsonParser(json).parse(root) || root.type != JsonValue::OBJECT)
+	{
+		return false;
+	}
+
+	for (const JsonValue& buffer : root.getItems("buffers"))
+	{
+		const JsonValue* pUri = buffer.find("uri");
+		if (pUri == nullptr || pUri->type != JsonValue::STRING || pUri->string.substr(0, 5) == "data:")
+		{
+			return false;
+		}
+
+		m_buffers.emplace_back(directory + std::string(pUri->string));
+		if (!m_buffers.back().isOpen() || m_buffers.back().getSize() < u64(buffer.getInteger("byteLength", 0)))
+		{
+			return false;
+		}
+	}
+
+	const std::vector<JsonValue>& bufferViews = root.getItems("bufferViews");
+	for (const JsonValue& accessor : root.getItems("accessors"))
+	{
+		i64				 viewIndex = accessor.getInteger("bufferView", -1);
+		const JsonValue* pType	   = accessor.find("type");
+		if (viewIndex < 0 || viewIndex >= i64(bufferViews.size()) || accessor.find("sparse") != nullptr ||
+			pType == nullptr)
+		{
+			return false;
+		}
+
+		const JsonValue& view		 = bufferViews[viewIndex];
+		i64				 bufferIndex = view.getInteger("buffer", -1);
+		if (bufferIndex < 0 || bufferIndex >= i64(m_buffers.size()))
+		{
+			return false;
+		}
+
+		GltfAccessor gltfAccessor	 = {};
+		gltfAccessor.count			 = u64(accessor.getInteger("count", 0));
+		gltfAccessor.componentType	 = GltfComponentType(accessor.getInteger("componentType", 0));
+		gltfAccessor.componentsCount = getComponentsCount(pType->string);
+		const JsonValue* pNormalized = accessor.find("normalized");
+		gltfAccessor.normalized		 = pNormalized != nullptr && pNormalized->number != 0.0;
+		if (gltfAccessor.getElementSize() == 0)
+		{
+			return false;
+		}
+		gltfAccessor.stride = u32(view.getInteger("byteStride", gltfAccessor.getElementSize()));
+		if (gltfAccessor.stride < gltfAccessor.getElementSize())
+		{
+			return false;
+		}
+
+		// Everything is checked here once, the views and the pack kernels then read without bounds checks
+		const FileView& buffer	   = m_buffers[bufferIndex];
+		u64				viewOffset = u64(view.getInteger("byteOffset", 0));
+		u64				viewLength = u64(view.getInteger("byteLength", 0));
+		u64				offset	   = u64(accessor.getInteger("byteOffset", 0));
+		if (viewOffset + viewLength > buffer.getSize() || offset + gltfAccessor.getSize() > viewLength)
+		{
+			return false;
+		}
+		gltfAccessor.pData = buffer.getData() + viewOffset + offset;
+		m_accessors.push_back(gltfAccessor);
+	}
+
+	auto getAccessorIndex = [&](const JsonValue* pObject, std::string_view key) -> i32 {
+		i64 index = pObject != nullptr ? pObject->getInteger(key, -1) : -1;
+		return index >= -1 && index < i64(m_accessors.size()) ? i32(index) : -2;
+	};
+
+	for (const JsonValue& mesh : root.getItems("meshes"))
+	{
+		GltfMesh& gltfMesh = m_meshes.emplace_back();
+		for (const JsonValue& primitive : mesh.getItems("primitives"))
+		{
+			const JsonValue* pAttributes  = primitive.find("attributes");
+			GltfPrimitive	 gltfPrimitive = {};
+			gltfPrimitive.positions		   = getAccessorIndex(pAttributes, "POSITION");
+			gltfPrimitive.normals		   = getAccessorIndex(pAttributes, "NORMAL");
+			gltfPrimitive.tangents		   = getAccessorIndex(pAttributes, "TANGENT");
+			gltfPrimitive.texCoords		   = getAccessorIndex(pAttributes, "TEXCOORD_0");
+			gltfPrimitive.joints		   = getAccessorIndex(pAttributes, "JOINTS_0");
+			gltfPrimitive.weights		   = getAccessorIndex(pAttributes, "WEIGHTS_0");
+			gltfPrimitive.indices		   = getAccessorIndex(&primitive, "indices");
+			gltfPrimitive.material		   = i32(primitive.getInteger("material", -1));
+			gltfPrimitive.mode			   = u32(primitive.getInteger("mode", GL_TRIANGLES));
+
+			// -2 marks an accessor index out of the table
+			if (gltfPrimitive.positions == -2 || gltfPrimitive.normals == -2 || gltfPrimitive.tangents == -2 ||
+				gltfPrimitive.texCoords == -2 || gltfPrimitive.joints == -2 || gltfPrimitive.weights == -2 ||
+				gltfPrimitive.indices == -2)
+			{
+				return false;
+			}
+			gltfMesh.primitives.push_back(gltfPrimitive);
+		}
+	}
+
+	const std::vector<JsonValue>& nodes = root.getItems("nodes");
+	for (const JsonValue& node : nodes)
+	{
+		GltfNode& gltfNode	 = m_nodes.emplace_back();
+		gltfNode.mesh		 = i32(node.getInteger("mesh", -1));
+		gltfNode.skin		 = i32(node.getInteger("skin", -1));
+		gltfNode.translation = vec3(0.0f);
+		gltfNode.rotation	 = quat(1.0f, 0.0f, 0.0f, 0.0f);
+		gltfNode.scale		 = vec3(1.0f);
+
+		f32 values[16];
+		if (readFloats(node.find("matrix"), values, 16))
+		{
+			decomposeMatrix(values, gltfNode);
+		}
+		if (readFloats(node.find("translation"), values, 3))
+		{
+			gltfNode.translation = vec3(values[0], values[1], values[2]);
+		}
+		if (readFloats(node.find("rotation"), values, 4))
+		{
+			gltfNode.rotation = quat(values[3], values[0], values[1], values[2]); // stored x, y, z, w
+		}
+		if (readFloats(node.find("scale"), values, 3))
+		{
+			gltfNode.scale = vec3(values[0], values[1], values[2]);
+		}
+
+		for (const JsonValue& child : node.getItems("children"))
+		{
+			gltfNode.children.push_back(i32(child.number));
+		}
+		if (gltfNode.mesh >= i32(m_meshes.size()) || gltfNode.skin >= i32(root.getItems("skins").size()))
+		{
+			return false;
+		}
+	}
+
+	for (const JsonValue& skin : root.getItems("skins"))
+	{
+		GltfSkin& gltfSkin			 = m_skins.emplace_back();
+		gltfSkin.inverseBindMatrices = getAccessorIndex(&skin, "inverseBindMatrices");
+		for (const JsonValue& joint : skin.getItems("joints"))
+		{
+			gltfSkin.joints.push_back(i32(joint.number));
+			if (gltfSkin.joints.back() < 0 || gltfSkin.joints.back() >= i32(m_nodes.size()))
+			{
+				return false;
+			}
+		}
+
+		if (gltfSkin.inverseBindMatrices == -2)
+		{
+			return false;
+		}
+		if (gltfSkin.inverseBindMatrices >= 0)
+		{
+			const GltfAccessor& matrices = m_accessors[gltfSkin.inverseBindMatrices];
+			if (matrices.componentType != GltfComponentType::FLOAT || matrices.componentsCount != 16 ||
+				matrices.count < gltfSkin.joints.size())
+			{
+				return false;
+			}
+		}
+	}
+
+	for (const JsonValue& animation : root.getItems("animations"))
+	{
+		GltfAnimation&				  gltfAnimation = m_animations.emplace_back();
+		const std::vector<JsonValue>& samplers		= animation.getItems("samplers");
+		gltfAnimation.duration						= 0.0f;
+		for (const JsonValue& channel : animation.getItems("channels"))
+		{
+			const JsonValue* pTarget = channel.find("target");
+			i64				 sampler = channel.getInteger("sampler", -1);
+			const JsonValue* pPath	 = pTarget != nullptr ? pTarget->find("path") : nullptr;
+			if (sampler < 0 || sampler >= i64(samplers.size()) || pPath == nullptr)
+			{
+				return false;
+			}
+
+			GltfAnimationChannel gltfChannel = {};
+			gltfChannel.node				 = i32(pTarget->getInteger("node", -1));
+			gltfChannel.input				 = getAccessorIndex(&samplers[sampler], "input");
+			gltfChannel.output				 = getAccessorIndex(&samplers[sampler], "output");
+			if (gltfChannel.node < 0 || gltfChannel.node >= i32(m_nodes.size()) || gltfChannel.input < 0 ||
+				gltfChannel.output < 0)
+			{
+				return false;
+			}
+
+			const std::pair<std::string_view, GltfAnimationPath> paths[] = {
+				{"translation", GltfAnimationPath::TRANSLATION},
+				{"rotation", GltfAnimationPath::ROTATION},
+				{"scale", GltfAnimationPath::SCALE},
+				{"weights", GltfAnimationPath::WEIGHTS}};
+			const std::pair<std::string_view, GltfInterpolation> interpolations[] = {
+				{"LINEAR", GltfInterpolation::LINEAR},
+				{"STEP", GltfInterpolation::STEP},
+				{"CUBICSPLINE", GltfInterpolation::CUBICSPLINE}};
+
+			// Paths added by extensions are skipped, channels keep their meaning without them
+			const auto* pPathEntry = std::find_if(
+				std::begin(paths), std::end(paths), [&](const auto& path) { return path.first == pPath->string; });
+			if (pPathEntry == std::end(paths))
+			{
+				continue;
+			}
+			gltfChannel.path = pPathEntry->second;
+
+			const JsonValue* pInterpolation = samplers[sampler].find("interpolation");
+			gltfChannel.interpolation		= GltfInterpolation::LINEAR;
+			for (const auto& [name, interpolation] : interpolations)
+			{
+				if (pInterpolation != nullptr && pInterpolation->string == name)
+				{
+					gltfChannel.interpolation = interpolation;
+				}
+			}
+
+			// Key times are read while sampling without further checks
+			const GltfAccessor& input	   = m_accessors[gltfChannel.input];
+			const GltfAccessor& output	   = m_accessors[gltfChannel.output];
+			u64					valuesCount = gltfChannel.interpolation == GltfInterpolation::CUBICSPLINE ? 3 : 1;
+			if (input.componentType != GltfComponentType::FLOAT || input.componentsCount != 1 || input.count == 0 ||
+				output.count < input.count * valuesCount)
+			{
+				return false;
+			}
+
+			gltfAnimation.duration = std::max(gltfAnimation.duration, GltfAccessorView<f32>(input)[input.count - 1]);
+			gltfAnimation.channels.push_back(gltfChannel);
+		}
+	}
+
+	const std::vector<JsonValue>& scenes = root.getItems("scenes");
+	i64							  scene	 = root.getInteger("scene", 0);
+	if (scene >= 0 && scene < i64(scenes.size()))
+	{
+		for (const JsonValue& node : scenes[scene].getItems("nodes"))
+		{
+			m_sceneRoots.push_back(i32(node.number));
+		}
+	}
+
+	for (const GltfNode& node : m_nodes)
+	{
+		for (i32 child : node.children)
+		{
+			if (child < 0 || child >= i32(m_nodes.size()))
+			{
+				return false;
+			}
+		}
+	}
+	for (i32 sceneRoot : m_sceneRoots)
+	{
+		if (sceneRoot < 0 || sceneRoot >= i32(m_nodes.size()))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void packIndices(const GltfAccessor& accessor, u32* pIndices)
+{
+	ASSERT(accessor.componentsCount == 1);
+
+	const u8* pSource = accessor.pData;
+	u64		  index	  = 0;
+	switch (accessor.componentType)
+	{
+	case GltfComponentType::UNSIGNED_INT:
+		if (accessor.stride == sizeof(u32))
+		{
+			memcpy(pIndices, pSource, accessor.count * sizeof(u32));
+			return;
+		}
+		for (; index < accessor.count; ++index)
+		{
+			memcpy(&pIndices[index], pSource + index * accessor.stride, sizeof(u32));
+		}
+		return;
+	case GltfComponentType::UNSIGNED_SHORT:
+#if defined(__SSE2__)
+		// Eight indices per iteration, interleaved with zeros to widen them
+		if (accessor.stride == sizeof(u16))
+		{
+			for (; index + 8 <= accessor.count; index += 8)
+			{
+				__m128i indices = _mm_loadu_si128((const __m128i*)(pSource + index * sizeof(u16)));
+				_mm_storeu_si128((__m128i*)&pIndices[index], _mm_unpacklo_epi16(indices, _mm_setzero_si128()));
+				_mm_storeu_si128((__m128i*)&pIndices[index + 4], _mm_unpackhi_epi16(indices, _mm_setzero_si128()));
+			}
+		}
+#endif
+		for (; index < accessor.count; ++index)
+		{
+			u16 value;
+			memcpy(&value, pSource + index * accessor.stride, sizeof(u16));
+			pIndices[index] = value;
+		}
+		return;
+	case GltfComponentType::UNSIGNED_BYTE:
+		for (; index < accessor.count; ++index)
+		{
+			pIndices[index] = pSource[index * accessor.stride];
+		}
+		return;
+	default:
+		ASSERT(false && "Unsupported index type");
+	}
+}
+
+void packJoints(const GltfAccessor& accessor, void* pDestination, u32 destinationStride)
+{
+	ASSERT(accessor.componentsCount == 4);
+
+	const u8* pSource = accessor.pData;
+	u8*		  pOutput = (u8*)pDestination;
+	u64		  index	  = 0;
+	switch (accessor.componentType)
+	{
+	case GltfComponentType::UNSIGNED_SHORT:
+		for (; index < accessor.count; ++index)
+		{
+			memcpy(pOutput + index * destinationStride, pSource + index * accessor.stride, 4 * sizeof(u16));
+		}
+		return;
+	case GltfComponentType::UNSIGNED_BYTE:
+#if defined(__SSE2__)
+		// Four bytes interleaved with zeros, one element per iteration
+		for (; index < accessor.count; ++index)
+		{
+			i32 joints;
+			memcpy(&joints, pSource + index * accessor.stride, sizeof(joints));
+			__m128i value = _mm_unpacklo_epi8(_mm_cvtsi32_si128(joints), _mm_setzero_si128());
+			_mm_storel_epi64((__m128i*)(pOutput + index * destinationStride), value);
+		}
+#endif
+		for (; index < accessor.count; ++index)
+		{
+			const u8* pJoints	= pSource + index * accessor.stride;
+			u16		  joints[4] = {pJoints[0], pJoints[1], pJoints[2], pJoints[3]};
+			memcpy(pOutput + index * destinationStride, joints, sizeof(joints));
+		}
+		return;
+	default:
+		ASSERT(false && "Unsupported joints type");
+	}
+}
+
+void packWeights(const GltfAccessor& accessor, void* pDestination, u32 destinationStride)
+{
+	ASSERT(accessor.componentsCount == 4);
+
+	const u8* pSource = accessor.pData;
+	u8*		  pOutput = (u8*)pDestination;
+	u64		  index	  = 0;
+	switch (accessor.componentType)
+	{
+	case GltfComponentType::FLOAT:
+		for (; index < accessor.count; ++index)
+		{
+			memcpy(pOutput + index * destinationStride, pSource + index * accessor.stride, 4 * sizeof(f32));
+		}
+		return;
+	case GltfComponentType::UNSIGNED_BYTE:
+#if defined(__SSE2__)
+		// Widened twice to 32 bits, converted and scaled back to [0, 1]
+		for (; index < accessor.count; ++index)
+		{
+			i32 weights;
+			memcpy(&weights, pSource + index * accessor.stride, sizeof(weights));
+			__m128i value = _mm_unpacklo_epi8(_mm_cvtsi32_si128(weights), _mm_setzero_si128());
+			value		  = _mm_unpacklo_epi16(value, _mm_setzero_si128());
+			_mm_storeu_ps((f32*)(pOutput + index * destinationStride),
+						  _mm_mul_ps(_mm_cvtepi32_ps(value), _mm_set1_ps(1.0f / 255.0f)));
+		}
+#endif
+		for (; index < accessor.count; ++index)
+		{
+			const u8* pWeights	 = pSource + index * accessor.stride;
+			f32		  weights[4] = {
+				  pWeights[0] / 255.0f, pWeights[1] / 255.0f, pWeights[2] / 255.0f, pWeights[3] / 255.0f};
+			memcpy(pOutput + index * destinationStride, weights, sizeof(weights));
+		}
+		return;
+	case GltfComponentType::UNSIGNED_SHORT:
+		for (; index < accessor.count; ++index)
+		{
+			u16 weights[4];
+			memcpy(weights, pSource + index * accessor.stride, sizeof(weights));
+			f32 normalized[4] = {
+				weights[0] / 65535.0f, weights[1] / 65535.0f, weights[2] / 65535.0f, weights[3] / 65535.0f};
+			memcpy(pOutput + index * destinationStride, normalized, sizeof(normalized));
+		}
+		return;
+	default:
+		ASSERT(false && "Unsupported weights type");
+	}
+}
+
+void packTexCoords(const GltfAccessor& accessor, void* pDestination, u32 destinationStride)
+{
+	ASSERT(accessor.componentType == GltfComponentType::FLOAT && accessor.componentsCount == 2);
+
+	const u8* pSource = accessor.pData;
+	u8*		  pOutput = (u8*)pDestination;
+	u64		  index	  = 0;
+
+#if defined(__SSE2__)
+	// (u, v) * (1, -1) + (0, 1) on 8-byte loads and stores, exactly one element each
+	const __m128 scale	= _mm_setr_ps(1.0f, -1.0f, 1.0f, -1.0f);
+	const __m128 offset = _mm_setr_ps(0.0f, 1.0f, 0.0f, 1.0f);
+	for (; index < accessor.count; ++index)
+	{
+		__m128 value = _mm_castsi128_ps(_mm_loadl_epi64((const __m128i*)(pSource + index * accessor.stride)));
+		value		 = _mm_add_ps(_mm_mul_ps(value, scale), offset);
+		_mm_storel_epi64((__m128i*)(pOutput + index * destinationStride), _mm_castps_si128(value));
+	}
+#endif
+
+	for (; index < accessor.count; ++index)
+	{
+		f32 value[2];
+		memcpy(value, pSource + index * accessor.stride, sizeof(value));
+		value[1] = 1.0f - value[1];
+		memcpy(pOutput + index * destinationStride, value, sizeof(value));
+	}
+}
+
+} // namespace ntt
\ No newline at end of file
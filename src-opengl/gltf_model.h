@@ -0,0 +1,309 @@
+#pragma once
+#include "common.h"
+#include "file_system.h"
+#include <cstring>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace ntt {
+
+/**
+ * glTF 2.0 model read without intermediate copies: the JSON is parsed once into the tables below, the buffers it
+ * references are FileViews (memory mapped, or served by the mounted asset archive) and accessors point straight into
+ * them. An accessor can be uploaded as is when its layout already is the GPU one, or converted with the pack kernels
+ * below directly into a mapped GPU buffer.
+ * Only external buffers are supported, no data URIs, no sparse accessors, no GLB container.
+ *
+ * @example
+ * ```c++
+ * GltfModel model(STRINGIFY(SOURCE_DIR) "/assets/gltfs/rubber_duck.gltf");
+ * ASSERT(model.isLoaded());
+ * const GltfPrimitive& primitive = model.getMesh(0).primitives[0];
+ * const GltfAccessor& indices = model.getAccessor(primitive.indices);
+ * if (indices.isTightlyPacked(GltfComponentType::UNSIGNED_INT))
+ * {
+ *     glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.getSize(), indices.pData, GL_STATIC_DRAW);
+ * }
+ * ```
+ */
+
+// Values of the glTF componentType, which are the GL ones
+enum class GltfComponentType : u32
+{
+	BYTE		   = 5120,
+	UNSIGNED_BYTE  = 5121,
+	SHORT		   = 5122,
+	UNSIGNED_SHORT = 5123,
+	UNSIGNED_INT   = 5125,
+	FLOAT		   = 5126,
+};
+
+u32 getGltfComponentSize(GltfComponentType componentType);
+
+struct GltfAccessor
+{
+	const u8*		  pData; // first element, inside a buffer FileView
+	u64				  count;
+	u32				  stride; // from the buffer view, or the element size when tightly packed
+	GltfComponentType componentType;
+	u32				  componentsCount; // 1 for SCALAR up to 16 for MAT4
+	bool			  normalized;
+
+	inline u32 getElementSize() const
+	{
+		return getGltfComponentSize(componentType) * componentsCount;
+	}
+
+	// Bytes covered by the elements, the stride padding of the last one excluded
+	inline u64 getSize() const
+	{
+		return count > 0 ? (count - 1) * stride + getElementSize() : 0;
+	}
+
+	inline bool isTightlyPacked(GltfComponentType expectedType) const
+	{
+		return componentType == expectedType && stride == getElementSize();
+	}
+
+	// Elements [first, first + rangeCount), to split the pack kernels over jobs
+	inline GltfAccessor getRange(u64 first, u64 rangeCount) const
+	{
+		ASSERT(first + rangeCount <= count);
+		GltfAccessor range = *this;
+		range.pData		   = pData + first * stride;
+		range.count		   = rangeCount;
+		return range;
+	}
+};
+
+// Typed access to the elements of an accessor, glTF aligns accessors on their component size so the reads are aligned
+template <typename T>
+class GltfAccessorView
+{
+public:
+	GltfAccessorView(const GltfAccessor& accessor)
+		: m_pData(accessor.pData)
+		, m_count(accessor.count)
+		, m_stride(accessor.stride)
+	{
+		ASSERT(sizeof(T) == accessor.getElementSize());
+	}
+
+public:
+	inline const T& operator[](u64 index) const
+	{
+		return *(const T*)(m_pData + index * m_stride);
+	}
+
+	inline u64 getCount() const
+	{
+		return m_count;
+	}
+
+	inline u32 getStride() const
+	{
+		return m_stride;
+	}
+
+private:
+	const u8* m_pData;
+	u64		  m_count;
+	u32		  m_stride;
+};
+
+// Attribute accessor indices, -1 when the primitive does not have it
+struct GltfPrimitive
+{
+	i32 positions;
+	i32 normals;
+	i32 tangents;
+	i32 texCoords;
+	i32 joints;	 // JOINTS_0, VEC4 of unsigned bytes or shorts indexing the skin joints
+	i32 weights; // WEIGHTS_0, VEC4 of floats or normalized unsigned bytes or shorts
+	i32 indices;
+	i32 material;
+	u32 mode; // GL primitive type, GL_TRIANGLES by default
+};
+
+struct GltfMesh
+{
+	std::vector<GltfPrimitive> primitives;
+};
+
+// Local transform, nodes given as a matrix are decomposed on load
+struct GltfNode
+{
+	i32				 mesh; // -1 for nodes that only carry a transform
+	i32				 skin; // -1 when the mesh is not skinned
+	vec3			 translation;
+	quat			 rotation;
+	vec3			 scale;
+	std::vector<i32> children;
+};
+
+// Joints in the order JOINTS_0 indexes them
+struct GltfSkin
+{
+	std::vector<i32> joints;			  // node indices
+	i32				 inverseBindMatrices; // float MAT4 accessor with one matrix per joint, -1 for identities
+};
+
+enum class GltfAnimationPath
+{
+	TRANSLATION,
+	ROTATION,
+	SCALE,
+	WEIGHTS,
+};
+
+enum class GltfInterpolation
+{
+	LINEAR,
+	STEP,
+	CUBICSPLINE,
+};
+
+// A channel merged with the sampler it references
+struct GltfAnimationChannel
+{
+	i32				  node;
+	GltfAnimationPath path;
+	GltfInterpolation interpolation;
+	i32				  input;  // float SCALAR key times in seconds, increasing
+	i32				  output; // one value per key, three (in-tangent, value, out-tangent) for CUBICSPLINE
+};
+
+struct GltfAnimation
+{
+	std::vector<GltfAnimationChannel> channels;
+	f32								  duration; // last key time over every channel
+};
+
+class GltfModel
+{
+public:
+	GltfModel(const std::string& path);
+	GltfModel(const GltfModel&) = delete;
+	GltfModel(GltfModel&& other) noexcept;
+	~GltfModel() = default;
+
+public:
+	inline bool isLoaded() const
+	{
+		return m_loaded;
+	}
+
+	inline u32 getMeshesCount() const
+	{
+		return u32(m_meshes.size());
+	}
+
+	inline const GltfMesh& getMesh(u32 meshIndex) const
+	{
+		return m_meshes[meshIndex];
+	}
+
+	inline const GltfAccessor& getAccessor(i32 accessorIndex) const
+	{
+		ASSERT(accessorIndex >= 0 && accessorIndex < i32(m_accessors.size()));
+		return m_accessors[accessorIndex];
+	}
+
+	inline u32 getNodesCount() const
+	{
+		return u32(m_nodes.size());
+	}
+
+	inline const GltfNode& getNode(u32 nodeIndex) const
+	{
+		return m_nodes[nodeIndex];
+	}
+
+	inline u32 getSkinsCount() const
+	{
+		return u32(m_skins.size());
+	}
+
+	inline const GltfSkin& getSkin(u32 skinIndex) const
+	{
+		return m_skins[skinIndex];
+	}
+
+	inline u32 getAnimationsCount() const
+	{
+		return u32(m_animations.size());
+	}
+
+	inline const GltfAnimation& getAnimation(u32 animationIndex) const
+	{
+		return m_animations[animationIndex];
+	}
+
+	// Root nodes of the default scene
+	inline const std::vector<i32>& getSceneRoots() const
+	{
+		return m_sceneRoots;
+	}
+
+private:
+	bool parse(std::string_view json, const std::string& directory);
+
+private:
+	bool					   m_loaded;
+	std::vector<FileView>	   m_buffers;
+	std::vector<GltfAccessor>  m_accessors;
+	std::vector<GltfMesh>	   m_meshes;
+	std::vector<GltfNode>	   m_nodes;
+	std::vector<GltfSkin>	   m_skins;
+	std::vector<GltfAnimation> m_animations;
+	std::vector<i32>		   m_sceneRoots;
+};
+
+// Index accessor of any glTF index type widened to u32
+void packIndices(const GltfAccessor& accessor, u32* pIndices);
+
+// TEXCOORD accessor as float pairs with V flipped, glTF puts the texture origin top-left where GL puts it bottom-left
+void packTexCoords(const GltfAccessor& accessor, void* pDestination, u32 destinationStride);
+
+// JOINTS_0 accessor as four u16 joint indices
+void packJoints(const GltfAccessor& accessor, void* pDestination, u32 destinationStride);
+
+// WEIGHTS_0 accessor as four floats
+void packWeights(const GltfAccessor& accessor, void* pDestination, u32 destinationStride);
+
+// Float VEC3 accessor with its components reordered, e.g. packVec3<0, 2, 1> writes (x, z, y)
+template <u32 X, u32 Y, u32 Z>
+void packVec3(const GltfAccessor& accessor, void* pDestination, u32 destinationStride)
+{
+	static_assert(X < 3 && Y < 3 && Z < 3, "Swizzle out of a VEC3");
+	ASSERT(accessor.componentType == GltfComponentType::FLOAT && accessor.componentsCount == 3);
+
+	const u8* pSource = accessor.pData;
+	u8*		  pOutput = (u8*)pDestination;
+	u64		  index	  = 0;
+
+#if defined(__SSE2__)
+	// One shuffle per element, the loads take 16 bytes so the last element is left to the scalar loop, which keeps
+	// every read inside the accessor
+	for (; index + 1 < accessor.count; ++index)
+	{
+		__m128 value = _mm_loadu_ps((const f32*)(pSource + index * accessor.stride));
+		value		 = _mm_shuffle_ps(value, value, _MM_SHUFFLE(3, Z, Y, X));
+		_mm_storel_pi((__m64*)(pOutput + index * destinationStride), value);
+		_mm_store_ss((f32*)(pOutput + index * destinationStride + 8), _mm_movehl_ps(value, value));
+	}
+#endif
+
+	for (; index < accessor.count; ++index)
+	{
+		f32 value[3];
+		memcpy(value, pSource + index * accessor.stride, sizeof(value));
+		f32 swizzled[3] = {value[X], value[Y], value[Z]};
+		memcpy(pOutput + index * destinationStride, swizzled, sizeof(swizzled));
+	}
+}
+
+} // namespace ntt
\ No newline at end of file
@@ -0,0 +1,225 @@
+#include "job_system.h"
+#include <algorithm>
+#include <easy/profiler.h>
+
+namespace ntt {
+
+// Set on the worker threads of a system so scheduling from a job lands in the worker's own deque
+static thread_local const JobSystem* t_pJobSystem = nullptr;
+static thread_local u32				 t_queueIndex = 0;
+
+JobCounter::JobCounter()
+	: m_pendingCount(0)
+{
+}
+
+JobSystem::JobSystem(u32 workersCount)
+	: m_mainThreadId(std::this_thread::get_id())
+	, m_queuedCount(0)
+	, m_running(true)
+{
+	for (u32 queueIndex = 0u; queueIndex <= workersCount; ++queueIndex)
+	{
+		m_queues.push_back(std::make_unique<JobQueue>());
+	}
+
+	// Every deque exists before the first worker starts stealing from them
+	for (u32 workerIndex = 0u; workerIndex < workersCount; ++workerIndex)
+	{
+		m_workers.emplace_back(&JobSystem::workerLoop, this, workerIndex + 1);
+	}
+}
+
+JobSystem::~JobSystem()
+{
+	// Jobs nobody waited on are finished first, they may reference anything still alive at this point
+	while (m_queuedCount.load(std::memory_order_acquire) > 0)
+	{
+		Job job;
+		if (stealJob(0, job))
+		{
+			runJob(job);
+		}
+	}
+	runMainThreadJobs();
+
+	{
+		std::lock_guard<std::mutex> lock(m_sleepMutex);
+		m_running = false;
+	}
+	m_wakeUp.notify_all();
+
+	for (std::thread& worker : m_workers)
+	{
+		worker.join();
+	}
+}
+
+void JobSystem::schedule(const char* name, std::function<void()> function, JobCounter* pCounter)
+{
+	if (pCounter != nullptr)
+	{
+		pCounter->m_pendingCount.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	JobQueue& queue = *m_queues[getQueueIndex()];
+	{
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		queue.jobs.push_back({name, std::move(function), pCounter});
+		m_queuedCount.fetch_add(1, std::memory_order_release);
+	}
+
+	// Taking the sleep mutex orders this with a worker checking m_queuedCount right before it sleeps
+	{
+		std::lock_guard<std::mutex> lock(m_sleepMutex);
+	}
+	m_wakeUp.notify_one();
+}
+
+void JobSystem::scheduleMainThread(const char* name, std::function<void()> function, JobCounter* pCounter)
+{
+	if (pCounter != nullptr)
+	{
+		pCounter->m_pendingCount.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	std::lock_guard<std::mutex> lock(m_mainThreadQueue.mutex);
+	m_mainThreadQueue.jobs.push_back({name, std::move(function), pCounter});
+}
+
+void JobSystem::wait(JobCounter& counter)
+{
+	bool mainThread = std::this_thread::get_id() == m_mainThreadId;
+	u32	 queueIndex = getQueueIndex();
+
+	while (!counter.isDone())
+	{
+		if (mainThread)
+		{
+			runMainThreadJobs();
+		}
+
+		Job job;
+		if (popJob(queueIndex, job) || stealJob(queueIndex, job))
+		{
+			runJob(job);
+		}
+		else
+		{
+			// What is left runs on other threads
+			std::this_thread::yield();
+		}
+	}
+}
+
+void JobSystem::parallelFor(const char*									   name,
+							u32											   count,
+							u32											   batchSize,
+							const std::function<void(u32 begin, u32 end)>& function)
+{
+	ASSERT(batchSize > 0);
+
+	JobCounter counter;
+	for (u32 begin = 0u; begin < count; begin += batchSize)
+	{
+		u32 end = std::min(count, begin + batchSize);
+		schedule(name, [&function, begin, end]() { function(begin, end); }, &counter);
+	}
+	wait(counter);
+}
+
+void JobSystem::runMainThreadJobs()
+{
+	ASSERT(std::this_thread::get_id() == m_mainThreadId);
+
+	std::deque<Job> jobs;
+	{
+		std::lock_guard<std::mutex> lock(m_mainThreadQueue.mutex);
+		jobs.swap(m_mainThreadQueue.jobs);
+	}
+
+	for (Job& job : jobs)
+	{
+		runJob(job);
+	}
+}
+
+void JobSystem::workerLoop(u32 queueIndex)
+{
+	EASY_THREAD("Job worker");
+	t_pJobSystem = this;
+	t_queueIndex = queueIndex;
+
+	while (true)
+	{
+		Job job;
+		if (popJob(queueIndex, job) || stealJob(queueIndex, job))
+		{
+			runJob(job);
+			continue;
+		}
+
+		// Stopping only once the deques are empty, jobs scheduled by the last running ones still run
+		std::unique_lock<std::mutex> lock(m_sleepMutex);
+		m_wakeUp.wait(lock, [this]() { return m_queuedCount.load(std::memory_order_acquire) > 0 || !m_running; });
+		if (!m_running && m_queuedCount.load(std::memory_order_acquire) == 0)
+		{
+			return;
+		}
+	}
+}
+
+u32 JobSystem::getQueueIndex() const
+{
+	return t_pJobSystem == this ? t_queueIndex : 0;
+}
+
+bool JobSystem::popJob(u32 queueIndex, Job& job)
+{
+	JobQueue&					queue = *m_queues[queueIndex];
+	std::lock_guard<std::mutex> lock(queue.mutex);
+	if (queue.jobs.empty())
+	{
+		return false;
+	}
+
+	job = std::move(queue.jobs.back());
+	queue.jobs.pop_back();
+	m_queuedCount.fetch_sub(1, std::memory_order_relaxed);
+	return true;
+}
+
+bool JobSystem::stealJob(u32 queueIndex, Job& job)
+{
+	// Starting after the thief spreads the thieves over the victims
+	for (u32 offset = 1u; offset <= u32(m_queues.size()); ++offset)
+	{
+		JobQueue&					queue = *m_queues[(queueIndex + offset) % m_queues.size()];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		if (queue.jobs.empty())
+		{
+			continue;
+		}
+
+		job = std::move(queue.jobs.front());
+		queue.jobs.pop_front();
+		m_queuedCount.fetch_sub(1, std::memory_order_relaxed);
+		return true;
+	}
+	return false;
+}
+
+void JobSystem::runJob(Job& job)
+{
+	{
+		EASY_BLOCK(job.name);
+		job.function();
+	}
+
+	if (job.pCounter != nullptr)
+	{
+		job.pCounter->m_pendingCount.fetch_sub(1, std::memory_order_release);
+	}
+}
+
+} // namespace ntt
\ No newline at end of file
@@ -0,0 +1,113 @@
+#pragma once
+#include "common.h"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ntt {
+
+/**
+ * Worker threads fed by per-thread job deques. Jobs scheduled from a thread go to the back of its own deque and are
+ * taken back from there (the most recent, hottest ones first), idle workers steal from the front of the others. The
+ * thread that created the system owns a deque too and runs jobs while it waits on a counter, so a system with no
+ * workers simply runs everything there.
+ * Jobs scheduled with `scheduleMainThread` only ever run on the creating thread, from `wait` or
+ * `runMainThreadJobs`, which is where anything touching the GL context belongs.
+ * Every job is an easy_profiler block named after it, on the thread that ran it.
+ *
+ * @example
+ * ```c++
+ * JobSystem  jobSystem(std::thread::hardware_concurrency() - 1);
+ * JobCounter decoded;
+ * jobSystem.schedule("Decode texture", [&]() { image = decode(path); }, &decoded);
+ * jobSystem.parallelFor("Pack vertices", verticesCount, 1024, [&](u32 begin, u32 end) { ... });
+ * jobSystem.wait(decoded);
+ * ```
+ */
+
+// Jobs scheduled against a counter and not finished yet, waiting on it is how jobs depend on each other
+class JobCounter
+{
+public:
+	JobCounter();
+	JobCounter(const JobCounter&) = delete;
+
+public:
+	inline bool isDone() const
+	{
+		return m_pendingCount.load(std::memory_order_acquire) == 0;
+	}
+
+private:
+	friend class JobSystem;
+
+	std::atomic<u32> m_pendingCount;
+};
+
+class JobSystem
+{
+public:
+	JobSystem(u32 workersCount);
+	JobSystem(const JobSystem&) = delete;
+	~JobSystem();
+
+public:
+	inline u32 getWorkersCount() const
+	{
+		return u32(m_workers.size());
+	}
+
+	// pCounter may be nullptr for jobs nobody waits on, the system still finishes them before being destroyed
+	void schedule(const char* name, std::function<void()> function, JobCounter* pCounter);
+	void scheduleMainThread(const char* name, std::function<void()> function, JobCounter* pCounter);
+
+	// Runs jobs until the counter is done instead of blocking
+	void wait(JobCounter& counter);
+
+	// Calls function over [0, count) split in batches of batchSize, in parallel, and returns once all are done
+	void parallelFor(const char*									 name,
+					 u32											 count,
+					 u32											 batchSize,
+					 const std::function<void(u32 begin, u32 end)>& function);
+
+	// Runs the main thread jobs scheduled so far, once per frame from the main loop
+	void runMainThreadJobs();
+
+private:
+	struct Job
+	{
+		const char*			  name;
+		std::function<void()> function;
+		JobCounter*			  pCounter;
+	};
+
+	struct JobQueue
+	{
+		std::mutex		mutex;
+		std::deque<Job> jobs;
+	};
+
+	void workerLoop(u32 queueIndex);
+	u32	 getQueueIndex() const;
+	bool popJob(u32 queueIndex, Job& job);
+	bool stealJob(u32 queueIndex, Job& job);
+	void runJob(Job& job);
+
+private:
+	std::vector<std::unique_ptr<JobQueue>> m_queues; // 0 for the creating thread, then one per worker
+	JobQueue							   m_mainThreadQueue;
+	std::vector<std::thread>			   m_workers;
+	std::thread::id						   m_mainThreadId;
+
+	std::atomic<u32>		m_queuedCount; // in any worker deque, lets idle workers sleep
+	std::atomic<bool>		m_running;
+	std::mutex				m_sleepMutex;
+	std::condition_variable m_wakeUp;
+};
+
+} // namespace ntt
\ No newline at end of file
@@ -6,19 +6,34 @@
 // clang-format on
 
 #include <easy/profiler.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
 #include <fstream>
+#include <memory>
 #include <string>
+#include <thread>
 
+#include "asset_archive.h"
+#include "buffer_arena.h"
+#include "dynamic_resolution.h"
+#include "file_system.h"
+#include "gltf_model.h"
+#include "job_system.h"
+#include "meshlets.h"
+#include "occlusion_culling.h"
 #include "pipeline.h"
+#include "render_target.h"
+#include "resource_registry.h"
 #include "shader.h"
+#include "skinning.h"
 #include "texture.h"
+#include "transform_hierarchy.h"
+#include "utils.h"
 #include "vertex_buffer.h"
 
-#include <assimp/cimport.h>
-#include <assimp/postprocess.h>
-#include <assimp/scene.h>
-#include <assimp/version.h>
-
 #include <glm/gtc/matrix_transform.hpp>
 
 using namespace ntt;
@@ -30,12 +45,24 @@ struct Vertex
 	vec2 texCoord;
 };
 
+// Pulled by simple.vert as float p[3], tc[2], the layout keeps it free of padding
 struct VertexData
 {
 	vec3 position;
 	vec2 texCoord;
 };
 
+VERTEX_LAYOUT(VertexData, VERTEX_ATTRIBUTE(position, VEC3), VERTEX_ATTRIBUTE(texCoord, VEC2));
+
+// Streamed every frame through a VertexFormat, color is RGBA8
+struct DebugLineVertex
+{
+	vec3 position;
+	u32	 color;
+};
+
+VERTEX_LAYOUT(DebugLineVertex, VERTEX_ATTRIBUTE(position, VEC3), VERTEX_ATTRIBUTE(color, UBYTE4_NORM));
+
 struct UniformBufferObject
 {
 	glm::mat4 mvp;
@@ -52,11 +79,958 @@ const Vertex vertices[] = {
 #define WIDTH  800
 #define HEIGHT 600
 
-int main()
+// Where the wireframe overlay gets its barycentric coordinates from
+enum class BarycentricSource
+{
+	GEOMETRY_SHADER,	// simple.geom attaches them per triangle
+	VERTEX_ID,			// non-indexed draw, derived from gl_VertexID % 3 in simple.vert
+	FRAGMENT_EXTENSION, // gl_BaryCoordNV, needs GL_NV_fragment_shader_barycentric
+	COUNT,
+};
+
+static const char* barycentricSourceNames[] = {"geometry shader", "gl_VertexID", "fragment barycentrics"};
+
+// Plain texturing first, then one wireframe mode per barycentric source
+#define SCENE_MODES_COUNT	(1 + u32(BarycentricSource::COUNT))
+#define TIMER_QUERIES_COUNT 3
+#define BENCHMARK_FRAMES	300
+#define VERTICES_PACK_BATCH 1024
+
+#define HIERARCHY_BENCHMARK_NODES  (1024 * 1024)
+#define HIERARCHY_BENCHMARK_FRAMES 60
+
+// Unused textures, shaders and pipelines stay resident up to this many bytes, --resource-budget=<MB> overrides it
+#define RESOURCE_MEMORY_BUDGET (256 * 1024 * 1024)
+
+// GPU frame time the render scale holds, --target-frame-ms=<ms> overrides it
+#define DYNAMIC_RESOLUTION_TARGET_MS (1000.0f / 60.0f)
+
+// Static meshes are sub-allocated from blocks of this size
+#define MESH_ARENA_BLOCK_SIZE (16 * 1024 * 1024)
+
+// About 85 MB of meshes, the compaction copies the live half next to the old blocks and peaks around 150 MB, which
+// small GPUs still have
+#define ARENA_STRESS_MESHES		  2048
+#define ARENA_STRESS_MIN_VERTICES 64
+#define ARENA_STRESS_MAX_VERTICES 4096
+
+// Ground grid under the duck and its axes, rewritten every frame
+#define DEBUG_GRID_LINES		 11
+#define DEBUG_LINES_MAX_VERTICES (4 * DEBUG_GRID_LINES + 6)
+
+#define SKINNING_STRESS_INSTANCES 4096
+#define SKINNING_SAMPLE_BATCH	  64
+#define TENTACLE_JOINTS			  16
+#define TENTACLE_SIDES			  16
+#define TENTACLE_KEYS			  9
+#define TENTACLE_SEGMENT		  0.15f
+
+struct SceneModeTimings
+{
+	f64 gpuMsSum;
+	u32 framesCount;
+};
+
+// Links the shaders and drops the references taken by loading them, the registry keeps them for the next pipelines
+static PipelineHandle linkPipeline(ResourceRegistry& registry, const std::vector<ShaderHandle>& shaders)
+{
+	PipelineHandle pipeline = registry.loadPipeline(shaders.data(), u32(shaders.size()));
+	for (ShaderHandle shader : shaders)
+	{
+		registry.release(shader);
+	}
+	return pipeline;
+}
+
+// Modes sharing a stage compile it once, the plain vertex shader serves three of them
+static PipelineHandle loadScenePipeline(ResourceRegistry& registry, u32 mode)
+{
+	std::vector<std::string> vertexDefines;
+	std::vector<std::string> fragmentDefines;
+	BarycentricSource		 source = mode != 0 ? BarycentricSource(mode - 1) : BarycentricSource::COUNT;
+
+	if (mode != 0)
+	{
+		fragmentDefines.push_back("WIREFRAME");
+	}
+	if (source == BarycentricSource::VERTEX_ID)
+	{
+		vertexDefines.push_back("VERTEX_BARYCENTRICS");
+	}
+	if (source == BarycentricSource::FRAGMENT_EXTENSION)
+	{
+		fragmentDefines.push_back("FRAGMENT_BARYCENTRICS");
+	}
+
+	std::vector<ShaderHandle> shaders = {
+		registry.loadShader(STRINGIFY(SOURCE_DIR) "/assets/shaders/opengl/simple.vert", VERTEX_SHADER, vertexDefines),
+		registry.loadShader(
+			STRINGIFY(SOURCE_DIR) "/assets/shaders/opengl/simple.frag", FRAGMENT_SHADER, fragmentDefines),
+	};
+	if (source == BarycentricSource::GEOMETRY_SHADER)
+	{
+		shaders.push_back(
+			registry.loadShader(STRINGIFY(SOURCE_DIR) "/assets/shaders/opengl/simple.geom", GEOMETRY_SHADER));
+	}
+	return linkPipeline(registry, shaders);
+}
+
+static PipelineHandle loadDebugLinesPipeline(ResourceRegistry& registry)
+{
+	std::vector<ShaderHandle> shaders = {
+		registry.loadShader(STRINGIFY(SOURCE_DIR) "/assets/shaders/opengl/debug_lines.vert", VERTEX_SHADER),
+		registry.loadShader(STRINGIFY(SOURCE_DIR) "/assets/shaders/opengl/debug_lines.frag", FRAGMENT_SHADER),
+	};
+	return linkPipeline(registry, shaders);
+}
+
+// Plain texturing through the pulled indices, for the meshlet draws
+static PipelineHandle loadMeshletPipeline(ResourceRegistry& registry)
+{
+	std::vector<ShaderHandle> shaders = {
+		registry.loadShader(
+			STRINGIFY(SOURCE_DIR) "/assets/shaders/opengl/simple.vert", VERTEX_SHADER, {"PULLED_INDICES"}),
+		registry.loadShader(STRINGIFY(SOURCE_DIR) "/assets/shaders/opengl/simple.frag", FRAGMENT_SHADER),
+	};
+	return linkPipeline(registry, shaders);
+}
+
+static const char* getSceneModeName(u32 mode)
+{
+	return mode == 0 ? "plain" : barycentricSourceNames[mode - 1];
+}
+
+static void printSceneModeTimings(const SceneModeTimings* pTimings, const bool* pSupported)
+{
+	f64 geometryShaderMs = pTimings[1].framesCount > 0 ? pTimings[1].gpuMsSum / pTimings[1].framesCount : 0.0;
+
+	printf("Scene GPU time per mode:\n");
+	for (u32 mode = 0u; mode < SCENE_MODES_COUNT; ++mode)
+	{
+		if (!pSupported[mode])
+		{
+			printf(" %-22s unsupported\n", getSceneModeName(mode));
+			continue;
+		}
+		if (pTimings[mode].framesCount == 0)
+		{
+			printf(" %-22s not measured\n", getSceneModeName(mode));
+			continue;
+		}
+
+		f64 gpuMs = pTimings[mode].gpuMsSum / pTimings[mode].framesCount;
+		if (geometryShaderMs > 0.0)
+		{
+			printf(" %-22s %.3f ms over %u frames (%.2fx the geometry shader)\n",
+				   getSceneModeName(mode),
+				   gpuMs,
+				   pTimings[mode].framesCount,
+				   gpuMs / geometryShaderMs);
+		}
+		else
+		{
+			printf(" %-22s %.3f ms over %u frames\n", getSceneModeName(mode), gpuMs, pTimings[mode].framesCount);
+		}
+	}
+}
+
+// W toggles the wireframe overlay, G cycles its barycentric source, L toggles the debug lines, M toggles the meshlet
+// culling, O toggles the occlusion culling of the crowd, R toggles the dynamic resolution
+struct SceneControls
+{
+	bool			  wireframe;
+	BarycentricSource source;
+	const bool*		  pSupported;
+	bool			  debugLines;
+	bool			  meshlets;
+	bool			  occlusion;
+	bool			  dynamicResolution;
+};
+
+static u32 getSceneMode(const SceneControls& controls)
+{
+	return controls.wireframe ? 1 + u32(controls.source) : 0;
+}
+
+static void onKeyPressed(GLFWwindow* pWindow, i32 key, i32 scancode, i32 action, i32 mods)
+{
+	if (action != GLFW_PRESS)
+	{
+		return;
+	}
+
+	SceneControls& controls = *(SceneControls*)glfwGetWindowUserPointer(pWindow);
+	if (key == GLFW_KEY_W)
+	{
+		controls.wireframe = !controls.wireframe;
+	}
+	else if (key == GLFW_KEY_G)
+	{
+		do
+		{
+			controls.source = BarycentricSource((u32(controls.source) + 1) % u32(BarycentricSource::COUNT));
+		} while (!controls.pSupported[1 + u32(controls.source)]);
+	}
+	else if (key == GLFW_KEY_L)
+	{
+		controls.debugLines = !controls.debugLines;
+		printf("Debug lines: %s\n", controls.debugLines ? "on" : "off");
+		return;
+	}
+	else if (key == GLFW_KEY_M)
+	{
+		controls.meshlets = !controls.meshlets;
+		printf("Meshlet culling: %s\n", controls.meshlets ? "on" : "off");
+		return;
+	}
+	else if (key == GLFW_KEY_O)
+	{
+		controls.occlusion = !controls.occlusion;
+		printf("Occlusion culling: %s\n", controls.occlusion ? "on" : "off");
+		return;
+	}
+	else if (key == GLFW_KEY_R)
+	{
+		controls.dynamicResolution = !controls.dynamicResolution;
+		printf("Dynamic resolution: %s\n", controls.dynamicResolution ? "on" : "off");
+		return;
+	}
+	else
+	{
+		return;
+	}
+
+	printf("Scene mode: %s\n", getSceneModeName(getSceneMode(controls)));
+}
+
+struct SceneTextures
+{
+	TextureHandle logo;
+	TextureHandle duck;
+};
+
+// Decoded on a worker and added to the registry by a main thread job, unless it is already resident. Without a
+// registry the image is only decoded
+static void loadImage(
+	JobSystem& jobSystem, JobCounter& loaded, const char* path, ResourceRegistry* pRegistry, TextureHandle* pTexture)
+{
+	if (pRegistry != nullptr)
+	{
+		*pTexture = pRegistry->acquireTexture(path);
+		if (pTexture->isValid())
+		{
+			return;
+		}
+	}
+
+	jobSystem.schedule(
+		"Decode image",
+		[&jobSystem, &loaded, path, pRegistry, pTexture]() {
+			std::shared_ptr<TextureImage> pImage = std::make_shared<TextureImage>(path);
+			if (pRegistry != nullptr)
+			{
+				jobSystem.scheduleMainThread(
+					"Upload texture",
+					[pImage, path, pRegistry, pTexture]() { *pTexture = pRegistry->addTexture(path, *pImage); },
+					&loaded);
+			}
+		},
+		&loaded);
+}
+
+// Decodes the scene images and packs the duck vertices into pVertices on the job system. Without pRegistry nothing
+// is uploaded, so the loading also runs without a GL context
+static void loadSceneAssets(JobSystem&			jobSystem,
+							const GltfAccessor& positions,
+							const GltfAccessor& texCoords,
+							u8*					pVertices,
+							ResourceRegistry*	pRegistry,
+							SceneTextures*		pTextures)
+{
+	JobCounter loaded;
+	loadImage(jobSystem,
+			  loaded,
+			  STRINGIFY(SOURCE_DIR) "/assets/images/meed-logo.png",
+			  pRegistry,
+			  pTextures != nullptr ? &pTextures->logo : nullptr);
+	loadImage(jobSystem,
+			  loaded,
+			  STRINGIFY(SOURCE_DIR) "/assets/images/Duck_baseColor.png",
+			  pRegistry,
+			  pTextures != nullptr ? &pTextures->duck : nullptr);
+
+	jobSystem.parallelFor("Pack vertices", u32(positions.count), VERTICES_PACK_BATCH, [&](u32 begin, u32 end) {
+		u8* pBatch = pVertices + u64(begin) * sizeof(VertexData);
+		packVec3<0, 1, 2>(
+			positions.getRange(begin, end - begin), pBatch + offsetof(VertexData, position), sizeof(VertexData));
+		packTexCoords(
+			texCoords.getRange(begin, end - begin), pBatch + offsetof(VertexData, texCoord), sizeof(VertexData));
+	});
+
+	jobSystem.wait(loaded);
+}
+
+// Loads the scene assets with 1 up to one thread per core and prints how the loading time scales
+static void printJobScaling(const GltfAccessor& positions, const GltfAccessor& texCoords)
+{
+	std::vector<VertexData> vertices(positions.count);
+	u32						coresCount	   = std::max(1u, std::thread::hardware_concurrency());
+	f64						singleThreadMs = 0.0;
+
+	printf("Scene asset loading:\n");
+	for (u32 threadsCount = 1u; threadsCount <= coresCount; ++threadsCount)
+	{
+		JobSystem jobSystem(threadsCount - 1);
+
+		std::chrono::steady_clock::time_point loadStart = std::chrono::steady_clock::now();
+		loadSceneAssets(jobSystem, positions, texCoords, (u8*)vertices.data(), nullptr, nullptr);
+		f64 loadMs = std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - loadStart).count();
+
+		singleThreadMs = threadsCount == 1 ? loadMs : singleThreadMs;
+		printf(" %2u threads %8.3f ms x%.2f\n", threadsCount, loadMs, singleThreadMs / loadMs);
+	}
+}
+
+// The glTF nodes under a turntable root carrying the scene animation, pMeshNode receives the node drawing mesh 0
+static TransformHierarchy createSceneHierarchy(const GltfModel& model, u32* pMeshNode)
+{
+	std::vector<TransformNode> nodes(1 + model.getNodesCount());
+	nodes[0]   = {-1, vec3(0.0f), quat(1.0f, 0.0f, 0.0f, 0.0f), vec3(1.0f)};
+	*pMeshNode = 0;
+	for (u32 nodeIndex = 0u; nodeIndex < model.getNodesCount(); ++nodeIndex)
+	{
+		const GltfNode& node = model.getNode(nodeIndex);
+		nodes[1 + nodeIndex] = {-1, node.translation, node.rotation, node.scale};
+		*pMeshNode			 = node.mesh == 0 && *pMeshNode == 0 ? 1 + nodeIndex : *pMeshNode;
+	}
+
+	for (u32 nodeIndex = 0u; nodeIndex < model.getNodesCount(); ++nodeIndex)
+	{
+		for (i32 child : model.getNode(nodeIndex).children)
+		{
+			nodes[1 + child].parent = i32(1 + nodeIndex);
+		}
+	}
+	for (i32 sceneRoot : model.getSceneRoots())
+	{
+		nodes[1 + sceneRoot].parent = 0;
+	}
+
+	TransformHierarchy hierarchy(nodes);
+	*pMeshNode = hierarchy.getNode(*pMeshNode);
+	return hierarchy;
+}
+
+// Updates HIERARCHY_BENCHMARK_NODES nodes, eight children per node, with every node animated and then one in a
+// hundred, on the calling thread and on the job system, and prints the time per update
+static void printHierarchyBenchmark()
+{
+	std::vector<TransformNode> nodes(HIERARCHY_BENCHMARK_NODES);
+	for (u32 nodeIndex = 0u; nodeIndex < HIERARCHY_BENCHMARK_NODES; ++nodeIndex)
+	{
+		nodes[nodeIndex].parent		 = nodeIndex == 0 ? -1 : i32((nodeIndex - 1) / 8);
+		nodes[nodeIndex].translation = vec3(0.1f * f32(nodeIndex % 8), 0.0f, 1.0f);
+		nodes[nodeIndex].rotation	 = quat(1.0f, 0.0f, 0.0f, 0.0f);
+		nodes[nodeIndex].scale		 = vec3(1.0f);
+	}
+
+	TransformHierarchy hierarchy(nodes);
+	JobSystem		   jobSystem(std::max(1u, std::thread::hardware_concurrency()) - 1);
+	printf("Transform hierarchy, %u nodes in %u levels:\n", hierarchy.getNodesCount(), hierarchy.getLevelsCount());
+
+	const u32 animatedStrides[] = {1, 100};
+	for (u32 animatedStride : animatedStrides)
+	{
+		for (JobSystem* pJobSystem : {(JobSystem*)nullptr, &jobSystem})
+		{
+			f64 updateMs	 = 0.0;
+			u32 updatedCount = 0;
+			for (u32 frame = 0u; frame < HIERARCHY_BENCHMARK_FRAMES; ++frame)
+			{
+				quat rotation = glm::angleAxis(0.01f * f32(frame), vec3(0.0f, 1.0f, 0.0f));
+				for (u32 nodeIndex = 0u; nodeIndex < HIERARCHY_BENCHMARK_NODES; nodeIndex += animatedStride)
+				{
+					const TransformNode& node = nodes[nodeIndex];
+					hierarchy.setLocalTransform(hierarchy.getNode(nodeIndex), node.translation, rotation, node.scale);
+				}
+
+				std::chrono::steady_clock::time_point updateStart = std::chrono::steady_clock::now();
+				updatedCount									  = hierarchy.update(pJobSystem);
+				std::chrono::steady_clock::duration	  updateTime  = std::chrono::steady_clock::now() - updateStart;
+				updateMs += std::chrono::duration<f64, std::milli>(updateTime).count();
+			}
+
+			printf(" 1 in %3u animated, %2u threads: %8.3f ms per update, %u world matrices\n",
+				   animatedStride,
+				   pJobSystem != nullptr ? 1 + pJobSystem->getWorkersCount() : 1,
+				   updateMs / HIERARCHY_BENCHMARK_FRAMES,
+				   updatedCount);
+		}
+	}
+}
+
+// Bind pose, skeleton and clip of the characters of the skinning stress test
+struct SkinnedCharacter
+{
+	std::unique_ptr<GltfModel> pModel; // owns the buffers a glTF clip reads its keys from, nullptr for built ones
+	std::vector<SkinnedVertex> vertices;
+	std::vector<u32>		   indices;
+	std::vector<SkeletonJoint> joints;
+	AnimationClip			   clip;
+};
+
+// Tube along Y around a chain of TENTACLE_JOINTS joints waving in a looping clip, for when no skinned model is given
+static void createTentacle(SkinnedCharacter* pCharacter)
 {
+	const f32 twoPi = 6.28318531f;
+
+	for (u32 joint = 0u; joint < TENTACLE_JOINTS; ++joint)
+	{
+		SkeletonJoint skeletonJoint = {};
+		skeletonJoint.parent		= i32(joint) - 1;
+		skeletonJoint.translation	= vec3(0.0f, joint > 0 ? TENTACLE_SEGMENT : 0.0f, 0.0f);
+		skeletonJoint.rotation		= quat(1.0f, 0.0f, 0.0f, 0.0f);
+		skeletonJoint.scale			= vec3(1.0f);
+		skeletonJoint.rootMatrix	= mat4(1.0f);
+		composeTransform(vec3(0.0f, -TENTACLE_SEGMENT * f32(joint), 0.0f),
+						 quat(1.0f, 0.0f, 0.0f, 0.0f),
+						 vec3(1.0f),
+						 skeletonJoint.inverseBindMatrix);
+		pCharacter->joints.push_back(skeletonJoint);
+	}
+
+	// One ring per joint plus the tip, the seam is duplicated so the texture wraps around once
+	for (u32 ring = 0u; ring <= TENTACLE_JOINTS; ++ring)
+	{
+		f32 radius = 0.08f * (1.0f - 0.8f * f32(ring) / f32(TENTACLE_JOINTS));
+		u16 below  = u16(ring > 0 ? std::min(ring, u32(TENTACLE_JOINTS)) - 1 : 0);
+		u16 above  = u16(std::min(ring, u32(TENTACLE_JOINTS) - 1));
+		for (u32 side = 0u; side <= TENTACLE_SIDES; ++side)
+		{
+			f32			  angle	 = twoPi * f32(side) / f32(TENTACLE_SIDES);
+			SkinnedVertex vertex = {{radius * std::cos(angle), TENTACLE_SEGMENT * f32(ring), radius * std::sin(angle)},
+									{f32(side) / f32(TENTACLE_SIDES), f32(ring) / f32(TENTACLE_JOINTS)},
+									{below, above, 0, 0},
+									{0.5f, 0.5f, 0.0f, 0.0f}};
+			pCharacter->vertices.push_back(vertex);
+		}
+	}
+
+	for (u32 ring = 0u; ring < TENTACLE_JOINTS; ++ring)
+	{
+		for (u32 side = 0u; side < TENTACLE_SIDES; ++side)
+		{
+			u32 corner	= ring * (TENTACLE_SIDES + 1) + side;
+			u32 quad[6] = {corner, corner + TENTACLE_SIDES + 1, corner + 1, corner + 1, corner + TENTACLE_SIDES + 1,
+						   corner + TENTACLE_SIDES + 2};
+			pCharacter->indices.insert(pCharacter->indices.end(), quad, quad + 6);
+		}
+	}
+
+	// Key times, then the rotations of every joint, the first and last keys match so the clip loops
+	AnimationClip& clip = pCharacter->clip;
+	clip.duration		= 2.0f;
+	for (u32 key = 0u; key < TENTACLE_KEYS; ++key)
+	{
+		clip.keyframes.push_back(clip.duration * f32(key) / f32(TENTACLE_KEYS - 1));
+	}
+	for (u32 joint = 0u; joint < TENTACLE_JOINTS; ++joint)
+	{
+		for (u32 key = 0u; key < TENTACLE_KEYS; ++key)
+		{
+			f32 angle	   = 0.3f * std::sin(twoPi * f32(key) / f32(TENTACLE_KEYS - 1) + 0.5f * f32(joint));
+			f32 keyframe[4] = {0.0f, 0.0f, std::sin(0.5f * angle), std::cos(0.5f * angle)}; // x, y, z, w about Z
+			clip.keyframes.insert(clip.keyframes.end(), keyframe, keyframe + 4);
+		}
+	}
+
+	const u8*	 pKeyframes = (const u8*)clip.keyframes.data();
+	GltfAccessor times		= {pKeyframes, TENTACLE_KEYS, sizeof(f32), GltfComponentType::FLOAT, 1, false};
+	for (u32 joint = 0u; joint < TENTACLE_JOINTS; ++joint)
+	{
+		GltfAccessor rotations	  = times;
+		rotations.pData			  = pKeyframes + sizeof(f32) * (TENTACLE_KEYS + joint * TENTACLE_KEYS * 4);
+		rotations.stride		  = 4 * sizeof(f32);
+		rotations.componentsCount = 4;
+		clip.channels.push_back({joint, GltfAnimationPath::ROTATION, GltfInterpolation::LINEAR, times, rotations});
+	}
+}
+
+// First skinned triangle mesh of the model with the first animation, false when there is none
+static bool loadGltfCharacter(JobSystem& jobSystem, const char* path, SkinnedCharacter* pCharacter)
+{
+	std::unique_ptr<GltfModel> pModel = std::make_unique<GltfModel>(path);
+	for (u32 nodeIndex = 0u; pModel->isLoaded() && nodeIndex < pModel->getNodesCount(); ++nodeIndex)
+	{
+		const GltfNode& node = pModel->getNode(nodeIndex);
+		if (node.mesh < 0 || node.skin < 0)
+		{
+			continue;
+		}
+
+		const GltfPrimitive& primitive = pModel->getMesh(node.mesh).primitives[0];
+		if (primitive.mode != GL_TRIANGLES || primitive.positions < 0 || primitive.texCoords < 0 ||
+			primitive.joints < 0 || primitive.weights < 0 || primitive.indices < 0)
+		{
+			continue;
+		}
+
+		u32 verticesCount = u32(pModel->getAccessor(primitive.positions).count);
+		pCharacter->vertices.resize(verticesCount);
+		jobSystem.parallelFor("Pack skinned vertices", verticesCount, VERTICES_PACK_BATCH, [&](u32 begin, u32 end) {
+			packSkinnedVertices(*pModel, primitive, begin, end - begin, pCharacter->vertices.data());
+		});
+
+		const GltfAccessor& indices = pModel->getAccessor(primitive.indices);
+		pCharacter->indices.resize(indices.count);
+		packIndices(indices, pCharacter->indices.data());
+
+		pCharacter->joints = getGltfSkeletonJoints(*pModel, u32(node.skin));
+		if (pModel->getAnimationsCount() > 0)
+		{
+			pCharacter->clip = createGltfAnimationClip(*pModel, 0, u32(node.skin));
+		}
+		pCharacter->pModel = std::move(pModel);
+		return true;
+	}
+	return false;
+}
+
+// Instances of one character laid out on a grid in front of the camera, posed and drawn every frame
+struct SkinnedCrowd
+{
+	SkinnedCharacter			  character;
+	std::unique_ptr<Skeleton>	  pSkeleton;
+	std::unique_ptr<SkinningPass> pPass;
+	std::vector<mat4>			  worldMatrices;
+
+	// One indirect draw per instance and culling phase, each with its base vertex into the posed vertices
+	std::unique_ptr<OcclusionCullingPass> pCulling;
+	u32									  indices; // in the index arena
+	u32									  vao;
+	u32									  uniformBuffer;
+
+	u32 timerQueries[TIMER_QUERIES_COUNT];
+	f64 sampleMsSum;
+	f64 skinningGpuMsSum;
+	u32 sampledFramesCount;
+	u32 skinnedFramesCount;
+
+	// Culling and draws of the crowd, apart with the occlusion culling on (1) and off (0)
+	u32	 drawTimerQueries[TIMER_QUERIES_COUNT];
+	bool drawTimerOcclusion[TIMER_QUERIES_COUNT];
+	f64	 drawGpuMsSums[2];
+	u32	 drawnFramesCounts[2];
+};
+
+static std::unique_ptr<SkinnedCrowd> createSkinnedCrowd(JobSystem&   jobSystem,
+													  BufferArena& indexArena,
+													  const char*  modelPath,
+													  u32		   instancesCount)
+{
+	std::unique_ptr<SkinnedCrowd> pCrowd = std::make_unique<SkinnedCrowd>();
+	if (modelPath == nullptr || !loadGltfCharacter(jobSystem, modelPath, &pCrowd->character))
+	{
+		if (modelPath != nullptr)
+		{
+			printf("No skinned mesh in %s, the crowd is made of tentacles\n", modelPath);
+		}
+		pCrowd->character = {};
+		createTentacle(&pCrowd->character);
+	}
+
+	SkinnedCharacter& character		= pCrowd->character;
+	u32				  verticesCount = u32(character.vertices.size());
+	u32				  jointsCount	= u32(character.joints.size());
+	pCrowd->pSkeleton				= std::make_unique<Skeleton>(character.joints);
+	pCrowd->pPass					= std::make_unique<SkinningPass>(verticesCount, jointsCount, instancesCount);
+	memcpy(pCrowd->pPass->mapSkinnedVertices(), character.vertices.data(), sizeof(SkinnedVertex) * verticesCount);
+	pCrowd->pPass->unmapSkinnedVertices();
+
+	u64 indicesSize = sizeof(u32) * character.indices.size();
+	pCrowd->indices = indexArena.allocate(indicesSize, 3 * sizeof(u32));
+	indexArena.upload(pCrowd->indices, character.indices.data(), indicesSize);
+	BufferRange indices = indexArena.getRange(pCrowd->indices);
+
+	u32 side = u32(std::ceil(std::sqrt(f32(instancesCount))));
+	for (u32 instance = 0u; instance < instancesCount; ++instance)
+	{
+		vec3 position(0.6f * (f32(instance % side) - 0.5f * f32(side)), -1.5f, -3.0f - 0.6f * f32(instance / side));
+		composeTransform(position, quat(1.0f, 0.0f, 0.0f, 0.0f), vec3(1.0f), pCrowd->worldMatrices.emplace_back());
+	}
+	pCrowd->pCulling = std::make_unique<OcclusionCullingPass>(
+		instancesCount, u32(character.indices.size()), u32(indices.offset / sizeof(u32)), verticesCount);
+
+	GL_ASSERT(glCreateVertexArrays(1, &pCrowd->vao));
+	GL_ASSERT(glVertexArrayElementBuffer(pCrowd->vao, indices.bufferId));
+	GL_ASSERT(glCreateBuffers(1, &pCrowd->uniformBuffer));
+	GL_ASSERT(glNamedBufferData(pCrowd->uniformBuffer, sizeof(UniformBufferObject), nullptr, GL_DYNAMIC_DRAW));
+	GL_ASSERT(glGenQueries(TIMER_QUERIES_COUNT, pCrowd->timerQueries));
+	GL_ASSERT(glGenQueries(TIMER_QUERIES_COUNT, pCrowd->drawTimerQueries));
+
+	printf("Skinning stress: %u instances of %u vertices and %u joints\n",
+		   instancesCount,
+		   verticesCount,
+		   jointsCount);
+	return pCrowd;
+}
+
+// Every instance at its own point of the clip, straight into the mapped joint matrices, from any thread
+static void sampleSkinnedCrowd(JobSystem& jobSystem, SkinnedCrowd& crowd, mat4* pJointMatrices, f32 time)
+{
+	std::chrono::steady_clock::time_point sampleStart = std::chrono::steady_clock::now();
+
+	u32 jointsCount = crowd.pSkeleton->getJointsCount();
+	jobSystem.parallelFor("Sample animations",
+						  crowd.pPass->getInstancesCount(),
+						  SKINNING_SAMPLE_BATCH,
+						  [&](u32 begin, u32 end) {
+							  for (u32 instance = begin; instance < end; ++instance)
+							  {
+								  crowd.pSkeleton->sample(crowd.character.clip,
+														  time + 0.173f * f32(instance),
+														  crowd.worldMatrices[instance],
+														  pJointMatrices + u64(instance) * jointsCount);
+							  }
+						  });
+
+	crowd.sampleMsSum += std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - sampleStart).count();
+	crowd.sampledFramesCount++;
+}
+
+static void skinSkinnedCrowd(SkinnedCrowd& crowd, u64 framesCount)
+{
+	u32 timerQuery = crowd.timerQueries[framesCount % TIMER_QUERIES_COUNT];
+	if (framesCount >= TIMER_QUERIES_COUNT)
+	{
+		GLuint64 elapsedNs = 0;
+		GL_ASSERT(glGetQueryObjectui64v(timerQuery, GL_QUERY_RESULT, &elapsedNs));
+		crowd.skinningGpuMsSum += f64(elapsedNs) / 1000000.0;
+		crowd.skinnedFramesCount++;
+	}
+
+	GL_ASSERT(glBeginQuery(GL_TIME_ELAPSED, timerQuery));
+	crowd.pPass->dispatch();
+	GL_ASSERT(glEndQuery(GL_TIME_ELAPSED));
+}
+
+// Through the plain pipeline and simple.vert like the duck, the culling binds its own storage buffers before
+static void drawSkinnedCrowdPhase(const SkinnedCrowd& crowd, const Pipeline& pipeline, OcclusionCullingPhase phase)
+{
+	GL_ASSERT(glBindBufferBase(GL_UNIFORM_BUFFER, 0, crowd.uniformBuffer));
+	GL_ASSERT(glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, crowd.pPass->getPosedVerticesBuffer()));
+	GL_ASSERT(glBindVertexArray(crowd.vao));
+
+	pipeline.bind();
+	crowd.pCulling->draw(phase);
+	pipeline.unbind();
+}
+
+// The posed vertices are already in view space, the projection is the view projection. Without a pyramid only the
+// frustum culls and every visible instance is drawn by the early phase. With one, the early phase draws what the
+// pyramid of the previous frame does not hide, the pyramid is rebuilt from the target depth and the late phase draws
+// the rest of what is visible
+static void drawSkinnedCrowd(SkinnedCrowd&		 crowd,
+							 const Pipeline&	 pipeline,
+							 const mat4&		 projection,
+							 const RenderTarget& target,
+							 DepthPyramid*		 pPyramid,
+							 u64				 framesCount)
+{
+	EASY_FUNCTION();
+
+	u32 timerQuery = crowd.drawTimerQueries[framesCount % TIMER_QUERIES_COUNT];
+	if (framesCount >= TIMER_QUERIES_COUNT)
+	{
+		GLuint64 elapsedNs = 0;
+		GL_ASSERT(glGetQueryObjectui64v(timerQuery, GL_QUERY_RESULT, &elapsedNs));
+
+		u32 occlusion = crowd.drawTimerOcclusion[framesCount % TIMER_QUERIES_COUNT] ? 1 : 0;
+		crowd.drawGpuMsSums[occlusion] += f64(elapsedNs) / 1000000.0;
+		crowd.drawnFramesCounts[occlusion]++;
+	}
+	crowd.drawTimerOcclusion[framesCount % TIMER_QUERIES_COUNT] = pPyramid != nullptr;
+
+	UniformBufferObject ubo = {projection};
+	GL_ASSERT(glNamedBufferSubData(crowd.uniformBuffer, 0, sizeof(UniformBufferObject), &ubo));
+
+	u32 boundsBuffer = crowd.pPass->getPosedBoundsBuffer();
+	GL_ASSERT(glBeginQuery(GL_TIME_ELAPSED, timerQuery));
+	crowd.pCulling->dispatch(OcclusionCullingPhase::EARLY, boundsBuffer, projection, pPyramid);
+	drawSkinnedCrowdPhase(crowd, pipeline, OcclusionCullingPhase::EARLY);
+	if (pPyramid != nullptr)
+	{
+		// The first build only serves the late test. The second one holds the late draws too, the early test of the
+		// next frame would otherwise miss every occluder that came into view this frame
+		pPyramid->build(target.getDepthTextureId(), target.getRenderWidth(), target.getRenderHeight(), projection);
+		crowd.pCulling->dispatch(OcclusionCullingPhase::LATE, boundsBuffer, projection, pPyramid);
+		drawSkinnedCrowdPhase(crowd, pipeline, OcclusionCullingPhase::LATE);
+		pPyramid->build(target.getDepthTextureId(), target.getRenderWidth(), target.getRenderHeight(), projection);
+	}
+	GL_ASSERT(glEndQuery(GL_TIME_ELAPSED));
+}
+
+static void printOcclusionCullingStatistics(const SkinnedCrowd& crowd)
+{
+	const OcclusionCullingStatistics& statistics = crowd.pCulling->getStatistics();
+	if (statistics.framesCount > 0)
+	{
+		f64 framesCount = f64(statistics.framesCount);
+		printf("Occlusion culling: %.0f of %u instances occluded per frame, %.0f drawn early, %.0f drawn late and %.0f "
+			   "outside the frustum, over %u frames\n",
+			   f64(statistics.occludedCount) / framesCount,
+			   crowd.pCulling->getInstancesCount(),
+			   f64(statistics.earlyDrawnCount) / framesCount,
+			   f64(statistics.lateDrawnCount) / framesCount,
+			   f64(statistics.frustumCulledCount) / framesCount,
+			   statistics.framesCount);
+	}
+
+	if (crowd.drawnFramesCounts[0] > 0 && crowd.drawnFramesCounts[1] > 0)
+	{
+		f64 frustumMs	= crowd.drawGpuMsSums[0] / crowd.drawnFramesCounts[0];
+		f64 occlusionMs = crowd.drawGpuMsSums[1] / crowd.drawnFramesCounts[1];
+		printf(" crowd GPU %.3f ms per frame with occlusion culling, %.3f ms with the frustum only, %.1f%% saved\n",
+			   occlusionMs,
+			   frustumMs,
+			   100.0 * (frustumMs - occlusionMs) / frustumMs);
+	}
+}
+
+static void destroySkinnedCrowd(std::unique_ptr<SkinnedCrowd>& pCrowd, BufferArena& indexArena, u32 threadsCount)
+{
+	if (pCrowd->sampledFramesCount > 0 && pCrowd->skinnedFramesCount > 0)
+	{
+		printf("Skinning stress: %.3f ms sampling on %u threads, %.3f ms GPU skinning per frame\n",
+			   pCrowd->sampleMsSum / pCrowd->sampledFramesCount,
+			   threadsCount,
+			   pCrowd->skinningGpuMsSum / pCrowd->skinnedFramesCount);
+	}
+	printOcclusionCullingStatistics(*pCrowd);
+
+	GL_ASSERT(glDeleteQueries(TIMER_QUERIES_COUNT, pCrowd->timerQueries));
+	GL_ASSERT(glDeleteQueries(TIMER_QUERIES_COUNT, pCrowd->drawTimerQueries));
+	indexArena.free(pCrowd->indices);
+	GL_ASSERT(glDeleteBuffers(1, &pCrowd->uniformBuffer));
+	GL_ASSERT(glDeleteVertexArrays(1, &pCrowd->vao));
+	pCrowd.reset();
+}
+
+// Grid on the ground under the duck and the axes of its world matrix, returns the vertices written
+static u32 writeDebugLines(const mat4& duckWorld, DebugLineVertex* pVertices)
+{
+	const vec3 center	 = vec3(0.0f, -0.5f, -1.5f);
+	const f32  halfSize	 = 1.0f;
+	const u32  gridColor = 0xFF606060u;
+	u32		   count	 = 0;
+	for (u32 line = 0u; line < DEBUG_GRID_LINES; ++line)
+	{
+		f32 along		   = -halfSize + 2.0f * halfSize * f32(line) / f32(DEBUG_GRID_LINES - 1);
+		pVertices[count++] = {center + vec3(along, 0.0f, -halfSize), gridColor};
+		pVertices[count++] = {center + vec3(along, 0.0f, halfSize), gridColor};
+		pVertices[count++] = {center + vec3(-halfSize, 0.0f, along), gridColor};
+		pVertices[count++] = {center + vec3(halfSize, 0.0f, along), gridColor};
+	}
+
+	// Red, green and blue for x, y and z, half a unit long whatever the scale
+	const u32 axisColors[3] = {0xFF0000FFu, 0xFF00FF00u, 0xFFFF0000u};
+	vec3	  origin		= vec3(duckWorld[3]);
+	for (u32 axis = 0u; axis < 3u; ++axis)
+	{
+		pVertices[count++] = {origin, axisColors[axis]};
+		pVertices[count++] = {origin + glm::normalize(vec3(duckWorld[axis])) * 0.5f, axisColors[axis]};
+	}
+	return count;
+}
+
+static void printDynamicResolutionStatistics(const DynamicResolution& resolution)
+{
+	const DynamicResolutionStatistics& statistics = resolution.getStatistics();
+	if (statistics.framesCount == 0)
+	{
+		return;
+	}
+
+	printf("Dynamic resolution: %.3f ms GPU per frame for a %.3f ms target, %.1f%% of the frames over it, scale %.2f "
+		   "on average and %.2f at least, over %u frames\n",
+		   statistics.frameMsSum / statistics.framesCount,
+		   resolution.getTargetFrameMs(),
+		   100.0 * statistics.overTargetFramesCount / statistics.framesCount,
+		   statistics.scaleSum / statistics.framesCount,
+		   statistics.minScale,
+		   statistics.framesCount);
+}
+
+static void printResourceStatistics(const ResourceRegistry& registry)
+{
+	ResourceStatistics statistics = registry.getStatistics();
+	printf("Resources: %u loads, %u hits, %u evictions, %u resident (%u unused), %.3f MB resident, %.3f MB peak\n",
+		   statistics.loadsCount,
+		   statistics.hitsCount,
+		   statistics.evictionsCount,
+		   statistics.residentCount,
+		   statistics.unusedCount,
+		   f64(statistics.residentSize) / (1024.0 * 1024.0),
+		   f64(statistics.peakSize) / (1024.0 * 1024.0));
+}
+
+static void printMeshletCullingStatistics(const MeshletCullingPass& culling)
+{
+	const MeshletCullingStatistics& statistics = culling.getStatistics();
+	if (statistics.framesCount == 0)
+	{
+		return;
+	}
+
+	f64 frustumCulledCount = f64(statistics.frustumCulledTrianglesCount) / statistics.framesCount;
+	f64 coneCulledCount	   = f64(statistics.coneCulledTrianglesCount) / statistics.framesCount;
+	printf("Meshlet culling: %.0f of %u triangles culled per frame (%.1f%%), %.0f outside the frustum and %.0f back "
+		   "facing, over %u frames\n",
+		   frustumCulledCount + coneCulledCount,
+		   culling.getTrianglesCount(),
+		   100.0 * (frustumCulledCount + coneCulledCount) / culling.getTrianglesCount(),
+		   frustumCulledCount,
+		   coneCulledCount,
+		   statistics.framesCount);
+}
+
+static void printBufferArenaStatistics(const char* name, const BufferArena& arena)
+{
+	BufferArenaStatistics statistics = arena.getStatistics();
+	printf(" %-14s %5u allocations in %2u blocks, %8.3f of %8.3f MB used, %5.1f%% fragmented\n",
+		   name,
+		   statistics.allocationsCount,
+		   statistics.blocksCount,
+		   f64(statistics.usedSize) / (1024.0 * 1024.0),
+		   f64(statistics.capacity) / (1024.0 * 1024.0),
+		   100.0 * statistics.fragmentation);
+}
+
+// Allocates ARENA_STRESS_MESHES meshes of random sizes, frees every other one, then compacts, printing the arena in
+// between. Needs a GL context
+static void printBufferArenaStress()
+{
+	BufferArena		 arena(MESH_ARENA_BLOCK_SIZE);
+	std::vector<u32> meshes;
+	u32				 seed		   = 1;
+	const u32		 verticesRange = ARENA_STRESS_MAX_VERTICES - ARENA_STRESS_MIN_VERTICES + 1;
+	for (u32 mesh = 0u; mesh < ARENA_STRESS_MESHES; ++mesh)
+	{
+		seed			  = seed * 1664525u + 1013904223u;
+		u32 verticesCount = ARENA_STRESS_MIN_VERTICES + (seed >> 8) % verticesRange;
+		meshes.push_back(arena.allocate(sizeof(VertexData) * verticesCount, sizeof(VertexData)));
+	}
+
+	printf("Buffer arena, %u meshes:\n", ARENA_STRESS_MESHES);
+	printBufferArenaStatistics("allocated", arena);
+	for (u32 mesh = 0u; mesh < ARENA_STRESS_MESHES; mesh += 2)
+	{
+		arena.free(meshes[mesh]);
+	}
+	printBufferArenaStatistics("half freed", arena);
+
+	std::chrono::steady_clock::time_point compactStart = std::chrono::steady_clock::now();
+	u64									  copiedSize   = arena.compact();
+	GL_ASSERT(glFinish());
+	f64 compactMs = std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - compactStart).count();
+	printBufferArenaStatistics("compacted", arena);
+	printf(" %.3f MB copied in %.3f ms\n", f64(copiedSize) / (1024.0 * 1024.0), compactMs);
+}
+
+int main(int argc, char** argv)
+{
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	// --benchmark renders BENCHMARK_FRAMES frames in every supported mode at full resolution, the first half of them
+	// with the occlusion culling and the second without, then prints the timings and exits
+	// --loose-assets reads the assets directory instead of the archive packed by the build
+	// --job-scaling loads the scene assets with 1 to N threads, prints the timings and exits
+	// --hierarchy-benchmark times the transform updates of a large hierarchy and exits
+	// --skinning-stress[=N] poses and draws N skinned characters every frame, SKINNING_STRESS_INSTANCES by default
+	// --skinned-model=<path> is the glTF the stress test takes its character from, a built tentacle otherwise
+	// --arena-stress fills, fragments and compacts a mesh buffer arena, prints its state along the way and exits
+	// --resource-budget=<MB> is how much unused textures, shaders and pipelines may keep resident
+	// --target-frame-ms=<ms> is the GPU frame time the dynamic resolution scales the render target to hold
+	bool		benchmark				= false;
+	bool		looseAssets				= false;
+	bool		jobScaling				= false;
+	bool		hierarchyBenchmark		= false;
+	bool		arenaStress				= false;
+	u32			skinningStressInstances = 0;
+	const char* skinnedModelPath		= nullptr;
+	u64			resourceBudget			= RESOURCE_MEMORY_BUDGET;
+	f32			targetFrameMs			= DYNAMIC_RESOLUTION_TARGET_MS;
+	for (i32 argIndex = 1; argIndex < argc; ++argIndex)
+	{
+		benchmark |= strcmp(argv[argIndex], "--benchmark") == 0;
+		looseAssets |= strcmp(argv[argIndex], "--loose-assets") == 0;
+		jobScaling |= strcmp(argv[argIndex], "--job-scaling") == 0;
+		hierarchyBenchmark |= strcmp(argv[argIndex], "--hierarchy-benchmark") == 0;
+		arenaStress |= strcmp(argv[argIndex], "--arena-stress") == 0;
+		if (strcmp(argv[argIndex], "--skinning-stress") == 0)
+		{
+			skinningStressInstances = SKINNING_STRESS_INSTANCES;
+		}
+		else if (strncmp(argv[argIndex], "--skinning-stress=", 18) == 0)
+		{
+			skinningStressInstances = u32(std::max(1, atoi(argv[argIndex] + 18)));
+		}
+		else if (strncmp(argv[argIndex], "--skinned-model=", 16) == 0)
+		{
+			skinnedModelPath = argv[argIndex] + 16;
+		}
+		else if (strncmp(argv[argIndex], "--resource-budget=", 18) == 0)
+		{
+			resourceBudget = u64(std::max(0, atoi(argv[argIndex] + 18))) * 1024 * 1024;
+		}
+		else if (strncmp(argv[argIndex], "--target-frame-ms=", 18) == 0)
+		{
+			targetFrameMs = std::max(0.1f, f32(atof(argv[argIndex] + 18)));
+		}
+	}
+
+	if (hierarchyBenchmark)
+	{
+		printHierarchyBenchmark();
+		return 0;
+	}
+
+	AssetArchive archive(STRINGIFY(BUILD_DIR) "/assets.pak");
+	if (archive.isOpen() && !looseAssets)
+	{
+		std::chrono::steady_clock::time_point preloadStart = std::chrono::steady_clock::now();
+		archive.preload();
+		printf("Asset archive: %u entries preloaded in %.3f ms with %s\n",
+			   archive.getEntriesCount(),
+			   std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - preloadStart).count(),
+			   archive.getReadBackendName());
+		mountAssetArchive(&archive, STRINGIFY(SOURCE_DIR) "/assets/");
+	}
+
+	GltfModel duck(STRINGIFY(SOURCE_DIR) "/assets/gltfs/rubber_duck.gltf");
+	ASSERT(duck.isLoaded() && duck.getMeshesCount() > 0);
+
+	const GltfPrimitive& primitive = duck.getMesh(0).primitives[0];
+	ASSERT(primitive.mode == GL_TRIANGLES && primitive.positions >= 0 && primitive.texCoords >= 0 &&
+		   primitive.indices >= 0);
+	const GltfAccessor& positions	  = duck.getAccessor(primitive.positions);
+	const GltfAccessor& texCoords	  = duck.getAccessor(primitive.texCoords);
+	const GltfAccessor& indexAccessor = duck.getAccessor(primitive.indices);
+	ASSERT(positions.count == texCoords.count);
+
+	if (jobScaling)
+	{
+		printJobScaling(positions, texCoords);
+		unmountAssetArchive();
+		return 0;
+	}
+
 	EASY_PROFILER_ENABLE;
 	profiler::startListen();
 
+	// The main thread is a worker too, while it waits
+	JobSystem jobSystem(std::max(1u, std::thread::hardware_concurrency()) - 1);
+
 	ASSERT(glfwInit() == GLFW_TRUE);
 
 	GLFWwindow* window = glfwCreateWindow(WIDTH, HEIGHT, "GLFW Window", nullptr, nullptr);
@@ -65,71 +1039,103 @@ int main()
 	glfwMakeContextCurrent(window);
 	ASSERT(gladLoadGLLoader((GLADloadproc)glfwGetProcAddress));
 
+	if (arenaStress)
+	{
+		printBufferArenaStress();
+		glfwDestroyWindow(window);
+		glfwTerminate();
+		unmountAssetArchive();
+		return 0;
+	}
+
 	glEnable(GL_DEPTH_TEST);
 	glDepthFunc(GL_LESS);
 
-	Texture texture(STRINGIFY(SOURCE_DIR) "/assets/images/meed-logo.png");
+	bool supportedModes[SCENE_MODES_COUNT] = {true, true, true, hasExtension("GL_NV_fragment_shader_barycentric")};
+
+	// Released before the context goes, along with everything it owns
+	std::unique_ptr<ResourceRegistry> pRegistry = std::make_unique<ResourceRegistry>(resourceBudget);
 
-	Shader vertexShader(STRINGIFY(SOURCE_DIR) "/assets/shaders/opengl/simple.vert", VERTEX_SHADER);
-	Shader fragmentShader(STRINGIFY(SOURCE_DIR) "/assets/shaders/opengl/simple.frag", FRAGMENT_SHADER);
-	Shader geometryShader(STRINGIFY(SOURCE_DIR) "/assets/shaders/opengl/simple.geom", GEOMETRY_SHADER);
+	std::vector<PipelineHandle> pipelines;
+	pipelines.reserve(SCENE_MODES_COUNT);
+	for (u32 mode = 0u; mode < SCENE_MODES_COUNT; ++mode)
+	{
+		// Unsupported modes take another reference on the plain pipeline so the vector stays indexed by mode, they
+		// are never selected
+		pipelines.push_back(loadScenePipeline(*pRegistry, supportedModes[mode] ? mode : 0));
+	}
 
-	Shader shaders[3] = {std::move(vertexShader), std::move(fragmentShader), std::move(geometryShader)};
+	SceneControls controls = {false, BarycentricSource::VERTEX_ID, supportedModes, false, true, true, true};
+	glfwSetWindowUserPointer(window, &controls);
+	glfwSetKeyCallback(window, onKeyPressed);
 
-	Pipeline	 pipeline(shaders, sizeof(shaders) / sizeof(Shader));
-	VertexBuffer buffer({VertexAttributeType::VEC2, VertexAttributeType::VEC3, VertexAttributeType::VEC2});
+	SceneModeTimings sceneTimings[SCENE_MODES_COUNT] = {};
+	u32				 timerQueries[TIMER_QUERIES_COUNT];
+	u32				 timerQueryModes[TIMER_QUERIES_COUNT];
+	GL_ASSERT(glGenQueries(TIMER_QUERIES_COUNT, timerQueries));
+	u64 framesCount		= 0;
+	u32 benchmarkMode	= 0;
+	u32 benchmarkFrames = 0;
 
-	const aiScene* scene = aiImportFile(STRINGIFY(SOURCE_DIR) "/assets/gltfs/rubber_duck.gltf", aiProcess_Triangulate);
+	// Fetched by the vertex format rather than pulled, from a persistently mapped stream
+	std::unique_ptr<VertexFormat> pDebugLineFormat =
+		std::make_unique<VertexFormat>(VertexFormat::create<DebugLineVertex>());
+	std::unique_ptr<VertexBuffer> pDebugLines = std::make_unique<VertexBuffer>(
+		*pDebugLineFormat, VertexBufferUsage::STREAM_PERSISTENT, DEBUG_LINES_MAX_VERTICES * sizeof(DebugLineVertex));
+	PipelineHandle debugLinesPipeline = loadDebugLinesPipeline(*pRegistry);
+	PipelineHandle meshletPipeline	  = loadMeshletPipeline(*pRegistry);
 
-	if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode)
-	{
-		printf("ASSIMP ERROR: %s\n", "error");
-		return -1;
-	}
+	// Every static mesh is sub-allocated from these and drawn with its base vertex and first index. Index ranges
+	// start on whole triangles so gl_VertexID % 3 still finds the corners when the indices are pulled
+	std::unique_ptr<BufferArena> pVertexArena = std::make_unique<BufferArena>(MESH_ARENA_BLOCK_SIZE);
+	std::unique_ptr<BufferArena> pIndexArena  = std::make_unique<BufferArena>(MESH_ARENA_BLOCK_SIZE);
 
-	const aiMesh* mesh = scene->mMeshes[0];
+	SceneTextures textures;
 
-	std::vector<VertexData> verticies;
-	for (u32 vIndex = 0u; vIndex < mesh->mNumVertices; ++vIndex)
-	{
-		aiVector3D position = mesh->mVertices[vIndex];
-		aiVector3D texCoord = mesh->mTextureCoords[0][vIndex];
+	// Packed from the mapped scene.bin straight into the mapped range by jobs while the images decode, the node
+	// transforms turn the model Y up
+	u64 verticesSize = sizeof(VertexData) * positions.count;
+	u32 duckVertices = pVertexArena->allocate(verticesSize, sizeof(VertexData));
+	u8* pVertices	 = (u8*)pVertexArena->map(duckVertices);
+	loadSceneAssets(jobSystem, positions, texCoords, pVertices, pRegistry.get(), &textures);
+	pVertexArena->unmap(duckVertices);
 
-		verticies.push_back({vec3(position.x, position.z, position.y), vec2(texCoord.x, texCoord.y)});
-	}
+	// The triangles are regrouped meshlet after meshlet and every draw uses the regrouped indices, the indexed ones
+	// included
+	u32				 indicesCount = u32(indexAccessor.count);
+	u64				 indicesSize  = sizeof(u32) * indexAccessor.count;
+	std::vector<u32> indices(indicesCount);
+	packIndices(indexAccessor, indices.data());
 
-	u32 verticiesSize = u32(sizeof(VertexData)) * static_cast<u32>(verticies.size());
+	std::chrono::steady_clock::time_point meshletsStart = std::chrono::steady_clock::now();
+	MeshletMesh							  duckMeshlets	= buildMeshlets(positions, indices.data(), indicesCount);
+	f64 meshletsMs = std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - meshletsStart).count();
 
-	std::vector<u32> indices;
-	for (u32 fIndex = 0u; fIndex < mesh->mNumFaces; ++fIndex)
+	u32 meshletsCount		 = u32(duckMeshlets.meshlets.size());
+	u32 meshletVerticesCount = 0;
+	for (const Meshlet& meshlet : duckMeshlets.meshlets)
 	{
-		aiFace face = mesh->mFaces[fIndex];
-		for (u32 iIndex = 0u; iIndex < face.mNumIndices; ++iIndex)
-		{
-			indices.push_back(face.mIndices[iIndex]);
-		}
+		meshletVerticesCount += meshlet.verticesCount;
 	}
-	u32 indicesSize = u32(sizeof(u32)) * static_cast<u32>(indices.size());
+	printf("Meshlets: %u of %.1f vertices and %.1f triangles on average, built in %.3f ms\n",
+		   meshletsCount,
+		   f64(meshletVerticesCount) / meshletsCount,
+		   f64(indicesCount / 3) / meshletsCount,
+		   meshletsMs);
 
-	u32 verticesBuffer;
-	GL_ASSERT(glGenBuffers(1, &verticesBuffer));
-	GL_ASSERT(glBindBuffer(GL_SHADER_STORAGE_BUFFER, verticesBuffer));
-	GL_ASSERT(glBufferData(GL_SHADER_STORAGE_BUFFER, verticiesSize, verticies.data(), GL_STATIC_DRAW));
+	u32 duckIndices = pIndexArena->allocate(indicesSize, 3 * sizeof(u32));
+	pIndexArena->upload(duckIndices, duckMeshlets.indices.data(), indicesSize);
+	std::unique_ptr<MeshletCullingPass> pMeshletCulling = std::make_unique<MeshletCullingPass>(duckMeshlets);
 
-	u32 indicesBuffer;
-	GL_ASSERT(glGenBuffers(1, &indicesBuffer));
-	GL_ASSERT(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indicesBuffer));
-	GL_ASSERT(glBufferData(GL_ELEMENT_ARRAY_BUFFER, indicesSize, indices.data(), GL_STATIC_DRAW));
+	BufferRange duckVerticesRange = pVertexArena->getRange(duckVertices);
+	BufferRange duckIndicesRange  = pIndexArena->getRange(duckIndices);
+	i32			duckBaseVertex	  = i32(duckVerticesRange.offset / sizeof(VertexData));
+	u32			duckFirstIndex	  = u32(duckIndicesRange.offset / sizeof(u32));
 
 	u32 vao;
 	GL_ASSERT(glGenVertexArrays(1, &vao));
 	GL_ASSERT(glBindVertexArray(vao));
-	// GL_ASSERT(glBindBuffer(GL_ARRAY_BUFFER, verticesBuffer));
-	GL_ASSERT(glVertexArrayElementBuffer(vao, indicesBuffer));
-
-	Texture duckTexture(STRINGIFY(SOURCE_DIR) "/assets/images/Duck_baseColor.png");
-
-	// buffer.update(vertices, sizeof(vertices));
+	GL_ASSERT(glVertexArrayElementBuffer(vao, duckIndicesRange.bufferId));
 
 	UniformBufferObject ubo{};
 
@@ -140,44 +1146,244 @@ int main()
 
 	const float ratio = float(WIDTH) / float(HEIGHT);
 
+	u32				   duckNode;
+	TransformHierarchy sceneHierarchy = createSceneHierarchy(duck, &duckNode);
+
+	std::unique_ptr<SkinnedCrowd> pCrowd;
+	if (skinningStressInstances > 0)
+	{
+		pCrowd = createSkinnedCrowd(jobSystem, *pIndexArena, skinnedModelPath, skinningStressInstances);
+	}
+
+	// The scene is drawn offscreen so that the crowd culling can reduce its depth and the render size can follow the
+	// load, the target and the pyramid follow the framebuffer size
+	std::unique_ptr<RenderTarget>	   pRenderTarget;
+	std::unique_ptr<DepthPyramid>	   pDepthPyramid;
+	std::unique_ptr<DynamicResolution> pDynamicResolution = std::make_unique<DynamicResolution>(targetFrameMs);
+
+	glm::mat4 projection = glm::perspective(45.0f, ratio, 0.1f, 1000.0f);
+
 	while (!glfwWindowShouldClose(window))
 	{
 		EASY_BLOCK("Main Loop");
+
+		if (benchmark)
+		{
+			// Walks through the supported modes, the plain one first
+			if (benchmarkFrames == BENCHMARK_FRAMES)
+			{
+				benchmarkMode++;
+				benchmarkFrames = 0;
+			}
+			while (benchmarkMode < SCENE_MODES_COUNT && !supportedModes[benchmarkMode])
+			{
+				benchmarkMode++;
+			}
+			if (benchmarkMode == SCENE_MODES_COUNT)
+			{
+				break;
+			}
+			benchmarkFrames++;
+
+			controls.wireframe = benchmarkMode != 0;
+			controls.source	   = benchmarkMode != 0 ? BarycentricSource(benchmarkMode - 1) : controls.source;
+			controls.occlusion = benchmarkFrames <= BENCHMARK_FRAMES / 2;
+
+			// The modes are compared at the same resolution
+			controls.dynamicResolution = false;
+		}
+
+		u32 mode = getSceneMode(controls);
+
+		// The frame matrices and the crowd poses are prepared by jobs while the main thread collects the timer query
+		// and clears, the joint matrices are mapped here since only the main thread talks to GL
+		f32 time = (float)glfwGetTime();
+		sceneHierarchy.setLocalTransform(sceneHierarchy.getNode(0),
+										 vec3(0.0f, -0.5f, -1.5f),
+										 glm::angleAxis(time, vec3(0.0f, 1.0f, 0.0f)),
+										 vec3(0.5f));
+		mat4*	   pJointMatrices = pCrowd != nullptr ? pCrowd->pPass->mapJointMatrices() : nullptr;
+		JobCounter framePrepared;
+		jobSystem.schedule(
+			"Prepare frame",
+			[&]() {
+				sceneHierarchy.update(&jobSystem);
+				ubo.mvp = projection * sceneHierarchy.getWorldMatrix(duckNode);
+
+				if (pCrowd != nullptr)
+				{
+					sampleSkinnedCrowd(jobSystem, *pCrowd, pJointMatrices, time);
+				}
+			},
+			&framePrepared);
+
+		// The query written TIMER_QUERIES_COUNT frames ago is done by now, reading it does not stall
+		u32 timerQuery = timerQueries[framesCount % TIMER_QUERIES_COUNT];
+		if (framesCount >= TIMER_QUERIES_COUNT)
+		{
+			GLuint64 elapsedNs = 0;
+			GL_ASSERT(glGetQueryObjectui64v(timerQuery, GL_QUERY_RESULT, &elapsedNs));
+
+			SceneModeTimings& timings = sceneTimings[timerQueryModes[framesCount % TIMER_QUERIES_COUNT]];
+			timings.gpuMsSum += f64(elapsedNs) / 1000000.0;
+			timings.framesCount++;
+		}
+
+		timerQueryModes[framesCount % TIMER_QUERIES_COUNT] = mode;
+
+		i32 framebufferWidth  = 0;
+		i32 framebufferHeight = 0;
+		glfwGetFramebufferSize(window, &framebufferWidth, &framebufferHeight);
+		u32 targetWidth	 = u32(std::max(1, framebufferWidth));
+		u32 targetHeight = u32(std::max(1, framebufferHeight));
+		if (pRenderTarget == nullptr || pRenderTarget->getWidth() != targetWidth ||
+			pRenderTarget->getHeight() != targetHeight)
+		{
+			pRenderTarget = std::make_unique<RenderTarget>(targetWidth, targetHeight);
+			pDepthPyramid = pCrowd != nullptr ? std::make_unique<DepthPyramid>(targetWidth, targetHeight) : nullptr;
+		}
+
+		// The scale follows the GPU time of the frames read back, the frame is timed from here to the blit
+		if (pDynamicResolution->isEnabled() != controls.dynamicResolution)
+		{
+			pDynamicResolution->setEnabled(controls.dynamicResolution);
+		}
+		pDynamicResolution->beginFrame();
+		pRenderTarget->setRenderSize(pDynamicResolution->getRenderSize(targetWidth),
+									 pDynamicResolution->getRenderSize(targetHeight));
+
+		pRenderTarget->bind();
 		glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
 		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-		const glm::mat4 m = glm::scale(glm::rotate(glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, -0.5f, -1.5f)),
-												   (float)glfwGetTime(),
-												   glm::vec3(0.0f, 1.0f, 0.0f)),
-									   glm::vec3(0.5f));
-		const glm::mat4 p = glm::perspective(45.0f, ratio, 0.1f, 1000.0f);
+		jobSystem.wait(framePrepared);
+		if (pCrowd != nullptr)
+		{
+			pCrowd->pPass->unmapJointMatrices();
+			skinSkinnedCrowd(*pCrowd, framesCount);
+		}
 
-		ubo.mvp = p * m;
 		GL_ASSERT(glBindBuffer(GL_UNIFORM_BUFFER, mvpDataBuffer));
 		GL_ASSERT(glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(UniformBufferObject), &ubo));
 
+		// Meshlets replace the draws that pull the indices or can, the other wireframe sources keep the indexed draw.
+		// The culling pass is timed with the scene and binds its own storage buffers, before the draw binds its
+		bool pulledIndices = mode != 0 && controls.source == BarycentricSource::VERTEX_ID;
+		bool drawMeshlets  = controls.meshlets && (mode == 0 || pulledIndices);
+		GL_ASSERT(glBeginQuery(GL_TIME_ELAPSED, timerQuery));
+		if (drawMeshlets)
+		{
+			// The camera sits at the origin, the world matrix is the model view
+			pMeshletCulling->dispatch(
+				sceneHierarchy.getWorldMatrix(duckNode), projection, duckFirstIndex, u32(duckBaseVertex));
+		}
+
 		GL_ASSERT(glBindVertexArray(vao));
-		// GL_ASSERT(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indicesBuffer));
 		GL_ASSERT(glBindBufferBase(GL_UNIFORM_BUFFER, 0, mvpDataBuffer));
-		GL_ASSERT(glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, verticesBuffer));
-		duckTexture.bind(0);
+		GL_ASSERT(glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, duckVerticesRange.bufferId));
+		GL_ASSERT(glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, duckIndicesRange.bufferId));
+		pRegistry->getTexture(textures.duck)->bind(0);
+
+		PipelineHandle	pipelineHandle = drawMeshlets && mode == 0 ? meshletPipeline : pipelines[mode];
+		const Pipeline& pipeline	   = *pRegistry->getPipeline(pipelineHandle);
 		pipeline.bind();
-		GL_ASSERT(glDrawElements(GL_TRIANGLES, indices.size(), GL_UNSIGNED_INT, 0));
+		if (drawMeshlets)
+		{
+			pMeshletCulling->draw();
+		}
+		else if (pulledIndices)
+		{
+			// Indices are pulled in simple.vert, gl_VertexID runs over every corner of every triangle and the base
+			// vertex travels as the base instance since non-indexed draws have none
+			GL_ASSERT(glDrawArraysInstancedBaseInstance(
+				GL_TRIANGLES, i32(duckFirstIndex), indicesCount, 1, u32(duckBaseVertex)));
+		}
+		else
+		{
+			GL_ASSERT(glDrawElementsBaseVertex(
+				GL_TRIANGLES, indicesCount, GL_UNSIGNED_INT, (const void*)duckIndicesRange.offset, duckBaseVertex));
+		}
 		pipeline.unbind();
+		GL_ASSERT(glEndQuery(GL_TIME_ELAPSED));
+
+		if (pCrowd != nullptr)
+		{
+			drawSkinnedCrowd(*pCrowd,
+							 *pRegistry->getPipeline(pipelines[0]),
+							 projection,
+							 *pRenderTarget,
+							 controls.occlusion ? pDepthPyramid.get() : nullptr,
+							 framesCount);
+		}
+
+		if (controls.debugLines)
+		{
+			u32 linesVerticesCount = writeDebugLines(
+				sceneHierarchy.getWorldMatrix(duckNode),
+				(DebugLineVertex*)pDebugLines->map(DEBUG_LINES_MAX_VERTICES * sizeof(DebugLineVertex)));
+			pDebugLines->unmap();
 
+			const Pipeline& linesPipeline = *pRegistry->getPipeline(debugLinesPipeline);
+			pDebugLines->bind();
+			linesPipeline.bind();
+			GL_ASSERT(glProgramUniformMatrix4fv(linesPipeline.getProgramId(), 0, 1, GL_FALSE, &projection[0][0]));
+			GL_ASSERT(glDrawArrays(GL_LINES, 0, linesVerticesCount));
+			linesPipeline.unbind();
+			pDebugLines->unbind();
+		}
+
+		pRenderTarget->unbind();
+		pRenderTarget->blitToWindow(u32(framebufferWidth), u32(framebufferHeight));
+		pDynamicResolution->endFrame();
 		glfwSwapBuffers(window);
 		glfwPollEvents();
+		if (framesCount == 0)
+		{
+			printf("First frame after %.3f ms\n",
+				   std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - start).count());
+		}
+		framesCount++;
 	}
 
-	GL_ASSERT(glDeleteBuffers(1, &verticesBuffer));
-	GL_ASSERT(glDeleteBuffers(1, &indicesBuffer));
+	printSceneModeTimings(sceneTimings, supportedModes);
+	if (pCrowd != nullptr)
+	{
+		destroySkinnedCrowd(pCrowd, *pIndexArena, 1 + jobSystem.getWorkersCount());
+	}
+	printFileStatistics();
+	printResourceStatistics(*pRegistry);
+	printDynamicResolutionStatistics(*pDynamicResolution);
+	printMeshletCullingStatistics(*pMeshletCulling);
+
+	printf("Mesh buffer arenas:\n");
+	printBufferArenaStatistics("vertices", *pVertexArena);
+	printBufferArenaStatistics("indices", *pIndexArena);
+	pVertexArena->free(duckVertices);
+	pIndexArena->free(duckIndices);
+	pVertexArena.reset();
+	pIndexArena.reset();
+	GL_ASSERT(glDeleteQueries(TIMER_QUERIES_COUNT, timerQueries));
+
 	GL_ASSERT(glDeleteVertexArrays(1, &vao));
 	GL_ASSERT(glDeleteBuffers(1, &mvpDataBuffer));
 
-	duckTexture.~Texture();
-	buffer.~VertexBuffer();
-	pipeline.~Pipeline();
-	texture.~Texture();
+	pDebugLines.reset();
+	pDebugLineFormat.reset();
+	pMeshletCulling.reset();
+	pDepthPyramid.reset();
+	pRenderTarget.reset();
+	pDynamicResolution.reset();
+	for (PipelineHandle pipeline : pipelines)
+	{
+		pRegistry->release(pipeline);
+	}
+	pRegistry->release(debugLinesPipeline);
+	pRegistry->release(meshletPipeline);
+	pRegistry->release(textures.duck);
+	pRegistry->release(textures.logo);
+	pRegistry.reset();
+
+	unmountAssetArchive();
 
 	glfwDestroyWindow(window);
 	glfwTerminate();
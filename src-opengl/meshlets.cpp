@@ -0,0 +1,265 @@
+#include "meshlets.h"
+#include <algorithm>
+#include <cmath>
+#include <easy/profiler.h>
+
+#define MESHLET_CULLING_GROUP_SIZE 64	// local_size_x of meshlet_culling.comp
+#define MESHLET_CONE_MIN_DOT	   0.1f // normals spread wider than about 84 degrees from the axis never cull
+#define NO_MESHLET				   (~0u)
+
+namespace ntt {
+
+// Read by meshlet_culling.comp as its Meshlet struct of floats and uints, std430 adds no padding there
+static_assert(sizeof(Meshlet) == 14 * sizeof(f32), "Meshlet does not match meshlet_culling.comp");
+
+// glDrawArraysIndirect layout, instanceCount is 0 for culled meshlets
+struct MeshletDrawCommand
+{
+	u32 count;
+	u32 instanceCount;
+	u32 first;
+	u32 baseInstance;
+};
+
+static Pipeline createMeshletCullingPipeline()
+{
+	Shader shader(STRINGIFY(SOURCE_DIR) "/assets/shaders/opengl/meshlet_culling.comp", COMPUTE_SHADER);
+	return Pipeline(&shader, 1);
+}
+
+// Sphere around the bounding box of the vertices, then the cone holding every triangle normal with its apex pushed
+// back until every triangle plane is in front of it
+static void computeMeshletBounds(const GltfAccessorView<vec3>& positions,
+								 const std::vector<u32>&	   vertices,
+								 const u32*					   pIndices,
+								 Meshlet*					   pMeshlet)
+{
+	vec3 lower = positions[vertices[0]];
+	vec3 upper = lower;
+	for (u32 vertex : vertices)
+	{
+		lower = glm::min(lower, positions[vertex]);
+		upper = glm::max(upper, positions[vertex]);
+	}
+
+	pMeshlet->center = (lower + upper) * 0.5f;
+	pMeshlet->radius = 0.0f;
+	for (u32 vertex : vertices)
+	{
+		pMeshlet->radius = std::max(pMeshlet->radius, glm::length(positions[vertex] - pMeshlet->center));
+	}
+
+	// Degenerate triangles are never seen, they do not widen the cone
+	vec3 normals[MESHLET_MAX_TRIANGLES];
+	vec3 corners[MESHLET_MAX_TRIANGLES];
+	vec3 axis		   = vec3(0.0f);
+	u32	 normalsCount = 0;
+	for (u32 triangle = 0u; triangle < pMeshlet->trianglesCount; ++triangle)
+	{
+		const u32* pTriangle = pIndices + 3 * triangle;
+		vec3	   corner	 = positions[pTriangle[0]];
+		vec3	   normal	 = glm::cross(positions[pTriangle[1]] - corner, positions[pTriangle[2]] - corner);
+		f32		   area		 = glm::length(normal);
+		if (area > 0.0f)
+		{
+			normals[normalsCount] = normal * (1.0f / area);
+			corners[normalsCount] = corner;
+			axis				  = axis + normals[normalsCount];
+			normalsCount++;
+		}
+	}
+
+	f32 axisLength = glm::length(axis);
+	f32 minDot	   = 1.0f;
+	axis		   = axisLength > 0.0f ? axis * (1.0f / axisLength) : vec3(0.0f);
+	for (u32 normal = 0u; normal < normalsCount; ++normal)
+	{
+		minDot = std::min(minDot, glm::dot(axis, normals[normal]));
+	}
+
+	pMeshlet->coneApex	 = pMeshlet->center;
+	pMeshlet->coneCutoff = 1.0f;
+	pMeshlet->coneAxis	 = vec3(0.0f);
+	if (normalsCount == 0 || axisLength == 0.0f || minDot <= MESHLET_CONE_MIN_DOT)
+	{
+		return;
+	}
+
+	// The apex at center - t * axis is behind the plane of a triangle once t >= dot(center - corner, n) / dot(axis, n)
+	f32 apexDistance = 0.0f;
+	for (u32 normal = 0u; normal < normalsCount; ++normal)
+	{
+		f32 distance = glm::dot(pMeshlet->center - corners[normal], normals[normal]) / glm::dot(axis, normals[normal]);
+		apexDistance = std::max(apexDistance, distance);
+	}
+
+	pMeshlet->coneApex	 = pMeshlet->center - axis * apexDistance;
+	pMeshlet->coneCutoff = std::sqrt(1.0f - minDot * minDot);
+	pMeshlet->coneAxis	 = axis;
+}
+
+MeshletMesh buildMeshlets(const GltfAccessor& positions, const u32* pIndices, u32 indicesCount)
+{
+	EASY_FUNCTION();
+	ASSERT(indicesCount % 3 == 0);
+
+	GltfAccessorView<vec3> positionsView(positions);
+	MeshletMesh			   mesh;
+	mesh.indices.reserve(indicesCount);
+
+	// Last meshlet every vertex went into, a vertex is in the meshlet being filled when it is its index
+	std::vector<u32> vertexMeshlets(positions.count, NO_MESHLET);
+	std::vector<u32> vertices;
+	Meshlet			 meshlet = {};
+	for (u32 index = 0u; index < indicesCount; index += 3)
+	{
+		u32 meshletIndex = u32(mesh.meshlets.size());
+		u32 a			 = pIndices[index];
+		u32 b			 = pIndices[index + 1];
+		u32 c			 = pIndices[index + 2];
+		u32 newVertices	 = (vertexMeshlets[a] != meshletIndex) + (vertexMeshlets[b] != meshletIndex && b != a) +
+						  (vertexMeshlets[c] != meshletIndex && c != a && c != b);
+		if (vertices.size() + newVertices > MESHLET_MAX_VERTICES || meshlet.trianglesCount == MESHLET_MAX_TRIANGLES)
+		{
+			meshlet.verticesCount = u32(vertices.size());
+			computeMeshletBounds(positionsView, vertices, mesh.indices.data() + meshlet.firstIndex, &meshlet);
+			mesh.meshlets.push_back(meshlet);
+
+			meshletIndex	   = u32(mesh.meshlets.size());
+			meshlet			   = {};
+			meshlet.firstIndex = u32(mesh.indices.size());
+			vertices.clear();
+		}
+
+		for (u32 vertex : {a, b, c})
+		{
+			if (vertexMeshlets[vertex] != meshletIndex)
+			{
+				vertexMeshlets[vertex] = meshletIndex;
+				vertices.push_back(vertex);
+			}
+			mesh.indices.push_back(vertex);
+		}
+		meshlet.trianglesCount++;
+	}
+
+	if (meshlet.trianglesCount > 0)
+	{
+		meshlet.verticesCount = u32(vertices.size());
+		computeMeshletBounds(positionsView, vertices, mesh.indices.data() + meshlet.firstIndex, &meshlet);
+		mesh.meshlets.push_back(meshlet);
+	}
+	return mesh;
+}
+
+MeshletCullingPass::MeshletCullingPass(const MeshletMesh& mesh)
+	: m_pipeline(createMeshletCullingPipeline())
+	, m_meshletsCount(u32(mesh.meshlets.size()))
+	, m_trianglesCount(u32(mesh.indices.size() / 3))
+	, m_dispatchesCount(0)
+	, m_statistics{}
+{
+	ASSERT(m_meshletsCount > 0);
+
+	GL_ASSERT(glCreateBuffers(1, &m_meshletsBuffer));
+	GL_ASSERT(glCreateBuffers(1, &m_commandsBuffer));
+	GL_ASSERT(glCreateBuffers(MESHLET_CULLING_FRAMES, m_countersBuffers));
+	GL_ASSERT(glNamedBufferStorage(m_meshletsBuffer, sizeof(Meshlet) * m_meshletsCount, mesh.meshlets.data(), 0));
+	GL_ASSERT(glNamedBufferStorage(m_commandsBuffer, sizeof(MeshletDrawCommand) * m_meshletsCount, nullptr, 0));
+	for (u32 counters : m_countersBuffers)
+	{
+		GL_ASSERT(glNamedBufferStorage(counters, 2 * sizeof(u32), nullptr, GL_DYNAMIC_STORAGE_BIT));
+	}
+
+	GL_ASSERT(glProgramUniform1ui(m_pipeline.getProgramId(), 9, m_meshletsCount));
+}
+
+MeshletCullingPass::MeshletCullingPass(MeshletCullingPass&& other) noexcept
+	: m_pipeline(std::move(other.m_pipeline))
+	, m_meshletsBuffer(other.m_meshletsBuffer)
+	, m_commandsBuffer(other.m_commandsBuffer)
+	, m_meshletsCount(other.m_meshletsCount)
+	, m_trianglesCount(other.m_trianglesCount)
+	, m_dispatchesCount(other.m_dispatchesCount)
+	, m_statistics(other.m_statistics)
+{
+	std::copy(other.m_countersBuffers, other.m_countersBuffers + MESHLET_CULLING_FRAMES, m_countersBuffers);
+	other.m_meshletsBuffer = 0;
+	other.m_commandsBuffer = 0;
+}
+
+MeshletCullingPass::~MeshletCullingPass()
+{
+	if (m_meshletsBuffer != 0)
+	{
+		u32 buffers[2] = {m_meshletsBuffer, m_commandsBuffer};
+		GL_ASSERT(glDeleteBuffers(2, buffers));
+		GL_ASSERT(glDeleteBuffers(MESHLET_CULLING_FRAMES, m_countersBuffers));
+		m_meshletsBuffer = 0;
+	}
+}
+
+void MeshletCullingPass::dispatch(const mat4& modelView, const mat4& projection, u32 firstIndex, u32 baseVertex)
+{
+	EASY_FUNCTION();
+
+	// The counters written MESHLET_CULLING_FRAMES dispatches ago are done by now, reading them does not stall
+	u32 counters = m_countersBuffers[m_dispatchesCount % MESHLET_CULLING_FRAMES];
+	if (m_dispatchesCount >= MESHLET_CULLING_FRAMES)
+	{
+		u32 culledCounts[2] = {};
+		GL_ASSERT(glGetNamedBufferSubData(counters, 0, sizeof(culledCounts), culledCounts));
+		m_statistics.frustumCulledTrianglesCount += culledCounts[0];
+		m_statistics.coneCulledTrianglesCount += culledCounts[1];
+		m_statistics.framesCount++;
+	}
+	GL_ASSERT(glClearNamedBufferData(counters, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr));
+	m_dispatchesCount++;
+
+	// Clip space planes brought back to view space (Gribb and Hartmann), normalized so that the sphere test can
+	// compare distances with radii
+	vec4 frustumPlanes[6];
+	for (u32 plane = 0u; plane < 6u; ++plane)
+	{
+		u32 axis = plane / 2;
+		f32 sign = plane % 2 == 0 ? 1.0f : -1.0f;
+		for (u32 column = 0u; column < 4u; ++column)
+		{
+			frustumPlanes[plane][column] = projection[column][3] + sign * projection[column][axis];
+		}
+		frustumPlanes[plane] = frustumPlanes[plane] * (1.0f / glm::length(vec3(frustumPlanes[plane])));
+	}
+
+	// The cone test is done in mesh space, which keeps its angles as long as the model view scales uniformly
+	vec3 cameraPosition = vec3(glm::inverse(modelView)[3]);
+	f32	 scale			= std::max(glm::length(vec3(modelView[0])),
+								   std::max(glm::length(vec3(modelView[1])), glm::length(vec3(modelView[2]))));
+
+	u32 programId = m_pipeline.getProgramId();
+	GL_ASSERT(glProgramUniformMatrix4fv(programId, 0, 1, GL_FALSE, &modelView[0][0]));
+	GL_ASSERT(glProgramUniform4fv(programId, 1, 6, &frustumPlanes[0][0]));
+	GL_ASSERT(glProgramUniform3fv(programId, 7, 1, &cameraPosition[0]));
+	GL_ASSERT(glProgramUniform1f(programId, 8, scale));
+	GL_ASSERT(glProgramUniform1ui(programId, 10, firstIndex));
+	GL_ASSERT(glProgramUniform1ui(programId, 11, baseVertex));
+
+	GL_ASSERT(glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, m_meshletsBuffer));
+	GL_ASSERT(glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, m_commandsBuffer));
+	GL_ASSERT(glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, counters));
+
+	m_pipeline.bind();
+	GL_ASSERT(glDispatchCompute((m_meshletsCount + MESHLET_CULLING_GROUP_SIZE - 1) / MESHLET_CULLING_GROUP_SIZE, 1, 1));
+	m_pipeline.unbind();
+
+	// The commands are read by the draw and the counters by glGetNamedBufferSubData
+	GL_ASSERT(glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_BUFFER_UPDATE_BARRIER_BIT));
+}
+
+void MeshletCullingPass::draw() const
+{
+	GL_ASSERT(glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_commandsBuffer));
+	GL_ASSERT(glMultiDrawArraysIndirect(GL_TRIANGLES, nullptr, i32(m_meshletsCount), 0));
+	GL_ASSERT(glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0));
+}
+
+} // namespace ntt
\ No newline at end of file
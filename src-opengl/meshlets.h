@@ -0,0 +1,113 @@
+#pragma once
+#include "common.h"
+#include "gltf_model.h"
+#include "pipeline.h"
+#include <vector>
+
+namespace ntt {
+
+/**
+ * Meshes split into meshlets, clusters of up to MESHLET_MAX_VERTICES vertices and MESHLET_MAX_TRIANGLES triangles
+ * bounded by a sphere and a normal cone. `buildMeshlets` regroups the triangles of a mesh meshlet after meshlet, so
+ * the indices it returns replace the original ones for every draw. Every frame a `MeshletCullingPass` culls the
+ * meshlets outside the frustum and the ones whose triangles all face away from the camera with
+ * meshlet_culling.comp, which writes one non-indexed draw per meshlet for simple.vert to pull the indices of, with no
+ * instance when culled.
+ *
+ * @example
+ * ```c++
+ * MeshletMesh		  mesh = buildMeshlets(positions, pIndices, indicesCount);
+ * MeshletCullingPass culling(mesh);
+ * uploadIndices(mesh.indices);
+ *
+ * culling.dispatch(modelView, projection, firstIndex, baseVertex);
+ * glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, verticesBuffer);
+ * glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, indicesBuffer);
+ * pulledIndicesPipeline.bind();
+ * culling.draw();
+ * ```
+ */
+
+#define MESHLET_MAX_VERTICES  64
+#define MESHLET_MAX_TRIANGLES 124
+
+// Dispatches between the culling of a frame and the read back of its culled triangles
+#define MESHLET_CULLING_FRAMES 3
+
+// As meshlet_culling.comp reads it, in mesh space
+struct Meshlet
+{
+	vec3 center;
+	f32	 radius;
+	vec3 coneApex;
+	f32	 coneCutoff; // sine of the cone half angle, 1 when the normals are too spread out to ever cull
+	vec3 coneAxis;	 // a camera inside the cone behind the apex, looking along the axis, sees only back faces
+	u32	 firstIndex; // into the meshlet indices
+	u32	 trianglesCount;
+	u32	 verticesCount;
+};
+
+struct MeshletMesh
+{
+	std::vector<Meshlet> meshlets;
+	std::vector<u32>	 indices; // the triangles of the mesh regrouped meshlet after meshlet
+};
+
+// Float VEC3 positions, meshlets are filled in the order of the triangles so the vertex cache order is kept
+MeshletMesh buildMeshlets(const GltfAccessor& positions, const u32* pIndices, u32 indicesCount);
+
+// Summed over the frames read back
+struct MeshletCullingStatistics
+{
+	u32 framesCount;
+	u64 frustumCulledTrianglesCount;
+	u64 coneCulledTrianglesCount;
+};
+
+/**
+ * GPU side of the meshlets: their bounds, one draw command per meshlet and the culled triangle counters, read back
+ * MESHLET_CULLING_FRAMES dispatches later so that the statistics never stall.
+ */
+class MeshletCullingPass
+{
+public:
+	MeshletCullingPass(const MeshletMesh& mesh);
+	MeshletCullingPass(const MeshletCullingPass&) = delete;
+	MeshletCullingPass(MeshletCullingPass&& other) noexcept;
+	~MeshletCullingPass();
+
+public:
+	inline u32 getMeshletsCount() const
+	{
+		return m_meshletsCount;
+	}
+
+	inline u32 getTrianglesCount() const
+	{
+		return m_trianglesCount;
+	}
+
+	inline const MeshletCullingStatistics& getStatistics() const
+	{
+		return m_statistics;
+	}
+
+	// The camera sits at the origin of the view space. firstIndex and baseVertex locate the meshlet indices and the
+	// vertices in the buffers the draw pulls from
+	void dispatch(const mat4& modelView, const mat4& projection, u32 firstIndex, u32 baseVertex);
+
+	// Draws the meshlets that survived the last dispatch, with the pipeline and the buffers of simple.vert bound
+	void draw() const;
+
+private:
+	Pipeline				 m_pipeline;
+	u32						 m_meshletsBuffer;
+	u32						 m_commandsBuffer;
+	u32						 m_countersBuffers[MESHLET_CULLING_FRAMES];
+	u32						 m_meshletsCount;
+	u32						 m_trianglesCount;
+	u64						 m_dispatchesCount;
+	MeshletCullingStatistics m_statistics;
+};
+
+} // namespace ntt
\ No newline at end of file
@@ -0,0 +1,274 @@
+#include "occlusion_culling.h"
+#include <algorithm>
+#include <easy/profiler.h>
+
+#define DEPTH_PYRAMID_GROUP_SIZE	 8	// local_size_x and local_size_y of depth_pyramid.comp
+#define OCCLUSION_CULLING_GROUP_SIZE 64 // local_size_x of occlusion_culling.comp
+#define DEPTH_TEXTURE_UNIT			 1	// the draws keep their texture on unit 0
+
+namespace ntt {
+
+// glDrawElementsIndirect layout, instanceCount is 0 for culled instances
+struct OcclusionDrawCommand
+{
+	u32 count;
+	u32 instanceCount;
+	u32 firstIndex;
+	i32 baseVertex;
+	u32 baseInstance;
+};
+
+// Read back as occlusion_culling.comp lays its Counters out
+struct OcclusionCounters
+{
+	u32 frustumCulledCount;
+	u32 earlyDrawnCount;
+	u32 lateDrawnCount;
+	u32 occludedCount;
+};
+
+static Pipeline createDepthPyramidPipeline(const std::vector<std::string>& defines)
+{
+	Shader shader(STRINGIFY(SOURCE_DIR) "/assets/shaders/opengl/depth_pyramid.comp", COMPUTE_SHADER, defines);
+	return Pipeline(&shader, 1);
+}
+
+static Pipeline createOcclusionCullingPipeline(const std::vector<std::string>& defines)
+{
+	Shader shader(STRINGIFY(SOURCE_DIR) "/assets/shaders/opengl/occlusion_culling.comp", COMPUTE_SHADER, defines);
+	return Pipeline(&shader, 1);
+}
+
+static u32 getNextPowerOfTwo(u32 value)
+{
+	u32 power = 1;
+	while (power < value)
+	{
+		power *= 2;
+	}
+	return power;
+}
+
+static u32 getPyramidLevelsCount(u32 width, u32 height)
+{
+	u32 levelsCount = 0;
+	do
+	{
+		width  = (width + 1) / 2;
+		height = (height + 1) / 2;
+		levelsCount++;
+	} while (width > 1 || height > 1);
+	return levelsCount;
+}
+
+static void dispatchPyramidLevel(const Pipeline& pipeline, u32 sourceWidth, u32 sourceHeight)
+{
+	u32 width  = (sourceWidth + 1) / 2;
+	u32 height = (sourceHeight + 1) / 2;
+	GL_ASSERT(glProgramUniform2i(pipeline.getProgramId(), 0, i32(sourceWidth), i32(sourceHeight)));
+	pipeline.bind();
+	GL_ASSERT(glDispatchCompute((width + DEPTH_PYRAMID_GROUP_SIZE - 1) / DEPTH_PYRAMID_GROUP_SIZE,
+								(height + DEPTH_PYRAMID_GROUP_SIZE - 1) / DEPTH_PYRAMID_GROUP_SIZE,
+								1));
+	pipeline.unbind();
+}
+
+DepthPyramid::DepthPyramid(u32 maxWidth, u32 maxHeight)
+	: m_fromDepthPipeline(createDepthPyramidPipeline({"FROM_DEPTH"}))
+	, m_reducePipeline(createDepthPyramidPipeline({}))
+	, m_maxWidth(maxWidth)
+	, m_maxHeight(maxHeight)
+	, m_levelsCount(0)
+	, m_depthWidth(0)
+	, m_depthHeight(0)
+	, m_viewProjection(1.0f)
+{
+	// Level sizes are powers of two so that every level holds the rounded up half of the one below, odd sizes
+	// included, the texels past the region a build covers are never read
+	u32 width			   = getNextPowerOfTwo((maxWidth + 1) / 2);
+	u32 height			   = getNextPowerOfTwo((maxHeight + 1) / 2);
+	u32 storageLevelsCount = getPyramidLevelsCount(2 * width, 2 * height);
+	GL_ASSERT(glCreateTextures(GL_TEXTURE_2D, 1, &m_textureId));
+	GL_ASSERT(glTextureStorage2D(m_textureId, i32(storageLevelsCount), GL_R32F, i32(width), i32(height)));
+
+	// Read with texelFetch, the mipmap filter only keeps every level in the texture
+	GL_ASSERT(glTextureParameteri(m_textureId, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST));
+	GL_ASSERT(glTextureParameteri(m_textureId, GL_TEXTURE_MAG_FILTER, GL_NEAREST));
+}
+
+DepthPyramid::DepthPyramid(DepthPyramid&& other) noexcept
+	: m_fromDepthPipeline(std::move(other.m_fromDepthPipeline))
+	, m_reducePipeline(std::move(other.m_reducePipeline))
+	, m_textureId(other.m_textureId)
+	, m_maxWidth(other.m_maxWidth)
+	, m_maxHeight(other.m_maxHeight)
+	, m_levelsCount(other.m_levelsCount)
+	, m_depthWidth(other.m_depthWidth)
+	, m_depthHeight(other.m_depthHeight)
+	, m_viewProjection(other.m_viewProjection)
+{
+	other.m_textureId = 0;
+}
+
+DepthPyramid::~DepthPyramid()
+{
+	if (m_textureId != 0)
+	{
+		GL_ASSERT(glDeleteTextures(1, &m_textureId));
+		m_textureId = 0;
+	}
+}
+
+void DepthPyramid::build(u32 depthTextureId, u32 width, u32 height, const mat4& viewProjection)
+{
+	EASY_FUNCTION();
+	ASSERT(width > 0 && width <= m_maxWidth && height > 0 && height <= m_maxHeight);
+
+	m_levelsCount	 = getPyramidLevelsCount(width, height);
+	m_depthWidth	 = width;
+	m_depthHeight	 = height;
+	m_viewProjection = viewProjection;
+
+	// The depth written by the draws is visible to the texture fetches after them without a barrier
+	GL_ASSERT(glBindTextureUnit(DEPTH_TEXTURE_UNIT, depthTextureId));
+	GL_ASSERT(glBindImageTexture(1, m_textureId, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F));
+	dispatchPyramidLevel(m_fromDepthPipeline, width, height);
+
+	for (u32 level = 1u; level < m_levelsCount; ++level)
+	{
+		width  = (width + 1) / 2;
+		height = (height + 1) / 2;
+		GL_ASSERT(glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT));
+		GL_ASSERT(glBindImageTexture(0, m_textureId, i32(level - 1), GL_FALSE, 0, GL_READ_ONLY, GL_R32F));
+		GL_ASSERT(glBindImageTexture(1, m_textureId, i32(level), GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F));
+		dispatchPyramidLevel(m_reducePipeline, width, height);
+	}
+
+	// The culling samples the pyramid
+	GL_ASSERT(glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT));
+}
+
+OcclusionCullingPass::OcclusionCullingPass(u32 instancesCount, u32 indicesCount, u32 firstIndex, u32 verticesCount)
+	: m_earlyPipeline(createOcclusionCullingPipeline({}))
+	, m_latePipeline(createOcclusionCullingPipeline({"LATE"}))
+	, m_occlusionTested{}
+	, m_instancesCount(instancesCount)
+	, m_framesCount(0)
+	, m_statistics{}
+{
+	ASSERT(instancesCount > 0);
+
+	u64 commandsSize = sizeof(OcclusionDrawCommand) * instancesCount;
+	GL_ASSERT(glCreateBuffers(1, &m_earlyDrawnBuffer));
+	GL_ASSERT(glCreateBuffers(2, m_commandsBuffers));
+	GL_ASSERT(glCreateBuffers(OCCLUSION_CULLING_FRAMES, m_countersBuffers));
+	GL_ASSERT(glNamedBufferStorage(m_earlyDrawnBuffer, sizeof(u32) * instancesCount, nullptr, 0));
+	for (u32 commands : m_commandsBuffers)
+	{
+		GL_ASSERT(glNamedBufferStorage(commands, commandsSize, nullptr, 0));
+	}
+	for (u32 counters : m_countersBuffers)
+	{
+		GL_ASSERT(glNamedBufferStorage(counters, sizeof(OcclusionCounters), nullptr, GL_DYNAMIC_STORAGE_BIT));
+	}
+
+	for (const Pipeline* pPipeline : {&m_earlyPipeline, &m_latePipeline})
+	{
+		GL_ASSERT(glProgramUniform1ui(pPipeline->getProgramId(), 4, instancesCount));
+		GL_ASSERT(glProgramUniform1ui(pPipeline->getProgramId(), 5, indicesCount));
+		GL_ASSERT(glProgramUniform1ui(pPipeline->getProgramId(), 6, firstIndex));
+		GL_ASSERT(glProgramUniform1ui(pPipeline->getProgramId(), 7, verticesCount));
+	}
+}
+
+OcclusionCullingPass::OcclusionCullingPass(OcclusionCullingPass&& other) noexcept
+	: m_earlyPipeline(std::move(other.m_earlyPipeline))
+	, m_latePipeline(std::move(other.m_latePipeline))
+	, m_earlyDrawnBuffer(other.m_earlyDrawnBuffer)
+	, m_instancesCount(other.m_instancesCount)
+	, m_framesCount(other.m_framesCount)
+	, m_statistics(other.m_statistics)
+{
+	std::copy(other.m_commandsBuffers, other.m_commandsBuffers + 2, m_commandsBuffers);
+	std::copy(other.m_countersBuffers, other.m_countersBuffers + OCCLUSION_CULLING_FRAMES, m_countersBuffers);
+	std::copy(other.m_occlusionTested, other.m_occlusionTested + OCCLUSION_CULLING_FRAMES, m_occlusionTested);
+	other.m_earlyDrawnBuffer = 0;
+}
+
+OcclusionCullingPass::~OcclusionCullingPass()
+{
+	if (m_earlyDrawnBuffer != 0)
+	{
+		GL_ASSERT(glDeleteBuffers(1, &m_earlyDrawnBuffer));
+		GL_ASSERT(glDeleteBuffers(2, m_commandsBuffers));
+		GL_ASSERT(glDeleteBuffers(OCCLUSION_CULLING_FRAMES, m_countersBuffers));
+		m_earlyDrawnBuffer = 0;
+	}
+}
+
+void OcclusionCullingPass::dispatch(OcclusionCullingPhase phase,
+									u32					  boundsBuffer,
+									const mat4&			  viewProjection,
+									const DepthPyramid*	  pPyramid)
+{
+	EASY_FUNCTION();
+
+	// Both phases of a frame count into the same counters. The ones written OCCLUSION_CULLING_FRAMES frames ago are
+	// done by now, reading them does not stall
+	if (phase == OcclusionCullingPhase::EARLY)
+	{
+		u32 counters = m_countersBuffers[m_framesCount % OCCLUSION_CULLING_FRAMES];
+		if (m_framesCount >= OCCLUSION_CULLING_FRAMES && m_occlusionTested[m_framesCount % OCCLUSION_CULLING_FRAMES])
+		{
+			OcclusionCounters counts = {};
+			GL_ASSERT(glGetNamedBufferSubData(counters, 0, sizeof(counts), &counts));
+			m_statistics.frustumCulledCount += counts.frustumCulledCount;
+			m_statistics.earlyDrawnCount += counts.earlyDrawnCount;
+			m_statistics.lateDrawnCount += counts.lateDrawnCount;
+			m_statistics.occludedCount += counts.occludedCount;
+			m_statistics.framesCount++;
+		}
+		GL_ASSERT(glClearNamedBufferData(counters, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr));
+		m_occlusionTested[m_framesCount % OCCLUSION_CULLING_FRAMES] = false;
+		m_framesCount++;
+	}
+	ASSERT(m_framesCount > 0 && "The late phase follows the early one");
+
+	u32				frame		= u32((m_framesCount - 1) % OCCLUSION_CULLING_FRAMES);
+	const Pipeline& pipeline	= phase == OcclusionCullingPhase::EARLY ? m_earlyPipeline : m_latePipeline;
+	u32				programId	= pipeline.getProgramId();
+	i32				levelsCount = pPyramid != nullptr ? i32(pPyramid->getLevelsCount()) : 0;
+	m_occlusionTested[frame] |= levelsCount > 0;
+	GL_ASSERT(glProgramUniformMatrix4fv(programId, 0, 1, GL_FALSE, &viewProjection[0][0]));
+	GL_ASSERT(glProgramUniform1i(programId, 3, levelsCount));
+	if (levelsCount > 0)
+	{
+		GL_ASSERT(glProgramUniformMatrix4fv(programId, 1, 1, GL_FALSE, &pPyramid->getViewProjection()[0][0]));
+		GL_ASSERT(glProgramUniform2i(
+			programId, 2, i32(pPyramid->getDepthWidth()), i32(pPyramid->getDepthHeight())));
+		GL_ASSERT(glBindTextureUnit(DEPTH_TEXTURE_UNIT, pPyramid->getTextureId()));
+	}
+
+	GL_ASSERT(glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, boundsBuffer));
+	GL_ASSERT(glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, m_earlyDrawnBuffer));
+	GL_ASSERT(glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, m_commandsBuffers[u32(phase)]));
+	GL_ASSERT(glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, m_countersBuffers[frame]));
+
+	pipeline.bind();
+	GL_ASSERT(glDispatchCompute(
+		(m_instancesCount + OCCLUSION_CULLING_GROUP_SIZE - 1) / OCCLUSION_CULLING_GROUP_SIZE, 1, 1));
+	pipeline.unbind();
+
+	// The commands are read by the draw, the early drawn flags by the late phase and the counters by
+	// glGetNamedBufferSubData
+	GL_ASSERT(glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT | GL_BUFFER_UPDATE_BARRIER_BIT));
+}
+
+void OcclusionCullingPass::draw(OcclusionCullingPhase phase) const
+{
+	GL_ASSERT(glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_commandsBuffers[u32(phase)]));
+	GL_ASSERT(glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, nullptr, i32(m_instancesCount), 0));
+	GL_ASSERT(glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0));
+}
+
+} // namespace ntt
\ No newline at end of file
@@ -0,0 +1,148 @@
+#pragma once
+#include "common.h"
+#include "pipeline.h"
+
+namespace ntt {
+
+/**
+ * Hierarchical-Z occlusion culling in two passes. A `DepthPyramid` reduces a depth texture with depth_pyramid.comp
+ * into mips that keep the farthest depth of the texels under them. The early `OcclusionCullingPass` dispatch tests
+ * every instance box against the pyramid of the previous frame, reprojected with the view projection that frame was
+ * drawn with, and draws what passes. The pyramid is then rebuilt from the depth of the early draws and the late
+ * dispatch draws the instances it now finds visible, so nothing that comes into view pops in a frame late. Once the
+ * late draws are done the pyramid is built again, the early dispatch of the next frame tests against all of them.
+ *
+ * @example
+ * ```c++
+ * DepthPyramid			pyramid(width, height);
+ * OcclusionCullingPass culling(instancesCount, indicesCount, firstIndex, verticesCount);
+ *
+ * target.bind();
+ * culling.dispatch(OcclusionCullingPhase::EARLY, boundsBuffer, viewProjection, &pyramid);
+ * culling.draw(OcclusionCullingPhase::EARLY);
+ * pyramid.build(target.getDepthTextureId(), width, height, viewProjection);
+ * culling.dispatch(OcclusionCullingPhase::LATE, boundsBuffer, viewProjection, &pyramid);
+ * culling.draw(OcclusionCullingPhase::LATE);
+ * pyramid.build(target.getDepthTextureId(), width, height, viewProjection); // for the next frame
+ * ```
+ */
+
+// Dispatches between the culling of a frame and the read back of its counters
+#define OCCLUSION_CULLING_FRAMES 3
+
+enum class OcclusionCullingPhase
+{
+	EARLY, // against the pyramid of the previous frame, built after its late draws
+	LATE,  // what the early phase did not draw, against the pyramid of the early draws
+};
+
+// Instances summed over the frames read back that were tested against a pyramid
+struct OcclusionCullingStatistics
+{
+	u32 framesCount;
+	u64 frustumCulledCount;
+	u64 earlyDrawnCount;
+	u64 lateDrawnCount;
+	u64 occludedCount;
+};
+
+class DepthPyramid
+{
+public:
+	// Big enough for any depth up to maxWidth x maxHeight
+	DepthPyramid(u32 maxWidth, u32 maxHeight);
+	DepthPyramid(const DepthPyramid&) = delete;
+	DepthPyramid(DepthPyramid&& other) noexcept;
+	~DepthPyramid();
+
+public:
+	// GL_R32F, level l holds the farthest depth of 2^(l + 1) x 2^(l + 1) pixels
+	inline u32 getTextureId() const
+	{
+		return m_textureId;
+	}
+
+	// 0 until the first build
+	inline u32 getLevelsCount() const
+	{
+		return m_levelsCount;
+	}
+
+	inline u32 getDepthWidth() const
+	{
+		return m_depthWidth;
+	}
+
+	inline u32 getDepthHeight() const
+	{
+		return m_depthHeight;
+	}
+
+	// The one the depth of the last build was drawn with
+	inline const mat4& getViewProjection() const
+	{
+		return m_viewProjection;
+	}
+
+	// Reduces the [0, width) x [0, height) corner of a depth texture, the result is visible to the dispatches after
+	void build(u32 depthTextureId, u32 width, u32 height, const mat4& viewProjection);
+
+private:
+	Pipeline m_fromDepthPipeline;
+	Pipeline m_reducePipeline;
+	u32		 m_textureId;
+	u32		 m_maxWidth;
+	u32		 m_maxHeight;
+	u32		 m_levelsCount;
+	u32		 m_depthWidth;
+	u32		 m_depthHeight;
+	mat4	 m_viewProjection;
+};
+
+/**
+ * Indexed draws of the instances of one mesh whose posed vertices follow each other, with one draw command per
+ * instance and phase written by occlusion_culling.comp, no instance when culled. The counters are read back
+ * OCCLUSION_CULLING_FRAMES frames later so that the statistics never stall.
+ */
+class OcclusionCullingPass
+{
+public:
+	OcclusionCullingPass(u32 instancesCount, u32 indicesCount, u32 firstIndex, u32 verticesCount);
+	OcclusionCullingPass(const OcclusionCullingPass&) = delete;
+	OcclusionCullingPass(OcclusionCullingPass&& other) noexcept;
+	~OcclusionCullingPass();
+
+public:
+	inline u32 getInstancesCount() const
+	{
+		return m_instancesCount;
+	}
+
+	inline const OcclusionCullingStatistics& getStatistics() const
+	{
+		return m_statistics;
+	}
+
+	// Boxes as SkinningPass::getPosedBoundsBuffer lays them out. Without a pyramid, or before its first build, only
+	// the frustum culls
+	void dispatch(OcclusionCullingPhase phase,
+				  u32					boundsBuffer,
+				  const mat4&			viewProjection,
+				  const DepthPyramid*	pPyramid);
+
+	// Draws the instances the dispatch of the phase kept, with the pipeline, the index buffer and the vertices bound
+	void draw(OcclusionCullingPhase phase) const;
+
+private:
+	Pipeline				   m_earlyPipeline;
+	Pipeline				   m_latePipeline;
+	u32						   m_earlyDrawnBuffer;
+	u32						   m_commandsBuffers[2]; // by phase
+	u32						   m_countersBuffers[OCCLUSION_CULLING_FRAMES];
+	bool					   m_occlusionTested[OCCLUSION_CULLING_FRAMES]; // frustum only frames are not counted
+	u32						   m_instancesCount;
+	u64						   m_framesCount;
+	OcclusionCullingStatistics m_statistics;
+};
+
+} // namespace ntt
\ No newline at end of file
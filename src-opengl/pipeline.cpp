@@ -1,27 +1,17 @@
 #include "pipeline.h"
+#include <vector>
 
 namespace ntt {
 
 Pipeline::Pipeline(Shader* shaders, u32 shaderCount)
+	: m_stagesMask(0)
 {
-	m_programId = glCreateProgram();
-
+	std::vector<const Shader*> pShaders(shaderCount);
 	for (u32 i = 0; i < shaderCount; ++i)
 	{
-		GL_ASSERT(glAttachShader(m_programId, shaders[i].getId()));
-	}
-
-	GL_ASSERT(glLinkProgram(m_programId));
-
-	bool success;
-	GL_ASSERT(glGetProgramiv(m_programId, GL_LINK_STATUS, (int*)&success));
-	if (!success)
-	{
-		char infoLog[512];
-		GL_ASSERT(glGetProgramInfoLog(m_programId, 512, nullptr, infoLog));
-		fprintf(stderr, "ERROR::PROGRAM::LINKING_FAILED\n%s", infoLog);
-		ASSERT(false);
+		pShaders[i] = &shaders[i];
 	}
+	link(pShaders.data(), shaderCount);
 
 	for (u32 i = 0; i < shaderCount; ++i)
 	{
@@ -29,8 +19,15 @@ Pipeline::Pipeline(Shader* shaders, u32 shaderCount)
 	}
 }
 
+Pipeline::Pipeline(const Shader* const* ppShaders, u32 shaderCount)
+	: m_stagesMask(0)
+{
+	link(ppShaders, shaderCount);
+}
+
 Pipeline::Pipeline(Pipeline&& other) noexcept
 	: m_programId(other.m_programId)
+	, m_stagesMask(other.m_stagesMask)
 {
 	other.m_programId = 0; // Invalidate the moved-from object
 }
@@ -44,4 +41,34 @@ Pipeline::~Pipeline()
 	}
 }
 
+void Pipeline::link(const Shader* const* ppShaders, u32 shaderCount)
+{
+	m_programId = glCreateProgram();
+
+	for (u32 i = 0; i < shaderCount; ++i)
+	{
+		GL_ASSERT(glAttachShader(m_programId, ppShaders[i]->getId()));
+		m_stagesMask |= 1u << ppShaders[i]->getType();
+	}
+	ASSERT(hasStage(COMPUTE_SHADER) ? shaderCount == 1 : hasStage(VERTEX_SHADER) && hasStage(FRAGMENT_SHADER));
+
+	GL_ASSERT(glLinkProgram(m_programId));
+
+	bool success;
+	GL_ASSERT(glGetProgramiv(m_programId, GL_LINK_STATUS, (int*)&success));
+	if (!success)
+	{
+		char infoLog[512];
+		GL_ASSERT(glGetProgramInfoLog(m_programId, 512, nullptr, infoLog));
+		fprintf(stderr, "ERROR::PROGRAM::LINKING_FAILED\n%s", infoLog);
+		ASSERT(false);
+	}
+
+	// Detached so the shaders are deleted as soon as their owners release them
+	for (u32 i = 0; i < shaderCount; ++i)
+	{
+		GL_ASSERT(glDetachShader(m_programId, ppShaders[i]->getId()));
+	}
+}
+
 } // namespace ntt
\ No newline at end of file
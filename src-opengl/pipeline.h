@@ -5,10 +5,27 @@
 
 namespace ntt {
 
+/**
+ * Linked program over any set of stages, only vertex and fragment are required, or over a single compute shader. The
+ * shaders are released once linked, unless they are passed by pointer to be shared with other pipelines.
+ *
+ * @example
+ * ```c++
+ * Shader shaders[2] = {Shader(vertexPath, VERTEX_SHADER), Shader(fragmentPath, FRAGMENT_SHADER)};
+ * Pipeline pipeline(shaders, 2);
+ * pipeline.bind();
+ *
+ * Shader compute(computePath, COMPUTE_SHADER);
+ * Pipeline computePipeline(&compute, 1);
+ * ```
+ */
+
 class Pipeline
 {
 public:
 	Pipeline(Shader* shaders, u32 shaderCount);
+	// Leaves the shaders alive, for shaders shared between pipelines
+	Pipeline(const Shader* const* ppShaders, u32 shaderCount);
 	Pipeline(const Pipeline& other) = delete;
 	Pipeline(Pipeline&& other) noexcept;
 	~Pipeline();
@@ -19,6 +36,11 @@ public:
 		return m_programId;
 	}
 
+	inline bool hasStage(ShaderType type) const
+	{
+		return (m_stagesMask & (1u << type)) != 0;
+	}
+
 	inline void bind() const
 	{
 		GL_ASSERT(glUseProgram(m_programId));
@@ -29,8 +51,12 @@ public:
 		GL_ASSERT(glUseProgram(0));
 	}
 
+private:
+	void link(const Shader* const* ppShaders, u32 shaderCount);
+
 private:
 	u32 m_programId;
+	u32 m_stagesMask; // bit per ShaderType attached
 };
 
 } // namespace ntt
\ No newline at end of file
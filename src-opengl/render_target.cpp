@@ -0,0 +1,83 @@
+#include "render_target.h"
+#include <algorithm>
+
+namespace ntt {
+
+RenderTarget::RenderTarget(u32 width, u32 height)
+	: m_width(width)
+	, m_height(height)
+	, m_renderWidth(width)
+	, m_renderHeight(height)
+{
+	GL_ASSERT(glCreateTextures(GL_TEXTURE_2D, 1, &m_colorTextureId));
+	GL_ASSERT(glCreateTextures(GL_TEXTURE_2D, 1, &m_depthTextureId));
+	GL_ASSERT(glTextureStorage2D(m_colorTextureId, 1, GL_RGBA8, i32(width), i32(height)));
+	GL_ASSERT(glTextureStorage2D(m_depthTextureId, 1, GL_DEPTH_COMPONENT32F, i32(width), i32(height)));
+
+	// Depth is read with texelFetch, without comparison
+	GL_ASSERT(glTextureParameteri(m_depthTextureId, GL_TEXTURE_MIN_FILTER, GL_NEAREST));
+	GL_ASSERT(glTextureParameteri(m_depthTextureId, GL_TEXTURE_MAG_FILTER, GL_NEAREST));
+
+	GL_ASSERT(glCreateFramebuffers(1, &m_framebufferId));
+	GL_ASSERT(glNamedFramebufferTexture(m_framebufferId, GL_COLOR_ATTACHMENT0, m_colorTextureId, 0));
+	GL_ASSERT(glNamedFramebufferTexture(m_framebufferId, GL_DEPTH_ATTACHMENT, m_depthTextureId, 0));
+	ASSERT(glCheckNamedFramebufferStatus(m_framebufferId, GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE);
+}
+
+RenderTarget::RenderTarget(RenderTarget&& other) noexcept
+	: m_framebufferId(other.m_framebufferId)
+	, m_colorTextureId(other.m_colorTextureId)
+	, m_depthTextureId(other.m_depthTextureId)
+	, m_width(other.m_width)
+	, m_height(other.m_height)
+	, m_renderWidth(other.m_renderWidth)
+	, m_renderHeight(other.m_renderHeight)
+{
+	other.m_framebufferId = 0;
+}
+
+RenderTarget::~RenderTarget()
+{
+	if (m_framebufferId != 0)
+	{
+		u32 textures[2] = {m_colorTextureId, m_depthTextureId};
+		GL_ASSERT(glDeleteFramebuffers(1, &m_framebufferId));
+		GL_ASSERT(glDeleteTextures(2, textures));
+		m_framebufferId = 0;
+	}
+}
+
+void RenderTarget::setRenderSize(u32 width, u32 height)
+{
+	m_renderWidth  = std::min(std::max(width, 1u), m_width);
+	m_renderHeight = std::min(std::max(height, 1u), m_height);
+}
+
+void RenderTarget::bind() const
+{
+	GL_ASSERT(glBindFramebuffer(GL_FRAMEBUFFER, m_framebufferId));
+	GL_ASSERT(glViewport(0, 0, i32(m_renderWidth), i32(m_renderHeight)));
+}
+
+void RenderTarget::unbind() const
+{
+	GL_ASSERT(glBindFramebuffer(GL_FRAMEBUFFER, 0));
+}
+
+void RenderTarget::blitToWindow(u32 windowWidth, u32 windowHeight) const
+{
+	GL_ASSERT(glBlitNamedFramebuffer(m_framebufferId,
+									 0,
+									 0,
+									 0,
+									 i32(m_renderWidth),
+									 i32(m_renderHeight),
+									 0,
+									 0,
+									 i32(windowWidth),
+									 i32(windowHeight),
+									 GL_COLOR_BUFFER_BIT,
+									 GL_LINEAR));
+}
+
+} // namespace ntt
\ No newline at end of file
@@ -0,0 +1,80 @@
+#pragma once
+#include "common.h"
+
+namespace ntt {
+
+/**
+ * Color and depth textures the scene is drawn into instead of the window, so that the passes after the draws can
+ * sample its depth. The draws only cover the render size, a corner of the textures that can shrink under load
+ * without reallocating them, and the color is presented by blitting that corner to the default framebuffer with a
+ * bilinear upscale.
+ *
+ * @example
+ * ```c++
+ * RenderTarget target(width, height);
+ * target.setRenderSize(u32(width * scale), u32(height * scale));
+ * target.bind();
+ * glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+ * drawScene();
+ * target.unbind();
+ * target.blitToWindow(width, height);
+ * ```
+ */
+
+class RenderTarget
+{
+public:
+	RenderTarget(u32 width, u32 height);
+	RenderTarget(const RenderTarget&) = delete;
+	RenderTarget(RenderTarget&& other) noexcept;
+	~RenderTarget();
+
+public:
+	inline u32 getWidth() const
+	{
+		return m_width;
+	}
+
+	inline u32 getHeight() const
+	{
+		return m_height;
+	}
+
+	// Pixels drawn, the whole target by default
+	inline u32 getRenderWidth() const
+	{
+		return m_renderWidth;
+	}
+
+	inline u32 getRenderHeight() const
+	{
+		return m_renderHeight;
+	}
+
+	// Clamped to the target, takes effect at the next bind
+	void setRenderSize(u32 width, u32 height);
+
+	// GL_DEPTH_COMPONENT32F, 0 near and 1 far
+	inline u32 getDepthTextureId() const
+	{
+		return m_depthTextureId;
+	}
+
+	// Binds the framebuffer with a viewport over the render size
+	void bind() const;
+	void unbind() const;
+
+	// Copies the color of the render size to the default framebuffer, stretched over the window
+	void blitToWindow(u32 windowWidth, u32 windowHeight) const;
+
+private:
+	u32 m_framebufferId;
+	u32 m_colorTextureId;
+	u32 m_depthTextureId;
+	u32 m_width;
+	u32 m_height;
+	u32 m_renderWidth;
+	u32 m_renderHeight;
+};
+
+} // namespace ntt
\ No newline at end of file
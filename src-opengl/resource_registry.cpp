@@ -0,0 +1,254 @@
+#include "resource_registry.h"
+#include <algorithm>
+#include <easy/profiler.h>
+#include <filesystem>
+
+#define TEXTURE_TEXEL_SIZE 4 // RGB8 is padded to RGBA8 by most drivers
+#define NO_UNUSED_RESOURCE (~0u)
+
+namespace ntt {
+
+std::string getCanonicalPath(const std::string& path)
+{
+	return std::filesystem::path(path).lexically_normal().generic_string();
+}
+
+ResourceRegistry::ResourceRegistry(u64 memoryBudget)
+	: m_memoryBudget(memoryBudget)
+	, m_tick(0)
+	, m_statistics{}
+{
+}
+
+ResourceRegistry::ResourceRegistry(ResourceRegistry&& other) noexcept
+	: m_textures(std::move(other.m_textures))
+	, m_shaders(std::move(other.m_shaders))
+	, m_pipelines(std::move(other.m_pipelines))
+	, m_memoryBudget(other.m_memoryBudget)
+	, m_tick(other.m_tick)
+	, m_statistics(other.m_statistics)
+{
+}
+
+TextureHandle ResourceRegistry::acquireTexture(const std::string& path)
+{
+	return acquire(m_textures, getCanonicalPath(path));
+}
+
+TextureHandle ResourceRegistry::addTexture(const std::string& path, const TextureImage& image)
+{
+	std::string	  key	 = getCanonicalPath(path);
+	TextureHandle handle = acquire(m_textures, key);
+	if (handle.isValid())
+	{
+		return handle;
+	}
+
+	u64 size = u64(image.getWidth()) * u64(image.getHeight()) * TEXTURE_TEXEL_SIZE;
+	return add(m_textures, key, Texture(image), size);
+}
+
+TextureHandle ResourceRegistry::loadTexture(const std::string& path)
+{
+	TextureHandle handle = acquireTexture(path);
+	return handle.isValid() ? handle : addTexture(path, TextureImage(path));
+}
+
+ShaderHandle ResourceRegistry::loadShader(
+	const std::string& path, ShaderType type, const std::vector<std::string>& defines)
+{
+	// Every define takes part in the key, in the order given since it is the order of the source
+	std::string key = getCanonicalPath(path) + "|" + std::to_string(u32(type));
+	for (const std::string& define : defines)
+	{
+		key += "|" + define;
+	}
+
+	ShaderHandle handle = acquire(m_shaders, key);
+	if (handle.isValid())
+	{
+		return handle;
+	}
+
+	EASY_BLOCK("Compile shader");
+	Shader shader(path, type, defines);
+	i32	   sourceLength = 0;
+	GL_ASSERT(glGetShaderiv(shader.getId(), GL_SHADER_SOURCE_LENGTH, &sourceLength));
+	return add(m_shaders, key, std::move(shader), u64(sourceLength));
+}
+
+PipelineHandle ResourceRegistry::loadPipeline(const ShaderHandle* pShaders, u32 shaderCount)
+{
+	// Keyed by the keys of its shaders, which are already resident whatever happens to the pipeline
+	std::vector<const Shader*> shaders(shaderCount);
+	std::string				   key;
+	for (u32 i = 0; i < shaderCount; ++i)
+	{
+		const Resource<Shader>* pShader = m_shaders.resources.get(pShaders[i]);
+		ASSERT(pShader != nullptr);
+		shaders[i] = &pShader->resource;
+		key += (i > 0 ? "+" : "") + pShader->key;
+	}
+
+	PipelineHandle handle = acquire(m_pipelines, key);
+	if (handle.isValid())
+	{
+		return handle;
+	}
+
+	EASY_BLOCK("Link pipeline");
+	Pipeline pipeline(shaders.data(), shaderCount);
+	i32		 binaryLength = 0;
+	GL_ASSERT(glGetProgramiv(pipeline.getProgramId(), GL_PROGRAM_BINARY_LENGTH, &binaryLength));
+	return add(m_pipelines, key, std::move(pipeline), u64(binaryLength));
+}
+
+Texture* ResourceRegistry::getTexture(TextureHandle handle)
+{
+	Resource<Texture>* pTexture = m_textures.resources.get(handle);
+	return pTexture != nullptr ? &pTexture->resource : nullptr;
+}
+
+const Shader* ResourceRegistry::getShader(ShaderHandle handle) const
+{
+	const Resource<Shader>* pShader = m_shaders.resources.get(handle);
+	return pShader != nullptr ? &pShader->resource : nullptr;
+}
+
+const Pipeline* ResourceRegistry::getPipeline(PipelineHandle handle) const
+{
+	const Resource<Pipeline>* pPipeline = m_pipelines.resources.get(handle);
+	return pPipeline != nullptr ? &pPipeline->resource : nullptr;
+}
+
+void ResourceRegistry::release(TextureHandle handle)
+{
+	release(m_textures, handle);
+}
+
+void ResourceRegistry::release(ShaderHandle handle)
+{
+	release(m_shaders, handle);
+}
+
+void ResourceRegistry::release(PipelineHandle handle)
+{
+	release(m_pipelines, handle);
+}
+
+void ResourceRegistry::evictUnused()
+{
+	u64 budget	   = m_memoryBudget;
+	m_memoryBudget = 0;
+	evictOverBudget();
+	m_memoryBudget = budget;
+}
+
+ResourceStatistics ResourceRegistry::getStatistics() const
+{
+	ResourceStatistics statistics = m_statistics;
+	statistics.residentCount =
+		m_textures.resources.getSize() + m_shaders.resources.getSize() + m_pipelines.resources.getSize();
+	return statistics;
+}
+
+template <typename T>
+SlotHandle<T> ResourceRegistry::acquire(ResourcePool<T>& pool, const std::string& key)
+{
+	auto found = pool.keys.find(key);
+	if (found == pool.keys.end())
+	{
+		return {0, 0};
+	}
+
+	Resource<T>* pResource = pool.resources.get(found->second);
+	if (pResource->referencesCount++ == 0)
+	{
+		m_statistics.unusedCount--;
+	}
+	m_statistics.hitsCount++;
+	return found->second;
+}
+
+template <typename T>
+SlotHandle<T> ResourceRegistry::add(ResourcePool<T>& pool, const std::string& key, T&& resource, u64 size)
+{
+	SlotHandle<T> handle = pool.resources.insert({std::move(resource), key, size, 1, 0});
+	pool.keys[key]		 = handle;
+
+	m_statistics.loadsCount++;
+	m_statistics.residentSize += size;
+	m_statistics.peakSize = std::max(m_statistics.peakSize, m_statistics.residentSize);
+	evictOverBudget();
+	return handle;
+}
+
+template <typename T>
+void ResourceRegistry::release(ResourcePool<T>& pool, SlotHandle<T> handle)
+{
+	Resource<T>* pResource = pool.resources.get(handle);
+	ASSERT(pResource != nullptr && pResource->referencesCount > 0);
+	if (--pResource->referencesCount == 0)
+	{
+		pResource->releaseTick = ++m_tick;
+		m_statistics.unusedCount++;
+		evictOverBudget();
+	}
+}
+
+template <typename T>
+u32 ResourceRegistry::findOldestUnused(ResourcePool<T>& pool) const
+{
+	u32 oldest = NO_UNUSED_RESOURCE;
+	u32 index  = 0;
+	for (const Resource<T>& resource : pool.resources)
+	{
+		if (resource.referencesCount == 0 &&
+			(oldest == NO_UNUSED_RESOURCE || resource.releaseTick < pool.resources.begin()[oldest].releaseTick))
+		{
+			oldest = index;
+		}
+		index++;
+	}
+	return oldest;
+}
+
+template <typename T>
+void ResourceRegistry::evict(ResourcePool<T>& pool, u32 denseIndex)
+{
+	Resource<T>& resource = pool.resources.begin()[denseIndex];
+	m_statistics.residentSize -= resource.size;
+	m_statistics.unusedCount--;
+	m_statistics.evictionsCount++;
+	pool.keys.erase(resource.key);
+	pool.resources.erase(pool.resources.getHandle(denseIndex));
+}
+
+void ResourceRegistry::evictOverBudget()
+{
+	// Scans the dense arrays, there are a few hundred resources at most and evictions are rare
+	while (m_statistics.residentSize > m_memoryBudget && m_statistics.unusedCount > 0)
+	{
+		u32 texture	 = findOldestUnused(m_textures);
+		u32 shader	 = findOldestUnused(m_shaders);
+		u32 pipeline = findOldestUnused(m_pipelines);
+
+		u64 textureTick	 = texture != NO_UNUSED_RESOURCE ? m_textures.resources.begin()[texture].releaseTick : ~0ull;
+		u64 shaderTick	 = shader != NO_UNUSED_RESOURCE ? m_shaders.resources.begin()[shader].releaseTick : ~0ull;
+		u64 pipelineTick = pipeline != NO_UNUSED_RESOURCE ? m_pipelines.resources.begin()[pipeline].releaseTick : ~0ull;
+		if (textureTick <= shaderTick && textureTick <= pipelineTick)
+		{
+			evict(m_textures, texture);
+		}
+		else if (shaderTick <= pipelineTick)
+		{
+			evict(m_shaders, shader);
+		}
+		else
+		{
+			evict(m_pipelines, pipeline);
+		}
+	}
+}
+
+} // namespace ntt
\ No newline at end of file
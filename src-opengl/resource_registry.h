@@ -0,0 +1,132 @@
+#pragma once
+#include "common.h"
+#include "pipeline.h"
+#include "shader.h"
+#include "slot_map.h"
+#include "texture.h"
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace ntt {
+
+typedef SlotHandle<Texture>	 TextureHandle;
+typedef SlotHandle<Shader>	 ShaderHandle;
+typedef SlotHandle<Pipeline> PipelineHandle;
+
+struct ResourceStatistics
+{
+	u32 loadsCount;		// resources actually created
+	u32 hitsCount;		// loads served by a resident resource
+	u32 evictionsCount; // unused resources destroyed to get back under the budget
+	u32 residentCount;
+	u32 unusedCount;
+	u64 residentSize; // estimated bytes
+	u64 peakSize;
+};
+
+/**
+ * Owner of the textures, shaders and pipelines, each kind in its own slot map and handed out as generational handles.
+ * Loads are keyed by the canonical path and the parameters of the resource, so loading one twice returns the resident
+ * copy with one more reference. A resource whose references are all released stays resident for the next load of its
+ * key, until the resident size goes over the memory budget and the least recently released ones are evicted. Sizes
+ * are estimates: 4 bytes per texel for textures, the source for shaders and the program binary for pipelines. Main
+ * thread only, like every GL call.
+ *
+ * @example
+ * ```c++
+ * ResourceRegistry registry(256 * 1024 * 1024);
+ * ShaderHandle		shaders[2] = {registry.loadShader(vertexPath, VERTEX_SHADER),
+ *								  registry.loadShader(fragmentPath, FRAGMENT_SHADER)};
+ * PipelineHandle	pipeline   = registry.loadPipeline(shaders, 2);
+ * registry.release(shaders[0]);
+ * registry.release(shaders[1]);
+ *
+ * registry.getPipeline(pipeline)->bind();
+ * registry.release(pipeline);
+ * ```
+ */
+
+class ResourceRegistry
+{
+public:
+	ResourceRegistry(u64 memoryBudget);
+	ResourceRegistry(const ResourceRegistry&) = delete;
+	ResourceRegistry(ResourceRegistry&& other) noexcept;
+	~ResourceRegistry() = default;
+
+public:
+	// Resident texture with one more reference, an invalid handle when it still has to be decoded and added
+	TextureHandle acquireTexture(const std::string& path);
+	// Uploads the decoded image, unless the path became resident in the meantime and the image is dropped
+	TextureHandle addTexture(const std::string& path, const TextureImage& image);
+	TextureHandle loadTexture(const std::string& path);
+
+	ShaderHandle loadShader(const std::string& path, ShaderType type, const std::vector<std::string>& defines = {});
+
+	// Takes no reference on the shaders, they can be released as soon as the pipeline is loaded
+	PipelineHandle loadPipeline(const ShaderHandle* pShaders, u32 shaderCount);
+
+	// nullptr for stale handles
+	Texture*		getTexture(TextureHandle handle);
+	const Shader*	getShader(ShaderHandle handle) const;
+	const Pipeline* getPipeline(PipelineHandle handle) const;
+
+	void release(TextureHandle handle);
+	void release(ShaderHandle handle);
+	void release(PipelineHandle handle);
+
+	// Destroys every unused resource, whatever the budget
+	void evictUnused();
+
+	ResourceStatistics getStatistics() const;
+
+private:
+	template <typename T>
+	struct Resource
+	{
+		T			resource;
+		std::string key;
+		u64			size;
+		u32			referencesCount;
+		u64			releaseTick; // when the last reference was released, orders the evictions
+	};
+
+	template <typename T>
+	struct ResourcePool
+	{
+		SlotMap<Resource<T>, T>						   resources;
+		std::unordered_map<std::string, SlotHandle<T>> keys;
+	};
+
+	template <typename T>
+	SlotHandle<T> acquire(ResourcePool<T>& pool, const std::string& key);
+
+	template <typename T>
+	SlotHandle<T> add(ResourcePool<T>& pool, const std::string& key, T&& resource, u64 size);
+
+	template <typename T>
+	void release(ResourcePool<T>& pool, SlotHandle<T> handle);
+
+	// Dense index of the least recently released unused resource, ~0u when every resource is used
+	template <typename T>
+	u32 findOldestUnused(ResourcePool<T>& pool) const;
+
+	template <typename T>
+	void evict(ResourcePool<T>& pool, u32 denseIndex);
+
+	void evictOverBudget();
+
+private:
+	ResourcePool<Texture>  m_textures;
+	ResourcePool<Shader>   m_shaders;
+	ResourcePool<Pipeline> m_pipelines;
+	u64					   m_memoryBudget;
+	u64					   m_tick;
+	ResourceStatistics	   m_statistics;
+};
+
+// Lexically normalized, so a path spelled two ways still names one resource
+std::string getCanonicalPath(const std::string& path);
+
+} // namespace ntt
\ No newline at end of file
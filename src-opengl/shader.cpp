@@ -1,13 +1,28 @@
 #include "shader.h"
-#include "utils.h"
+#include "file_system.h"
 
 namespace ntt {
 
-Shader::Shader(const std::string& filePath, ShaderType type)
+Shader::Shader(const std::string& filePath, ShaderType type, const std::vector<std::string>& defines)
 	: m_type(type)
 {
-	std::string shaderSource = readFile(filePath);
-	ASSERT(!shaderSource.empty());
+	FileView file(filePath);
+	ASSERT(file.isOpen() && file.getSize() > 0);
+
+	// Compiled straight from the mapping, the defines are handed over as a separate string right after the #version
+	// line, which has to stay the first statement of the source
+	std::string_view source		= file.getText();
+	size_t			 versionEnd = source.find('\n', source.find("#version"));
+	ASSERT(versionEnd != std::string_view::npos);
+
+	std::string definesSource;
+	for (const std::string& define : defines)
+	{
+		definesSource += "#define " + define + "\n";
+	}
+
+	const char* sources[3] = {source.data(), definesSource.c_str(), source.data() + versionEnd + 1};
+	i32			lengths[3] = {i32(versionEnd + 1), i32(definesSource.size()), i32(source.size() - versionEnd - 1)};
 
 	GLenum shaderTypeGL;
 
@@ -28,13 +43,15 @@ Shader::Shader(const std::string& filePath, ShaderType type)
 	case TESS_EVALUATION_SHADER:
 		shaderTypeGL = GL_TESS_EVALUATION_SHADER;
 		break;
+	case COMPUTE_SHADER:
+		shaderTypeGL = GL_COMPUTE_SHADER;
+		break;
 	default:
 		ASSERT(false); // Unknown shader type
 	}
 
-	m_shaderId			   = glCreateShader(shaderTypeGL);
-	const char* sourceCStr = shaderSource.c_str();
-	GL_ASSERT(glShaderSource(m_shaderId, 1, &sourceCStr, nullptr));
+	m_shaderId = glCreateShader(shaderTypeGL);
+	GL_ASSERT(glShaderSource(m_shaderId, 3, sources, lengths));
 	GL_ASSERT(glCompileShader(m_shaderId));
 
 	bool success;
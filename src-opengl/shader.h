@@ -1,5 +1,6 @@
 #pragma once
 #include "common.h"
+#include <vector>
 
 namespace ntt {
 
@@ -10,12 +11,14 @@ enum ShaderType
 	GEOMETRY_SHADER,
 	TESS_CONTROL_SHADER,
 	TESS_EVALUATION_SHADER,
+	COMPUTE_SHADER,
 };
 
 class Shader
 {
 public:
-	Shader(const std::string& filePath, ShaderType type);
+	// Every define is inserted as `#define <define>` right after the #version line of the source
+	Shader(const std::string& filePath, ShaderType type, const std::vector<std::string>& defines = {});
 	Shader(const Shader& other) = delete;
 	Shader(Shader&& other) noexcept;
 	~Shader();
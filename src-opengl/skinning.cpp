@@ -0,0 +1,407 @@
+#include "skinning.h"
+#include "transform_hierarchy.h"
+#include "vertex_layout.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <easy/profiler.h>
+
+#define SKINNING_GROUP_SIZE 64 // local_size_x of skinning.comp
+#define POSED_BOUNDS_SIZE	16 // one ivec4 corner
+
+// Read by skinning.comp as its SkinnedVertex struct, std430 has no padding there either
+VERTEX_LAYOUT(ntt::SkinnedVertex,
+			  VERTEX_ATTRIBUTE(position, VEC3),
+			  VERTEX_ATTRIBUTE(texCoord, VEC2),
+			  VERTEX_ATTRIBUTE(joints, USHORT4),
+			  VERTEX_ATTRIBUTE(weights, VEC4));
+
+namespace ntt {
+
+// Local transforms and joint worlds of the instance being sampled, reused from one instance to the next
+static thread_local std::vector<vec3> t_translations;
+static thread_local std::vector<quat> t_rotations;
+static thread_local std::vector<vec3> t_scales;
+static thread_local std::vector<mat4> t_worldMatrices;
+
+static Pipeline createSkinningPipeline()
+{
+	Shader shader(STRINGIFY(SOURCE_DIR) "/assets/shaders/opengl/skinning.comp", COMPUTE_SHADER);
+	return Pipeline(&shader, 1);
+}
+
+// Last key at or before time, the first one before the animation starts
+static u64 findKey(const GltfAccessorView<f32>& times, f32 time)
+{
+	u64 first = 0;
+	u64 last  = times.getCount();
+	while (last - first > 1)
+	{
+		u64 middle = (first + last) / 2;
+		if (times[middle] <= time)
+		{
+			first = middle;
+		}
+		else
+		{
+			last = middle;
+		}
+	}
+	return first;
+}
+
+static void readValue(const GltfAccessor& values, u64 index, f32* pValue, u32 componentsCount)
+{
+	memcpy(pValue, values.pData + index * values.stride, componentsCount * sizeof(f32));
+}
+
+// Normalized lerp on the shortest arc, indistinguishable from a slerp between keys this close
+static quat blendRotations(const f32* a, const f32* b, f32 factor)
+{
+	f32 sign	 = a[0] * b[0] + a[1] * b[1] + a[2] * b[2] + a[3] * b[3] < 0.0f ? -1.0f : 1.0f;
+	f32 blend[4] = {};
+	for (u32 component = 0u; component < 4u; ++component)
+	{
+		blend[component] = a[component] * (1.0f - factor) + b[component] * factor * sign;
+	}
+
+	f32 length = std::sqrt(blend[0] * blend[0] + blend[1] * blend[1] + blend[2] * blend[2] + blend[3] * blend[3]);
+	f32 scale  = length > 0.0f ? 1.0f / length : 0.0f;
+	return quat(blend[3] * scale, blend[0] * scale, blend[1] * scale, blend[2] * scale); // stored x, y, z, w
+}
+
+static void sampleChannel(
+	const AnimationChannel& channel, f32 time, vec3* pTranslations, quat* pRotations, vec3* pScales)
+{
+	GltfAccessorView<f32> times(channel.times);
+	u64					  key	  = findKey(times, time);
+	u64					  nextKey = std::min(key + 1, times.getCount() - 1);
+
+	f32 factor = 0.0f;
+	if (channel.interpolation != GltfInterpolation::STEP && nextKey != key && times[nextKey] > times[key])
+	{
+		factor = std::min(std::max((time - times[key]) / (times[nextKey] - times[key]), 0.0f), 1.0f);
+	}
+
+	// Cubic spline keys are (in-tangent, value, out-tangent)
+	u64 valueStride = channel.interpolation == GltfInterpolation::CUBICSPLINE ? 3 : 1;
+	u64 valueOffset = channel.interpolation == GltfInterpolation::CUBICSPLINE ? 1 : 0;
+	u32 size		= channel.path == GltfAnimationPath::ROTATION ? 4 : 3;
+	f32 a[4];
+	f32 b[4];
+	readValue(channel.values, key * valueStride + valueOffset, a, size);
+	readValue(channel.values, nextKey * valueStride + valueOffset, b, size);
+
+	if (channel.path == GltfAnimationPath::ROTATION)
+	{
+		pRotations[channel.joint] = blendRotations(a, b, factor);
+		return;
+	}
+
+	vec3 value(a[0] + (b[0] - a[0]) * factor, a[1] + (b[1] - a[1]) * factor, a[2] + (b[2] - a[2]) * factor);
+	if (channel.path == GltfAnimationPath::TRANSLATION)
+	{
+		pTranslations[channel.joint] = value;
+	}
+	else
+	{
+		pScales[channel.joint] = value;
+	}
+}
+
+Skeleton::Skeleton(const std::vector<SkeletonJoint>& joints)
+{
+	u32 jointsCount = u32(joints.size());
+	m_parents.resize(jointsCount);
+	m_translations.resize(jointsCount);
+	m_rotations.resize(jointsCount);
+	m_scales.resize(jointsCount);
+	m_inverseBindMatrices.resize(jointsCount);
+	m_rootMatrices.resize(jointsCount);
+	for (u32 joint = 0u; joint < jointsCount; ++joint)
+	{
+		ASSERT(joints[joint].parent < i32(jointsCount));
+		m_parents[joint]			 = joints[joint].parent;
+		m_translations[joint]		 = joints[joint].translation;
+		m_rotations[joint]			 = joints[joint].rotation;
+		m_scales[joint]				 = joints[joint].scale;
+		m_inverseBindMatrices[joint] = joints[joint].inverseBindMatrix;
+		m_rootMatrices[joint]		 = joints[joint].rootMatrix;
+	}
+
+	// The joints keep their indices, the ones JOINTS_0 uses, only the evaluation follows the parents
+	std::vector<u8> ordered(jointsCount, 0);
+	for (u32 joint = 0u; joint < jointsCount; ++joint)
+	{
+		std::vector<u32> chain;
+		for (i32 ancestor = i32(joint); ancestor >= 0 && !ordered[ancestor]; ancestor = m_parents[ancestor])
+		{
+			chain.push_back(u32(ancestor));
+			ASSERT(chain.size() <= jointsCount && "Cycle in the skeleton");
+		}
+		for (auto ancestor = chain.rbegin(); ancestor != chain.rend(); ++ancestor)
+		{
+			ordered[*ancestor] = 1;
+			m_order.push_back(*ancestor);
+		}
+	}
+}
+
+Skeleton::Skeleton(Skeleton&& other) noexcept
+	: m_parents(std::move(other.m_parents))
+	, m_order(std::move(other.m_order))
+	, m_translations(std::move(other.m_translations))
+	, m_rotations(std::move(other.m_rotations))
+	, m_scales(std::move(other.m_scales))
+	, m_inverseBindMatrices(std::move(other.m_inverseBindMatrices))
+	, m_rootMatrices(std::move(other.m_rootMatrices))
+{
+}
+
+void Skeleton::sample(const AnimationClip& clip, f32 time, const mat4& world, mat4* pJointMatrices) const
+{
+	u32 jointsCount = getJointsCount();
+	t_translations.assign(m_translations.begin(), m_translations.end());
+	t_rotations.assign(m_rotations.begin(), m_rotations.end());
+	t_scales.assign(m_scales.begin(), m_scales.end());
+	t_worldMatrices.resize(jointsCount);
+
+	f32 clipTime = clip.duration > 0.0f ? std::fmod(time, clip.duration) : 0.0f;
+	clipTime	 = clipTime < 0.0f ? clipTime + clip.duration : clipTime;
+	for (const AnimationChannel& channel : clip.channels)
+	{
+		sampleChannel(channel, clipTime, t_translations.data(), t_rotations.data(), t_scales.data());
+	}
+
+	// The worlds stay in the thread's scratch, pJointMatrices is usually a write-only GL mapping that is never read
+	for (u32 joint : m_order)
+	{
+		mat4 local;
+		composeTransform(t_translations[joint], t_rotations[joint], t_scales[joint], local);
+
+		i32 parent = m_parents[joint];
+		if (parent >= 0)
+		{
+			multiplyMatrices(t_worldMatrices[parent], local, t_worldMatrices[joint]);
+			continue;
+		}
+
+		mat4 root;
+		multiplyMatrices(world, m_rootMatrices[joint], root);
+		multiplyMatrices(root, local, t_worldMatrices[joint]);
+	}
+
+	for (u32 joint = 0u; joint < jointsCount; ++joint)
+	{
+		multiplyMatrices(t_worldMatrices[joint], m_inverseBindMatrices[joint], pJointMatrices[joint]);
+	}
+}
+
+std::vector<SkeletonJoint> getGltfSkeletonJoints(const GltfModel& model, u32 skinIndex)
+{
+	const GltfSkin&	 skin = model.getSkin(skinIndex);
+	std::vector<i32> nodeParents(model.getNodesCount(), -1);
+	std::vector<i32> nodeJoints(model.getNodesCount(), -1);
+	for (u32 nodeIndex = 0u; nodeIndex < model.getNodesCount(); ++nodeIndex)
+	{
+		for (i32 child : model.getNode(nodeIndex).children)
+		{
+			nodeParents[child] = i32(nodeIndex);
+		}
+	}
+	for (u32 joint = 0u; joint < u32(skin.joints.size()); ++joint)
+	{
+		nodeJoints[skin.joints[joint]] = i32(joint);
+	}
+
+	std::vector<SkeletonJoint> joints(skin.joints.size());
+	for (u32 joint = 0u; joint < u32(joints.size()); ++joint)
+	{
+		const GltfNode& node   = model.getNode(skin.joints[joint]);
+		i32				parent = nodeParents[skin.joints[joint]];
+		joints[joint]		   = {-1, node.translation, node.rotation, node.scale, mat4(1.0f), mat4(1.0f)};
+		if (skin.inverseBindMatrices >= 0)
+		{
+			const GltfAccessor& matrices = model.getAccessor(skin.inverseBindMatrices);
+			memcpy(&joints[joint].inverseBindMatrix[0][0], matrices.pData + joint * matrices.stride, sizeof(f32) * 16);
+		}
+
+		if (parent >= 0 && nodeJoints[parent] >= 0)
+		{
+			joints[joint].parent = nodeJoints[parent];
+			continue;
+		}
+
+		// Rest transforms of the nodes above a root joint, up to the scene root
+		for (; parent >= 0; parent = nodeParents[parent])
+		{
+			const GltfNode& ancestor = model.getNode(parent);
+			mat4			transform;
+			composeTransform(ancestor.translation, ancestor.rotation, ancestor.scale, transform);
+			multiplyMatrices(transform, joints[joint].rootMatrix, joints[joint].rootMatrix);
+		}
+	}
+	return joints;
+}
+
+AnimationClip createGltfAnimationClip(const GltfModel& model, u32 animationIndex, u32 skinIndex)
+{
+	const GltfAnimation& animation = model.getAnimation(animationIndex);
+	const GltfSkin&		 skin	   = model.getSkin(skinIndex);
+
+	AnimationClip clip = {};
+	clip.duration	   = animation.duration;
+	for (const GltfAnimationChannel& channel : animation.channels)
+	{
+		auto joint = std::find(skin.joints.begin(), skin.joints.end(), channel.node);
+		if (joint == skin.joints.end() || channel.path == GltfAnimationPath::WEIGHTS)
+		{
+			continue;
+		}
+
+		const GltfAccessor& values = model.getAccessor(channel.output);
+		if (values.componentType != GltfComponentType::FLOAT ||
+			values.componentsCount != (channel.path == GltfAnimationPath::ROTATION ? 4u : 3u))
+		{
+			continue;
+		}
+
+		clip.channels.push_back({u32(joint - skin.joints.begin()),
+								 channel.path,
+								 channel.interpolation,
+								 model.getAccessor(channel.input),
+								 values});
+	}
+	return clip;
+}
+
+void packSkinnedVertices(
+	const GltfModel& model, const GltfPrimitive& primitive, u32 first, u32 count, SkinnedVertex* pVertices)
+{
+	ASSERT(primitive.positions >= 0 && primitive.texCoords >= 0 && primitive.joints >= 0 && primitive.weights >= 0);
+
+	packVec3<0, 1, 2>(model.getAccessor(primitive.positions).getRange(first, count),
+					  &pVertices[first].position,
+					  sizeof(SkinnedVertex));
+	packTexCoords(model.getAccessor(primitive.texCoords).getRange(first, count),
+				  &pVertices[first].texCoord,
+				  sizeof(SkinnedVertex));
+	packJoints(
+		model.getAccessor(primitive.joints).getRange(first, count), &pVertices[first].joints, sizeof(SkinnedVertex));
+	packWeights(
+		model.getAccessor(primitive.weights).getRange(first, count), &pVertices[first].weights, sizeof(SkinnedVertex));
+}
+
+SkinningPass::SkinningPass(u32 verticesCount, u32 jointsCount, u32 instancesCount)
+	: m_pipeline(createSkinningPipeline())
+	, m_verticesCount(verticesCount)
+	, m_jointsCount(jointsCount)
+	, m_instancesCount(instancesCount)
+{
+	// One work group row per instance
+	i32 maxGroupsCount = 0;
+	GL_ASSERT(glGetIntegeri_v(GL_MAX_COMPUTE_WORK_GROUP_COUNT, 1, &maxGroupsCount));
+	ASSERT(instancesCount > 0 && instancesCount <= u32(maxGroupsCount));
+
+	u64 posedSize = u64(verticesCount) * instancesCount * (sizeof(f32) * 5);
+	GL_ASSERT(glCreateBuffers(1, &m_skinnedVerticesBuffer));
+	GL_ASSERT(glCreateBuffers(1, &m_jointMatricesBuffer));
+	GL_ASSERT(glCreateBuffers(1, &m_posedVerticesBuffer));
+	GL_ASSERT(glCreateBuffers(1, &m_posedBoundsBuffer));
+	GL_ASSERT(glNamedBufferData(
+		m_skinnedVerticesBuffer, sizeof(SkinnedVertex) * verticesCount, nullptr, GL_STATIC_DRAW));
+	GL_ASSERT(glNamedBufferData(
+		m_jointMatricesBuffer, sizeof(mat4) * jointsCount * instancesCount, nullptr, GL_STREAM_DRAW));
+	GL_ASSERT(glNamedBufferData(m_posedVerticesBuffer, posedSize, nullptr, GL_DYNAMIC_COPY));
+	GL_ASSERT(glNamedBufferData(m_posedBoundsBuffer, 2 * POSED_BOUNDS_SIZE * instancesCount, nullptr, GL_DYNAMIC_COPY));
+
+	GL_ASSERT(glProgramUniform1ui(m_pipeline.getProgramId(), 0, verticesCount));
+	GL_ASSERT(glProgramUniform1ui(m_pipeline.getProgramId(), 1, jointsCount));
+	GL_ASSERT(glProgramUniform1ui(m_pipeline.getProgramId(), 2, instancesCount));
+}
+
+SkinningPass::SkinningPass(SkinningPass&& other) noexcept
+	: m_pipeline(std::move(other.m_pipeline))
+	, m_skinnedVerticesBuffer(other.m_skinnedVerticesBuffer)
+	, m_jointMatricesBuffer(other.m_jointMatricesBuffer)
+	, m_posedVerticesBuffer(other.m_posedVerticesBuffer)
+	, m_posedBoundsBuffer(other.m_posedBoundsBuffer)
+	, m_verticesCount(other.m_verticesCount)
+	, m_jointsCount(other.m_jointsCount)
+	, m_instancesCount(other.m_instancesCount)
+{
+	other.m_skinnedVerticesBuffer = 0;
+	other.m_jointMatricesBuffer	  = 0;
+	other.m_posedVerticesBuffer	  = 0;
+}
+
+SkinningPass::~SkinningPass()
+{
+	if (m_skinnedVerticesBuffer != 0)
+	{
+		u32 buffers[4] = {m_skinnedVerticesBuffer, m_jointMatricesBuffer, m_posedVerticesBuffer, m_posedBoundsBuffer};
+		GL_ASSERT(glDeleteBuffers(4, buffers));
+		m_skinnedVerticesBuffer = 0;
+	}
+}
+
+SkinnedVertex* SkinningPass::mapSkinnedVertices()
+{
+	void* pVertices = glMapNamedBufferRange(m_skinnedVerticesBuffer,
+											0,
+											sizeof(SkinnedVertex) * m_verticesCount,
+											GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+	ASSERT(pVertices != nullptr);
+	return (SkinnedVertex*)pVertices;
+}
+
+void SkinningPass::unmapSkinnedVertices()
+{
+	GL_ASSERT(glUnmapNamedBuffer(m_skinnedVerticesBuffer));
+}
+
+mat4* SkinningPass::mapJointMatrices()
+{
+	// Invalidating lets the driver hand out fresh storage while last frame's dispatch still reads the old one
+	void* pMatrices = glMapNamedBufferRange(m_jointMatricesBuffer,
+											0,
+											sizeof(mat4) * m_jointsCount * m_instancesCount,
+											GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+	ASSERT(pMatrices != nullptr);
+	return (mat4*)pMatrices;
+}
+
+void SkinningPass::unmapJointMatrices()
+{
+	GL_ASSERT(glUnmapNamedBuffer(m_jointMatricesBuffer));
+}
+
+void SkinningPass::dispatch() const
+{
+	EASY_FUNCTION();
+
+	GL_ASSERT(glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, m_skinnedVerticesBuffer));
+	GL_ASSERT(glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, m_jointMatricesBuffer));
+	GL_ASSERT(glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, m_posedVerticesBuffer));
+	GL_ASSERT(glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, m_posedBoundsBuffer));
+
+	// Empty boxes, which the first vertex of every instance grows to itself
+	const i32 emptyLower[4] = {INT32_MAX, INT32_MAX, INT32_MAX, INT32_MAX};
+	const i32 emptyUpper[4] = {INT32_MIN, INT32_MIN, INT32_MIN, INT32_MIN};
+	u64		  boundsSize	= POSED_BOUNDS_SIZE * m_instancesCount;
+	GL_ASSERT(glClearNamedBufferSubData(
+		m_posedBoundsBuffer, GL_RGBA32I, 0, boundsSize, GL_RGBA_INTEGER, GL_INT, emptyLower));
+	GL_ASSERT(glClearNamedBufferSubData(
+		m_posedBoundsBuffer, GL_RGBA32I, boundsSize, boundsSize, GL_RGBA_INTEGER, GL_INT, emptyUpper));
+
+	m_pipeline.bind();
+	u32 groupsCount = (m_verticesCount + SKINNING_GROUP_SIZE - 1) / SKINNING_GROUP_SIZE;
+	GL_ASSERT(glDispatchCompute(groupsCount, m_instancesCount, 1));
+	m_pipeline.unbind();
+
+	// simple.vert pulls the posed vertices from a storage buffer too, the culling reads the bounds the same way
+	GL_ASSERT(glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT));
+}
+
+} // namespace ntt
\ No newline at end of file
@@ -0,0 +1,166 @@
+#pragma once
+#include "common.h"
+#include "gltf_model.h"
+#include "pipeline.h"
+#include <vector>
+
+namespace ntt {
+
+/**
+ * Skeletal animation split between the CPU and the GPU. `Skeleton::sample` evaluates a clip into the joint matrices of
+ * one instance and only reads shared data, so instances are sampled by parallel jobs straight into the mapped joint
+ * matrices of a `SkinningPass`. The pass then poses every instance with skinning.comp into the `Vertices` layout
+ * simple.vert reads, one instance after the other, and the posed meshes go through the regular draw path with a base
+ * vertex per instance.
+ *
+ * @example
+ * ```c++
+ * Skeleton		 skeleton(getGltfSkeletonJoints(model, skinIndex));
+ * AnimationClip clip = createGltfAnimationClip(model, animationIndex, skinIndex);
+ * SkinningPass	 pass(verticesCount, skeleton.getJointsCount(), instancesCount);
+ * packSkinnedVertices(model, primitive, 0, verticesCount, pass.mapSkinnedVertices());
+ * pass.unmapSkinnedVertices();
+ *
+ * mat4* pJointMatrices = pass.mapJointMatrices();
+ * jobSystem.parallelFor("Sample animations", instancesCount, 64, [&](u32 begin, u32 end) {
+ *     for (u32 instance = begin; instance < end; ++instance)
+ *         skeleton.sample(clip, time, worlds[instance], pJointMatrices + instance * skeleton.getJointsCount());
+ * });
+ * pass.unmapJointMatrices();
+ * pass.dispatch();
+ * glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, pass.getPosedVerticesBuffer());
+ * ```
+ */
+
+// Bind pose vertex as skinning.comp reads it, the posed Vertex is its first 20 bytes
+struct SkinnedVertex
+{
+	f32 position[3];
+	f32 texCoord[2];
+	u16 joints[4];
+	f32 weights[4];
+};
+
+struct SkeletonJoint
+{
+	i32	 parent;	  // -1 for roots, parents do not have to come first
+	vec3 translation; // rest pose, kept for the paths a clip does not animate
+	quat rotation;
+	vec3 scale;
+	mat4 inverseBindMatrix;
+	mat4 rootMatrix; // roots only, transform of the nodes above the skeleton
+};
+
+// Keyframes of one joint property, the accessors point into a glTF buffer or into the keyframes of the clip
+struct AnimationChannel
+{
+	u32				  joint;
+	GltfAnimationPath path;
+	GltfInterpolation interpolation; // cubic splines are interpolated linearly between their values
+	GltfAccessor	  times;
+	GltfAccessor	  values;
+};
+
+struct AnimationClip
+{
+	std::vector<AnimationChannel> channels;
+	f32							  duration;
+	std::vector<f32>			  keyframes; // storage of the clips built in code, empty for glTF ones
+};
+
+class Skeleton
+{
+public:
+	Skeleton(const std::vector<SkeletonJoint>& joints);
+	Skeleton(const Skeleton&) = delete;
+	Skeleton(Skeleton&& other) noexcept;
+	~Skeleton() = default;
+
+public:
+	inline u32 getJointsCount() const
+	{
+		return u32(m_parents.size());
+	}
+
+	// Thread-safe. Writes world * joint world * inverse bind for every joint, time wraps around the clip
+	void sample(const AnimationClip& clip, f32 time, const mat4& world, mat4* pJointMatrices) const;
+
+private:
+	std::vector<i32>  m_parents;
+	std::vector<u32>  m_order; // every parent before its children
+	std::vector<vec3> m_translations;
+	std::vector<quat> m_rotations;
+	std::vector<vec3> m_scales;
+	std::vector<mat4> m_inverseBindMatrices;
+	std::vector<mat4> m_rootMatrices;
+};
+
+// Joints of a glTF skin in the order JOINTS_0 indexes them, nodes between two joints are expected to be joints too
+std::vector<SkeletonJoint> getGltfSkeletonJoints(const GltfModel& model, u32 skinIndex);
+
+// Channels of the animation that target the skin, morph weights and non float outputs are dropped
+AnimationClip createGltfAnimationClip(const GltfModel& model, u32 animationIndex, u32 skinIndex);
+
+// Vertices [first, first + count) of a skinned primitive in bind pose, texture coordinates flipped like packTexCoords
+void packSkinnedVertices(
+	const GltfModel& model, const GltfPrimitive& primitive, u32 first, u32 count, SkinnedVertex* pVertices);
+
+/**
+ * GPU side of the skinning: the bind pose vertices, the joint matrices of every instance and the posed vertices of
+ * every instance, with the compute pipeline writing the latter.
+ */
+class SkinningPass
+{
+public:
+	SkinningPass(u32 verticesCount, u32 jointsCount, u32 instancesCount);
+	SkinningPass(const SkinningPass&) = delete;
+	SkinningPass(SkinningPass&& other) noexcept;
+	~SkinningPass();
+
+public:
+	inline u32 getVerticesCount() const
+	{
+		return m_verticesCount;
+	}
+
+	inline u32 getInstancesCount() const
+	{
+		return m_instancesCount;
+	}
+
+	// Posed vertices of instance i start at i * getVerticesCount()
+	inline u32 getPosedVerticesBuffer() const
+	{
+		return m_posedVerticesBuffer;
+	}
+
+	// Box around the posed vertices of every instance, rebuilt by every dispatch: the ivec4 lower corners of the
+	// instances then their upper corners, floats stored as ordered ints so that atomicMin and atomicMax can grow them
+	inline u32 getPosedBoundsBuffer() const
+	{
+		return m_posedBoundsBuffer;
+	}
+
+	// Bind pose, written once
+	SkinnedVertex* mapSkinnedVertices();
+	void		   unmapSkinnedVertices();
+
+	// Write only, jointsCount matrices per instance, the previous frame's are discarded
+	mat4* mapJointMatrices();
+	void  unmapJointMatrices();
+
+	// Poses every instance, the result is visible to the draws issued after
+	void dispatch() const;
+
+private:
+	Pipeline m_pipeline;
+	u32		 m_skinnedVerticesBuffer;
+	u32		 m_jointMatricesBuffer;
+	u32		 m_posedVerticesBuffer;
+	u32		 m_posedBoundsBuffer;
+	u32		 m_verticesCount;
+	u32		 m_jointsCount;
+	u32		 m_instancesCount;
+};
+
+} // namespace ntt
\ No newline at end of file
@@ -0,0 +1,162 @@
+#pragma once
+#include "common.h"
+#include <new>
+#include <vector>
+
+namespace ntt {
+
+// Index of a slot and the generation it was handed out at, a zero generation is never handed out
+template <typename T>
+struct SlotHandle
+{
+	u32 index;
+	u32 generation;
+
+	inline bool isValid() const
+	{
+		return generation != 0;
+	}
+
+	inline bool operator==(const SlotHandle& other) const
+	{
+		return index == other.index && generation == other.generation;
+	}
+};
+
+/**
+ * Values packed in a dense array addressed through generational handles, typed by THandle so that containers of
+ * wrappers can hand out handles to what they wrap. Slots map a handle to its value and back,
+ * erasing moves the last value into the hole and bumps the generation of the slot, so handles to erased values are
+ * detected instead of aliasing whatever reuses the slot. Iterating walks the dense array only.
+ *
+ * @example
+ * ```c++
+ * SlotMap<Texture>    textures;
+ * SlotHandle<Texture> handle = textures.insert(Texture(path));
+ * textures.get(handle)->bind(0);
+ * textures.erase(handle);
+ * ASSERT(textures.get(handle) == nullptr);
+ * ```
+ */
+
+template <typename T, typename THandle = T>
+class SlotMap
+{
+public:
+	SlotMap()
+		: m_freeSlot(INVALID_SLOT)
+	{
+	}
+	SlotMap(const SlotMap&) = delete;
+	SlotMap(SlotMap&& other) noexcept = default;
+	~SlotMap()						  = default;
+
+public:
+	inline u32 getSize() const
+	{
+		return u32(m_values.size());
+	}
+
+	inline T* begin()
+	{
+		return m_values.data();
+	}
+
+	inline T* end()
+	{
+		return m_values.data() + m_values.size();
+	}
+
+	inline const T* begin() const
+	{
+		return m_values.data();
+	}
+
+	inline const T* end() const
+	{
+		return m_values.data() + m_values.size();
+	}
+
+	// Handle of the value at a dense index, for the values found by iterating
+	inline SlotHandle<THandle> getHandle(u32 denseIndex) const
+	{
+		u32 slot = m_denseSlots[denseIndex];
+		return {slot, m_slots[slot].generation};
+	}
+
+	inline T* get(SlotHandle<THandle> handle)
+	{
+		return contains(handle) ? &m_values[m_slots[handle.index].denseIndex] : nullptr;
+	}
+
+	inline const T* get(SlotHandle<THandle> handle) const
+	{
+		return contains(handle) ? &m_values[m_slots[handle.index].denseIndex] : nullptr;
+	}
+
+	inline bool contains(SlotHandle<THandle> handle) const
+	{
+		return handle.isValid() && handle.index < m_slots.size() &&
+			   m_slots[handle.index].generation == handle.generation;
+	}
+
+	SlotHandle<THandle> insert(T&& value)
+	{
+		u32 slot = m_freeSlot;
+		if (slot != INVALID_SLOT)
+		{
+			m_freeSlot = m_slots[slot].denseIndex;
+		}
+		else
+		{
+			slot = u32(m_slots.size());
+			m_slots.push_back({0, 1});
+		}
+
+		Slot& entry		 = m_slots[slot];
+		entry.denseIndex = u32(m_values.size());
+		m_values.push_back(std::move(value));
+		m_denseSlots.push_back(slot);
+		return {slot, entry.generation};
+	}
+
+	void erase(SlotHandle<THandle> handle)
+	{
+		ASSERT(contains(handle));
+		Slot& entry = m_slots[handle.index];
+
+		// Rebuilt in place rather than assigned, resources only have move constructors
+		u32 last = u32(m_values.size()) - 1;
+		if (entry.denseIndex != last)
+		{
+			T* pHole = &m_values[entry.denseIndex];
+			pHole->~T();
+			new (pHole) T(std::move(m_values[last]));
+			m_denseSlots[entry.denseIndex]		   = m_denseSlots[last];
+			m_slots[m_denseSlots[last]].denseIndex = entry.denseIndex;
+		}
+		m_values.pop_back();
+		m_denseSlots.pop_back();
+
+		// Handles to the erased value miss from now on, generations skip 0 when they wrap around
+		entry.generation = entry.generation + 1 != 0 ? entry.generation + 1 : 1;
+		entry.denseIndex = m_freeSlot;
+		m_freeSlot		 = handle.index;
+	}
+
+private:
+	static constexpr u32 INVALID_SLOT = ~0u;
+
+	struct Slot
+	{
+		u32 denseIndex; // next free slot while free
+		u32 generation;
+	};
+
+	std::vector<T>	  m_values;
+	std::vector<u32>  m_denseSlots; // slot of every value
+	std::vector<Slot> m_slots;
+	u32				  m_freeSlot;
+};
+
+} // namespace ntt
\ No newline at end of file
@@ -1,22 +1,58 @@
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h>
 
+#include "file_system.h"
 #include "texture.h"
 
 namespace ntt {
 
+TextureImage::TextureImage(const std::string& path)
+	: m_pPixels(nullptr)
+	, m_width(0)
+	, m_height(0)
+	, m_channels(0)
+{
+	FileView file(path);
+	ASSERT(file.isOpen());
+
+	m_pPixels = stbi_load_from_memory(file.getData(), i32(file.getSize()), &m_width, &m_height, &m_channels, 0);
+	ASSERT(m_pPixels != nullptr);
+}
+
+TextureImage::TextureImage(TextureImage&& other) noexcept
+	: m_pPixels(other.m_pPixels)
+	, m_width(other.m_width)
+	, m_height(other.m_height)
+	, m_channels(other.m_channels)
+{
+	other.m_pPixels = nullptr;
+}
+
+TextureImage::~TextureImage()
+{
+	if (m_pPixels != nullptr)
+	{
+		stbi_image_free(m_pPixels);
+		m_pPixels = nullptr;
+	}
+}
+
 Texture::Texture(const std::string& path)
+	: Texture(TextureImage(path))
+{
+}
+
+Texture::Texture(const TextureImage& image)
 	: m_textureId(0)
 	, m_unit(-1)
 {
-	i32 width, height, channels;
-
-	u8* data = stbi_load(path.c_str(), &width, &height, &channels, 0);
-	ASSERT(data != nullptr);
+	i32		  width	 = image.getWidth();
+	i32		  height = image.getHeight();
+	const u8* data	 = image.getPixels();
 
 	GL_ASSERT(glCreateTextures(GL_TEXTURE_2D, 1, &m_textureId));
 
-	switch (channels)
+	switch (image.getChannels())
 	{
 	case 3:
 		GL_ASSERT(glTextureStorage2D(m_textureId, 1, GL_RGB8, width, height));
@@ -34,8 +70,6 @@ Texture::Texture(const std::string& path)
 	GL_ASSERT(glTextureParameteri(m_textureId, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
 	GL_ASSERT(glTextureParameteri(m_textureId, GL_TEXTURE_WRAP_S, GL_REPEAT));
 	GL_ASSERT(glTextureParameteri(m_textureId, GL_TEXTURE_WRAP_T, GL_REPEAT));
-
-	stbi_image_free(data);
 }
 
 Texture::Texture(Texture&& other) noexcept
@@ -4,10 +4,48 @@
 
 namespace ntt {
 
+// Pixels decoded from an image file, needs no GL context so any thread can decode while the main one uploads
+class TextureImage
+{
+public:
+	TextureImage(const std::string& path);
+	TextureImage(const TextureImage&) = delete;
+	TextureImage(TextureImage&& other) noexcept;
+	~TextureImage();
+
+public:
+	inline i32 getWidth() const
+	{
+		return m_width;
+	}
+
+	inline i32 getHeight() const
+	{
+		return m_height;
+	}
+
+	inline i32 getChannels() const
+	{
+		return m_channels;
+	}
+
+	inline const u8* getPixels() const
+	{
+		return m_pPixels;
+	}
+
+private:
+	u8* m_pPixels;
+	i32 m_width;
+	i32 m_height;
+	i32 m_channels;
+};
+
 class Texture
 {
 public:
 	Texture(const std::string& path);
+	Texture(const TextureImage& image);
 	Texture(const Texture&) = delete;
 	Texture(Texture&&) noexcept;
 	~Texture();
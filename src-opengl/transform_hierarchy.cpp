@@ -0,0 +1,210 @@
+#include "transform_hierarchy.h"
+#include "job_system.h"
+#include <algorithm>
+#include <atomic>
+#include <easy/profiler.h>
+
+#if defined(__SSE__)
+#include <xmmintrin.h>
+#endif
+
+// Levels smaller than two batches are updated on the calling thread, jobs would cost more than they save
+#define TRANSFORM_UPDATE_BATCH_SIZE 4096
+
+namespace ntt {
+
+void multiplyMatrices(const mat4& a, const mat4& b, mat4& result)
+{
+#if defined(__SSE__)
+	// Every result column is the columns of a weighted by one column of b
+	__m128 a0 = _mm_loadu_ps(&a[0][0]);
+	__m128 a1 = _mm_loadu_ps(&a[1][0]);
+	__m128 a2 = _mm_loadu_ps(&a[2][0]);
+	__m128 a3 = _mm_loadu_ps(&a[3][0]);
+	for (u32 column = 0u; column < 4u; ++column)
+	{
+		__m128 value = _mm_mul_ps(a0, _mm_set1_ps(b[column][0]));
+		value		 = _mm_add_ps(value, _mm_mul_ps(a1, _mm_set1_ps(b[column][1])));
+		value		 = _mm_add_ps(value, _mm_mul_ps(a2, _mm_set1_ps(b[column][2])));
+		value		 = _mm_add_ps(value, _mm_mul_ps(a3, _mm_set1_ps(b[column][3])));
+		_mm_storeu_ps(&result[column][0], value);
+	}
+#else
+	mat4 product = a * b;
+	result		 = product;
+#endif
+}
+
+void composeTransform(const vec3& translation, const quat& rotation, const vec3& scale, mat4& result)
+{
+	f32 xx = rotation.x * rotation.x;
+	f32 yy = rotation.y * rotation.y;
+	f32 zz = rotation.z * rotation.z;
+	f32 xy = rotation.x * rotation.y;
+	f32 xz = rotation.x * rotation.z;
+	f32 yz = rotation.y * rotation.z;
+	f32 wx = rotation.w * rotation.x;
+	f32 wy = rotation.w * rotation.y;
+	f32 wz = rotation.w * rotation.z;
+
+	result[0] = vec4((1.0f - 2.0f * (yy + zz)) * scale.x, 2.0f * (xy + wz) * scale.x, 2.0f * (xz - wy) * scale.x, 0.0f);
+	result[1] = vec4(2.0f * (xy - wz) * scale.y, (1.0f - 2.0f * (xx + zz)) * scale.y, 2.0f * (yz + wx) * scale.y, 0.0f);
+	result[2] = vec4(2.0f * (xz + wy) * scale.z, 2.0f * (yz - wx) * scale.z, (1.0f - 2.0f * (xx + yy)) * scale.z, 0.0f);
+	result[3] = vec4(translation.x, translation.y, translation.z, 1.0f);
+}
+
+TransformHierarchy::TransformHierarchy(const std::vector<TransformNode>& nodes)
+	: m_frame(0)
+	, m_firstDirtyLevel(0)
+{
+	u32 nodesCount = u32(nodes.size());
+
+	// Depth of every node, parents may come after their children in the source list
+	std::vector<i32> depths(nodesCount, -1);
+	for (u32 sourceIndex = 0u; sourceIndex < nodesCount; ++sourceIndex)
+	{
+		std::vector<u32> chain;
+		u32				 node = sourceIndex;
+		while (depths[node] < 0 && nodes[node].parent >= 0)
+		{
+			chain.push_back(node);
+			node = u32(nodes[node].parent);
+			ASSERT(chain.size() <= nodesCount && "Cycle in the transform hierarchy");
+		}
+		i32 depth	 = depths[node] >= 0 ? depths[node] : 0;
+		depths[node] = depth;
+		for (auto chainNode = chain.rbegin(); chainNode != chain.rend(); ++chainNode)
+		{
+			depths[*chainNode] = ++depth;
+		}
+	}
+
+	// Stable, siblings keep their source order within a level
+	std::vector<u32> order(nodesCount);
+	for (u32 sourceIndex = 0u; sourceIndex < nodesCount; ++sourceIndex)
+	{
+		order[sourceIndex] = sourceIndex;
+	}
+	std::stable_sort(order.begin(), order.end(), [&](u32 a, u32 b) { return depths[a] < depths[b]; });
+
+	m_sourceToNode.resize(nodesCount);
+	for (u32 node = 0u; node < nodesCount; ++node)
+	{
+		m_sourceToNode[order[node]] = node;
+	}
+
+	m_parents.resize(nodesCount);
+	m_translations.resize(nodesCount);
+	m_rotations.resize(nodesCount);
+	m_scales.resize(nodesCount);
+	m_localDirty.assign(nodesCount, 1);
+	m_updatedFrames.assign(nodesCount, 0);
+	m_worldMatrices.resize(nodesCount, mat4(1.0f));
+	for (u32 node = 0u; node < nodesCount; ++node)
+	{
+		const TransformNode& source = nodes[order[node]];
+		m_parents[node]				= source.parent >= 0 ? i32(m_sourceToNode[source.parent]) : -1;
+		m_translations[node]		= source.translation;
+		m_rotations[node]			= source.rotation;
+		m_scales[node]				= source.scale;
+
+		if (node == 0 || depths[order[node]] != depths[order[node - 1]])
+		{
+			m_levelStarts.push_back(node);
+		}
+	}
+	m_levelStarts.push_back(nodesCount);
+}
+
+TransformHierarchy::TransformHierarchy(TransformHierarchy&& other) noexcept
+	: m_parents(std::move(other.m_parents))
+	, m_translations(std::move(other.m_translations))
+	, m_rotations(std::move(other.m_rotations))
+	, m_scales(std::move(other.m_scales))
+	, m_localDirty(std::move(other.m_localDirty))
+	, m_updatedFrames(std::move(other.m_updatedFrames))
+	, m_worldMatrices(std::move(other.m_worldMatrices))
+	, m_levelStarts(std::move(other.m_levelStarts))
+	, m_sourceToNode(std::move(other.m_sourceToNode))
+	, m_frame(other.m_frame)
+	, m_firstDirtyLevel(other.m_firstDirtyLevel)
+{
+	other.m_levelStarts = {0};
+}
+
+void TransformHierarchy::setLocalTransform(u32 node, const vec3& translation, const quat& rotation, const vec3& scale)
+{
+	m_translations[node] = translation;
+	m_rotations[node]	 = rotation;
+	m_scales[node]		 = scale;
+	m_localDirty[node]	 = 1;
+
+	auto levelEnd	  = std::upper_bound(m_levelStarts.begin(), m_levelStarts.end(), node);
+	m_firstDirtyLevel = std::min(m_firstDirtyLevel, u32(levelEnd - m_levelStarts.begin()) - 1);
+}
+
+u32 TransformHierarchy::update(JobSystem* pJobSystem)
+{
+	EASY_FUNCTION();
+
+	u32 levelsCount = getLevelsCount();
+	if (m_firstDirtyLevel >= levelsCount)
+	{
+		return 0;
+	}
+
+	// A fresh frame number invalidates every "recomputed by this update" mark at once
+	m_frame++;
+
+	std::atomic<u32> updatedCount(0);
+	for (u32 level = m_firstDirtyLevel; level < levelsCount; ++level)
+	{
+		u32 begin = m_levelStarts[level];
+		u32 end	  = m_levelStarts[level + 1];
+		if (pJobSystem == nullptr || end - begin < 2 * TRANSFORM_UPDATE_BATCH_SIZE)
+		{
+			updatedCount += updateNodes(begin, end);
+			continue;
+		}
+
+		pJobSystem->parallelFor(
+			"Update transforms", end - begin, TRANSFORM_UPDATE_BATCH_SIZE, [&](u32 batchBegin, u32 batchEnd) {
+				updatedCount += updateNodes(begin + batchBegin, begin + batchEnd);
+			});
+	}
+
+	m_firstDirtyLevel = levelsCount;
+	return updatedCount;
+}
+
+u32 TransformHierarchy::updateNodes(u32 begin, u32 end)
+{
+	u32 updatedCount = 0;
+	for (u32 node = begin; node < end; ++node)
+	{
+		i32	 parent		   = m_parents[node];
+		bool parentUpdated = parent >= 0 && m_updatedFrames[parent] == m_frame;
+		if (!m_localDirty[node] && !parentUpdated)
+		{
+			continue;
+		}
+
+		mat4 local;
+		composeTransform(m_translations[node], m_rotations[node], m_scales[node], local);
+		if (parent >= 0)
+		{
+			multiplyMatrices(m_worldMatrices[parent], local, m_worldMatrices[node]);
+		}
+		else
+		{
+			m_worldMatrices[node] = local;
+		}
+
+		m_localDirty[node]	  = 0;
+		m_updatedFrames[node] = m_frame;
+		updatedCount++;
+	}
+	return updatedCount;
+}
+
+} // namespace ntt
\ No newline at end of file
@@ -0,0 +1,99 @@
+#pragma once
+#include "common.h"
+#include <vector>
+
+namespace ntt {
+
+class JobSystem;
+
+/**
+ * Node transforms in structure-of-arrays form, sorted by depth: every parent is stored before its children and every
+ * depth level is contiguous. `update` walks the levels in order, a node is recomputed only when its local transform
+ * changed or its parent was recomputed in the same update, so untouched subtrees cost a flag test per node and levels
+ * above the shallowest change are not visited at all. The nodes of a level only read the previous one, a level is
+ * split over jobs when it is large enough.
+ *
+ * @example
+ * ```c++
+ * std::vector<TransformNode> nodes = {{-1, translation, rotation, scale}, {0, ...}};
+ * TransformHierarchy hierarchy(nodes);
+ * u32 child = hierarchy.getNode(1);
+ *
+ * hierarchy.setLocalTransform(hierarchy.getNode(0), translation, glm::angleAxis(time, up), scale);
+ * hierarchy.update(&jobSystem);
+ * const mat4& model = hierarchy.getWorldMatrix(child);
+ * ```
+ */
+
+struct TransformNode
+{
+	i32	 parent; // index in the list given to the hierarchy, -1 for roots
+	vec3 translation;
+	quat rotation;
+	vec3 scale;
+};
+
+class TransformHierarchy
+{
+public:
+	TransformHierarchy(const std::vector<TransformNode>& nodes);
+	TransformHierarchy(const TransformHierarchy&) = delete;
+	TransformHierarchy(TransformHierarchy&& other) noexcept;
+	~TransformHierarchy() = default;
+
+public:
+	inline u32 getNodesCount() const
+	{
+		return u32(m_parents.size());
+	}
+
+	inline u32 getLevelsCount() const
+	{
+		return u32(m_levelStarts.size()) - 1;
+	}
+
+	// Where a node given to the constructor ended up once sorted by depth
+	inline u32 getNode(u32 sourceIndex) const
+	{
+		return m_sourceToNode[sourceIndex];
+	}
+
+	// Up to date as of the last update
+	inline const mat4& getWorldMatrix(u32 node) const
+	{
+		return m_worldMatrices[node];
+	}
+
+	// Not thread-safe, transforms are set from one thread between updates
+	void setLocalTransform(u32 node, const vec3& translation, const quat& rotation, const vec3& scale);
+
+	// Recomputes the world matrices of the changed subtrees, on the job system when given one. Returns how many were
+	// recomputed
+	u32 update(JobSystem* pJobSystem);
+
+private:
+	u32 updateNodes(u32 begin, u32 end);
+
+private:
+	std::vector<i32>  m_parents; // sorted indices, always lower than the node's own
+	std::vector<vec3> m_translations;
+	std::vector<quat> m_rotations;
+	std::vector<vec3> m_scales;
+	std::vector<u8>	  m_localDirty;
+	std::vector<u32>  m_updatedFrames; // update that last recomputed the world matrix, children compare it with theirs
+	std::vector<mat4> m_worldMatrices;
+
+	std::vector<u32> m_levelStarts; // first node of every level, then the nodes count
+	std::vector<u32> m_sourceToNode;
+
+	u32 m_frame;
+	u32 m_firstDirtyLevel; // levels count when nothing changed
+};
+
+// Column-major a * b, SSE when available
+void multiplyMatrices(const mat4& a, const mat4& b, mat4& result);
+
+// T * R * S without going through three full matrix products
+void composeTransform(const vec3& translation, const quat& rotation, const vec3& scale, mat4& result);
+
+} // namespace ntt
\ No newline at end of file
@@ -1,23 +1,24 @@
 #include "utils.h"
 #include "common.h"
-#include <fstream>
+#include <cstring>
 
 namespace ntt {
 
-std::string readFile(const std::string& filepath)
+bool hasExtension(const char* name)
 {
-	std::ifstream fileStream(filepath, std::ios::in);
-	ASSERT(fileStream.is_open());
+	i32 extensionsCount = 0;
+	GL_ASSERT(glGetIntegerv(GL_NUM_EXTENSIONS, &extensionsCount));
 
-	std::string content;
-	std::string line;
-	while (std::getline(fileStream, line))
+	for (i32 extensionIndex = 0; extensionIndex < extensionsCount; ++extensionIndex)
 	{
-		content += line + "\n";
+		const char* extension = (const char*)glGetStringi(GL_EXTENSIONS, extensionIndex);
+		if (extension != nullptr && strcmp(extension, name) == 0)
+		{
+			return true;
+		}
 	}
 
-	fileStream.close();
-	return content;
+	return false;
 }
 
 } // namespace ntt
\ No newline at end of file
@@ -2,6 +2,7 @@
 
 namespace ntt {
 
-std::string readFile(const std::string& filepath);
+// Whether the current context exposes the extension, e.g. "GL_NV_fragment_shader_barycentric"
+bool hasExtension(const char* name);
 
 } // namespace ntt
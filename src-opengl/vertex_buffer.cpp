@@ -1,87 +1,263 @@
 #include "vertex_buffer.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
 
 namespace ntt {
 
-static u32 getAttributeTypeBytes(VertexAttributeType type)
+static GLenum getComponentType(VertexComponentType type)
 {
 	switch (type)
 	{
-	case VertexAttributeType::FLOAT:
-		return 1;
-	case VertexAttributeType::VEC2:
-		return 2;
-	case VertexAttributeType::VEC3:
-		return 3;
-	case VertexAttributeType::VEC4:
-		return 4;
+	case VertexComponentType::FLOAT:
+		return GL_FLOAT;
+	case VertexComponentType::HALF:
+		return GL_HALF_FLOAT;
+	case VertexComponentType::BYTE:
+		return GL_BYTE;
+	case VertexComponentType::UNSIGNED_BYTE:
+		return GL_UNSIGNED_BYTE;
+	case VertexComponentType::SHORT:
+		return GL_SHORT;
+	case VertexComponentType::UNSIGNED_SHORT:
+		return GL_UNSIGNED_SHORT;
+	case VertexComponentType::INT_2_10_10_10:
+		return GL_INT_2_10_10_10_REV;
+	case VertexComponentType::UINT_2_10_10_10:
+		return GL_UNSIGNED_INT_2_10_10_10_REV;
 	default:
-		ASSERT(false && "Unknown VertexAttributeType");
+		ASSERT(false && "Unknown VertexComponentType");
 		return 0;
 	}
 }
 
-VertexBuffer::VertexBuffer(const std::initializer_list<VertexAttributeType>& attributeTypes)
+VertexFormat::VertexFormat(const VertexLayoutAttribute* pAttributes, u32 attributesCount, u32 stride)
+	: m_stride(stride)
 {
-	GL_ASSERT(glGenBuffers(1, &m_vbo));
+	GL_ASSERT(glCreateVertexArrays(1, &m_vao));
 
-	GL_ASSERT(glGenVertexArrays(1, &m_vao));
-	GL_ASSERT(glBindVertexArray(m_vao));
-	GL_ASSERT(glBindBuffer(GL_ARRAY_BUFFER, m_vbo));
+	for (u32 location = 0u; location < attributesCount; ++location)
+	{
+		const VertexLayoutAttribute& attribute = pAttributes[location];
+		VertexAttributeFormat		 format	   = getVertexAttributeFormat(attribute.type);
+		GLenum						 type	   = getComponentType(format.componentType);
+
+		GL_ASSERT(glEnableVertexArrayAttrib(m_vao, location));
+		if (format.integer)
+		{
+			GL_ASSERT(glVertexArrayAttribIFormat(m_vao, location, format.componentsCount, type, attribute.offset));
+		}
+		else
+		{
+			GL_ASSERT(glVertexArrayAttribFormat(
+				m_vao, location, format.componentsCount, type, format.normalized, attribute.offset));
+		}
+		GL_ASSERT(glVertexArrayAttribBinding(m_vao, location, 0));
+	}
+}
 
-	u32 attributesCount = u32(attributeTypes.size());
-	m_attributes.resize(attributesCount);
+VertexFormat::VertexFormat(VertexFormat&& other) noexcept
+	: m_vao(other.m_vao)
+	, m_stride(other.m_stride)
+{
+	other.m_vao = 0;
+}
 
-	u32 bytes = 0;
-	for (const auto& type : attributeTypes)
+VertexFormat::~VertexFormat()
+{
+	if (m_vao != 0)
 	{
-		bytes += getAttributeTypeBytes(type);
+		GL_ASSERT(glDeleteVertexArrays(1, &m_vao));
+		m_vao = 0;
 	}
+}
+
+VertexBuffer::VertexBuffer(const VertexFormat& format, VertexBufferUsage usage, u32 capacity, const void* pData)
+	: m_vao(format.getVertexArrayId())
+	, m_stride(format.getStride())
+	, m_capacity(capacity)
+	, m_offset(0)
+	, m_usage(usage)
+	, m_pPersistent(nullptr)
+	, m_region(VERTEX_STREAM_FRAMES - 1)
+	, m_fences{}
+{
+	ASSERT(capacity > 0);
+	GL_ASSERT(glCreateBuffers(1, &m_vbo));
 
-	u32 offset = 0;
-	for (u32 i = 0; i < attributesCount; ++i)
+	switch (usage)
 	{
-		VertexAttributeType type = *(std::next(attributeTypes.begin(), i));
-		VertexAttribute&	attr = m_attributes[i];
-		attr.size				 = getAttributeTypeBytes(type);
-
-		GL_ASSERT(glEnableVertexAttribArray(i));
-		GL_ASSERT(glVertexAttribPointer(
-			i, attr.size, GL_FLOAT, GL_FALSE, bytes * sizeof(float), (void*)(uintptr_t)(offset * sizeof(float))));
-		offset += attr.size;
+	case VertexBufferUsage::STATIC:
+		ASSERT(pData != nullptr);
+		GL_ASSERT(glNamedBufferStorage(m_vbo, capacity, pData, 0));
+		break;
+	case VertexBufferUsage::DYNAMIC:
+		GL_ASSERT(glNamedBufferStorage(m_vbo, capacity, pData, GL_DYNAMIC_STORAGE_BIT | GL_MAP_WRITE_BIT));
+		break;
+	case VertexBufferUsage::STREAM_ORPHAN:
+		// Mutable storage, glNamedBufferData is what orphans it
+		GL_ASSERT(glNamedBufferData(m_vbo, capacity, pData, GL_STREAM_DRAW));
+		break;
+	case VertexBufferUsage::STREAM_PERSISTENT:
+	{
+		GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		GL_ASSERT(glNamedBufferStorage(m_vbo, u64(capacity) * VERTEX_STREAM_FRAMES, nullptr, flags));
+		m_pPersistent = (u8*)glMapNamedBufferRange(m_vbo, 0, u64(capacity) * VERTEX_STREAM_FRAMES, flags);
+		ASSERT(m_pPersistent != nullptr);
+		if (pData != nullptr)
+		{
+			memcpy(m_pPersistent + m_region * capacity, pData, capacity);
+			m_offset = m_region * capacity;
+		}
+		break;
+	}
 	}
-
-	unbind();
 }
 
 VertexBuffer::VertexBuffer(VertexBuffer&& other) noexcept
-	: m_attributes(other.m_attributes)
-	, m_vao(other.m_vao)
+	: m_vao(other.m_vao)
+	, m_stride(other.m_stride)
 	, m_vbo(other.m_vbo)
+	, m_capacity(other.m_capacity)
+	, m_offset(other.m_offset)
+	, m_usage(other.m_usage)
+	, m_pPersistent(other.m_pPersistent)
+	, m_region(other.m_region)
 {
-	other.m_vao = 0;
-	other.m_vbo = 0;
+	std::copy(other.m_fences, other.m_fences + VERTEX_STREAM_FRAMES, m_fences);
+	std::fill(other.m_fences, other.m_fences + VERTEX_STREAM_FRAMES, nullptr);
+	other.m_vbo			= 0;
+	other.m_pPersistent = nullptr;
 }
 
 VertexBuffer::~VertexBuffer()
 {
+	for (GLsync& fence : m_fences)
+	{
+		if (fence != nullptr)
+		{
+			GL_ASSERT(glDeleteSync(fence));
+			fence = nullptr;
+		}
+	}
+
+	if (m_pPersistent != nullptr)
+	{
+		GL_ASSERT(glUnmapNamedBuffer(m_vbo));
+		m_pPersistent = nullptr;
+	}
+
 	if (m_vbo != 0)
 	{
 		GL_ASSERT(glDeleteBuffers(1, &m_vbo));
 		m_vbo = 0;
 	}
+}
 
-	if (m_vao != 0)
+void VertexBuffer::update(const void* pData, u32 size)
+{
+	ASSERT(m_usage != VertexBufferUsage::STATIC && size <= m_capacity);
+	if (m_usage == VertexBufferUsage::DYNAMIC)
 	{
-		GL_ASSERT(glDeleteVertexArrays(1, &m_vao));
-		m_vao = 0;
+		GL_ASSERT(glNamedBufferSubData(m_vbo, 0, size, pData));
+		return;
+	}
+
+	memcpy(map(size), pData, size);
+	unmap();
+}
+
+void* VertexBuffer::map(u32 size)
+{
+	ASSERT(m_usage != VertexBufferUsage::STATIC && size <= m_capacity);
+
+	if (m_usage == VertexBufferUsage::STREAM_PERSISTENT)
+	{
+		// Everything queued so far, the draws reading the current region included, is behind this fence
+		m_fences[m_region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		m_region		   = (m_region + 1) % VERTEX_STREAM_FRAMES;
+		m_offset		   = m_region * m_capacity;
+
+		if (m_fences[m_region] != nullptr)
+		{
+			GLenum result = glClientWaitSync(m_fences[m_region], GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+			while (result == GL_TIMEOUT_EXPIRED)
+			{
+				result = glClientWaitSync(m_fences[m_region], 0, 1000000);
+			}
+			ASSERT(result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED);
+			GL_ASSERT(glDeleteSync(m_fences[m_region]));
+			m_fences[m_region] = nullptr;
+		}
+		return m_pPersistent + m_offset;
+	}
+
+	if (m_usage == VertexBufferUsage::STREAM_ORPHAN)
+	{
+		// The draws still reading the old storage keep it, the driver hands out a fresh one
+		GL_ASSERT(glNamedBufferData(m_vbo, m_capacity, nullptr, GL_STREAM_DRAW));
+	}
+
+	void* pData = glMapNamedBufferRange(m_vbo, 0, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+	ASSERT(pData != nullptr);
+	return pData;
+}
+
+void VertexBuffer::unmap()
+{
+	// Persistent mappings stay, the coherent writes are visible to the draws issued after
+	if (m_usage != VertexBufferUsage::STREAM_PERSISTENT)
+	{
+		GL_ASSERT(glUnmapNamedBuffer(m_vbo));
+	}
+}
+
+u16 packHalf(f32 value)
+{
+	u32 bits;
+	memcpy(&bits, &value, sizeof(bits));
+
+	u32 sign	 = (bits >> 16) & 0x8000u;
+	i32 exponent = i32((bits >> 23) & 0xFFu) - 127 + 15;
+	u32 mantissa = bits & 0x7FFFFFu;
+
+	if (exponent >= 31)
+	{
+		// Infinity and NaN keep their class, overflows become infinity
+		bool nan = ((bits >> 23) & 0xFFu) == 0xFFu && mantissa != 0;
+		return u16(sign | 0x7C00u | (nan ? 0x200u : 0u));
 	}
+	if (exponent <= 0)
+	{
+		// Subnormal or zero
+		if (exponent < -10)
+		{
+			return u16(sign);
+		}
+		mantissa |= 0x800000u;
+		u32 shift = u32(14 - exponent);
+		u32 half  = mantissa >> shift;
+		u32 rest  = mantissa & ((1u << shift) - 1);
+		u32 tie	  = 1u << (shift - 1);
+		half += rest > tie || (rest == tie && (half & 1u) != 0) ? 1 : 0;
+		return u16(sign | half);
+	}
+
+	// Round to nearest even, a carry out of the mantissa bumps the exponent
+	u32 half = sign | (u32(exponent) << 10) | (mantissa >> 13);
+	u32 rest = mantissa & 0x1FFFu;
+	half += rest > 0x1000u || (rest == 0x1000u && (half & 1u) != 0) ? 1 : 0;
+	return u16(half);
 }
 
-void VertexBuffer::update(const void* data, u32 size)
+u32 packSnorm1010102(const vec4& value)
 {
-	bind();
-	GL_ASSERT(glBufferData(GL_ARRAY_BUFFER, size, data, GL_STATIC_DRAW));
-	unbind();
+	auto pack = [](f32 component, f32 scale, u32 mask) {
+		i32 quantized = i32(std::round(std::min(std::max(component, -1.0f), 1.0f) * scale));
+		return u32(quantized) & mask;
+	};
+	return pack(value.x, 511.0f, 0x3FFu) | (pack(value.y, 511.0f, 0x3FFu) << 10) |
+		   (pack(value.z, 511.0f, 0x3FFu) << 20) | (pack(value.w, 1.0f, 0x3u) << 30);
 }
 
-} // namespace ntt
+} // namespace ntt
\ No newline at end of file
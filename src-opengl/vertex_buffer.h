@@ -1,58 +1,142 @@
 #pragma once
 #include "common.h"
-#include <vector>
+#include "vertex_layout.h"
 
 namespace ntt {
 
-enum class VertexAttributeType
+enum class VertexBufferUsage
 {
-	FLOAT,
-	VEC2,
-	VEC3,
-	VEC4,
+	STATIC,			   // immutable storage written by the constructor
+	DYNAMIC,		   // rewritten now and then, in place
+	STREAM_ORPHAN,	   // rewritten every frame, the storage is orphaned before every write
+	STREAM_PERSISTENT, // rewritten every frame into a persistently mapped ring of VERTEX_STREAM_FRAMES regions
 };
 
-struct VertexAttribute
+// Regions of a persistently mapped stream, a region is written again once the frames after it are queued
+#define VERTEX_STREAM_FRAMES 3
+
+/**
+ * Vertex array holding only the attribute formats of a vertex struct, read from binding 0 at the offsets of its
+ * `VERTEX_LAYOUT`. Meshes of the same struct share one format and a `VertexBuffer` points the binding at its storage
+ * before the draw.
+ *
+ * @example
+ * ```c++
+ * VertexFormat meshFormat = VertexFormat::create<MeshVertex>();
+ * VertexBuffer duck(meshFormat, VertexBufferUsage::STATIC, duckSize, pDuckVertices);
+ * VertexBuffer rock(meshFormat, VertexBufferUsage::STATIC, rockSize, pRockVertices);
+ * ```
+ */
+
+class VertexFormat
 {
-	u32 size;
+public:
+	template <typename TVertex>
+	static VertexFormat create()
+	{
+		return VertexFormat(VertexLayout<TVertex>::attributes, VertexLayout<TVertex>::attributesCount, sizeof(TVertex));
+	}
+
+	VertexFormat(const VertexFormat&) = delete;
+	VertexFormat(VertexFormat&& other) noexcept;
+	~VertexFormat();
+
+public:
+	inline u32 getVertexArrayId() const
+	{
+		return m_vao;
+	}
+
+	// Bytes per vertex
+	inline u32 getStride() const
+	{
+		return m_stride;
+	}
+
+private:
+	VertexFormat(const VertexLayoutAttribute* pAttributes, u32 attributesCount, u32 stride);
+
+private:
+	u32 m_vao;
+	u32 m_stride;
 };
 
 /**
+ * Interleaved vertices of a `VertexFormat`. Static buffers are written once by the constructor, dynamic ones are
+ * updated in place and streams are rewritten every frame, either into orphaned storage or into the next region of a
+ * persistent mapping. A region is fenced when the one after it is mapped, so it is only waited on once it comes back
+ * around VERTEX_STREAM_FRAMES writes later. `bind` points the format at the data written last.
+ *
  * @example
  * ```c++
- * VertexBuffer vertexBuffer(VEC2, VEC3, VEC2);
- * vertexBuffer.update(data, dataSize);
- * vertexBuffer.bind();
+ * VertexBuffer lines(format, VertexBufferUsage::STREAM_PERSISTENT, maxVerticesCount * format.getStride());
+ * memcpy(lines.map(size), pVertices, size);
+ * lines.unmap();
+ * lines.bind();
+ * glDrawArrays(GL_LINES, 0, size / format.getStride());
  * ```
  */
 
 class VertexBuffer
 {
 public:
-	VertexBuffer(const std::initializer_list<VertexAttributeType>& attributeTypes);
+	VertexBuffer(const VertexFormat& format, VertexBufferUsage usage, u32 capacity, const void* pData = nullptr);
 	VertexBuffer(const VertexBuffer&) = delete;
-	VertexBuffer(VertexBuffer&&) noexcept;
+	VertexBuffer(VertexBuffer&& other) noexcept;
 	~VertexBuffer();
 
 public:
+	inline u32 getBufferId() const
+	{
+		return m_vbo;
+	}
+
+	// Bytes, per region for persistent streams
+	inline u32 getCapacity() const
+	{
+		return m_capacity;
+	}
+
+	inline VertexBufferUsage getUsage() const
+	{
+		return m_usage;
+	}
+
+	// Binds the format with binding 0 on the written vertices
 	inline void bind() const
 	{
+		GL_ASSERT(glVertexArrayVertexBuffer(m_vao, 0, m_vbo, m_offset, i32(m_stride)));
 		GL_ASSERT(glBindVertexArray(m_vao));
-		GL_ASSERT(glBindBuffer(GL_ARRAY_BUFFER, m_vbo));
 	}
 
 	inline void unbind() const
 	{
 		GL_ASSERT(glBindVertexArray(0));
-		GL_ASSERT(glBindBuffer(GL_ARRAY_BUFFER, 0));
 	}
 
-	void update(const void* data, u32 size);
+	// Dynamic and streaming buffers only, size bytes from the first vertex
+	void update(const void* pData, u32 size);
+
+	// Write only, the whole previous content is discarded
+	void* map(u32 size);
+	void  unmap();
 
 private:
-	std::vector<VertexAttribute> m_attributes;
-	u32							 m_vao;
-	u32							 m_vbo;
+	u32				  m_vao;
+	u32				  m_stride;
+	u32				  m_vbo;
+	u32				  m_capacity;
+	u32				  m_offset; // start of the written vertices
+	VertexBufferUsage m_usage;
+	u8*				  m_pPersistent;
+	u32				  m_region;
+	GLsync			  m_fences[VERTEX_STREAM_FRAMES];
 };
 
-}; // namespace ntt
\ No newline at end of file
+// IEEE 754 binary16, rounded to nearest, for HALF2 and HALF4
+u16 packHalf(f32 value);
+
+// Components clamped to [-1, 1], for INT_2_10_10_10_NORM
+u32 packSnorm1010102(const vec4& value);
+
+} // namespace ntt
\ No newline at end of file
@@ -0,0 +1,297 @@
+#include "bindless.h"
+#include <algorithm>
+#include <mutex>
+
+struct RetiredSlot
+{
+	u32 slot;
+	u64 frameNumber;
+};
+
+struct BindlessSlots
+{
+	u32						 capacity;
+	u32						 nextSlot; // slots below have been handed out at least once
+	std::vector<u32>		 freeSlots;
+	std::vector<RetiredSlot> retiredSlots;
+};
+
+struct BindlessTable
+{
+	VkDevice device;
+	u32		 framesInFlight;
+	u64		 frameNumber;
+
+	VkDescriptorSetLayout setLayout;
+	VkPipelineLayout	  pipelineLayout;
+	VkDescriptorPool	  descriptorPool;
+	VkDescriptorSet		  descriptorSet;
+	u32					  pushConstantsSize;
+
+	BindlessSlots textures;
+	BindlessSlots buffers;
+
+	std::mutex mutex;
+};
+
+static u32 allocateSlot(BindlessSlots& slots)
+{
+	if (!slots.freeSlots.empty())
+	{
+		u32 slot = slots.freeSlots.back();
+		slots.freeSlots.pop_back();
+		return slot;
+	}
+
+	ASSERT(slots.nextSlot < slots.capacity);
+	return slots.nextSlot++;
+}
+
+static void retireSlot(BindlessSlots& slots, u32 slot, u64 frameNumber)
+{
+	ASSERT(slot < slots.nextSlot);
+	slots.retiredSlots.push_back({slot, frameNumber});
+}
+
+static void recycleSlots(BindlessSlots& slots, u64 frameNumber, u32 framesInFlight)
+{
+	// Retired in frame order, so only the front of the list can be old enough
+	u32 recycledCount = 0;
+	while (recycledCount < slots.retiredSlots.size() &&
+		   slots.retiredSlots[recycledCount].frameNumber + framesInFlight <= frameNumber)
+	{
+		slots.freeSlots.push_back(slots.retiredSlots[recycledCount].slot);
+		recycledCount++;
+	}
+
+	slots.retiredSlots.erase(slots.retiredSlots.begin(), slots.retiredSlots.begin() + recycledCount);
+}
+
+b8 enableBindlessFeatures(const VkPhysicalDeviceVulkan12Features& supported, VkPhysicalDeviceVulkan12Features* pEnabled)
+{
+	b8 isSupported = supported.runtimeDescriptorArray && supported.descriptorBindingPartiallyBound &&
+					 supported.descriptorBindingSampledImageUpdateAfterBind &&
+					 supported.descriptorBindingStorageBufferUpdateAfterBind &&
+					 supported.descriptorBindingUpdateUnusedWhilePending &&
+					 supported.shaderSampledImageArrayNonUniformIndexing &&
+					 supported.shaderStorageBufferArrayNonUniformIndexing;
+	if (!isSupported)
+	{
+		return false;
+	}
+
+	pEnabled->runtimeDescriptorArray						= VK_TRUE;
+	pEnabled->descriptorBindingPartiallyBound				= VK_TRUE;
+	pEnabled->descriptorBindingSampledImageUpdateAfterBind	= VK_TRUE;
+	pEnabled->descriptorBindingStorageBufferUpdateAfterBind = VK_TRUE;
+	pEnabled->descriptorBindingUpdateUnusedWhilePending		= VK_TRUE;
+	pEnabled->shaderSampledImageArrayNonUniformIndexing		= VK_TRUE;
+	pEnabled->shaderStorageBufferArrayNonUniformIndexing	= VK_TRUE;
+
+	return true;
+}
+
+BindlessTable* createBindlessTable(const BindlessTableCreateInfo& createInfo)
+{
+	// The update after bind limits are Vulkan 1.2 properties, not part of VkPhysicalDeviceLimits
+	VkPhysicalDeviceVulkan12Properties properties12 = {};
+	properties12.sType								= VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_PROPERTIES;
+
+	VkPhysicalDeviceProperties2 properties = {};
+	properties.sType					   = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+	properties.pNext					   = &properties12;
+	vkGetPhysicalDeviceProperties2(createInfo.physicalDevice, &properties);
+	const VkPhysicalDeviceLimits& limits = properties.properties.limits;
+
+	BindlessTable* pTable	  = new BindlessTable();
+	pTable->device			  = createInfo.device;
+	pTable->framesInFlight	  = createInfo.framesInFlight;
+	pTable->frameNumber		  = 0;
+	pTable->pushConstantsSize = std::min(createInfo.pushConstantsSize, limits.maxPushConstantsSize);
+
+	// The textures are combined image samplers, so they count against both the sampled image and the sampler limits
+	pTable->textures.capacity = std::min({createInfo.maxTextures,
+										  properties12.maxPerStageDescriptorUpdateAfterBindSampledImages,
+										  properties12.maxDescriptorSetUpdateAfterBindSampledImages,
+										  properties12.maxPerStageDescriptorUpdateAfterBindSamplers,
+										  properties12.maxDescriptorSetUpdateAfterBindSamplers});
+	pTable->buffers.capacity  = std::min({createInfo.maxBuffers,
+										  properties12.maxPerStageDescriptorUpdateAfterBindStorageBuffers,
+										  properties12.maxDescriptorSetUpdateAfterBindStorageBuffers});
+
+	// Both bindings are visible to every stage, so together they must also fit the per stage resource limit, which is
+	// shared out in proportion to what was asked for
+	const u64 resourcesCount = u64(pTable->textures.capacity) + pTable->buffers.capacity;
+	const u32 maxResources	 = properties12.maxPerStageUpdateAfterBindResources;
+	if (resourcesCount > maxResources)
+	{
+		pTable->textures.capacity = u32(u64(pTable->textures.capacity) * maxResources / resourcesCount);
+		pTable->buffers.capacity  = maxResources - pTable->textures.capacity;
+	}
+
+	VkDescriptorSetLayoutBinding bindings[2] = {};
+	bindings[0].binding						 = BINDLESS_TEXTURES_BINDING;
+	bindings[0].descriptorType				 = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	bindings[0].descriptorCount				 = pTable->textures.capacity;
+	bindings[0].stageFlags					 = VK_SHADER_STAGE_ALL;
+	bindings[1].binding						 = BINDLESS_BUFFERS_BINDING;
+	bindings[1].descriptorType				 = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+	bindings[1].descriptorCount				 = pTable->buffers.capacity;
+	bindings[1].stageFlags					 = VK_SHADER_STAGE_ALL;
+
+	VkDescriptorBindingFlags bindingFlags[2] = {};
+	bindingFlags[0] = VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT | VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT |
+					  VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT;
+	bindingFlags[1] = bindingFlags[0];
+
+	VkDescriptorSetLayoutBindingFlagsCreateInfo bindingFlagsInfo = {};
+	bindingFlagsInfo.sType		   = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO;
+	bindingFlagsInfo.bindingCount  = 2;
+	bindingFlagsInfo.pBindingFlags = bindingFlags;
+
+	VkDescriptorSetLayoutCreateInfo setLayoutInfo = {};
+	setLayoutInfo.sType							  = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+	setLayoutInfo.pNext							  = &bindingFlagsInfo;
+	setLayoutInfo.flags							  = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT;
+	setLayoutInfo.bindingCount					  = 2;
+	setLayoutInfo.pBindings						  = bindings;
+	VK_ASSERT(vkCreateDescriptorSetLayout(pTable->device, &setLayoutInfo, nullptr, &pTable->setLayout));
+
+	VkPushConstantRange pushConstantRange = {};
+	pushConstantRange.stageFlags		  = VK_SHADER_STAGE_ALL;
+	pushConstantRange.offset			  = 0;
+	pushConstantRange.size				  = pTable->pushConstantsSize;
+
+	VkPipelineLayoutCreateInfo pipelineLayoutInfo = {};
+	pipelineLayoutInfo.sType					  = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+	pipelineLayoutInfo.setLayoutCount			  = 1;
+	pipelineLayoutInfo.pSetLayouts				  = &pTable->setLayout;
+	pipelineLayoutInfo.pushConstantRangeCount	  = pTable->pushConstantsSize > 0 ? 1 : 0;
+	pipelineLayoutInfo.pPushConstantRanges		  = &pushConstantRange;
+	VK_ASSERT(vkCreatePipelineLayout(pTable->device, &pipelineLayoutInfo, nullptr, &pTable->pipelineLayout));
+
+	VkDescriptorPoolSize poolSizes[2] = {};
+	poolSizes[0].type				  = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	poolSizes[0].descriptorCount	  = pTable->textures.capacity;
+	poolSizes[1].type				  = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+	poolSizes[1].descriptorCount	  = pTable->buffers.capacity;
+
+	VkDescriptorPoolCreateInfo poolInfo = {};
+	poolInfo.sType						= VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+	poolInfo.flags						= VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT;
+	poolInfo.maxSets					= 1;
+	poolInfo.poolSizeCount				= 2;
+	poolInfo.pPoolSizes					= poolSizes;
+	VK_ASSERT(vkCreateDescriptorPool(pTable->device, &poolInfo, nullptr, &pTable->descriptorPool));
+
+	VkDescriptorSetAllocateInfo setInfo = {};
+	setInfo.sType						= VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+	setInfo.descriptorPool				= pTable->descriptorPool;
+	setInfo.descriptorSetCount			= 1;
+	setInfo.pSetLayouts					= &pTable->setLayout;
+	VK_ASSERT(vkAllocateDescriptorSets(pTable->device, &setInfo, &pTable->descriptorSet));
+
+	printf("Bindless table created (%u textures, %u storage buffers).\n",
+		   pTable->textures.capacity,
+		   pTable->buffers.capacity);
+
+	return pTable;
+}
+
+void destroyBindlessTable(BindlessTable* pTable)
+{
+	vkDestroyDescriptorPool(pTable->device, pTable->descriptorPool, nullptr);
+	vkDestroyPipelineLayout(pTable->device, pTable->pipelineLayout, nullptr);
+	vkDestroyDescriptorSetLayout(pTable->device, pTable->setLayout, nullptr);
+
+	delete pTable;
+}
+
+BindlessID registerTexture(BindlessTable* pTable, VkImageView imageView, VkSampler sampler, VkImageLayout layout)
+{
+	std::lock_guard<std::mutex> lock(pTable->mutex);
+	u32							slot = allocateSlot(pTable->textures);
+
+	VkDescriptorImageInfo imageInfo = {};
+	imageInfo.sampler				= sampler;
+	imageInfo.imageView				= imageView;
+	imageInfo.imageLayout			= layout;
+
+	VkWriteDescriptorSet write = {};
+	write.sType				   = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+	write.dstSet			   = pTable->descriptorSet;
+	write.dstBinding		   = BINDLESS_TEXTURES_BINDING;
+	write.dstArrayElement	   = slot;
+	write.descriptorCount	   = 1;
+	write.descriptorType	   = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	write.pImageInfo		   = &imageInfo;
+	vkUpdateDescriptorSets(pTable->device, 1, &write, 0, nullptr);
+
+	return slot;
+}
+
+BindlessID registerStorageBuffer(BindlessTable* pTable, VkBuffer buffer, VkDeviceSize offset, VkDeviceSize range)
+{
+	std::lock_guard<std::mutex> lock(pTable->mutex);
+	u32							slot = allocateSlot(pTable->buffers);
+
+	VkDescriptorBufferInfo bufferInfo = {};
+	bufferInfo.buffer				  = buffer;
+	bufferInfo.offset				  = offset;
+	bufferInfo.range				  = range;
+
+	VkWriteDescriptorSet write = {};
+	write.sType				   = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+	write.dstSet			   = pTable->descriptorSet;
+	write.dstBinding		   = BINDLESS_BUFFERS_BINDING;
+	write.dstArrayElement	   = slot;
+	write.descriptorCount	   = 1;
+	write.descriptorType	   = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+	write.pBufferInfo		   = &bufferInfo;
+	vkUpdateDescriptorSets(pTable->device, 1, &write, 0, nullptr);
+
+	return slot;
+}
+
+void releaseTexture(BindlessTable* pTable, BindlessID id)
+{
+	std::lock_guard<std::mutex> lock(pTable->mutex);
+	retireSlot(pTable->textures, id, pTable->frameNumber);
+}
+
+void releaseStorageBuffer(BindlessTable* pTable, BindlessID id)
+{
+	std::lock_guard<std::mutex> lock(pTable->mutex);
+	retireSlot(pTable->buffers, id, pTable->frameNumber);
+}
+
+void beginBindlessFrame(BindlessTable* pTable, u64 frameNumber)
+{
+	std::lock_guard<std::mutex> lock(pTable->mutex);
+	pTable->frameNumber = frameNumber;
+
+	recycleSlots(pTable->textures, frameNumber, pTable->framesInFlight);
+	recycleSlots(pTable->buffers, frameNumber, pTable->framesInFlight);
+}
+
+VkDescriptorSetLayout getBindlessSetLayout(BindlessTable* pTable)
+{
+	return pTable->setLayout;
+}
+
+VkPipelineLayout getBindlessPipelineLayout(BindlessTable* pTable)
+{
+	return pTable->pipelineLayout;
+}
+
+void bindBindlessTable(BindlessTable* pTable, VkCommandBuffer commandBuffer, VkPipelineBindPoint bindPoint)
+{
+	vkCmdBindDescriptorSets(
+		commandBuffer, bindPoint, pTable->pipelineLayout, 0, 1, &pTable->descriptorSet, 0, nullptr);
+}
+
+void pushBindlessConstants(BindlessTable* pTable, VkCommandBuffer commandBuffer, const void* pData, u32 size)
+{
+	ASSERT(size <= pTable->pushConstantsSize);
+	vkCmdPushConstants(commandBuffer, pTable->pipelineLayout, VK_SHADER_STAGE_ALL, 0, size, pData);
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "common.h"
+
+/**
+ * One global descriptor set holding every texture and storage buffer of the scene (Vulkan 1.2 descriptor
+ * indexing). Resources are registered once and addressed in shaders by the returned ID, which is passed through
+ * push constants, so the set is bound once per frame instead of once per material.
+ *
+ * Binding 0 is an array of `sampler2D`, binding 1 an array of storage buffers, both update-after-bind and
+ * partially bound. Released IDs are only handed out again after `framesInFlight` frames, so a frame still on the
+ * GPU never sees its descriptor rewritten.
+ *
+ * @example
+ * ```c++
+ * BindlessID albedo = registerTexture(pTable, imageView, sampler);
+ * ...
+ * beginBindlessFrame(pTable, frameNumber);
+ * bindBindlessTable(pTable, commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS);
+ * DrawIDs ids = {albedo, material};
+ * pushBindlessConstants(pTable, commandBuffer, &ids, sizeof(ids));
+ * vkCmdDraw(commandBuffer, ...);
+ * ```
+ */
+
+typedef u32 BindlessID;
+
+#define BINDLESS_INVALID_ID (~0u)
+
+#define BINDLESS_TEXTURES_BINDING 0
+#define BINDLESS_BUFFERS_BINDING  1
+
+struct BindlessTable;
+
+struct BindlessTableCreateInfo
+{
+	VkDevice		 device;
+	VkPhysicalDevice physicalDevice;
+	u32				 maxTextures; // clamped to the device update-after-bind limits
+	u32				 maxBuffers;
+	u32				 framesInFlight;
+	u32				 pushConstantsSize;
+};
+
+// Fills the descriptor indexing features the table needs, returns false when the device lacks any of them.
+b8 enableBindlessFeatures(const VkPhysicalDeviceVulkan12Features& supported, VkPhysicalDeviceVulkan12Features* pEnabled);
+
+BindlessTable* createBindlessTable(const BindlessTableCreateInfo& createInfo);
+void		   destroyBindlessTable(BindlessTable* pTable);
+
+BindlessID registerTexture(BindlessTable* pTable,
+						   VkImageView	  imageView,
+						   VkSampler	  sampler,
+						   VkImageLayout  layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+BindlessID registerStorageBuffer(BindlessTable* pTable,
+								 VkBuffer		buffer,
+								 VkDeviceSize	offset = 0,
+								 VkDeviceSize	range  = VK_WHOLE_SIZE);
+void	   releaseTexture(BindlessTable* pTable, BindlessID id);
+void	   releaseStorageBuffer(BindlessTable* pTable, BindlessID id);
+
+// Recycles the IDs released `framesInFlight` frames ago, call once per frame before recording.
+void beginBindlessFrame(BindlessTable* pTable, u64 frameNumber);
+
+VkDescriptorSetLayout getBindlessSetLayout(BindlessTable* pTable);
+VkPipelineLayout	  getBindlessPipelineLayout(BindlessTable* pTable);
+
+void bindBindlessTable(BindlessTable* pTable, VkCommandBuffer commandBuffer, VkPipelineBindPoint bindPoint);
+void pushBindlessConstants(BindlessTable* pTable, VkCommandBuffer commandBuffer, const void* pData, u32 size);
@@ -29,6 +29,9 @@
 		}                                                                                                              \
 	} while (0)
 
+#define _STRINGIFY(x) #x
+#define STRINGIFY(x)  _STRINGIFY(x)
+
 typedef unsigned char	   u8;
 typedef unsigned short	   u16;
 typedef unsigned int	   u32;
@@ -0,0 +1,347 @@
+#include "compute_scheduler.h"
+#include <algorithm>
+
+#define QUERIES_PER_FRAME 4
+#define COMPUTE_BEGIN	  0
+#define COMPUTE_END		  1
+#define GRAPHICS_BEGIN	  2
+#define GRAPHICS_END	  3
+
+struct ComputeFrame
+{
+	VkCommandPool	commandPool;
+	VkCommandBuffer commandBuffer;
+	uint64_t		computeValue; // timeline value of the last submission recorded from this frame's pool
+
+	b8 computeTimed;
+	b8 graphicsTimed;
+};
+
+struct ComputeScheduler
+{
+	VkDevice device;
+	b8		 separateComputeFamily;
+	VkQueue	 computeQueue;
+	VkQueue	 graphicsQueue;
+
+	VkSemaphore computeTimeline;
+	VkSemaphore graphicsTimeline;
+	uint64_t	nextComputeValue;
+	uint64_t	nextGraphicsValue;
+
+	std::vector<ComputeFrame> frames;
+	u32						  recordingFrame;
+
+	VkQueryPool queryPool;
+	b8			timestampsSupported;
+	f64			timestampPeriodNs;
+
+	QueueTimings totals;
+};
+
+static void createTimelineSemaphore(VkDevice device, VkSemaphore* pSemaphore)
+{
+	VkSemaphoreTypeCreateInfo semaphoreTypeInfo = {};
+	semaphoreTypeInfo.sType						= VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+	semaphoreTypeInfo.semaphoreType				= VK_SEMAPHORE_TYPE_TIMELINE;
+	semaphoreTypeInfo.initialValue				= 0;
+
+	VkSemaphoreCreateInfo semaphoreInfo = {};
+	semaphoreInfo.sType					= VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+	semaphoreInfo.pNext					= &semaphoreTypeInfo;
+	VK_ASSERT(vkCreateSemaphore(device, &semaphoreInfo, nullptr, pSemaphore));
+}
+
+static void waitTimeline(VkDevice device, VkSemaphore semaphore, uint64_t value)
+{
+	if (value == 0)
+	{
+		return;
+	}
+
+	VkSemaphoreWaitInfo waitInfo = {};
+	waitInfo.sType				 = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+	waitInfo.semaphoreCount		 = 1;
+	waitInfo.pSemaphores		 = &semaphore;
+	waitInfo.pValues			 = &value;
+	VK_ASSERT(vkWaitSemaphores(device, &waitInfo, UINT64_MAX));
+}
+
+static void collectTimings(ComputeScheduler& scheduler, u32 frameIndex)
+{
+	ComputeFrame& frame = scheduler.frames[frameIndex];
+	if (!scheduler.timestampsSupported || !frame.computeTimed || !frame.graphicsTimed)
+	{
+		return;
+	}
+
+	// Pairs of (timestamp, availability)
+	uint64_t results[QUERIES_PER_FRAME * 2] = {};
+	VkResult result							= vkGetQueryPoolResults(scheduler.device,
+														scheduler.queryPool,
+														frameIndex * QUERIES_PER_FRAME,
+														QUERIES_PER_FRAME,
+														sizeof(results),
+														results,
+														sizeof(uint64_t) * 2,
+														VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+	if (result != VK_SUCCESS && result != VK_NOT_READY)
+	{
+		VK_ASSERT(result);
+	}
+
+	for (u32 queryIndex = 0u; queryIndex < QUERIES_PER_FRAME; ++queryIndex)
+	{
+		if (results[queryIndex * 2 + 1] == 0)
+		{
+			return; // the graphics work of that frame is still running, try again next time
+		}
+	}
+
+	f64 computeBegin  = f64(results[COMPUTE_BEGIN * 2]) * scheduler.timestampPeriodNs;
+	f64 computeEnd	  = f64(results[COMPUTE_END * 2]) * scheduler.timestampPeriodNs;
+	f64 graphicsBegin = f64(results[GRAPHICS_BEGIN * 2]) * scheduler.timestampPeriodNs;
+	f64 graphicsEnd	  = f64(results[GRAPHICS_END * 2]) * scheduler.timestampPeriodNs;
+	f64 overlap		  = std::min(computeEnd, graphicsEnd) - std::max(computeBegin, graphicsBegin);
+
+	scheduler.totals.framesMeasured++;
+	scheduler.totals.computeBusyMs += (computeEnd - computeBegin) * 1e-6;
+	scheduler.totals.graphicsBusyMs += (graphicsEnd - graphicsBegin) * 1e-6;
+	scheduler.totals.overlapMs += std::max(overlap, 0.0) * 1e-6;
+
+	frame.computeTimed	= false;
+	frame.graphicsTimed = false;
+}
+
+ComputeScheduler* createComputeScheduler(const ComputeSchedulerCreateInfo& createInfo)
+{
+	ComputeScheduler* pScheduler	  = new ComputeScheduler();
+	pScheduler->device				  = createInfo.device;
+	pScheduler->separateComputeFamily = createInfo.separateComputeFamily;
+	pScheduler->computeQueue		  = createInfo.separateComputeFamily ? createInfo.computeQueue : createInfo.graphicsQueue;
+	pScheduler->graphicsQueue		  = createInfo.graphicsQueue;
+	pScheduler->nextComputeValue	  = 1;
+	pScheduler->nextGraphicsValue	  = 1;
+	pScheduler->recordingFrame		  = UINT32_MAX;
+
+	u32 computeFamilyIndex =
+		createInfo.separateComputeFamily ? createInfo.computeFamilyIndex : createInfo.graphicsFamilyIndex;
+
+	createTimelineSemaphore(pScheduler->device, &pScheduler->computeTimeline);
+	createTimelineSemaphore(pScheduler->device, &pScheduler->graphicsTimeline);
+
+	pScheduler->frames.resize(createInfo.framesInFlight);
+	for (ComputeFrame& frame : pScheduler->frames)
+	{
+		frame = {};
+
+		VkCommandPoolCreateInfo poolInfo = {};
+		poolInfo.sType					 = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+		poolInfo.queueFamilyIndex		 = computeFamilyIndex;
+		poolInfo.flags					 = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+		VK_ASSERT(vkCreateCommandPool(pScheduler->device, &poolInfo, nullptr, &frame.commandPool));
+
+		VkCommandBufferAllocateInfo allocInfo = {};
+		allocInfo.sType						  = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+		allocInfo.commandPool				  = frame.commandPool;
+		allocInfo.level						  = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+		allocInfo.commandBufferCount		  = 1;
+		VK_ASSERT(vkAllocateCommandBuffers(pScheduler->device, &allocInfo, &frame.commandBuffer));
+	}
+
+	u32 queueFamiliesCount = 0;
+	vkGetPhysicalDeviceQueueFamilyProperties(createInfo.physicalDevice, &queueFamiliesCount, nullptr);
+	std::vector<VkQueueFamilyProperties> queueFamilies(queueFamiliesCount);
+	vkGetPhysicalDeviceQueueFamilyProperties(createInfo.physicalDevice, &queueFamiliesCount, queueFamilies.data());
+
+	VkPhysicalDeviceProperties deviceProperties;
+	vkGetPhysicalDeviceProperties(createInfo.physicalDevice, &deviceProperties);
+
+	pScheduler->timestampPeriodNs	= f64(deviceProperties.limits.timestampPeriod);
+	pScheduler->timestampsSupported = queueFamilies[computeFamilyIndex].timestampValidBits > 0 &&
+									  queueFamilies[createInfo.graphicsFamilyIndex].timestampValidBits > 0;
+
+	if (pScheduler->timestampsSupported)
+	{
+		VkQueryPoolCreateInfo queryPoolInfo = {};
+		queryPoolInfo.sType					= VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+		queryPoolInfo.queryType				= VK_QUERY_TYPE_TIMESTAMP;
+		queryPoolInfo.queryCount			= createInfo.framesInFlight * QUERIES_PER_FRAME;
+		VK_ASSERT(vkCreateQueryPool(pScheduler->device, &queryPoolInfo, nullptr, &pScheduler->queryPool));
+	}
+
+	printf("Async compute: %s\n",
+		   createInfo.separateComputeFamily ? "dedicated compute queue" : "falling back to the graphics queue");
+
+	return pScheduler;
+}
+
+void destroyComputeScheduler(ComputeScheduler* pScheduler)
+{
+	waitTimeline(pScheduler->device, pScheduler->computeTimeline, pScheduler->nextComputeValue - 1);
+	waitTimeline(pScheduler->device, pScheduler->graphicsTimeline, pScheduler->nextGraphicsValue - 1);
+
+	for (ComputeFrame& frame : pScheduler->frames)
+	{
+		vkDestroyCommandPool(pScheduler->device, frame.commandPool, nullptr);
+	}
+
+	if (pScheduler->timestampsSupported)
+	{
+		vkDestroyQueryPool(pScheduler->device, pScheduler->queryPool, nullptr);
+	}
+
+	vkDestroySemaphore(pScheduler->device, pScheduler->computeTimeline, nullptr);
+	vkDestroySemaphore(pScheduler->device, pScheduler->graphicsTimeline, nullptr);
+
+	delete pScheduler;
+}
+
+b8 isAsyncComputeAvailable(ComputeScheduler* pScheduler)
+{
+	return pScheduler->separateComputeFamily;
+}
+
+VkCommandBuffer beginComputeFrame(ComputeScheduler* pScheduler, u32 frameIndex)
+{
+	ASSERT(pScheduler->recordingFrame == UINT32_MAX);
+	ComputeFrame& frame = pScheduler->frames[frameIndex];
+
+	// The pool is reused every framesInFlight frames, its previous submission must be done by now
+	waitTimeline(pScheduler->device, pScheduler->computeTimeline, frame.computeValue);
+	collectTimings(*pScheduler, frameIndex);
+
+	VK_ASSERT(vkResetCommandPool(pScheduler->device, frame.commandPool, 0));
+
+	VkCommandBufferBeginInfo beginInfo = {};
+	beginInfo.sType					   = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+	beginInfo.flags					   = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+	VK_ASSERT(vkBeginCommandBuffer(frame.commandBuffer, &beginInfo));
+
+	if (pScheduler->timestampsSupported)
+	{
+		u32 firstQuery = frameIndex * QUERIES_PER_FRAME;
+		vkCmdResetQueryPool(frame.commandBuffer, pScheduler->queryPool, firstQuery + COMPUTE_BEGIN, 2);
+		vkCmdWriteTimestamp(
+			frame.commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, pScheduler->queryPool, firstQuery + COMPUTE_BEGIN);
+	}
+
+	pScheduler->recordingFrame = frameIndex;
+	return frame.commandBuffer;
+}
+
+u64 submitCompute(ComputeScheduler* pScheduler, u64 waitGraphicsValue)
+{
+	ASSERT(pScheduler->recordingFrame != UINT32_MAX);
+	u32			  frameIndex = pScheduler->recordingFrame;
+	ComputeFrame& frame		 = pScheduler->frames[frameIndex];
+
+	if (pScheduler->timestampsSupported)
+	{
+		vkCmdWriteTimestamp(frame.commandBuffer,
+							VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+							pScheduler->queryPool,
+							frameIndex * QUERIES_PER_FRAME + COMPUTE_END);
+		frame.computeTimed = true;
+	}
+
+	VK_ASSERT(vkEndCommandBuffer(frame.commandBuffer));
+
+	frame.computeValue					= pScheduler->nextComputeValue++;
+	uint64_t			 waitValue		= waitGraphicsValue;
+	VkPipelineStageFlags waitStageMask	= VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+	b8					 waitOnGraphics = waitGraphicsValue > 0;
+
+	VkTimelineSemaphoreSubmitInfo timelineInfo = {};
+	timelineInfo.sType						   = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+	timelineInfo.waitSemaphoreValueCount	   = waitOnGraphics ? 1 : 0;
+	timelineInfo.pWaitSemaphoreValues		   = &waitValue;
+	timelineInfo.signalSemaphoreValueCount	   = 1;
+	timelineInfo.pSignalSemaphoreValues		   = &frame.computeValue;
+
+	VkSubmitInfo submitInfo			= {};
+	submitInfo.sType				= VK_STRUCTURE_TYPE_SUBMIT_INFO;
+	submitInfo.pNext				= &timelineInfo;
+	submitInfo.waitSemaphoreCount	= waitOnGraphics ? 1 : 0;
+	submitInfo.pWaitSemaphores		= &pScheduler->graphicsTimeline;
+	submitInfo.pWaitDstStageMask	= &waitStageMask;
+	submitInfo.commandBufferCount	= 1;
+	submitInfo.pCommandBuffers		= &frame.commandBuffer;
+	submitInfo.signalSemaphoreCount = 1;
+	submitInfo.pSignalSemaphores	= &pScheduler->computeTimeline;
+	VK_ASSERT(vkQueueSubmit(pScheduler->computeQueue, 1, &submitInfo, VK_NULL_HANDLE));
+
+	pScheduler->recordingFrame = UINT32_MAX;
+	return frame.computeValue;
+}
+
+void beginGraphicsTiming(ComputeScheduler* pScheduler, VkCommandBuffer commandBuffer, u32 frameIndex)
+{
+	if (!pScheduler->timestampsSupported)
+	{
+		return;
+	}
+
+	u32 firstQuery = frameIndex * QUERIES_PER_FRAME;
+	vkCmdResetQueryPool(commandBuffer, pScheduler->queryPool, firstQuery + GRAPHICS_BEGIN, 2);
+	vkCmdWriteTimestamp(
+		commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, pScheduler->queryPool, firstQuery + GRAPHICS_BEGIN);
+}
+
+void endGraphicsTiming(ComputeScheduler* pScheduler, VkCommandBuffer commandBuffer, u32 frameIndex)
+{
+	if (!pScheduler->timestampsSupported)
+	{
+		return;
+	}
+
+	vkCmdWriteTimestamp(commandBuffer,
+						VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+						pScheduler->queryPool,
+						frameIndex * QUERIES_PER_FRAME + GRAPHICS_END);
+	pScheduler->frames[frameIndex].graphicsTimed = true;
+}
+
+QueueSync getGraphicsQueueSync(ComputeScheduler* pScheduler, u64 computeTicket, VkPipelineStageFlags waitStageMask)
+{
+	QueueSync sync		 = {};
+	sync.waitSemaphore	 = computeTicket > 0 ? pScheduler->computeTimeline : VK_NULL_HANDLE;
+	sync.waitValue		 = computeTicket;
+	sync.waitStageMask	 = waitStageMask;
+	sync.signalSemaphore = pScheduler->graphicsTimeline;
+	sync.signalValue	 = pScheduler->nextGraphicsValue++;
+
+	return sync;
+}
+
+QueueTimings getQueueTimings(ComputeScheduler* pScheduler)
+{
+	QueueTimings timings = pScheduler->totals;
+	if (timings.framesMeasured > 0)
+	{
+		timings.computeBusyMs /= timings.framesMeasured;
+		timings.graphicsBusyMs /= timings.framesMeasured;
+		timings.overlapMs /= timings.framesMeasured;
+	}
+
+	return timings;
+}
+
+void printQueueTimings(ComputeScheduler* pScheduler)
+{
+	QueueTimings timings = getQueueTimings(pScheduler);
+	if (timings.framesMeasured == 0)
+	{
+		printf("Queue timings: no frame measured.\n");
+		return;
+	}
+
+	f64 overlapPercent = timings.computeBusyMs > 0.0 ? timings.overlapMs / timings.computeBusyMs * 100.0 : 0.0;
+
+	printf("Queue timings (%u frames, %s):\n",
+		   timings.framesMeasured,
+		   pScheduler->separateComputeFamily ? "async compute" : "single queue");
+	printf(" Graphics busy: %.3f ms\n", timings.graphicsBusyMs);
+	printf(" Compute busy:  %.3f ms\n", timings.computeBusyMs);
+	printf(" Overlap:       %.3f ms (%.1f%% of compute)\n", timings.overlapMs, overlapPercent);
+}
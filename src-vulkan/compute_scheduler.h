@@ -0,0 +1,75 @@
+#pragma once
+
+#include "common.h"
+
+/**
+ * Schedules compute work (culling, skinning, post-processing) on the async compute queue so that it runs next to
+ * the graphics work of the following frame. Both queues own a timeline semaphore: compute submissions can wait on
+ * a graphics value (e.g. last frame's depth for occlusion culling) and graphics submissions wait on the compute
+ * value they consume. Without a separate compute family everything goes to the graphics queue, the semaphores
+ * still order the work but nothing overlaps.
+ *
+ * @example
+ * ```c++
+ * VkCommandBuffer computeBuffer = beginComputeFrame(pScheduler, frameIndex);
+ * vkCmdDispatch(computeBuffer, ...);
+ * u64 computeTicket = submitCompute(pScheduler, graphicsValueToWaitFor);
+ *
+ * // next frame, graphics side
+ * beginGraphicsTiming(pScheduler, graphicsBuffer, frameIndex);
+ * ...
+ * endGraphicsTiming(pScheduler, graphicsBuffer, frameIndex);
+ * QueueSync sync = getGraphicsQueueSync(pScheduler, computeTicket);
+ * // add sync.waitSemaphore/sync.waitValue and sync.signalSemaphore/sync.signalValue to the graphics submit
+ * ```
+ */
+
+struct ComputeScheduler;
+
+struct ComputeSchedulerCreateInfo
+{
+	VkDevice		 device;
+	VkPhysicalDevice physicalDevice;
+	u32				 framesInFlight;
+
+	b8		separateComputeFamily;
+	u32		computeFamilyIndex;
+	VkQueue computeQueue;
+	u32		graphicsFamilyIndex;
+	VkQueue graphicsQueue;
+};
+
+struct QueueSync
+{
+	VkSemaphore			 waitSemaphore; // VK_NULL_HANDLE when there is no compute work to wait for
+	u64					 waitValue;
+	VkPipelineStageFlags waitStageMask;
+
+	VkSemaphore signalSemaphore;
+	u64			signalValue;
+};
+
+struct QueueTimings
+{
+	u32 framesMeasured;
+	f64 graphicsBusyMs; // averages over the measured frames
+	f64 computeBusyMs;
+	f64 overlapMs;
+};
+
+ComputeScheduler* createComputeScheduler(const ComputeSchedulerCreateInfo& createInfo);
+void			  destroyComputeScheduler(ComputeScheduler* pScheduler);
+
+b8 isAsyncComputeAvailable(ComputeScheduler* pScheduler);
+
+VkCommandBuffer beginComputeFrame(ComputeScheduler* pScheduler, u32 frameIndex);
+u64				submitCompute(ComputeScheduler* pScheduler, u64 waitGraphicsValue = 0);
+
+void	  beginGraphicsTiming(ComputeScheduler* pScheduler, VkCommandBuffer commandBuffer, u32 frameIndex);
+void	  endGraphicsTiming(ComputeScheduler* pScheduler, VkCommandBuffer commandBuffer, u32 frameIndex);
+QueueSync getGraphicsQueueSync(ComputeScheduler*	pScheduler,
+							   u64					computeTicket,
+							   VkPipelineStageFlags waitStageMask = VK_PIPELINE_STAGE_VERTEX_SHADER_BIT);
+
+QueueTimings getQueueTimings(ComputeScheduler* pScheduler);
+void		 printQueueTimings(ComputeScheduler* pScheduler);
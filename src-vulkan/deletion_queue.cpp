@@ -0,0 +1,250 @@
+#include "deletion_queue.h"
+#include <algorithm>
+#include <mutex>
+
+enum class DeletionType : u8
+{
+	BUFFER,
+	IMAGE,
+	IMAGE_VIEW,
+	SAMPLER,
+	FRAMEBUFFER,
+	SEMAPHORE,
+	PIPELINE,
+	SWAPCHAIN,
+	ALLOCATED_BUFFER,
+	ALLOCATED_IMAGE,
+	MEMORY,
+};
+
+// Everything needed to destroy one object, the allocator fields are only used by allocated buffers/images
+struct DeletionEntry
+{
+	u64			 handle;
+	MemoryBlock* pBlock;
+	u32			 node;
+	DeletionType type;
+};
+
+struct DeletionQueue
+{
+	VkDevice		 device;
+	MemoryAllocator* pMemoryAllocator;
+
+	std::mutex								mutex;
+	std::vector<std::vector<DeletionEntry>> frames; // one queue per frame in flight
+	std::vector<DeletionEntry>				destroying;
+	u32										frameIndex;
+
+	u64 queuedCount;
+	u64 destroyedCount;
+	u32 pendingCount;
+	u32 maxPendingCount;
+};
+
+static void enqueue(DeletionQueue* pQueue, DeletionType type, u64 handle, MemoryBlock* pBlock = nullptr, u32 node = 0)
+{
+	if (handle == 0)
+	{
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock(pQueue->mutex);
+	pQueue->frames[pQueue->frameIndex].push_back({handle, pBlock, node, type});
+	pQueue->queuedCount++;
+	pQueue->pendingCount++;
+	pQueue->maxPendingCount = std::max(pQueue->maxPendingCount, pQueue->pendingCount);
+}
+
+static void destroyEntry(DeletionQueue* pQueue, const DeletionEntry& entry)
+{
+	VkDevice device = pQueue->device;
+
+	switch (entry.type)
+	{
+	case DeletionType::BUFFER:
+		vkDestroyBuffer(device, (VkBuffer)entry.handle, nullptr);
+		break;
+	case DeletionType::IMAGE:
+		vkDestroyImage(device, (VkImage)entry.handle, nullptr);
+		break;
+	case DeletionType::IMAGE_VIEW:
+		vkDestroyImageView(device, (VkImageView)entry.handle, nullptr);
+		break;
+	case DeletionType::SAMPLER:
+		vkDestroySampler(device, (VkSampler)entry.handle, nullptr);
+		break;
+	case DeletionType::FRAMEBUFFER:
+		vkDestroyFramebuffer(device, (VkFramebuffer)entry.handle, nullptr);
+		break;
+	case DeletionType::SEMAPHORE:
+		vkDestroySemaphore(device, (VkSemaphore)entry.handle, nullptr);
+		break;
+	case DeletionType::PIPELINE:
+		vkDestroyPipeline(device, (VkPipeline)entry.handle, nullptr);
+		break;
+	case DeletionType::SWAPCHAIN:
+		vkDestroySwapchainKHR(device, (VkSwapchainKHR)entry.handle, nullptr);
+		break;
+	case DeletionType::ALLOCATED_BUFFER:
+	case DeletionType::ALLOCATED_IMAGE:
+	case DeletionType::MEMORY:
+	{
+		if (entry.type == DeletionType::ALLOCATED_BUFFER)
+		{
+			vkDestroyBuffer(device, (VkBuffer)entry.handle, nullptr);
+		}
+		else if (entry.type == DeletionType::ALLOCATED_IMAGE)
+		{
+			vkDestroyImage(device, (VkImage)entry.handle, nullptr);
+		}
+
+		MemoryAllocation allocation = {};
+		allocation.pBlock			= entry.pBlock;
+		allocation.node				= entry.node;
+		freeMemory(pQueue->pMemoryAllocator, allocation);
+		break;
+	}
+	}
+}
+
+// Destroys outside of the lock, so other threads can keep queuing while a frame is being released. The arrays are
+// swapped rather than copied, which keeps their capacity around from frame to frame.
+static void destroyEntries(DeletionQueue* pQueue, std::vector<DeletionEntry>& entries)
+{
+	{
+		std::lock_guard<std::mutex> lock(pQueue->mutex);
+		pQueue->destroying.swap(entries);
+	}
+
+	for (const DeletionEntry& entry : pQueue->destroying)
+	{
+		destroyEntry(pQueue, entry);
+	}
+
+	std::lock_guard<std::mutex> lock(pQueue->mutex);
+	pQueue->destroyedCount += pQueue->destroying.size();
+	pQueue->pendingCount -= u32(pQueue->destroying.size());
+	pQueue->destroying.clear();
+}
+
+DeletionQueue* createDeletionQueue(const DeletionQueueCreateInfo& createInfo)
+{
+	ASSERT(createInfo.framesInFlight > 0);
+
+	DeletionQueue* pQueue	 = new DeletionQueue();
+	pQueue->device			 = createInfo.device;
+	pQueue->pMemoryAllocator = createInfo.pMemoryAllocator;
+	pQueue->frames.resize(createInfo.framesInFlight);
+
+	return pQueue;
+}
+
+void destroyDeletionQueue(DeletionQueue* pQueue)
+{
+	flushDeletionQueue(pQueue);
+	delete pQueue;
+}
+
+void beginDeletionFrame(DeletionQueue* pQueue, u32 frameIndex)
+{
+	ASSERT(frameIndex < pQueue->frames.size());
+
+	destroyEntries(pQueue, pQueue->frames[frameIndex]);
+
+	std::lock_guard<std::mutex> lock(pQueue->mutex);
+	pQueue->frameIndex = frameIndex;
+}
+
+void flushDeletionQueue(DeletionQueue* pQueue)
+{
+	for (std::vector<DeletionEntry>& frame : pQueue->frames)
+	{
+		destroyEntries(pQueue, frame);
+	}
+}
+
+void deferDestroyBuffer(DeletionQueue* pQueue, VkBuffer buffer)
+{
+	enqueue(pQueue, DeletionType::BUFFER, (u64)buffer);
+}
+
+void deferDestroyImage(DeletionQueue* pQueue, VkImage image)
+{
+	enqueue(pQueue, DeletionType::IMAGE, (u64)image);
+}
+
+void deferDestroyImageView(DeletionQueue* pQueue, VkImageView imageView)
+{
+	enqueue(pQueue, DeletionType::IMAGE_VIEW, (u64)imageView);
+}
+
+void deferDestroySampler(DeletionQueue* pQueue, VkSampler sampler)
+{
+	enqueue(pQueue, DeletionType::SAMPLER, (u64)sampler);
+}
+
+void deferDestroyFramebuffer(DeletionQueue* pQueue, VkFramebuffer framebuffer)
+{
+	enqueue(pQueue, DeletionType::FRAMEBUFFER, (u64)framebuffer);
+}
+
+void deferDestroySemaphore(DeletionQueue* pQueue, VkSemaphore semaphore)
+{
+	enqueue(pQueue, DeletionType::SEMAPHORE, (u64)semaphore);
+}
+
+void deferDestroyPipeline(DeletionQueue* pQueue, VkPipeline pipeline)
+{
+	enqueue(pQueue, DeletionType::PIPELINE, (u64)pipeline);
+}
+
+void deferDestroySwapchain(DeletionQueue* pQueue, VkSwapchainKHR swapchain)
+{
+	enqueue(pQueue, DeletionType::SWAPCHAIN, (u64)swapchain);
+}
+
+void deferDestroyAllocatedBuffer(DeletionQueue* pQueue, AllocatedBuffer& buffer)
+{
+	ASSERT(pQueue->pMemoryAllocator != nullptr);
+	enqueue(
+		pQueue, DeletionType::ALLOCATED_BUFFER, (u64)buffer.buffer, buffer.allocation.pBlock, buffer.allocation.node);
+	buffer = {};
+}
+
+void deferDestroyAllocatedImage(DeletionQueue* pQueue, AllocatedImage& image)
+{
+	ASSERT(pQueue->pMemoryAllocator != nullptr);
+	enqueue(pQueue, DeletionType::ALLOCATED_IMAGE, (u64)image.image, image.allocation.pBlock, image.allocation.node);
+	image = {};
+}
+
+void deferFreeMemory(DeletionQueue* pQueue, MemoryAllocation& allocation)
+{
+	ASSERT(pQueue->pMemoryAllocator != nullptr);
+	enqueue(pQueue, DeletionType::MEMORY, (u64)allocation.memory, allocation.pBlock, allocation.node);
+	allocation = {};
+}
+
+DeletionStatistics getDeletionStatistics(DeletionQueue* pQueue)
+{
+	std::lock_guard<std::mutex> lock(pQueue->mutex);
+
+	DeletionStatistics statistics = {};
+	statistics.queuedCount		  = pQueue->queuedCount;
+	statistics.destroyedCount	  = pQueue->destroyedCount;
+	statistics.pendingCount		  = pQueue->pendingCount;
+	statistics.maxPendingCount	  = pQueue->maxPendingCount;
+
+	return statistics;
+}
+
+void printDeletionStatistics(DeletionQueue* pQueue)
+{
+	DeletionStatistics statistics = getDeletionStatistics(pQueue);
+	printf("Deletion queue: %llu objects queued, %llu destroyed, %u pending (peak %u)\n",
+		   statistics.queuedCount,
+		   statistics.destroyedCount,
+		   statistics.pendingCount,
+		   statistics.maxPendingCount);
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "common.h"
+#include "memory_allocator.h"
+
+/**
+ * Defers the destruction of device objects until the GPU is done with them, without waiting for the device to go
+ * idle. There is one queue per frame in flight: an object handed over while recording frame N is destroyed when
+ * frame N's slot comes around again, that is once the fence of the last frame that could use it has signaled.
+ * Entries are compact typed handles (memory allocator blocks included) stored in flat arrays, queuing never
+ * allocates once the arrays have grown to their steady-state size. Queuing is thread safe.
+ *
+ * @example
+ * ```c++
+ * vkWaitForFences(device, 1, &inFlightFences[frameIndex], VK_TRUE, UINT64_MAX);
+ * beginDeletionFrame(pDeletionQueue, frameIndex);
+ * ...
+ * deferDestroyAllocatedBuffer(pDeletionQueue, streamedBuffer); // may still be read by frames in flight
+ * ```
+ */
+
+struct DeletionQueue;
+
+struct DeletionQueueCreateInfo
+{
+	VkDevice		 device;
+	MemoryAllocator* pMemoryAllocator; // owner of the allocated buffers/images queued, may be nullptr
+	u32				 framesInFlight;
+};
+
+struct DeletionStatistics
+{
+	u64 queuedCount;
+	u64 destroyedCount;
+	u32 pendingCount;
+	u32 maxPendingCount;
+};
+
+DeletionQueue* createDeletionQueue(const DeletionQueueCreateInfo& createInfo);
+// Destroys every object still queued, the device must be idle
+void destroyDeletionQueue(DeletionQueue* pQueue);
+
+// Destroys the objects queued the last time `frameIndex` was recorded, its fence must have signaled
+void beginDeletionFrame(DeletionQueue* pQueue, u32 frameIndex);
+// Destroys every object queued, the device must be idle
+void flushDeletionQueue(DeletionQueue* pQueue);
+
+void deferDestroyBuffer(DeletionQueue* pQueue, VkBuffer buffer);
+void deferDestroyImage(DeletionQueue* pQueue, VkImage image);
+void deferDestroyImageView(DeletionQueue* pQueue, VkImageView imageView);
+void deferDestroySampler(DeletionQueue* pQueue, VkSampler sampler);
+void deferDestroyFramebuffer(DeletionQueue* pQueue, VkFramebuffer framebuffer);
+void deferDestroySemaphore(DeletionQueue* pQueue, VkSemaphore semaphore);
+void deferDestroyPipeline(DeletionQueue* pQueue, VkPipeline pipeline);
+void deferDestroySwapchain(DeletionQueue* pQueue, VkSwapchainKHR swapchain);
+void deferDestroyAllocatedBuffer(DeletionQueue* pQueue, AllocatedBuffer& buffer);
+void deferDestroyAllocatedImage(DeletionQueue* pQueue, AllocatedImage& image);
+void deferFreeMemory(DeletionQueue* pQueue, MemoryAllocation& allocation);
+
+DeletionStatistics getDeletionStatistics(DeletionQueue* pQueue);
+void			   printDeletionStatistics(DeletionQueue* pQueue);
@@ -0,0 +1,243 @@
+#include "frame_pacing.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <thread>
+
+using Clock = std::chrono::steady_clock;
+
+#define MIN_SPIN_MARGIN_MS 0.25
+#define MAX_SPIN_MARGIN_MS 4.0
+
+struct FramePacer
+{
+	FramePacingSettings settings;
+
+	Clock::time_point nextFrameTime;
+	f64				  spinMarginMs;
+
+	Clock::time_point acquireTime;
+	Clock::time_point lastPresentTime;
+
+	u64 framesCount;
+	u64 intervalsCount;
+	f64 frameIntervalSum;
+	f64 frameIntervalSquaredSum;
+	f64 acquireToPresentSum;
+	f64 acquireToPresentMax;
+	f64 waitSum;
+};
+
+static f64 toMilliseconds(Clock::duration duration)
+{
+	return std::chrono::duration<f64, std::milli>(duration).count();
+}
+
+static b8 isPresentModeAvailable(const std::vector<VkPresentModeKHR>& availablePresentModes, VkPresentModeKHR mode)
+{
+	return std::find(availablePresentModes.begin(), availablePresentModes.end(), mode) != availablePresentModes.end();
+}
+
+FramePacer* createFramePacer(const FramePacingSettings& settings)
+{
+	FramePacer* pPacer	 = new FramePacer();
+	pPacer->settings	 = settings;
+	pPacer->spinMarginMs = 1.0;
+
+	return pPacer;
+}
+
+void destroyFramePacer(FramePacer* pPacer)
+{
+	delete pPacer;
+}
+
+FramePacingSettings getFramePacingSettings(FramePacer* pPacer)
+{
+	return pPacer->settings;
+}
+
+void setFramePacingSettings(FramePacer* pPacer, const FramePacingSettings& settings)
+{
+	pPacer->settings	  = settings;
+	pPacer->nextFrameTime = Clock::time_point();
+	resetFramePacingStatistics(pPacer);
+}
+
+const char* getPresentPolicyName(PresentPolicy presentPolicy)
+{
+	switch (presentPolicy)
+	{
+	case PresentPolicy::LOW_LATENCY:
+		return "low-latency";
+	case PresentPolicy::VSYNC:
+		return "vsync";
+	case PresentPolicy::RELAXED_VSYNC:
+		return "relaxed-vsync";
+	case PresentPolicy::UNCAPPED:
+		return "uncapped";
+	default:
+		return "unknown";
+	}
+}
+
+VkPresentModeKHR choosePresentMode(FramePacer* pPacer, const std::vector<VkPresentModeKHR>& availablePresentModes)
+{
+	VkPresentModeKHR preferences[2] = {VK_PRESENT_MODE_FIFO_KHR, VK_PRESENT_MODE_FIFO_KHR};
+
+	switch (pPacer->settings.presentPolicy)
+	{
+	case PresentPolicy::LOW_LATENCY:
+		preferences[0] = VK_PRESENT_MODE_MAILBOX_KHR;
+		break;
+	case PresentPolicy::RELAXED_VSYNC:
+		preferences[0] = VK_PRESENT_MODE_FIFO_RELAXED_KHR;
+		break;
+	case PresentPolicy::UNCAPPED:
+		preferences[0] = VK_PRESENT_MODE_IMMEDIATE_KHR;
+		preferences[1] = VK_PRESENT_MODE_MAILBOX_KHR;
+		break;
+	default:
+		break;
+	}
+
+	for (VkPresentModeKHR presentMode : preferences)
+	{
+		if (isPresentModeAvailable(availablePresentModes, presentMode))
+		{
+			return presentMode;
+		}
+	}
+
+	return VK_PRESENT_MODE_FIFO_KHR; // guaranteed to be available
+}
+
+u32 chooseImageCount(FramePacer* pPacer, const VkSurfaceCapabilitiesKHR& surfaceCapabilities)
+{
+	u32 imageCount = surfaceCapabilities.minImageCount + pPacer->settings.extraImages;
+
+	if (surfaceCapabilities.maxImageCount > 0 && imageCount > surfaceCapabilities.maxImageCount)
+	{
+		imageCount = surfaceCapabilities.maxImageCount;
+	}
+
+	return imageCount;
+}
+
+void waitForNextFrame(FramePacer* pPacer)
+{
+	Clock::time_point now = Clock::now();
+	if (pPacer->settings.targetFps <= 0.0)
+	{
+		return;
+	}
+
+	Clock::duration period = std::chrono::duration_cast<Clock::duration>(
+		std::chrono::duration<f64>(1.0 / pPacer->settings.targetFps));
+
+	// More than a frame late (first frame, hitch, settings change): restart the schedule from now
+	if (pPacer->nextFrameTime + period < now)
+	{
+		pPacer->nextFrameTime = now;
+	}
+
+	Clock::time_point target	  = pPacer->nextFrameTime;
+	f64				  remainingMs = toMilliseconds(target - now);
+
+	// Sleeping is coarse, leave a margin that is spun away; the margin follows the observed overshoot
+	if (remainingMs > pPacer->spinMarginMs)
+	{
+		f64 sleepMs = remainingMs - pPacer->spinMarginMs;
+		std::this_thread::sleep_for(std::chrono::duration<f64, std::milli>(sleepMs));
+
+		f64 overshootMs		 = toMilliseconds(Clock::now() - now) - sleepMs;
+		pPacer->spinMarginMs = std::clamp(
+			0.9 * pPacer->spinMarginMs + 0.1 * (overshootMs * 1.5), MIN_SPIN_MARGIN_MS, MAX_SPIN_MARGIN_MS);
+	}
+
+	while (Clock::now() < target)
+	{
+		std::this_thread::yield();
+	}
+
+	pPacer->waitSum += toMilliseconds(Clock::now() - now);
+	pPacer->nextFrameTime = target + period;
+}
+
+void markFrameAcquire(FramePacer* pPacer)
+{
+	pPacer->acquireTime = Clock::now();
+}
+
+void markFramePresented(FramePacer* pPacer)
+{
+	Clock::time_point now = Clock::now();
+
+	f64 acquireToPresentMs = toMilliseconds(now - pPacer->acquireTime);
+	pPacer->acquireToPresentSum += acquireToPresentMs;
+	pPacer->acquireToPresentMax = std::max(pPacer->acquireToPresentMax, acquireToPresentMs);
+
+	if (pPacer->framesCount > 0)
+	{
+		f64 intervalMs = toMilliseconds(now - pPacer->lastPresentTime);
+		pPacer->frameIntervalSum += intervalMs;
+		pPacer->frameIntervalSquaredSum += intervalMs * intervalMs;
+		pPacer->intervalsCount++;
+	}
+
+	pPacer->lastPresentTime = now;
+	pPacer->framesCount++;
+}
+
+FramePacingStatistics getFramePacingStatistics(FramePacer* pPacer)
+{
+	FramePacingStatistics statistics = {};
+	statistics.framesCount			 = pPacer->framesCount;
+	if (pPacer->framesCount == 0)
+	{
+		return statistics;
+	}
+
+	statistics.averageAcquireToPresentMs = pPacer->acquireToPresentSum / f64(pPacer->framesCount);
+	statistics.maxAcquireToPresentMs	 = pPacer->acquireToPresentMax;
+	statistics.averageWaitMs			 = pPacer->waitSum / f64(pPacer->framesCount);
+
+	if (pPacer->intervalsCount > 0)
+	{
+		f64 mean				  = pPacer->frameIntervalSum / f64(pPacer->intervalsCount);
+		f64 variance			  = pPacer->frameIntervalSquaredSum / f64(pPacer->intervalsCount) - mean * mean;
+		statistics.averageFrameMs = mean;
+		statistics.frameJitterMs  = std::sqrt(std::max(variance, 0.0));
+	}
+
+	return statistics;
+}
+
+void printFramePacingStatistics(FramePacer* pPacer)
+{
+	FramePacingStatistics	   statistics = getFramePacingStatistics(pPacer);
+	const FramePacingSettings& settings	  = pPacer->settings;
+
+	printf("Frame pacing [%s, +%u images, %.0f fps cap]: %llu frames, %.2f ms/frame, jitter %.3f ms, "
+		   "acquire->present %.2f ms (max %.2f ms), throttle wait %.2f ms\n",
+		   getPresentPolicyName(settings.presentPolicy),
+		   settings.extraImages,
+		   settings.targetFps,
+		   statistics.framesCount,
+		   statistics.averageFrameMs,
+		   statistics.frameJitterMs,
+		   statistics.averageAcquireToPresentMs,
+		   statistics.maxAcquireToPresentMs,
+		   statistics.averageWaitMs);
+}
+
+void resetFramePacingStatistics(FramePacer* pPacer)
+{
+	pPacer->framesCount				= 0;
+	pPacer->intervalsCount			= 0;
+	pPacer->frameIntervalSum		= 0.0;
+	pPacer->frameIntervalSquaredSum = 0.0;
+	pPacer->acquireToPresentSum		= 0.0;
+	pPacer->acquireToPresentMax		= 0.0;
+	pPacer->waitSum					= 0.0;
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "common.h"
+
+/**
+ * Present mode / swapchain image count policy and CPU frame pacing. The policy decides the latency/throughput
+ * trade-off of the swapchain, the pacer throttles the main loop to a target frame rate. Waiting happens before
+ * input is polled, so a capped frame samples input as late as possible instead of queueing up behind the
+ * presentation engine. The wait sleeps for most of the remaining time and spins the rest, the spin margin
+ * follows the measured sleep overshoot.
+ *
+ * @example
+ * ```c++
+ * while (running)
+ * {
+ *     waitForNextFrame(pPacer);
+ *     glfwPollEvents();
+ *     markFrameAcquire(pPacer);
+ *     vkAcquireNextImageKHR(...);
+ *     ...
+ *     vkQueuePresentKHR(...);
+ *     markFramePresented(pPacer);
+ * }
+ * ```
+ */
+
+enum class PresentPolicy
+{
+	LOW_LATENCY,   // MAILBOX, then FIFO, never tears
+	VSYNC,		   // FIFO
+	RELAXED_VSYNC, // FIFO_RELAXED, then FIFO
+	UNCAPPED,	   // IMMEDIATE, then MAILBOX, then FIFO
+
+	COUNT,
+};
+
+struct FramePacingSettings
+{
+	PresentPolicy presentPolicy;
+	u32			  extraImages; // swapchain images requested on top of minImageCount
+	f64			  targetFps;   // 0 disables the CPU throttle
+};
+
+struct FramePacingStatistics
+{
+	u64 framesCount;
+	f64 averageFrameMs;
+	f64 frameJitterMs; // standard deviation of the present-to-present interval
+	f64 averageAcquireToPresentMs;
+	f64 maxAcquireToPresentMs;
+	f64 averageWaitMs; // time spent in the throttle
+};
+
+struct FramePacer;
+
+FramePacer* createFramePacer(const FramePacingSettings& settings);
+void		destroyFramePacer(FramePacer* pPacer);
+
+FramePacingSettings getFramePacingSettings(FramePacer* pPacer);
+void				setFramePacingSettings(FramePacer* pPacer, const FramePacingSettings& settings);
+const char*			getPresentPolicyName(PresentPolicy presentPolicy);
+
+VkPresentModeKHR choosePresentMode(FramePacer* pPacer, const std::vector<VkPresentModeKHR>& availablePresentModes);
+u32				 chooseImageCount(FramePacer* pPacer, const VkSurfaceCapabilitiesKHR& surfaceCapabilities);
+
+void waitForNextFrame(FramePacer* pPacer);
+void markFrameAcquire(FramePacer* pPacer);
+void markFramePresented(FramePacer* pPacer);
+
+FramePacingStatistics getFramePacingStatistics(FramePacer* pPacer);
+void				  printFramePacingStatistics(FramePacer* pPacer);
+void				  resetFramePacingStatistics(FramePacer* pPacer);
@@ -1,10 +1,25 @@
 #include "common.h"
+#include "bindless.h"
+#include "compute_scheduler.h"
+#include "deletion_queue.h"
+#include "frame_pacing.h"
+#include "memory_allocator.h"
+#include "parallel_recorder.h"
+#include "pipeline_cache.h"
+#include "render_graph.h"
+#include "shader_variants.h"
+#include "upload_service.h"
+#include "vertex_input.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
 #include <cstring>
 #include <functional>
 #include <set>
 #include <stack>
 
-using ReleaseFunc = std::function<void(void*)>;
+// Plain function pointer, every release node is a capture-less lambda working on pData
+typedef void (*ReleaseFunc)(void*);
 struct ReleaseNode
 {
 	void*		pData;
@@ -49,9 +64,101 @@ struct QueueFamilies
 
 struct FlightSyncObjects
 {
-	VkSemaphore imageAvailableSemaphore;
-	VkSemaphore renderFinishedSemaphore;
-	VkFence		inFlightFence;
+	VkSemaphore		imageAvailableSemaphore;
+	VkSemaphore		renderFinishedSemaphore;
+	VkFence			inFlightFence;
+	VkCommandBuffer graphicsBuffer; // recorded again once inFlightFence is signaled
+};
+
+using Clock = std::chrono::steady_clock;
+
+struct SwapchainResizeState
+{
+	b8				  dirty;			// resized or out of date, recreated once the debounce delay has passed
+	b8				  outOfDate;		// the current swapchain can't be presented anymore
+	b8				  measuring;		// the next presented frame closes a resize latency measurement
+	Clock::time_point firstEventTime;	// first resize event of the current burst
+	Clock::time_point lastEventTime;
+	Clock::time_point recreateTime;
+	f64				  recreateMs;
+	u32				  eventsCount;		// resize events coalesced into the pending recreation
+	u32				  recreationsCount;
+};
+
+// Push constants of one draw, laid out like the push_constant block of the shaders
+struct DrawConstants
+{
+	f32 offset[2];
+	f32 scale;
+	u32 textureID;
+	u32 materialID;
+};
+
+// Vertices of the scene triangle, placed and scaled by the push constants of each draw
+struct SceneVertex
+{
+	f32 position[2];
+	f32 color[3];
+};
+
+VERTEX_LAYOUT(SceneVertex, VERTEX_ATTRIBUTE(position, VEC2), VERTEX_ATTRIBUTE(color, VEC3));
+
+static constexpr VertexInputDescription sceneVertexInput = getVertexInputDescription<SceneVertex>(0);
+static_assert(sceneVertexInput.binding.stride == 20, "Scene vertices are two then three floats");
+static_assert(sceneVertexInput.attributes[0].format == VK_FORMAT_R32G32_SFLOAT &&
+				  sceneVertexInput.attributes[0].offset == 0,
+			  "simple.vert reads the position as a vec2 at location 0");
+static_assert(sceneVertexInput.attributes[1].format == VK_FORMAT_R32G32B32_SFLOAT &&
+				  sceneVertexInput.attributes[1].offset == 8,
+			  "simple.vert reads the color as a vec3 at location 1");
+
+static const SceneVertex sceneTriangle[3] = {
+	{{0.0f, -0.5f}, {1.0f, 0.0f, 0.0f}},
+	{{0.5f, 0.5f}, {0.0f, 1.0f, 0.0f}},
+	{{-0.5f, 0.5f}, {0.0f, 0.0f, 1.0f}},
+};
+
+// Push constants of tint.comp
+struct TintConstants
+{
+	f32 time;
+	u32 materialID;
+};
+
+// Feature bits of the scene fragment shaders, the pipelines of every declared combination are created up front
+enum SceneFeature : u32
+{
+	SCENE_FEATURE_WIREFRAME		= 1u << 0, // preprocessor variant, reads the barycentrics
+	SCENE_FEATURE_MATERIAL_TINT = 1u << 1, // specialization constant of bindless.frag
+};
+
+#define SCENE_VARIANTS_COUNT 4
+
+#define MATERIAL_TINT_PRESETS_COUNT 3
+static const f32 materialTintPresets[MATERIAL_TINT_PRESETS_COUNT][4] = {
+	{1.0f, 0.85f, 0.6f, 1.0f},
+	{0.6f, 0.85f, 1.0f, 1.0f},
+	{0.7f, 1.0f, 0.7f, 1.0f},
+};
+
+struct GraphBlit
+{
+	GraphResource source;
+	GraphResource destination;
+	VkFilter	  filter;
+};
+
+// Resources and pass data of the frame graph, redeclared every frame
+struct FrameGraph
+{
+	GraphResource backbuffer;
+	GraphResource sceneColor;
+	GraphResource softFocusHalf;
+	GraphResource softFocusFull;
+
+	GraphBlit downsampleBlit;
+	GraphBlit upsampleBlit;
+	GraphBlit presentBlit;
 };
 
 struct DeviceContext
@@ -61,6 +168,11 @@ struct DeviceContext
 	VkDevice		 device;
 	QueueFamilies	 queueFamilies;
 
+	VkQueue graphicsQueue;
+	VkQueue presentQueue;
+	VkQueue computeQueue;
+	VkQueue transferQueue;
+
 	VkSwapchainKHR			 swapchain;
 	VkFormat				 swapchainImageFormat;
 	VkExtent2D				 swapchainExtent;
@@ -69,13 +181,56 @@ struct DeviceContext
 	std::vector<VkImage>	 swapchainImages;
 	std::vector<VkImageView> swapchainImageViews;
 
+	SwapchainResizeState resizeState;
+
 	VkCommandPool graphicsCommandPool;
 	VkCommandPool presentCommandPool;
 
-	VkCommandBuffer graphicsBuffer;
 	VkCommandBuffer presentBuffer;
 
 	std::vector<FlightSyncObjects> flightSyncObjects;
+	u32							   currentFrame;
+	u64							   framesCount;
+
+	VkPipelineCache	  pipelineCache;
+	PipelineCacheInfo pipelineCacheInfo;
+
+	VkRenderPass	 renderPass;
+	VkPipelineLayout pipelineLayout;
+	VkPipeline		 scenePipelines[SCENE_VARIANTS_COUNT]; // indexed by the features the scene shader declares
+	u32				 sceneFeaturesMask;
+	VkPipeline		 tintPipeline; // async compute, animates the tint materials
+
+	RenderGraph*  pRenderGraph;
+	FrameGraph	  frameGraph;
+	VkFramebuffer sceneFramebuffer;
+	VkImageView	  sceneFramebufferView; // scene color view sceneFramebuffer was created for
+
+	MemoryAllocator* pMemoryAllocator;
+	FrameAllocator	 frameAllocator;
+	DeletionQueue*	 pDeletionQueue;
+	UploadService*	 pUploadService;
+
+	ComputeScheduler* pComputeScheduler;
+	FramePacer*		  pFramePacer;
+	ParallelRecorder* pParallelRecorder;
+
+	AllocatedBuffer			   sceneVertexBuffer;
+	std::vector<DrawConstants> drawList;
+
+	b8				bindlessSupported;
+	BindlessTable*	pBindlessTable;
+	AllocatedImage	checkerTexture;
+	VkImageView		checkerTextureView;
+	VkSampler		sampler;
+	AllocatedBuffer materialsBuffer;
+	BindlessID		checkerTextureID;
+	BindlessID		materialID;
+	u32				materialTintPreset; // the one materialsBuffer holds
+
+	// One per frame in flight, written by the compute queue and read by the frame of the same slot
+	std::vector<AllocatedBuffer> tintMaterialsBuffers;
+	std::vector<BindlessID>		 tintMaterialIDs;
 
 	std::stack<ReleaseNode> releaseStack;
 };
@@ -83,6 +238,16 @@ struct DeviceContext
 static InstanceContext		   instanceContext = {};
 static std::stack<ReleaseNode> releaseStack;
 
+static Clock::time_point	 startTime;
+static b8					 pipelineCacheEnabled = true;
+static FramePacingSettings framePacingSettings	= {PresentPolicy::LOW_LATENCY, 1, 0.0};
+static u32					 drawsCount			  = 4096;
+static u32					 recordThreadsCount	  = 0; // 0 uses every hardware thread
+static b8					 recordSweep		  = false;
+static b8					 softFocusEnabled	  = false;
+static u32					 sceneFeatures		  = SCENE_FEATURE_MATERIAL_TINT;
+static u32					 materialTintPreset	  = 0;
+
 static void createInstance();
 static void getPhysicalDevices();
 static void createSurface(GLFWwindow* pWindow);
@@ -92,17 +257,21 @@ using EvaluatePhysicalDeviceFunc = std::function<u32(VkPhysicalDevice)>;
 using ChooseFormatFunc		= std::function<VkFormat(const std::vector<VkFormat>&)>;
 using ChoosePresentModeFunc = std::function<VkPresentModeKHR(const std::vector<VkPresentModeKHR>&)>;
 using ChooseImageCountFunc	= std::function<u32(VkSurfaceCapabilitiesKHR)>;
-using ChooseExtentFunc		= std::function<VkExtent2D(const VkSurfaceCapabilitiesKHR&)>;
+using ChooseExtentFunc		= std::function<VkExtent2D(const VkSurfaceCapabilitiesKHR&, VkExtent2D)>;
 
 static u32				evaluatePhysicalDevice(VkPhysicalDevice physicalDevice);
 static VkFormat			chooseSwapchainFormat(const std::vector<VkFormat>& availableFormats);
 static VkPresentModeKHR chooseSwapchainPresentMode(const std::vector<VkPresentModeKHR>& availablePresentModes);
 static u32				chooseSwapchainImageCount(VkSurfaceCapabilitiesKHR surfaceCapabilities);
-static VkExtent2D		chooseSwapchainExtent(const VkSurfaceCapabilitiesKHR& surfaceCapabilities);
+static VkExtent2D		chooseSwapchainExtent(const VkSurfaceCapabilitiesKHR& surfaceCapabilities,
+											  VkExtent2D					  framebufferExtent);
 
 static DeviceContext createDevice(GLFWwindow*				 pWindow,
 								  EvaluatePhysicalDeviceFunc evaluateFunc = evaluatePhysicalDevice);
 static void			 destroyDevice(DeviceContext& deviceContext);
+static void			 drawFrame(DeviceContext& deviceContext);
+static void			 onFramebufferResized(GLFWwindow* pWindow, i32 width, i32 height);
+static void			 onKeyPressed(GLFWwindow* pWindow, i32 key, i32 scancode, i32 action, i32 mods);
 
 #define CLEANUP(releaseStack)                                                                                          \
 	do                                                                                                                 \
@@ -115,8 +284,48 @@ static void			 destroyDevice(DeviceContext& deviceContext);
 		}                                                                                                              \
 	} while (0)
 
-int main()
+int main(int argc, char** argv)
 {
+	startTime = Clock::now();
+
+	for (i32 argIndex = 1; argIndex < argc; ++argIndex)
+	{
+		if (strcmp(argv[argIndex], "--no-pipeline-cache") == 0)
+		{
+			pipelineCacheEnabled = false;
+		}
+		else if (strncmp(argv[argIndex], "--present-policy=", 17) == 0)
+		{
+			for (u32 policy = 0u; policy < u32(PresentPolicy::COUNT); ++policy)
+			{
+				if (strcmp(argv[argIndex] + 17, getPresentPolicyName(PresentPolicy(policy))) == 0)
+				{
+					framePacingSettings.presentPolicy = PresentPolicy(policy);
+				}
+			}
+		}
+		else if (strncmp(argv[argIndex], "--extra-images=", 15) == 0)
+		{
+			framePacingSettings.extraImages = u32(atoi(argv[argIndex] + 15));
+		}
+		else if (strncmp(argv[argIndex], "--fps=", 6) == 0)
+		{
+			framePacingSettings.targetFps = atof(argv[argIndex] + 6);
+		}
+		else if (strncmp(argv[argIndex], "--draws=", 8) == 0)
+		{
+			drawsCount = u32(atoi(argv[argIndex] + 8));
+		}
+		else if (strncmp(argv[argIndex], "--record-threads=", 17) == 0)
+		{
+			recordThreadsCount = u32(atoi(argv[argIndex] + 17));
+		}
+		else if (strcmp(argv[argIndex], "--record-sweep") == 0)
+		{
+			recordSweep = true;
+		}
+	}
+
 	ASSERT(glfwInit());
 	releaseStack.push({nullptr, [](void*) { glfwTerminate(); }});
 
@@ -132,11 +341,19 @@ int main()
 	DeviceContext device = createDevice(pWindow, evaluatePhysicalDevice);
 	releaseStack.push({&device, [](void* p) { destroyDevice(*(DeviceContext*)p); }});
 
+	glfwSetWindowUserPointer(pWindow, &device);
+	glfwSetFramebufferSizeCallback(pWindow, onFramebufferResized);
+	glfwSetKeyCallback(pWindow, onKeyPressed);
+
 	while (!glfwWindowShouldClose(pWindow))
 	{
+		// Throttle before polling so the frame works with the freshest input
+		waitForNextFrame(device.pFramePacer);
 		glfwPollEvents();
+		drawFrame(device);
 	}
 
+	VK_ASSERT(vkDeviceWaitIdle(device.device));
 	CLEANUP(releaseStack);
 
 	return 0;
@@ -151,7 +368,7 @@ static void createInstance()
 	appInfo.applicationVersion = VK_MAKE_VERSION(1, 0, 0);
 	appInfo.pEngineName		   = "No Engine";
 	appInfo.engineVersion	   = VK_MAKE_VERSION(1, 0, 0);
-	appInfo.apiVersion		   = VK_API_VERSION_1_1;
+	appInfo.apiVersion		   = VK_API_VERSION_1_2;
 
 	std::vector<const char*> finalExtensions	= requiredExtensions;
 	u32						 glfwExtensionCount = 0;
@@ -210,6 +427,23 @@ static void createSwapchainImagesViews(DeviceContext& deviceContext);
 static void createCommandPools(DeviceContext& deviceContext);
 static void createCommandBuffers(DeviceContext& deviceContext);
 static void createFlightSyncObjects(DeviceContext& deviceContext);
+static void createSemaphore(VkDevice device, VkSemaphore* pSemaphore);
+static void createFence(VkDevice device, VkFence* pFence);
+static void createPipelineCache(DeviceContext& deviceContext);
+static void createRenderPass(DeviceContext& deviceContext);
+static void createFramePacer(DeviceContext& deviceContext);
+static void createPacedSwapchain(DeviceContext& deviceContext);
+static void createSwapchainRelease(DeviceContext& deviceContext);
+static void createGraphicsPipelines(DeviceContext& deviceContext);
+static void createComputePipelines(DeviceContext& deviceContext);
+static void createMemoryAllocators(DeviceContext& deviceContext);
+static void createUploadService(DeviceContext& deviceContext);
+static void createComputeScheduler(DeviceContext& deviceContext);
+static void createBindlessResources(DeviceContext& deviceContext);
+static void createParallelRecorder(DeviceContext& deviceContext);
+static void createSceneVertexBuffer(DeviceContext& deviceContext);
+static void createDrawList(DeviceContext& deviceContext);
+static void createRenderGraph(DeviceContext& deviceContext);
 
 static DeviceContext createDevice(GLFWwindow* pWindow, EvaluatePhysicalDeviceFunc evaluateFunc)
 {
@@ -219,23 +453,1205 @@ static DeviceContext createDevice(GLFWwindow* pWindow, EvaluatePhysicalDeviceFun
 	choosePhysicalDevice(deviceContext, evaluateFunc);
 	findQueueFamilies(deviceContext);
 	createDevice(deviceContext);
-	createSwapchain(deviceContext);
+	createPipelineCache(deviceContext);
+	createFramePacer(deviceContext);
+	createPacedSwapchain(deviceContext);
 	aquireSwapchainImages(deviceContext);
 	createSwapchainImagesViews(deviceContext);
+	createRenderPass(deviceContext);
+	createSwapchainRelease(deviceContext);
 	createCommandPools(deviceContext);
 	createCommandBuffers(deviceContext);
 	createFlightSyncObjects(deviceContext);
+	createMemoryAllocators(deviceContext);
+	createUploadService(deviceContext);
+	createComputeScheduler(deviceContext);
+	createBindlessResources(deviceContext);
+	createGraphicsPipelines(deviceContext);
+	createComputePipelines(deviceContext);
+	createParallelRecorder(deviceContext);
+	createSceneVertexBuffer(deviceContext);
+	createDrawList(deviceContext);
+	createRenderGraph(deviceContext);
 
 	return deviceContext;
 }
 
-static void createSemaphore(VkDevice device, VkSemaphore* pSemaphore);
-static void createFence(VkDevice device, VkFence* pFence);
+#define SWAPCHAIN_RESIZE_DEBOUNCE_MS 50.0
+
+static void onFramebufferResized(GLFWwindow* pWindow, i32 width, i32 height)
+{
+	DeviceContext&		  deviceContext = *(DeviceContext*)glfwGetWindowUserPointer(pWindow);
+	SwapchainResizeState& resizeState	= deviceContext.resizeState;
+
+	Clock::time_point now = Clock::now();
+	if (!resizeState.dirty)
+	{
+		resizeState.dirty		   = true;
+		resizeState.firstEventTime = now;
+		resizeState.eventsCount	   = 0;
+	}
+	resizeState.lastEventTime = now;
+	resizeState.eventsCount++;
+}
+
+static void markSwapchainOutOfDate(DeviceContext& deviceContext);
+
+#define TARGET_FPS_PRESETS_COUNT 5
+static const f64 targetFpsPresets[TARGET_FPS_PRESETS_COUNT] = {0.0, 30.0, 60.0, 120.0, 144.0};
+
+static u32 nextRecordThreadsCount(ParallelRecorder* pRecorder, u32 threadsCount)
+{
+	u32 maxThreadsCount = getRecorderMaxThreadsCount(pRecorder);
+	return threadsCount >= maxThreadsCount ? 1u : std::min(threadsCount * 2u, maxThreadsCount);
+}
+
+// P cycles the present policy, I the extra swapchain images, F the frame rate cap, T the recording threads,
+// B toggles the soft focus passes of the frame graph, W and M the wireframe and material tint shader variants,
+// C cycles the tint of the material
+static void onKeyPressed(GLFWwindow* pWindow, i32 key, i32 scancode, i32 action, i32 mods)
+{
+	if (action != GLFW_PRESS)
+	{
+		return;
+	}
+
+	DeviceContext& deviceContext = *(DeviceContext*)glfwGetWindowUserPointer(pWindow);
+	if (key == GLFW_KEY_B)
+	{
+		softFocusEnabled = !softFocusEnabled;
+		return;
+	}
+
+	if (key == GLFW_KEY_W || key == GLFW_KEY_M)
+	{
+		sceneFeatures ^= key == GLFW_KEY_W ? SCENE_FEATURE_WIREFRAME : SCENE_FEATURE_MATERIAL_TINT;
+		return;
+	}
+
+	if (key == GLFW_KEY_C)
+	{
+		materialTintPreset = (materialTintPreset + 1) % MATERIAL_TINT_PRESETS_COUNT;
+		return;
+	}
+
+	if (key == GLFW_KEY_T)
+	{
+		RecorderTimings timings = getRecorderTimings(deviceContext.pParallelRecorder);
+		printRecorderTimings(deviceContext.pParallelRecorder);
+		setRecorderThreadsCount(deviceContext.pParallelRecorder,
+								nextRecordThreadsCount(deviceContext.pParallelRecorder, timings.threadsCount));
+		return;
+	}
+
+	if (key != GLFW_KEY_P && key != GLFW_KEY_I && key != GLFW_KEY_F)
+	{
+		return;
+	}
+
+	FramePacingSettings settings = getFramePacingSettings(deviceContext.pFramePacer);
+
+	if (key == GLFW_KEY_P)
+	{
+		settings.presentPolicy = PresentPolicy((u32(settings.presentPolicy) + 1) % u32(PresentPolicy::COUNT));
+	}
+	else if (key == GLFW_KEY_I)
+	{
+		settings.extraImages = (settings.extraImages + 1) % 3;
+	}
+	else
+	{
+		u32 preset = 0;
+		while (preset < TARGET_FPS_PRESETS_COUNT && targetFpsPresets[preset] != settings.targetFps)
+		{
+			preset++;
+		}
+		settings.targetFps = targetFpsPresets[(preset + 1) % TARGET_FPS_PRESETS_COUNT];
+	}
+
+	// Report the configuration being left, so configurations can be compared
+	printFramePacingStatistics(deviceContext.pFramePacer);
+	setFramePacingSettings(deviceContext.pFramePacer, settings);
+
+	if (key != GLFW_KEY_F)
+	{
+		markSwapchainOutOfDate(deviceContext);
+	}
+}
+
+static void markSwapchainOutOfDate(DeviceContext& deviceContext)
+{
+	SwapchainResizeState& resizeState = deviceContext.resizeState;
+	if (!resizeState.dirty)
+	{
+		// Not caused by a resize event, nothing to debounce
+		resizeState.dirty		   = true;
+		resizeState.firstEventTime = Clock::now();
+		resizeState.lastEventTime  = Clock::time_point();
+		resizeState.eventsCount	   = 0;
+	}
+	resizeState.outOfDate = true;
+}
+
+// Returns false while the window is minimized or the resize burst is still going on
+static b8 recreateSwapchain(DeviceContext& deviceContext)
+{
+	SwapchainResizeState& resizeState = deviceContext.resizeState;
+
+	f64 sinceLastEvent = std::chrono::duration<f64, std::milli>(Clock::now() - resizeState.lastEventTime).count();
+	if (sinceLastEvent < SWAPCHAIN_RESIZE_DEBOUNCE_MS)
+	{
+		return false;
+	}
+
+	i32 width, height;
+	glfwGetFramebufferSize(deviceContext.pWindow, &width, &height);
+	if (width == 0 || height == 0)
+	{
+		glfwWaitEvents();
+		return false;
+	}
+
+	Clock::time_point recreateStart = Clock::now();
+
+	// The old swapchain stays alive (and keeps presenting) until the frames using it have completed
+	DeletionQueue* pDeletionQueue = deviceContext.pDeletionQueue;
+	for (VkImageView imageView : deviceContext.swapchainImageViews)
+	{
+		deferDestroyImageView(pDeletionQueue, imageView);
+	}
+	VkSwapchainKHR oldSwapchain = deviceContext.swapchain;
+
+	// A failed acquire/present leaves the semaphores in an unknown state, replace them all
+	for (FlightSyncObjects& syncObjects : deviceContext.flightSyncObjects)
+	{
+		deferDestroySemaphore(pDeletionQueue, syncObjects.imageAvailableSemaphore);
+		deferDestroySemaphore(pDeletionQueue, syncObjects.renderFinishedSemaphore);
+		createSemaphore(deviceContext.device, &syncObjects.imageAvailableSemaphore);
+		createSemaphore(deviceContext.device, &syncObjects.renderFinishedSemaphore);
+	}
+
+	VkFormat previousFormat = deviceContext.swapchainImageFormat;
+
+	createPacedSwapchain(deviceContext);
+	aquireSwapchainImages(deviceContext);
+	createSwapchainImagesViews(deviceContext);
+	deferDestroySwapchain(pDeletionQueue, oldSwapchain);
+
+	// The render pass and pipelines are built for the swapchain format
+	ASSERT(deviceContext.swapchainImageFormat == previousFormat);
+
+	resizeState.dirty		 = false;
+	resizeState.outOfDate	 = false;
+	resizeState.measuring	 = true;
+	resizeState.recreateTime = Clock::now();
+	resizeState.recreateMs	 = std::chrono::duration<f64, std::milli>(resizeState.recreateTime - recreateStart).count();
+	resizeState.recreationsCount++;
+
+	return true;
+}
+
+#define RECORD_SWEEP_FRAMES 300
+
+static u32	nextRecordThreadsCount(ParallelRecorder* pRecorder, u32 threadsCount);
+static u64	recordTintCompute(DeviceContext& deviceContext);
+static void recordFrame(DeviceContext& deviceContext, u32 imageIndex, UploadWait* pUploadWait);
+static void drawFrame(DeviceContext& deviceContext)
+{
+	FlightSyncObjects& syncObjects = deviceContext.flightSyncObjects[deviceContext.currentFrame];
+
+	VK_ASSERT(vkWaitForFences(deviceContext.device, 1, &syncObjects.inFlightFence, VK_TRUE, UINT64_MAX));
+
+	// Whatever was retired the last time this frame slot was recorded is no longer in use
+	beginDeletionFrame(deviceContext.pDeletionQueue, deviceContext.currentFrame);
+
+	// During a resize burst the old swapchain keeps being used for as long as it can present
+	if (deviceContext.resizeState.dirty && !recreateSwapchain(deviceContext) && deviceContext.resizeState.outOfDate)
+	{
+		return;
+	}
+
+	markFrameAcquire(deviceContext.pFramePacer);
+
+	u32		 imageIndex	   = 0;
+	VkResult acquireResult = vkAcquireNextImageKHR(deviceContext.device,
+												   deviceContext.swapchain,
+												   UINT64_MAX,
+												   syncObjects.imageAvailableSemaphore,
+												   VK_NULL_HANDLE,
+												   &imageIndex);
+	if (acquireResult == VK_ERROR_OUT_OF_DATE_KHR)
+	{
+		markSwapchainOutOfDate(deviceContext);
+		return;
+	}
+	ASSERT(acquireResult == VK_SUCCESS || acquireResult == VK_SUBOPTIMAL_KHR);
+
+	resetFrameAllocator(deviceContext.frameAllocator, deviceContext.currentFrame);
+	if (deviceContext.bindlessSupported)
+	{
+		beginBindlessFrame(deviceContext.pBindlessTable, deviceContext.framesCount);
+	}
+
+	VK_ASSERT(vkResetFences(deviceContext.device, 1, &syncObjects.inFlightFence));
+
+	u64		   computeTicket = recordTintCompute(deviceContext);
+	UploadWait uploadWait	 = {};
+	recordFrame(deviceContext, imageIndex, &uploadWait);
+
+	// Only the fragment shaders read what the compute queue wrote, the graphics value lets compute depend on us
+	QueueSync queueSync =
+		getGraphicsQueueSync(deviceContext.pComputeScheduler, computeTicket, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+
+	VkSemaphore			 waitSemaphores[3];
+	uint64_t			 waitValues[3];
+	VkPipelineStageFlags waitStages[3];
+	u32					 waitCount = 0;
+
+	waitSemaphores[waitCount] = syncObjects.imageAvailableSemaphore;
+	waitValues[waitCount]	  = 0;
+	waitStages[waitCount++]	  = VK_PIPELINE_STAGE_TRANSFER_BIT; // the frame graph blits to the backbuffer
+
+	if (uploadWait.semaphore != VK_NULL_HANDLE)
+	{
+		waitSemaphores[waitCount] = uploadWait.semaphore;
+		waitValues[waitCount]	  = uploadWait.value;
+		waitStages[waitCount++]	  = uploadWait.stageMask;
+	}
+
+	if (queueSync.waitSemaphore != VK_NULL_HANDLE)
+	{
+		waitSemaphores[waitCount] = queueSync.waitSemaphore;
+		waitValues[waitCount]	  = queueSync.waitValue;
+		waitStages[waitCount++]	  = queueSync.waitStageMask;
+	}
+
+	VkSemaphore signalSemaphores[] = {syncObjects.renderFinishedSemaphore, queueSync.signalSemaphore};
+	uint64_t	signalValues[]	   = {0, queueSync.signalValue};
+
+	VkTimelineSemaphoreSubmitInfo timelineInfo = {};
+	timelineInfo.sType						   = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+	timelineInfo.waitSemaphoreValueCount	   = waitCount;
+	timelineInfo.pWaitSemaphoreValues		   = waitValues;
+	timelineInfo.signalSemaphoreValueCount	   = 2;
+	timelineInfo.pSignalSemaphoreValues		   = signalValues;
+
+	VkSubmitInfo submitInfo			= {};
+	submitInfo.sType				= VK_STRUCTURE_TYPE_SUBMIT_INFO;
+	submitInfo.pNext				= &timelineInfo;
+	submitInfo.waitSemaphoreCount	= waitCount;
+	submitInfo.pWaitSemaphores		= waitSemaphores;
+	submitInfo.pWaitDstStageMask	= waitStages;
+	submitInfo.commandBufferCount	= 1;
+	submitInfo.pCommandBuffers		= &syncObjects.graphicsBuffer;
+	submitInfo.signalSemaphoreCount = 2;
+	submitInfo.pSignalSemaphores	= signalSemaphores;
+	VK_ASSERT(vkQueueSubmit(deviceContext.graphicsQueue, 1, &submitInfo, syncObjects.inFlightFence));
+
+	VkPresentInfoKHR presentInfo   = {};
+	presentInfo.sType			   = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
+	presentInfo.waitSemaphoreCount = 1;
+	presentInfo.pWaitSemaphores	   = &syncObjects.renderFinishedSemaphore;
+	presentInfo.swapchainCount	   = 1;
+	presentInfo.pSwapchains		   = &deviceContext.swapchain;
+	presentInfo.pImageIndices	   = &imageIndex;
+	VkResult presentResult = vkQueuePresentKHR(deviceContext.presentQueue, &presentInfo);
+	markFramePresented(deviceContext.pFramePacer);
+	if (presentResult == VK_ERROR_OUT_OF_DATE_KHR || presentResult == VK_SUBOPTIMAL_KHR ||
+		acquireResult == VK_SUBOPTIMAL_KHR)
+	{
+		markSwapchainOutOfDate(deviceContext);
+	}
+	else
+	{
+		VK_ASSERT(presentResult);
+	}
+
+	SwapchainResizeState& resizeState = deviceContext.resizeState;
+	if (resizeState.measuring)
+	{
+		Clock::time_point now = Clock::now();
+		printf("Swapchain recreated to %ux%u: resize to first frame %.2f ms (recreation %.2f ms, frame %.2f ms), "
+			   "%u resize events coalesced\n",
+			   deviceContext.swapchainExtent.width,
+			   deviceContext.swapchainExtent.height,
+			   std::chrono::duration<f64, std::milli>(now - resizeState.firstEventTime).count(),
+			   resizeState.recreateMs,
+			   std::chrono::duration<f64, std::milli>(now - resizeState.recreateTime).count(),
+			   resizeState.eventsCount);
+		resizeState.measuring = false;
+	}
+
+	if (deviceContext.framesCount == 0)
+	{
+		f64 timeToFirstFrame = std::chrono::duration<f64, std::milli>(Clock::now() - startTime).count();
+		printf("Time to first frame: %.2f ms (pipeline cache %s)\n",
+			   timeToFirstFrame,
+			   !pipelineCacheEnabled						  ? "disabled"
+			   : deviceContext.pipelineCacheInfo.loadedFromDisk ? "warm"
+																: "cold");
+	}
+
+	deviceContext.framesCount++;
+	deviceContext.currentFrame = (deviceContext.currentFrame + 1) % u32(deviceContext.flightSyncObjects.size());
+
+	if (recordSweep && deviceContext.framesCount % RECORD_SWEEP_FRAMES == 0)
+	{
+		ParallelRecorder* pRecorder	   = deviceContext.pParallelRecorder;
+		u32				  threadsCount = getRecorderTimings(pRecorder).threadsCount;
+		printRecorderTimings(pRecorder);
+
+		if (threadsCount == getRecorderMaxThreadsCount(pRecorder))
+		{
+			printRecorderScaling(pRecorder);
+			recordSweep = false;
+		}
+		else
+		{
+			setRecorderThreadsCount(pRecorder, nextRecordThreadsCount(pRecorder, threadsCount));
+		}
+	}
+}
+
+// Runs on the recording threads, only reads the device context
+static void recordDraws(VkCommandBuffer commandBuffer, u32 firstDraw, u32 drawCount, void* pUserData)
+{
+	const DeviceContext& deviceContext = *(const DeviceContext*)pUserData;
+
+	VkViewport viewport = {};
+	viewport.width		= f32(deviceContext.swapchainExtent.width);
+	viewport.height		= f32(deviceContext.swapchainExtent.height);
+	viewport.maxDepth	= 1.0f;
+	vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+
+	VkRect2D scissor = {};
+	scissor.extent	 = deviceContext.swapchainExtent;
+	vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+
+	VkPipeline scenePipeline = deviceContext.scenePipelines[sceneFeatures & deviceContext.sceneFeaturesMask];
+	vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, scenePipeline);
+
+	VkDeviceSize vertexOffset = 0;
+	vkCmdBindVertexBuffers(commandBuffer, 0, 1, &deviceContext.sceneVertexBuffer.buffer, &vertexOffset);
+
+	if (deviceContext.bindlessSupported)
+	{
+		// One set for the whole frame, draws only differ by the IDs they push
+		bindBindlessTable(deviceContext.pBindlessTable, commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS);
+
+		// Every other draw samples the tint the compute queue wrote for this frame
+		BindlessID tintMaterialID = deviceContext.tintMaterialIDs[deviceContext.currentFrame];
+		for (u32 drawIndex = firstDraw; drawIndex < firstDraw + drawCount; ++drawIndex)
+		{
+			DrawConstants draw = deviceContext.drawList[drawIndex];
+			draw.materialID	   = drawIndex % 2 ? tintMaterialID : draw.materialID;
+			pushBindlessConstants(deviceContext.pBindlessTable, commandBuffer, &draw, sizeof(draw));
+			vkCmdDraw(commandBuffer, 3, 1, 0, 0);
+		}
+	}
+	else
+	{
+		for (u32 drawIndex = firstDraw; drawIndex < firstDraw + drawCount; ++drawIndex)
+		{
+			const DrawConstants& draw = deviceContext.drawList[drawIndex];
+			vkCmdPushConstants(
+				commandBuffer, deviceContext.pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(draw), &draw);
+			vkCmdDraw(commandBuffer, 3, 1, 0, 0);
+		}
+	}
+}
+
+static void recordScenePass(VkCommandBuffer commandBuffer, RenderGraph* pGraph, void* pUserData)
+{
+	DeviceContext& deviceContext = *(DeviceContext*)pUserData;
+
+	// The scene color image only changes when the graph is recompiled, so does its framebuffer
+	VkImageView sceneColorView = getGraphImageView(pGraph, deviceContext.frameGraph.sceneColor);
+	if (deviceContext.sceneFramebufferView != sceneColorView)
+	{
+		deferDestroyFramebuffer(deviceContext.pDeletionQueue, deviceContext.sceneFramebuffer);
+
+		VkExtent2D				extent			= getGraphImageExtent(pGraph, deviceContext.frameGraph.sceneColor);
+		VkFramebufferCreateInfo framebufferInfo = {};
+		framebufferInfo.sType					= VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+		framebufferInfo.renderPass				= deviceContext.renderPass;
+		framebufferInfo.attachmentCount			= 1;
+		framebufferInfo.pAttachments			= &sceneColorView;
+		framebufferInfo.width					= extent.width;
+		framebufferInfo.height					= extent.height;
+		framebufferInfo.layers					= 1;
+		VK_ASSERT(
+			vkCreateFramebuffer(deviceContext.device, &framebufferInfo, nullptr, &deviceContext.sceneFramebuffer));
+		deviceContext.sceneFramebufferView = sceneColorView;
+	}
+
+	VkClearValue clearValue		= {};
+	clearValue.color.float32[0] = 0.1f;
+	clearValue.color.float32[1] = 0.1f;
+	clearValue.color.float32[2] = 0.1f;
+	clearValue.color.float32[3] = 1.0f;
+
+	VkRenderPassBeginInfo renderPassInfo = {};
+	renderPassInfo.sType				 = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+	renderPassInfo.renderPass			 = deviceContext.renderPass;
+	renderPassInfo.framebuffer			 = deviceContext.sceneFramebuffer;
+	renderPassInfo.renderArea.offset	 = {0, 0};
+	renderPassInfo.renderArea.extent	 = deviceContext.swapchainExtent;
+	renderPassInfo.clearValueCount		 = 1;
+	renderPassInfo.pClearValues			 = &clearValue;
+	vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+
+	// Secondary buffers do not inherit any state from the primary, every slice sets up its own
+	VkCommandBufferInheritanceInfo inheritanceInfo = {};
+	inheritanceInfo.sType						   = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+	inheritanceInfo.renderPass					   = deviceContext.renderPass;
+	inheritanceInfo.subpass						   = 0;
+	inheritanceInfo.framebuffer					   = deviceContext.sceneFramebuffer;
+	recordParallel(deviceContext.pParallelRecorder,
+				   commandBuffer,
+				   inheritanceInfo,
+				   u32(deviceContext.drawList.size()),
+				   recordDraws,
+				   &deviceContext);
+
+	vkCmdEndRenderPass(commandBuffer);
+}
+
+static void recordBlitPass(VkCommandBuffer commandBuffer, RenderGraph* pGraph, void* pUserData)
+{
+	const GraphBlit& blit			   = *(const GraphBlit*)pUserData;
+	VkExtent2D		 sourceExtent	   = getGraphImageExtent(pGraph, blit.source);
+	VkExtent2D		 destinationExtent = getGraphImageExtent(pGraph, blit.destination);
+
+	VkImageBlit region				 = {};
+	region.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	region.srcSubresource.layerCount = 1;
+	region.srcOffsets[1]			 = {i32(sourceExtent.width), i32(sourceExtent.height), 1};
+	region.dstSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	region.dstSubresource.layerCount = 1;
+	region.dstOffsets[1]			 = {i32(destinationExtent.width), i32(destinationExtent.height), 1};
+	vkCmdBlitImage(commandBuffer,
+				   getGraphImage(pGraph, blit.source),
+				   VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+				   getGraphImage(pGraph, blit.destination),
+				   VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+				   1,
+				   &region,
+				   blit.filter);
+}
+
+// Every pass is declared every frame, the graph culls the soft focus passes while their result is not presented.
+// Returns true when the graph layout changed.
+static b8 buildFrameGraph(DeviceContext& deviceContext, u32 imageIndex)
+{
+	RenderGraph* pGraph		= deviceContext.pRenderGraph;
+	FrameGraph&	 frameGraph = deviceContext.frameGraph;
+	VkFormat	 format		= deviceContext.swapchainImageFormat;
+	VkExtent2D	 extent		= deviceContext.swapchainExtent;
+	VkExtent2D	 halfExtent = {std::max(extent.width / 2u, 1u), std::max(extent.height / 2u, 1u)};
+
+	beginRenderGraph(pGraph);
+
+	GraphImportInfo backbufferInfo	= {};
+	backbufferInfo.image			= deviceContext.swapchainImages[imageIndex];
+	backbufferInfo.imageView		= deviceContext.swapchainImageViews[imageIndex];
+	backbufferInfo.format			= format;
+	backbufferInfo.extent			= extent;
+	backbufferInfo.initialLayout	= VK_IMAGE_LAYOUT_UNDEFINED;
+	backbufferInfo.initialStageMask = VK_PIPELINE_STAGE_TRANSFER_BIT; // imageAvailable semaphore wait stage
+	backbufferInfo.finalLayout		= VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+
+	frameGraph.backbuffer	 = importGraphImage(pGraph, "backbuffer", backbufferInfo);
+	frameGraph.sceneColor	 = createTransientImage(pGraph, "scene color", format, extent);
+	frameGraph.softFocusHalf = createTransientImage(pGraph, "soft focus half", format, halfExtent);
+	frameGraph.softFocusFull = createTransientImage(pGraph, "soft focus full", format, extent);
+
+	GraphPass scenePass = addGraphPass(pGraph, "scene", recordScenePass, &deviceContext);
+	writeGraphImage(pGraph, scenePass, frameGraph.sceneColor, GraphAccess::COLOR_ATTACHMENT_WRITE);
+
+	frameGraph.downsampleBlit = {frameGraph.sceneColor, frameGraph.softFocusHalf, VK_FILTER_LINEAR};
+	GraphPass downsamplePass  = addGraphPass(pGraph, "downsample", recordBlitPass, &frameGraph.downsampleBlit);
+	readGraphImage(pGraph, downsamplePass, frameGraph.sceneColor, GraphAccess::TRANSFER_READ);
+	writeGraphImage(pGraph, downsamplePass, frameGraph.softFocusHalf, GraphAccess::TRANSFER_WRITE);
+
+	frameGraph.upsampleBlit = {frameGraph.softFocusHalf, frameGraph.softFocusFull, VK_FILTER_LINEAR};
+	GraphPass upsamplePass	= addGraphPass(pGraph, "upsample", recordBlitPass, &frameGraph.upsampleBlit);
+	readGraphImage(pGraph, upsamplePass, frameGraph.softFocusHalf, GraphAccess::TRANSFER_READ);
+	writeGraphImage(pGraph, upsamplePass, frameGraph.softFocusFull, GraphAccess::TRANSFER_WRITE);
+
+	GraphResource presented = softFocusEnabled ? frameGraph.softFocusFull : frameGraph.sceneColor;
+	frameGraph.presentBlit	= {presented, frameGraph.backbuffer, VK_FILTER_NEAREST};
+	GraphPass presentPass	= addGraphPass(pGraph, "present", recordBlitPass, &frameGraph.presentBlit);
+	readGraphImage(pGraph, presentPass, presented, GraphAccess::TRANSFER_READ);
+	writeGraphImage(pGraph, presentPass, frameGraph.backbuffer, GraphAccess::TRANSFER_WRITE);
+
+	return compileRenderGraph(pGraph);
+}
+
+// The buffer of this frame slot was last read by the frame whose fence drawFrame just waited on, so the dispatch
+// needs no graphics value and runs next to the frames still in flight. Returns the ticket of the dispatch, 0 when
+// there is no bindless table to write the materials through
+static u64 recordTintCompute(DeviceContext& deviceContext)
+{
+	if (!deviceContext.bindlessSupported)
+	{
+		return 0;
+	}
+
+	VkCommandBuffer commandBuffer = beginComputeFrame(deviceContext.pComputeScheduler, deviceContext.currentFrame);
+	vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, deviceContext.tintPipeline);
+	bindBindlessTable(deviceContext.pBindlessTable, commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE);
+
+	TintConstants constants = {};
+	constants.time			= std::chrono::duration<f32>(Clock::now() - startTime).count();
+	constants.materialID	= deviceContext.tintMaterialIDs[deviceContext.currentFrame];
+	pushBindlessConstants(deviceContext.pBindlessTable, commandBuffer, &constants, sizeof(constants));
+	vkCmdDispatch(commandBuffer, 1, 1, 1);
+
+	return submitCompute(deviceContext.pComputeScheduler);
+}
+
+// Material edits are staged in the frame allocator and copied on the graphics queue, which avoids a round trip
+// through the transfer queue for a few bytes. The copy waits for the frames in flight still reading the material
+static void recordMaterialUpdate(DeviceContext& deviceContext, VkCommandBuffer commandBuffer)
+{
+	if (!deviceContext.bindlessSupported || deviceContext.materialTintPreset == materialTintPreset)
+	{
+		return;
+	}
+
+	TransientAllocation staging = {};
+	if (!allocateTransient(deviceContext.frameAllocator, sizeof(materialTintPresets[0]), 16, &staging))
+	{
+		return; // the frame region is full, tried again next frame
+	}
+	memcpy(staging.pData, materialTintPresets[materialTintPreset], sizeof(materialTintPresets[0]));
+
+	VkBufferMemoryBarrier barrier = {};
+	barrier.sType				  = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+	barrier.srcAccessMask		  = 0; // write after read, the execution dependency is enough
+	barrier.dstAccessMask		  = VK_ACCESS_TRANSFER_WRITE_BIT;
+	barrier.srcQueueFamilyIndex	  = VK_QUEUE_FAMILY_IGNORED;
+	barrier.dstQueueFamilyIndex	  = VK_QUEUE_FAMILY_IGNORED;
+	barrier.buffer				  = deviceContext.materialsBuffer.buffer;
+	barrier.size				  = VK_WHOLE_SIZE;
+	vkCmdPipelineBarrier(commandBuffer,
+						 VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+						 VK_PIPELINE_STAGE_TRANSFER_BIT,
+						 0,
+						 0,
+						 nullptr,
+						 1,
+						 &barrier,
+						 0,
+						 nullptr);
+
+	VkBufferCopy region = {};
+	region.srcOffset	= staging.offset;
+	region.size			= sizeof(materialTintPresets[0]);
+	vkCmdCopyBuffer(commandBuffer, staging.buffer, deviceContext.materialsBuffer.buffer, 1, &region);
+
+	barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+	vkCmdPipelineBarrier(commandBuffer,
+						 VK_PIPELINE_STAGE_TRANSFER_BIT,
+						 VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+						 0,
+						 0,
+						 nullptr,
+						 1,
+						 &barrier,
+						 0,
+						 nullptr);
+
+	deviceContext.materialTintPreset = materialTintPreset;
+}
+
+static void recordFrame(DeviceContext& deviceContext, u32 imageIndex, UploadWait* pUploadWait)
+{
+	VkCommandBuffer commandBuffer = deviceContext.flightSyncObjects[deviceContext.currentFrame].graphicsBuffer;
+	VK_ASSERT(vkResetCommandBuffer(commandBuffer, 0));
+
+	VkCommandBufferBeginInfo beginInfo = {};
+	beginInfo.sType					   = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+	beginInfo.flags					   = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+	VK_ASSERT(vkBeginCommandBuffer(commandBuffer, &beginInfo));
+
+	beginRecorderFrame(deviceContext.pParallelRecorder, deviceContext.currentFrame);
+	beginGraphicsTiming(deviceContext.pComputeScheduler, commandBuffer, deviceContext.currentFrame);
+	*pUploadWait = acquireUploads(deviceContext.pUploadService, commandBuffer);
+	recordMaterialUpdate(deviceContext, commandBuffer);
+
+	b8 graphChanged = buildFrameGraph(deviceContext, imageIndex);
+	executeRenderGraph(deviceContext.pRenderGraph, commandBuffer);
+	if (graphChanged)
+	{
+		printRenderGraphStatistics(deviceContext.pRenderGraph);
+	}
+
+	endGraphicsTiming(deviceContext.pComputeScheduler, commandBuffer, deviceContext.currentFrame);
+	VK_ASSERT(vkEndCommandBuffer(commandBuffer));
+}
+
+static void createPipelineCache(DeviceContext& deviceContext)
+{
+	deviceContext.pipelineCache = createPersistentPipelineCache(deviceContext.physicalDevice,
+																deviceContext.device,
+																STRINGIFY(BUILD_DIR),
+																pipelineCacheEnabled,
+																&deviceContext.pipelineCacheInfo);
+
+	printf("Pipeline cache: %s (%llu bytes)\n",
+		   deviceContext.pipelineCacheInfo.loadedFromDisk ? "loaded from disk" : "empty",
+		   deviceContext.pipelineCacheInfo.loadedBytes);
+
+	deviceContext.releaseStack.push({&deviceContext, [](void* p) {
+										 DeviceContext& deviceContext = *(DeviceContext*)p;
+										 if (pipelineCacheEnabled)
+										 {
+											 savePersistentPipelineCache(deviceContext.device,
+																		 deviceContext.pipelineCache,
+																		 deviceContext.pipelineCacheInfo);
+										 }
+										 vkDestroyPipelineCache(deviceContext.device, deviceContext.pipelineCache, nullptr);
+									 }});
+}
+
+static void createRenderPass(DeviceContext& deviceContext)
+{
+	VkAttachmentDescription colorAttachment = {};
+	colorAttachment.format					= deviceContext.swapchainImageFormat;
+	colorAttachment.samples					= VK_SAMPLE_COUNT_1_BIT;
+	colorAttachment.loadOp					= VK_ATTACHMENT_LOAD_OP_CLEAR;
+	colorAttachment.storeOp					= VK_ATTACHMENT_STORE_OP_STORE;
+	colorAttachment.stencilLoadOp			= VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+	colorAttachment.stencilStoreOp			= VK_ATTACHMENT_STORE_OP_DONT_CARE;
+	colorAttachment.initialLayout			= VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+	colorAttachment.finalLayout				= VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+
+	VkAttachmentReference colorReference = {};
+	colorReference.attachment			 = 0;
+	colorReference.layout				 = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+
+	VkSubpassDescription subpass = {};
+	subpass.pipelineBindPoint	 = VK_PIPELINE_BIND_POINT_GRAPHICS;
+	subpass.colorAttachmentCount = 1;
+	subpass.pColorAttachments	 = &colorReference;
+
+	VkRenderPassCreateInfo renderPassInfo = {};
+	renderPassInfo.sType				  = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+	renderPassInfo.attachmentCount		  = 1;
+	renderPassInfo.pAttachments			  = &colorAttachment;
+	renderPassInfo.subpassCount			  = 1;
+	renderPassInfo.pSubpasses			  = &subpass;
+
+	VK_ASSERT(vkCreateRenderPass(deviceContext.device, &renderPassInfo, nullptr, &deviceContext.renderPass));
+	deviceContext.releaseStack.push({&deviceContext, [](void* p) {
+										 DeviceContext& deviceContext = *(DeviceContext*)p;
+										 vkDestroyRenderPass(deviceContext.device, deviceContext.renderPass, nullptr);
+									 }});
+}
+
+// The swapchain and its views are replaced on resize, release whatever is current at shutdown
+static void createSwapchainRelease(DeviceContext& deviceContext)
+{
+	deviceContext.releaseStack.push({&deviceContext, [](void* p) {
+										 DeviceContext& deviceContext = *(DeviceContext*)p;
+										 for (VkImageView imageView : deviceContext.swapchainImageViews)
+										 {
+											 vkDestroyImageView(deviceContext.device, imageView, nullptr);
+										 }
+										 vkDestroySwapchainKHR(deviceContext.device, deviceContext.swapchain, nullptr);
+									 }});
+}
+
+static const ShaderPermutations sceneVertexPermutations = {"simple.vert", VK_SHADER_STAGE_VERTEX_BIT, 0, 0};
+static const ShaderPermutations simpleFragmentPermutations = {
+	"simple.frag", VK_SHADER_STAGE_FRAGMENT_BIT, SCENE_FEATURE_WIREFRAME, 0};
+static const ShaderPermutations bindlessFragmentPermutations = {
+	"bindless.frag", VK_SHADER_STAGE_FRAGMENT_BIT, SCENE_FEATURE_WIREFRAME, SCENE_FEATURE_MATERIAL_TINT};
+
+static void createGraphicsPipelines(DeviceContext& deviceContext)
+{
+	Clock::time_point pipelinesStart = Clock::now();
+
+	ShaderVariantCacheCreateInfo variantCacheInfo = {};
+	variantCacheInfo.device						  = deviceContext.device;
+	variantCacheInfo.directory					  = STRINGIFY(BUILD_DIR) "/shaders";
+	ShaderVariantCache* pVariantCache			  = createShaderVariantCache(variantCacheInfo);
+
+	const ShaderPermutations& fragmentPermutations =
+		deviceContext.bindlessSupported ? bindlessFragmentPermutations : simpleFragmentPermutations;
+	deviceContext.sceneFeaturesMask = getDeclaredShaderFeatures(fragmentPermutations);
+	ASSERT(deviceContext.sceneFeaturesMask < SCENE_VARIANTS_COUNT);
+
+	VkPipelineVertexInputStateCreateInfo vertexInput = getVertexInputState(sceneVertexInput);
+
+	VkPipelineInputAssemblyStateCreateInfo inputAssembly = {};
+	inputAssembly.sType	   = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+	inputAssembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+
+	VkPipelineViewportStateCreateInfo viewportState = {};
+	viewportState.sType								= VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+	viewportState.viewportCount						= 1;
+	viewportState.scissorCount						= 1;
+
+	VkPipelineRasterizationStateCreateInfo rasterization = {};
+	rasterization.sType		  = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+	rasterization.polygonMode = VK_POLYGON_MODE_FILL;
+	rasterization.cullMode	  = VK_CULL_MODE_NONE;
+	rasterization.frontFace	  = VK_FRONT_FACE_CLOCKWISE;
+	rasterization.lineWidth	  = 1.0f;
+
+	VkPipelineMultisampleStateCreateInfo multisample = {};
+	multisample.sType								 = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+	multisample.rasterizationSamples				 = VK_SAMPLE_COUNT_1_BIT;
+
+	VkPipelineColorBlendAttachmentState colorBlendAttachment = {};
+	colorBlendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT |
+										  VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+
+	VkPipelineColorBlendStateCreateInfo colorBlend = {};
+	colorBlend.sType							   = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+	colorBlend.attachmentCount					   = 1;
+	colorBlend.pAttachments						   = &colorBlendAttachment;
+
+	VkDynamicState					 dynamicStates[] = {VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR};
+	VkPipelineDynamicStateCreateInfo dynamicState	 = {};
+	dynamicState.sType								 = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+	dynamicState.dynamicStateCount					 = 2;
+	dynamicState.pDynamicStates						 = dynamicStates;
+
+	VkPushConstantRange pushConstantRange = {};
+	pushConstantRange.stageFlags		  = VK_SHADER_STAGE_VERTEX_BIT;
+	pushConstantRange.size				  = sizeof(DrawConstants);
+
+	VkPipelineLayoutCreateInfo layoutInfo = {};
+	layoutInfo.sType					  = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+	layoutInfo.pushConstantRangeCount	  = 1;
+	layoutInfo.pPushConstantRanges		  = &pushConstantRange;
+	VK_ASSERT(vkCreatePipelineLayout(deviceContext.device, &layoutInfo, nullptr, &deviceContext.pipelineLayout));
+
+	VkGraphicsPipelineCreateInfo pipelineInfo = {};
+	pipelineInfo.sType						  = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+	pipelineInfo.stageCount					  = 2;
+	pipelineInfo.pVertexInputState			  = &vertexInput;
+	pipelineInfo.pInputAssemblyState		  = &inputAssembly;
+	pipelineInfo.pViewportState				  = &viewportState;
+	pipelineInfo.pRasterizationState		  = &rasterization;
+	pipelineInfo.pMultisampleState			  = &multisample;
+	pipelineInfo.pColorBlendState			  = &colorBlend;
+	pipelineInfo.pDynamicState				  = &dynamicState;
+	pipelineInfo.layout						  = deviceContext.bindlessSupported
+													? getBindlessPipelineLayout(deviceContext.pBindlessTable)
+													: deviceContext.pipelineLayout;
+	pipelineInfo.renderPass					  = deviceContext.renderPass;
+	pipelineInfo.subpass					  = 0;
+
+	// One pipeline per combination of the features the fragment shader declares, the others are never looked up
+	std::vector<u32> variantsFeatures;
+	for (u32 features = 0u; features < SCENE_VARIANTS_COUNT; ++features)
+	{
+		if ((features & ~deviceContext.sceneFeaturesMask) == 0)
+		{
+			variantsFeatures.push_back(features);
+		}
+	}
+
+	std::vector<VkPipelineShaderStageCreateInfo> stages(variantsFeatures.size() * 2);
+	std::vector<VkGraphicsPipelineCreateInfo>	 pipelineInfos(variantsFeatures.size(), pipelineInfo);
+	for (u32 variantIndex = 0u; variantIndex < u32(variantsFeatures.size()); ++variantIndex)
+	{
+		u32 features						= variantsFeatures[variantIndex];
+		stages[variantIndex * 2]			= getShaderVariantStage(pVariantCache, sceneVertexPermutations, features);
+		stages[variantIndex * 2 + 1]		= getShaderVariantStage(pVariantCache, fragmentPermutations, features);
+		pipelineInfos[variantIndex].pStages = &stages[variantIndex * 2];
+	}
+
+	std::vector<VkPipeline> pipelines(pipelineInfos.size());
+	createGraphicsPipelinesParallel(deviceContext.device,
+									deviceContext.pipelineCache,
+									pipelineInfos.data(),
+									u32(pipelineInfos.size()),
+									pipelines.data());
+	for (u32 variantIndex = 0u; variantIndex < u32(variantsFeatures.size()); ++variantIndex)
+	{
+		deviceContext.scenePipelines[variantsFeatures[variantIndex]] = pipelines[variantIndex];
+	}
+
+	printShaderVariantStatistics(pVariantCache);
+	destroyShaderVariantCache(pVariantCache);
+
+	printf("Graphics pipelines created in %.2f ms\n",
+		   std::chrono::duration<f64, std::milli>(Clock::now() - pipelinesStart).count());
+
+	deviceContext.releaseStack.push({&deviceContext, [](void* p) {
+										 DeviceContext& deviceContext = *(DeviceContext*)p;
+										 for (VkPipeline pipeline : deviceContext.scenePipelines)
+										 {
+											 vkDestroyPipeline(deviceContext.device, pipeline, nullptr);
+										 }
+										 vkDestroyPipelineLayout(deviceContext.device, deviceContext.pipelineLayout, nullptr);
+									 }});
+}
+
+static const ShaderPermutations tintComputePermutations = {"tint.comp", VK_SHADER_STAGE_COMPUTE_BIT, 0, 0};
+
+// The tint dispatch writes through the bindless table, there is nothing to animate without it
+static void createComputePipelines(DeviceContext& deviceContext)
+{
+	if (!deviceContext.bindlessSupported)
+	{
+		return;
+	}
+
+	ShaderVariantCacheCreateInfo variantCacheInfo = {};
+	variantCacheInfo.device						  = deviceContext.device;
+	variantCacheInfo.directory					  = STRINGIFY(BUILD_DIR) "/shaders";
+	ShaderVariantCache* pVariantCache			  = createShaderVariantCache(variantCacheInfo);
+
+	VkComputePipelineCreateInfo pipelineInfo = {};
+	pipelineInfo.sType						 = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+	pipelineInfo.stage						 = getShaderVariantStage(pVariantCache, tintComputePermutations, 0);
+	pipelineInfo.layout						 = getBindlessPipelineLayout(deviceContext.pBindlessTable);
+	VK_ASSERT(vkCreateComputePipelines(
+		deviceContext.device, deviceContext.pipelineCache, 1, &pipelineInfo, nullptr, &deviceContext.tintPipeline));
+
+	destroyShaderVariantCache(pVariantCache);
+
+	deviceContext.releaseStack.push({&deviceContext, [](void* p) {
+										 DeviceContext& deviceContext = *(DeviceContext*)p;
+										 vkDestroyPipeline(deviceContext.device, deviceContext.tintPipeline, nullptr);
+									 }});
+}
+
+static void createParallelRecorder(DeviceContext& deviceContext)
+{
+	ParallelRecorderCreateInfo recorderInfo = {};
+	recorderInfo.device						= deviceContext.device;
+	recorderInfo.queueFamilyIndex			= deviceContext.queueFamilies.graphics.index;
+	recorderInfo.framesInFlight				= u32(deviceContext.flightSyncObjects.size());
+	recorderInfo.maxThreadsCount			= recordThreadsCount;
+	deviceContext.pParallelRecorder			= createParallelRecorder(recorderInfo);
+
+	// The sweep starts from a single thread and doubles up to every thread
+	if (recordSweep)
+	{
+		setRecorderThreadsCount(deviceContext.pParallelRecorder, 1);
+	}
+
+	deviceContext.releaseStack.push({&deviceContext, [](void* p) {
+										 DeviceContext& deviceContext = *(DeviceContext*)p;
+										 printRecorderTimings(deviceContext.pParallelRecorder);
+										 printRecorderScaling(deviceContext.pParallelRecorder);
+										 destroyParallelRecorder(deviceContext.pParallelRecorder);
+									 }});
+}
+
+// Lays the draws out as a grid of small triangles covering the screen
+static void createSceneVertexBuffer(DeviceContext& deviceContext)
+{
+	VkBufferCreateInfo bufferInfo = {};
+	bufferInfo.sType			  = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+	bufferInfo.size				  = sizeof(sceneTriangle);
+	bufferInfo.usage			  = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+	bufferInfo.sharingMode		  = VK_SHARING_MODE_EXCLUSIVE;
+	AllocatedBuffer& vertexBuffer = deviceContext.sceneVertexBuffer;
+	createAllocatedBuffer(
+		deviceContext.pMemoryAllocator, bufferInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &vertexBuffer);
+	uploadBuffer(deviceContext.pUploadService, vertexBuffer.buffer, 0, sceneTriangle, sizeof(sceneTriangle));
+	flushUploads(deviceContext.pUploadService);
+
+	deviceContext.releaseStack.push({&deviceContext, [](void* p) {
+										 DeviceContext&	  deviceContext = *(DeviceContext*)p;
+										 MemoryAllocator* pAllocator	= deviceContext.pMemoryAllocator;
+										 destroyAllocatedBuffer(pAllocator, deviceContext.sceneVertexBuffer);
+									 }});
+}
+
+static void createDrawList(DeviceContext& deviceContext)
+{
+	u32 gridSize = 1u;
+	while (gridSize * gridSize < drawsCount)
+	{
+		gridSize++;
+	}
+
+	f32 cellSize = 2.0f / f32(gridSize);
+	deviceContext.drawList.resize(drawsCount);
+	for (u32 drawIndex = 0u; drawIndex < drawsCount; ++drawIndex)
+	{
+		DrawConstants& draw = deviceContext.drawList[drawIndex];
+		draw.offset[0]		= -1.0f + cellSize * (f32(drawIndex % gridSize) + 0.5f);
+		draw.offset[1]		= -1.0f + cellSize * (f32(drawIndex / gridSize) + 0.5f);
+		draw.scale			= cellSize;
+		draw.textureID		= deviceContext.checkerTextureID;
+		draw.materialID		= deviceContext.materialID;
+	}
+}
+
+static void createRenderGraph(DeviceContext& deviceContext)
+{
+	RenderGraphCreateInfo graphInfo = {};
+	graphInfo.device				= deviceContext.device;
+	graphInfo.pMemoryAllocator		= deviceContext.pMemoryAllocator;
+	graphInfo.pDeletionQueue		= deviceContext.pDeletionQueue;
+	deviceContext.pRenderGraph		= createRenderGraph(graphInfo);
+
+	deviceContext.releaseStack.push({&deviceContext, [](void* p) {
+										 DeviceContext& deviceContext = *(DeviceContext*)p;
+										 printRenderGraphStatistics(deviceContext.pRenderGraph);
+										 deferDestroyFramebuffer(deviceContext.pDeletionQueue,
+																 deviceContext.sceneFramebuffer);
+										 destroyRenderGraph(deviceContext.pRenderGraph);
+									 }});
+}
+
+static void createFramePacer(DeviceContext& deviceContext)
+{
+	deviceContext.pFramePacer = createFramePacer(framePacingSettings);
+	deviceContext.releaseStack.push({&deviceContext, [](void* p) {
+										 DeviceContext& deviceContext = *(DeviceContext*)p;
+										 printFramePacingStatistics(deviceContext.pFramePacer);
+										 destroyFramePacer(deviceContext.pFramePacer);
+									 }});
+}
+
+static void createPacedSwapchain(DeviceContext& deviceContext)
+{
+	FramePacer* pFramePacer = deviceContext.pFramePacer;
+
+	createSwapchain(
+		deviceContext,
+		chooseSwapchainFormat,
+		[pFramePacer](const std::vector<VkPresentModeKHR>& presentModes) {
+			return choosePresentMode(pFramePacer, presentModes);
+		},
+		[pFramePacer](VkSurfaceCapabilitiesKHR surfaceCapabilities) {
+			return chooseImageCount(pFramePacer, surfaceCapabilities);
+		});
+}
+
+static void createComputeScheduler(DeviceContext& deviceContext)
+{
+	const QueueFamilies& queueFamilies = deviceContext.queueFamilies;
+
+	ComputeSchedulerCreateInfo schedulerInfo = {};
+	schedulerInfo.device					 = deviceContext.device;
+	schedulerInfo.physicalDevice			 = deviceContext.physicalDevice;
+	schedulerInfo.framesInFlight			 = u32(deviceContext.flightSyncObjects.size());
+	schedulerInfo.separateComputeFamily =
+		queueFamilies.compute.existed && queueFamilies.compute.index != queueFamilies.graphics.index;
+	schedulerInfo.computeFamilyIndex  = queueFamilies.compute.index;
+	schedulerInfo.computeQueue		  = deviceContext.computeQueue;
+	schedulerInfo.graphicsFamilyIndex = queueFamilies.graphics.index;
+	schedulerInfo.graphicsQueue		  = deviceContext.graphicsQueue;
+
+	deviceContext.pComputeScheduler = createComputeScheduler(schedulerInfo);
+	deviceContext.releaseStack.push({&deviceContext, [](void* p) {
+										 DeviceContext& deviceContext = *(DeviceContext*)p;
+										 printQueueTimings(deviceContext.pComputeScheduler);
+										 destroyComputeScheduler(deviceContext.pComputeScheduler);
+									 }});
+}
+
+#define UPLOAD_STAGING_RING_SIZE (32ull * 1024 * 1024)
+
+static void createUploadService(DeviceContext& deviceContext)
+{
+	UploadServiceCreateInfo uploadInfo = {};
+	uploadInfo.device				   = deviceContext.device;
+	uploadInfo.pAllocator			   = deviceContext.pMemoryAllocator;
+	uploadInfo.stagingRingSize		   = UPLOAD_STAGING_RING_SIZE;
+	uploadInfo.transferFamilyIndex	   = deviceContext.queueFamilies.transfer.index;
+	uploadInfo.transferQueue		   = deviceContext.transferQueue;
+	uploadInfo.graphicsFamilyIndex	   = deviceContext.queueFamilies.graphics.index;
+
+	deviceContext.pUploadService = createUploadService(uploadInfo);
+	deviceContext.releaseStack.push({&deviceContext, [](void* p) {
+										 DeviceContext&	  deviceContext = *(DeviceContext*)p;
+										 UploadStatistics statistics	= getUploadStatistics(deviceContext.pUploadService);
+										 printf("Uploads: %llu bytes in %llu batches, %llu staging stalls\n",
+												statistics.bytesUploaded,
+												statistics.batchesSubmitted,
+												statistics.ringStalls);
+										 destroyUploadService(deviceContext.pUploadService);
+									 }});
+}
+
+#define BINDLESS_MAX_TEXTURES		 4096
+#define BINDLESS_MAX_BUFFERS		 1024
+#define BINDLESS_PUSH_CONSTANTS_SIZE 128
+#define CHECKER_TEXTURE_SIZE		 64
+
+static void createBindlessResources(DeviceContext& deviceContext)
+{
+	if (!deviceContext.bindlessSupported)
+	{
+		return;
+	}
+
+	BindlessTableCreateInfo tableInfo = {};
+	tableInfo.device				  = deviceContext.device;
+	tableInfo.physicalDevice		  = deviceContext.physicalDevice;
+	tableInfo.maxTextures			  = BINDLESS_MAX_TEXTURES;
+	tableInfo.maxBuffers			  = BINDLESS_MAX_BUFFERS;
+	tableInfo.framesInFlight		  = u32(deviceContext.flightSyncObjects.size());
+	tableInfo.pushConstantsSize		  = BINDLESS_PUSH_CONSTANTS_SIZE;
+	deviceContext.pBindlessTable	  = createBindlessTable(tableInfo);
+
+	// A checker texture and a tint material, enough to show resources being fetched by ID
+	std::vector<u32> texels(CHECKER_TEXTURE_SIZE * CHECKER_TEXTURE_SIZE);
+	for (u32 y = 0u; y < CHECKER_TEXTURE_SIZE; ++y)
+	{
+		for (u32 x = 0u; x < CHECKER_TEXTURE_SIZE; ++x)
+		{
+			texels[y * CHECKER_TEXTURE_SIZE + x] = ((x / 8 + y / 8) % 2) ? 0xFFFFFFFF : 0xFF404040;
+		}
+	}
+
+	VkImageCreateInfo imageInfo = {};
+	imageInfo.sType				= VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+	imageInfo.imageType			= VK_IMAGE_TYPE_2D;
+	imageInfo.format			= VK_FORMAT_R8G8B8A8_UNORM;
+	imageInfo.extent			= {CHECKER_TEXTURE_SIZE, CHECKER_TEXTURE_SIZE, 1};
+	imageInfo.mipLevels			= 1;
+	imageInfo.arrayLayers		= 1;
+	imageInfo.samples			= VK_SAMPLE_COUNT_1_BIT;
+	imageInfo.tiling			= VK_IMAGE_TILING_OPTIMAL;
+	imageInfo.usage				= VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+	imageInfo.sharingMode		= VK_SHARING_MODE_EXCLUSIVE;
+	imageInfo.initialLayout		= VK_IMAGE_LAYOUT_UNDEFINED;
+	createAllocatedImage(
+		deviceContext.pMemoryAllocator, imageInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &deviceContext.checkerTexture);
+	uploadImage(deviceContext.pUploadService,
+				deviceContext.checkerTexture.image,
+				imageInfo.extent,
+				sizeof(u32),
+				texels.data(),
+				VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+
+	VkImageViewCreateInfo viewInfo			 = {};
+	viewInfo.sType							 = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+	viewInfo.image							 = deviceContext.checkerTexture.image;
+	viewInfo.viewType						 = VK_IMAGE_VIEW_TYPE_2D;
+	viewInfo.format							 = imageInfo.format;
+	viewInfo.subresourceRange.aspectMask	 = VK_IMAGE_ASPECT_COLOR_BIT;
+	viewInfo.subresourceRange.levelCount	 = 1;
+	viewInfo.subresourceRange.layerCount	 = 1;
+	VK_ASSERT(vkCreateImageView(deviceContext.device, &viewInfo, nullptr, &deviceContext.checkerTextureView));
+
+	VkSamplerCreateInfo samplerInfo = {};
+	samplerInfo.sType				= VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+	samplerInfo.magFilter			= VK_FILTER_NEAREST;
+	samplerInfo.minFilter			= VK_FILTER_NEAREST;
+	samplerInfo.mipmapMode			= VK_SAMPLER_MIPMAP_MODE_NEAREST;
+	samplerInfo.addressModeU		= VK_SAMPLER_ADDRESS_MODE_REPEAT;
+	samplerInfo.addressModeV		= VK_SAMPLER_ADDRESS_MODE_REPEAT;
+	samplerInfo.addressModeW		= VK_SAMPLER_ADDRESS_MODE_REPEAT;
+	samplerInfo.maxLod				= 1.0f;
+	VK_ASSERT(vkCreateSampler(deviceContext.device, &samplerInfo, nullptr, &deviceContext.sampler));
+
+	const f32*	 tint	  = materialTintPresets[materialTintPreset];
+	VkDeviceSize tintSize = sizeof(materialTintPresets[0]);
+
+	VkBufferCreateInfo bufferInfo = {};
+	bufferInfo.sType			  = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+	bufferInfo.size				  = tintSize;
+	bufferInfo.usage			  = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+	bufferInfo.sharingMode		  = VK_SHARING_MODE_EXCLUSIVE;
+	createAllocatedBuffer(
+		deviceContext.pMemoryAllocator, bufferInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &deviceContext.materialsBuffer);
+	uploadBuffer(deviceContext.pUploadService, deviceContext.materialsBuffer.buffer, 0, tint, tintSize);
+	flushUploads(deviceContext.pUploadService);
+
+	deviceContext.checkerTextureID =
+		registerTexture(deviceContext.pBindlessTable, deviceContext.checkerTextureView, deviceContext.sampler);
+	deviceContext.materialID = registerStorageBuffer(deviceContext.pBindlessTable, deviceContext.materialsBuffer.buffer);
+	deviceContext.materialTintPreset = materialTintPreset;
+
+	// Written on the compute queue and read on the graphics one, concurrent sharing spares the ownership transfers
+	const QueueFamilies& queueFamilies		 = deviceContext.queueFamilies;
+	u32					 queueFamilyIndices[] = {queueFamilies.graphics.index, queueFamilies.compute.index};
+	b8					 asyncCompute		  = isAsyncComputeAvailable(deviceContext.pComputeScheduler);
+
+	VkBufferCreateInfo tintBufferInfo	 = {};
+	tintBufferInfo.sType				 = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+	tintBufferInfo.size					 = tintSize;
+	tintBufferInfo.usage				 = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+	tintBufferInfo.sharingMode			 = asyncCompute ? VK_SHARING_MODE_CONCURRENT : VK_SHARING_MODE_EXCLUSIVE;
+	tintBufferInfo.queueFamilyIndexCount = asyncCompute ? 2 : 0;
+	tintBufferInfo.pQueueFamilyIndices	 = queueFamilyIndices;
+
+	u32 framesInFlight = u32(deviceContext.flightSyncObjects.size());
+	deviceContext.tintMaterialsBuffers.resize(framesInFlight);
+	deviceContext.tintMaterialIDs.resize(framesInFlight);
+	for (u32 frameIndex = 0u; frameIndex < framesInFlight; ++frameIndex)
+	{
+		AllocatedBuffer& tintBuffer = deviceContext.tintMaterialsBuffers[frameIndex];
+		createAllocatedBuffer(
+			deviceContext.pMemoryAllocator, tintBufferInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &tintBuffer);
+		deviceContext.tintMaterialIDs[frameIndex] =
+			registerStorageBuffer(deviceContext.pBindlessTable, tintBuffer.buffer);
+	}
+
+	deviceContext.releaseStack.push({&deviceContext, [](void* p) {
+										 DeviceContext& deviceContext = *(DeviceContext*)p;
+										 destroyBindlessTable(deviceContext.pBindlessTable);
+										 vkDestroySampler(deviceContext.device, deviceContext.sampler, nullptr);
+										 vkDestroyImageView(deviceContext.device, deviceContext.checkerTextureView, nullptr);
+										 destroyAllocatedImage(deviceContext.pMemoryAllocator, deviceContext.checkerTexture);
+										 destroyAllocatedBuffer(deviceContext.pMemoryAllocator, deviceContext.materialsBuffer);
+										 for (AllocatedBuffer& tintBuffer : deviceContext.tintMaterialsBuffers)
+										 {
+											 destroyAllocatedBuffer(deviceContext.pMemoryAllocator, tintBuffer);
+										 }
+									 }});
+}
+
+#define FRAME_ALLOCATOR_CAPACITY (8ull * 1024 * 1024)
+
+static void createMemoryAllocators(DeviceContext& deviceContext)
+{
+	deviceContext.pMemoryAllocator = createMemoryAllocator(deviceContext.physicalDevice, deviceContext.device);
+	deviceContext.releaseStack.push({&deviceContext, [](void* p) {
+										 DeviceContext& deviceContext = *(DeviceContext*)p;
+										 printMemoryStatistics(deviceContext.pMemoryAllocator);
+										 destroyMemoryAllocator(deviceContext.pMemoryAllocator);
+									 }});
+
+	createFrameAllocator(deviceContext.pMemoryAllocator,
+						 FRAME_ALLOCATOR_CAPACITY,
+						 u32(deviceContext.flightSyncObjects.size()),
+						 &deviceContext.frameAllocator);
+	deviceContext.releaseStack.push({&deviceContext, [](void* p) {
+										 DeviceContext& deviceContext = *(DeviceContext*)p;
+										 destroyFrameAllocator(deviceContext.pMemoryAllocator, deviceContext.frameAllocator);
+									 }});
+
+	DeletionQueueCreateInfo deletionQueueInfo = {};
+	deletionQueueInfo.device				  = deviceContext.device;
+	deletionQueueInfo.pMemoryAllocator		  = deviceContext.pMemoryAllocator;
+	deletionQueueInfo.framesInFlight		  = u32(deviceContext.flightSyncObjects.size());
+	deviceContext.pDeletionQueue			  = createDeletionQueue(deletionQueueInfo);
+	deviceContext.releaseStack.push({&deviceContext, [](void* p) {
+										 DeviceContext& deviceContext = *(DeviceContext*)p;
+										 printDeletionStatistics(deviceContext.pDeletionQueue);
+										 destroyDeletionQueue(deviceContext.pDeletionQueue);
+									 }});
+}
+
 static void createFlightSyncObjects(DeviceContext& deviceContext)
 {
 	deviceContext.flightSyncObjects.resize(deviceContext.swapchainImagesCount);
 	memset(deviceContext.flightSyncObjects.data(), 0, sizeof(FlightSyncObjects) * deviceContext.swapchainImagesCount);
 
+	VkCommandBufferAllocateInfo graphicsAllocInfo = {};
+	graphicsAllocInfo.sType						  = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+	graphicsAllocInfo.commandPool				  = deviceContext.graphicsCommandPool;
+	graphicsAllocInfo.level						  = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+	graphicsAllocInfo.commandBufferCount		  = 1;
+
 	for (u32 flightIndex = 0u; flightIndex < deviceContext.swapchainImagesCount; ++flightIndex)
 	{
 		FlightSyncObjects& syncObjects = deviceContext.flightSyncObjects[flightIndex];
@@ -243,6 +1659,7 @@ static void createFlightSyncObjects(DeviceContext& deviceContext)
 		createSemaphore(deviceContext.device, &syncObjects.imageAvailableSemaphore);
 		createSemaphore(deviceContext.device, &syncObjects.renderFinishedSemaphore);
 		createFence(deviceContext.device, &syncObjects.inFlightFence);
+		VK_ASSERT(vkAllocateCommandBuffers(deviceContext.device, &graphicsAllocInfo, &syncObjects.graphicsBuffer));
 	}
 
 	deviceContext.releaseStack.push(
@@ -253,6 +1670,8 @@ static void createFlightSyncObjects(DeviceContext& deviceContext)
 				 vkDestroySemaphore(deviceContext.device, syncObjects.imageAvailableSemaphore, nullptr);
 				 vkDestroySemaphore(deviceContext.device, syncObjects.renderFinishedSemaphore, nullptr);
 				 vkDestroyFence(deviceContext.device, syncObjects.inFlightFence, nullptr);
+				 vkFreeCommandBuffers(
+					 deviceContext.device, deviceContext.graphicsCommandPool, 1, &syncObjects.graphicsBuffer);
 			 }
 		 }});
 }
@@ -274,20 +1693,6 @@ static void createFence(VkDevice device, VkFence* pFence)
 
 static void createCommandBuffers(DeviceContext& deviceContext)
 {
-	VkCommandBufferAllocateInfo graphicsAllocInfo = {};
-	graphicsAllocInfo.sType						  = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-	graphicsAllocInfo.commandPool				  = deviceContext.graphicsCommandPool;
-	graphicsAllocInfo.level						  = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-	graphicsAllocInfo.commandBufferCount		  = 1;
-	VK_ASSERT(vkAllocateCommandBuffers(deviceContext.device, &graphicsAllocInfo, &deviceContext.graphicsBuffer));
-	deviceContext.releaseStack.push({&deviceContext, [](void* p) {
-										 DeviceContext& deviceContext = *(DeviceContext*)p;
-										 vkFreeCommandBuffers(deviceContext.device,
-															  deviceContext.graphicsCommandPool,
-															  1,
-															  &deviceContext.graphicsBuffer);
-									 }});
-
 	VkCommandBufferAllocateInfo presentAllocInfo = {};
 	presentAllocInfo.sType						 = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
 	presentAllocInfo.commandPool				 = deviceContext.presentCommandPool;
@@ -364,27 +1769,18 @@ static void createSwapchainImagesViews(DeviceContext& deviceContext)
 
 		VK_ASSERT(vkCreateImageView(deviceContext.device, &imageViewInfo, nullptr, &swapchainImageView));
 	}
-
-	deviceContext.releaseStack.push({&deviceContext, [](void* p) {
-										 DeviceContext& deviceContext = *(DeviceContext*)p;
-										 for (VkImageView imageView : deviceContext.swapchainImageViews)
-										 {
-											 vkDestroyImageView(deviceContext.device, imageView, nullptr);
-										 }
-									 }});
 }
 
 static void aquireSwapchainImages(DeviceContext& deviceContext)
 {
+	// The implementation may create more images than the requested minimum
+	VK_ASSERT(vkGetSwapchainImagesKHR(
+		deviceContext.device, deviceContext.swapchain, &deviceContext.swapchainImagesCount, nullptr));
 	deviceContext.swapchainImages.resize(deviceContext.swapchainImagesCount);
-
-	for (u32 imageIndex = 0u; imageIndex < deviceContext.swapchainImagesCount; ++imageIndex)
-	{
-		VK_ASSERT(vkGetSwapchainImagesKHR(deviceContext.device,
-										  deviceContext.swapchain,
-										  &deviceContext.swapchainImagesCount,
-										  deviceContext.swapchainImages.data()));
-	}
+	VK_ASSERT(vkGetSwapchainImagesKHR(deviceContext.device,
+									  deviceContext.swapchain,
+									  &deviceContext.swapchainImagesCount,
+									  deviceContext.swapchainImages.data()));
 }
 
 static void destroyDevice(DeviceContext& deviceContext)
@@ -427,8 +1823,30 @@ static void createDevice(DeviceContext& deviceContext)
 		queueCreateInfo.pQueuePriorities		 = queuePriority;
 	}
 
+	VkPhysicalDeviceVulkan12Features supportedFeatures12 = {};
+	supportedFeatures12.sType							 = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+	VkPhysicalDeviceFeatures2 supportedFeatures			 = {};
+	supportedFeatures.sType								 = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+	supportedFeatures.pNext								 = &supportedFeatures12;
+	vkGetPhysicalDeviceFeatures2(deviceContext.physicalDevice, &supportedFeatures);
+
+	ASSERT(supportedFeatures12.timelineSemaphore);
+
+	VkPhysicalDeviceVulkan12Features enabledFeatures12 = {};
+	enabledFeatures12.sType							   = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+	enabledFeatures12.timelineSemaphore				   = VK_TRUE;
+	deviceContext.bindlessSupported					   = enableBindlessFeatures(supportedFeatures12, &enabledFeatures12);
+	if (!deviceContext.bindlessSupported)
+	{
+		printf("Descriptor indexing is not supported, falling back to the non-bindless pipeline.\n");
+	}
+	VkPhysicalDeviceFeatures2 enabledFeatures		   = {};
+	enabledFeatures.sType							   = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+	enabledFeatures.pNext							   = &enabledFeatures12;
+
 	VkDeviceCreateInfo deviceInfo	   = {};
 	deviceInfo.sType				   = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+	deviceInfo.pNext				   = &enabledFeatures;
 	deviceInfo.queueCreateInfoCount	   = uniqueFamiliesCount;
 	deviceInfo.pQueueCreateInfos	   = queueCreateInfos.data();
 	deviceInfo.enabledExtensionCount   = u32(requiredDeviceExtensions.size());
@@ -442,6 +1860,21 @@ static void createDevice(DeviceContext& deviceContext)
 										 vkDestroyDevice(device, nullptr);
 									 }});
 
+	vkGetDeviceQueue(deviceContext.device, deviceContext.queueFamilies.graphics.index, 0, &deviceContext.graphicsQueue);
+	vkGetDeviceQueue(deviceContext.device, deviceContext.queueFamilies.present.index, 0, &deviceContext.presentQueue);
+	deviceContext.computeQueue	= deviceContext.graphicsQueue;
+	deviceContext.transferQueue = deviceContext.graphicsQueue;
+	if (deviceContext.queueFamilies.compute.existed)
+	{
+		vkGetDeviceQueue(
+			deviceContext.device, deviceContext.queueFamilies.compute.index, 0, &deviceContext.computeQueue);
+	}
+	if (deviceContext.queueFamilies.transfer.existed)
+	{
+		vkGetDeviceQueue(
+			deviceContext.device, deviceContext.queueFamilies.transfer.index, 0, &deviceContext.transferQueue);
+	}
+
 	printf("Logical device created.\n");
 }
 
@@ -505,7 +1938,7 @@ static void findQueueFamilies(DeviceContext& deviceContext)
 	for (u32 familyIndex = 0u; familyIndex < queueFamiliesCount; ++familyIndex)
 	{
 		const VkQueueFamilyProperties& properties = queueFamilies[familyIndex];
-		if (properties.queueFlags & VK_QUEUE_TRANSFER_BIT)
+		if (properties.queueFlags & VK_QUEUE_TRANSFER_BIT && !foundTransfer)
 		{
 			deviceContext.queueFamilies.transfer.existed = true;
 			deviceContext.queueFamilies.transfer.index	 = familyIndex;
@@ -571,8 +2004,11 @@ static void createSwapchain(DeviceContext&		  deviceContext,
 		VK_ASSERT(vkGetPhysicalDeviceSurfaceCapabilitiesKHR(
 			deviceContext.physicalDevice, instanceContext.surface, &surfaceCapabilities));
 
+		i32 width, height;
+		glfwGetFramebufferSize(deviceContext.pWindow, &width, &height);
+
 		deviceContext.swapchainImagesCount = chooseImageCount(surfaceCapabilities);
-		deviceContext.swapchainExtent	   = chooseExtent(surfaceCapabilities);
+		deviceContext.swapchainExtent	   = chooseExtent(surfaceCapabilities, VkExtent2D{u32(width), u32(height)});
 	}
 
 	{
@@ -603,19 +2039,19 @@ static void createSwapchain(DeviceContext&		  deviceContext,
 	swapchainInfo.imageArrayLayers		   = 1;
 	swapchainInfo.imageSharingMode		   = VK_SHARING_MODE_EXCLUSIVE;
 	swapchainInfo.queueFamilyIndexCount	   = 0;
-	swapchainInfo.imageUsage			   = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+	swapchainInfo.imageUsage			   = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
 	swapchainInfo.preTransform			   = VK_SURFACE_TRANSFORM_IDENTITY_BIT_KHR;
 	swapchainInfo.compositeAlpha		   = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
 	swapchainInfo.clipped				   = VK_TRUE;
-	swapchainInfo.oldSwapchain			   = VK_NULL_HANDLE;
+	swapchainInfo.oldSwapchain			   = deviceContext.swapchain;
 
 	VK_ASSERT(vkCreateSwapchainKHR(deviceContext.device, &swapchainInfo, nullptr, &deviceContext.swapchain));
-	deviceContext.releaseStack.push({&deviceContext, [](void* p) {
-										 DeviceContext& deviceContext = *(DeviceContext*)p;
-										 vkDestroySwapchainKHR(deviceContext.device, deviceContext.swapchain, nullptr);
-									 }});
 
-	printf("Swapchain created.\n");
+	printf("Swapchain created (%ux%u, present mode %d, %u images).\n",
+		   deviceContext.swapchainExtent.width,
+		   deviceContext.swapchainExtent.height,
+		   deviceContext.swapchainPresentMode,
+		   deviceContext.swapchainImagesCount);
 }
 
 static u32 evaluatePhysicalDevice(VkPhysicalDevice physicalDevice)
@@ -623,6 +2059,11 @@ static u32 evaluatePhysicalDevice(VkPhysicalDevice physicalDevice)
 	VkPhysicalDeviceProperties deviceProperties;
 	vkGetPhysicalDeviceProperties(physicalDevice, &deviceProperties);
 
+	if (deviceProperties.apiVersion < VK_API_VERSION_1_2)
+	{
+		return 0;
+	}
+
 	u32 score = 0;
 
 	if (deviceProperties.deviceType == VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU)
@@ -681,15 +2122,21 @@ static u32 chooseSwapchainImageCount(VkSurfaceCapabilitiesKHR surfaceCapabilitie
 	return imageCount;
 }
 
-static VkExtent2D chooseSwapchainExtent(const VkSurfaceCapabilitiesKHR& surfaceCapabilities)
+static VkExtent2D chooseSwapchainExtent(const VkSurfaceCapabilitiesKHR& surfaceCapabilities,
+										VkExtent2D						framebufferExtent)
 {
-	ASSERT(surfaceCapabilities.currentExtent.width != UINT32_MAX);
-
 	if (surfaceCapabilities.currentExtent.width != UINT32_MAX)
 	{
 		return surfaceCapabilities.currentExtent;
 	}
 
-	ASSERT(false); // For simplicity, we ignore the case where we have to choose the extent ourselves.
-	return VkExtent2D{800, 600};
+	// The surface size is defined by the swapchain (e.g. Wayland), follow the window framebuffer
+	const VkExtent2D& minExtent = surfaceCapabilities.minImageExtent;
+	const VkExtent2D& maxExtent = surfaceCapabilities.maxImageExtent;
+
+	VkExtent2D extent;
+	extent.width  = std::clamp(framebufferExtent.width, minExtent.width, maxExtent.width);
+	extent.height = std::clamp(framebufferExtent.height, minExtent.height, maxExtent.height);
+
+	return extent;
 }
\ No newline at end of file
@@ -0,0 +1,695 @@
+#include "memory_allocator.h"
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+
+#define TLSF_SL_LOG2		4u
+#define TLSF_SL_COUNT		(1u << TLSF_SL_LOG2)
+#define TLSF_SMALL_LOG2		8u
+#define TLSF_SMALL_SIZE		(1u << TLSF_SMALL_LOG2)
+#define TLSF_FL_COUNT		(64u - TLSF_SMALL_LOG2 + 1u)
+#define TLSF_MIN_BLOCK_SIZE 16u
+#define INVALID_NODE		UINT32_MAX
+
+struct TlsfNode
+{
+	VkDeviceSize offset;
+	VkDeviceSize size;
+	u32			 prevPhysical;
+	u32			 nextPhysical;
+	u32			 prevFree;
+	u32			 nextFree;
+	b8			 isFree;
+};
+
+struct Tlsf
+{
+	std::vector<TlsfNode> nodes;
+	std::vector<u32>	  unusedNodes;
+
+	u64 flBitmap;
+	u32 slBitmaps[TLSF_FL_COUNT];
+	u32 freeHeads[TLSF_FL_COUNT][TLSF_SL_COUNT];
+
+	VkDeviceSize freeBytes;
+	u32			 allocationsCount;
+};
+
+struct MemoryBlock
+{
+	VkDeviceMemory memory;
+	VkDeviceSize   size;
+	u8*			   pMapped;
+	b8			   dedicated;
+	Tlsf		   tlsf;
+};
+
+struct MemoryPool
+{
+	std::vector<MemoryBlock*> blocks;
+};
+
+struct MemoryAllocator
+{
+	VkPhysicalDevice				 physicalDevice;
+	VkDevice						 device;
+	VkPhysicalDeviceMemoryProperties memoryProperties;
+	VkDeviceSize					 bufferImageGranularity;
+	u32								 maxAllocationsCount;
+	VkDeviceSize					 blockSizes[VK_MAX_MEMORY_HEAPS];
+
+	// Indexed by memoryTypeIndex * 2 + AllocationKind
+	MemoryPool pools[VK_MAX_MEMORY_TYPES * 2];
+	u32		   vkAllocationsCount;
+
+	std::mutex mutex;
+};
+
+static inline VkDeviceSize alignUp(VkDeviceSize value, VkDeviceSize alignment)
+{
+	return (value + alignment - 1) & ~(alignment - 1);
+}
+
+static inline u32 findMsb(u64 value)
+{
+	return 63u - u32(__builtin_clzll(value));
+}
+
+static inline u32 findLsb(u64 value)
+{
+	return u32(__builtin_ctzll(value));
+}
+
+static void tlsfMapping(VkDeviceSize size, u32& fl, u32& sl)
+{
+	if (size < TLSF_SMALL_SIZE)
+	{
+		fl = 0;
+		sl = u32(size / (TLSF_SMALL_SIZE / TLSF_SL_COUNT));
+		return;
+	}
+
+	u32 msb = findMsb(size);
+	fl		= msb - TLSF_SMALL_LOG2 + 1;
+	sl		= u32(size >> (msb - TLSF_SL_LOG2)) ^ TLSF_SL_COUNT;
+}
+
+// Rounds the size up to the next class so that any node found in that class is big enough.
+static void tlsfMappingSearch(VkDeviceSize size, u32& fl, u32& sl)
+{
+	if (size < TLSF_SMALL_SIZE)
+	{
+		size += (TLSF_SMALL_SIZE / TLSF_SL_COUNT) - 1;
+	}
+	else
+	{
+		size += (VkDeviceSize(1) << (findMsb(size) - TLSF_SL_LOG2)) - 1;
+	}
+
+	tlsfMapping(size, fl, sl);
+}
+
+static u32 tlsfCreateNode(Tlsf& tlsf)
+{
+	if (!tlsf.unusedNodes.empty())
+	{
+		u32 nodeIndex = tlsf.unusedNodes.back();
+		tlsf.unusedNodes.pop_back();
+		return nodeIndex;
+	}
+
+	tlsf.nodes.push_back({});
+	return u32(tlsf.nodes.size() - 1);
+}
+
+static void tlsfReleaseNode(Tlsf& tlsf, u32 nodeIndex)
+{
+	tlsf.nodes[nodeIndex] = {};
+	tlsf.unusedNodes.push_back(nodeIndex);
+}
+
+static void tlsfInsertFree(Tlsf& tlsf, u32 nodeIndex)
+{
+	TlsfNode& node = tlsf.nodes[nodeIndex];
+
+	u32 fl, sl;
+	tlsfMapping(node.size, fl, sl);
+
+	u32& head	  = tlsf.freeHeads[fl][sl];
+	node.isFree	  = true;
+	node.prevFree = INVALID_NODE;
+	node.nextFree = head;
+	if (head != INVALID_NODE)
+	{
+		tlsf.nodes[head].prevFree = nodeIndex;
+	}
+	head = nodeIndex;
+
+	tlsf.flBitmap |= u64(1) << fl;
+	tlsf.slBitmaps[fl] |= 1u << sl;
+	tlsf.freeBytes += node.size;
+}
+
+static void tlsfRemoveFree(Tlsf& tlsf, u32 nodeIndex)
+{
+	TlsfNode& node = tlsf.nodes[nodeIndex];
+
+	u32 fl, sl;
+	tlsfMapping(node.size, fl, sl);
+
+	if (node.prevFree != INVALID_NODE)
+	{
+		tlsf.nodes[node.prevFree].nextFree = node.nextFree;
+	}
+	if (node.nextFree != INVALID_NODE)
+	{
+		tlsf.nodes[node.nextFree].prevFree = node.prevFree;
+	}
+
+	u32& head = tlsf.freeHeads[fl][sl];
+	if (head == nodeIndex)
+	{
+		head = node.nextFree;
+		if (head == INVALID_NODE)
+		{
+			tlsf.slBitmaps[fl] &= ~(1u << sl);
+			if (tlsf.slBitmaps[fl] == 0)
+			{
+				tlsf.flBitmap &= ~(u64(1) << fl);
+			}
+		}
+	}
+
+	node.isFree	  = false;
+	node.prevFree = INVALID_NODE;
+	node.nextFree = INVALID_NODE;
+	tlsf.freeBytes -= node.size;
+}
+
+// Splits the node so that it keeps the first `size` bytes, the rest goes into the returned node.
+static u32 tlsfSplit(Tlsf& tlsf, u32 nodeIndex, VkDeviceSize size)
+{
+	u32 restIndex = tlsfCreateNode(tlsf);
+
+	TlsfNode& node = tlsf.nodes[nodeIndex];
+	TlsfNode& rest = tlsf.nodes[restIndex];
+
+	rest.offset		  = node.offset + size;
+	rest.size		  = node.size - size;
+	rest.prevPhysical = nodeIndex;
+	rest.nextPhysical = node.nextPhysical;
+	rest.prevFree	  = INVALID_NODE;
+	rest.nextFree	  = INVALID_NODE;
+	rest.isFree		  = false;
+
+	if (node.nextPhysical != INVALID_NODE)
+	{
+		tlsf.nodes[node.nextPhysical].prevPhysical = restIndex;
+	}
+
+	node.size		  = size;
+	node.nextPhysical = restIndex;
+
+	return restIndex;
+}
+
+static void tlsfInit(Tlsf& tlsf, VkDeviceSize size)
+{
+	tlsf.flBitmap = 0;
+	memset(tlsf.slBitmaps, 0, sizeof(tlsf.slBitmaps));
+	memset(tlsf.freeHeads, 0xFF, sizeof(tlsf.freeHeads));
+	tlsf.freeBytes		  = 0;
+	tlsf.allocationsCount = 0;
+
+	u32		  nodeIndex = tlsfCreateNode(tlsf);
+	TlsfNode& node		= tlsf.nodes[nodeIndex];
+	node.offset			= 0;
+	node.size			= size;
+	node.prevPhysical	= INVALID_NODE;
+	node.nextPhysical	= INVALID_NODE;
+	tlsfInsertFree(tlsf, nodeIndex);
+}
+
+static b8 tlsfAllocate(Tlsf& tlsf, VkDeviceSize size, VkDeviceSize alignment, u32* pNode)
+{
+	size = alignUp(size, TLSF_MIN_BLOCK_SIZE);
+
+	u32 fl, sl;
+	tlsfMappingSearch(size + alignment - 1, fl, sl);
+	if (fl >= TLSF_FL_COUNT)
+	{
+		return false;
+	}
+
+	u32 slBitmap = tlsf.slBitmaps[fl] & (~0u << sl);
+	if (slBitmap == 0)
+	{
+		u64 flBitmap = tlsf.flBitmap & (~u64(0) << (fl + 1));
+		if (flBitmap == 0)
+		{
+			return false;
+		}
+
+		fl		 = findLsb(flBitmap);
+		slBitmap = tlsf.slBitmaps[fl];
+	}
+	sl = findLsb(slBitmap);
+
+	u32 nodeIndex = tlsf.freeHeads[fl][sl];
+	tlsfRemoveFree(tlsf, nodeIndex);
+
+	VkDeviceSize padding = alignUp(tlsf.nodes[nodeIndex].offset, alignment) - tlsf.nodes[nodeIndex].offset;
+	if (padding > 0)
+	{
+		u32 alignedIndex = tlsfSplit(tlsf, nodeIndex, padding);
+		tlsfInsertFree(tlsf, nodeIndex);
+		nodeIndex = alignedIndex;
+	}
+
+	if (tlsf.nodes[nodeIndex].size - size >= TLSF_MIN_BLOCK_SIZE)
+	{
+		u32 restIndex = tlsfSplit(tlsf, nodeIndex, size);
+		tlsfInsertFree(tlsf, restIndex);
+	}
+
+	tlsf.allocationsCount++;
+	*pNode = nodeIndex;
+	return true;
+}
+
+// Dedicated blocks are sized for exactly one allocation, which the size classes cannot always find again.
+static u32 tlsfAllocateWhole(Tlsf& tlsf)
+{
+	ASSERT(tlsf.allocationsCount == 0 && tlsf.nodes.size() == 1);
+
+	tlsfRemoveFree(tlsf, 0);
+	tlsf.allocationsCount++;
+	return 0;
+}
+
+static void tlsfFree(Tlsf& tlsf, u32 nodeIndex)
+{
+	u32 nextIndex = tlsf.nodes[nodeIndex].nextPhysical;
+	if (nextIndex != INVALID_NODE && tlsf.nodes[nextIndex].isFree)
+	{
+		tlsfRemoveFree(tlsf, nextIndex);
+
+		TlsfNode& node = tlsf.nodes[nodeIndex];
+		node.size += tlsf.nodes[nextIndex].size;
+		node.nextPhysical = tlsf.nodes[nextIndex].nextPhysical;
+		if (node.nextPhysical != INVALID_NODE)
+		{
+			tlsf.nodes[node.nextPhysical].prevPhysical = nodeIndex;
+		}
+		tlsfReleaseNode(tlsf, nextIndex);
+	}
+
+	u32 prevIndex = tlsf.nodes[nodeIndex].prevPhysical;
+	if (prevIndex != INVALID_NODE && tlsf.nodes[prevIndex].isFree)
+	{
+		tlsfRemoveFree(tlsf, prevIndex);
+
+		TlsfNode& prev = tlsf.nodes[prevIndex];
+		prev.size += tlsf.nodes[nodeIndex].size;
+		prev.nextPhysical = tlsf.nodes[nodeIndex].nextPhysical;
+		if (prev.nextPhysical != INVALID_NODE)
+		{
+			tlsf.nodes[prev.nextPhysical].prevPhysical = prevIndex;
+		}
+		tlsfReleaseNode(tlsf, nodeIndex);
+		nodeIndex = prevIndex;
+	}
+
+	tlsfInsertFree(tlsf, nodeIndex);
+	tlsf.allocationsCount--;
+}
+
+static VkDeviceSize tlsfLargestFreeRange(const Tlsf& tlsf)
+{
+	if (tlsf.flBitmap == 0)
+	{
+		return 0;
+	}
+
+	u32			 fl			 = findMsb(tlsf.flBitmap);
+	u32			 sl			 = findMsb(tlsf.slBitmaps[fl]);
+	VkDeviceSize largestSize = 0;
+
+	for (u32 nodeIndex = tlsf.freeHeads[fl][sl]; nodeIndex != INVALID_NODE; nodeIndex = tlsf.nodes[nodeIndex].nextFree)
+	{
+		largestSize = std::max(largestSize, tlsf.nodes[nodeIndex].size);
+	}
+
+	return largestSize;
+}
+
+static u32 findMemoryType(const MemoryAllocator& allocator, u32 typeBits, VkMemoryPropertyFlags properties)
+{
+	for (u32 typeIndex = 0u; typeIndex < allocator.memoryProperties.memoryTypeCount; ++typeIndex)
+	{
+		const VkMemoryType& memoryType = allocator.memoryProperties.memoryTypes[typeIndex];
+		if ((typeBits & (1u << typeIndex)) && (memoryType.propertyFlags & properties) == properties)
+		{
+			return typeIndex;
+		}
+	}
+
+	ASSERT(false); // No memory type satisfies the requested properties
+	return UINT32_MAX;
+}
+
+static MemoryBlock* createMemoryBlock(MemoryAllocator& allocator, u32 memoryTypeIndex, VkDeviceSize size, b8 dedicated)
+{
+	ASSERT(allocator.vkAllocationsCount < allocator.maxAllocationsCount);
+
+	MemoryBlock* pBlock = new MemoryBlock();
+	pBlock->size		= size;
+	pBlock->dedicated	= dedicated;
+	pBlock->pMapped		= nullptr;
+
+	VkMemoryAllocateInfo allocInfo = {};
+	allocInfo.sType				   = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+	allocInfo.allocationSize	   = size;
+	allocInfo.memoryTypeIndex	   = memoryTypeIndex;
+	VK_ASSERT(vkAllocateMemory(allocator.device, &allocInfo, nullptr, &pBlock->memory));
+	allocator.vkAllocationsCount++;
+
+	if (allocator.memoryProperties.memoryTypes[memoryTypeIndex].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)
+	{
+		VK_ASSERT(vkMapMemory(allocator.device, pBlock->memory, 0, VK_WHOLE_SIZE, 0, (void**)&pBlock->pMapped));
+	}
+
+	tlsfInit(pBlock->tlsf, size);
+	return pBlock;
+}
+
+static void destroyMemoryBlock(MemoryAllocator& allocator, MemoryBlock* pBlock)
+{
+	if (pBlock->pMapped != nullptr)
+	{
+		vkUnmapMemory(allocator.device, pBlock->memory);
+	}
+
+	vkFreeMemory(allocator.device, pBlock->memory, nullptr);
+	allocator.vkAllocationsCount--;
+	delete pBlock;
+}
+
+MemoryAllocator* createMemoryAllocator(VkPhysicalDevice physicalDevice,
+									   VkDevice			device,
+									   VkDeviceSize		preferredBlockSize)
+{
+	MemoryAllocator* pAllocator = new MemoryAllocator();
+	pAllocator->physicalDevice	= physicalDevice;
+	pAllocator->device			= device;
+
+	VkPhysicalDeviceProperties deviceProperties;
+	vkGetPhysicalDeviceProperties(physicalDevice, &deviceProperties);
+	pAllocator->bufferImageGranularity = deviceProperties.limits.bufferImageGranularity;
+	pAllocator->maxAllocationsCount	   = deviceProperties.limits.maxMemoryAllocationCount;
+
+	vkGetPhysicalDeviceMemoryProperties(physicalDevice, &pAllocator->memoryProperties);
+
+	for (u32 heapIndex = 0u; heapIndex < pAllocator->memoryProperties.memoryHeapCount; ++heapIndex)
+	{
+		// Small heaps (e.g. the 256MB BAR heap) should not be eaten by a couple of blocks
+		VkDeviceSize heapSize			   = pAllocator->memoryProperties.memoryHeaps[heapIndex].size;
+		pAllocator->blockSizes[heapIndex] = heapSize <= 1024ull * 1024 * 1024 ? heapSize / 8 : preferredBlockSize;
+		pAllocator->blockSizes[heapIndex] = std::min(pAllocator->blockSizes[heapIndex], preferredBlockSize);
+	}
+
+	return pAllocator;
+}
+
+void destroyMemoryAllocator(MemoryAllocator* pAllocator)
+{
+	for (MemoryPool& pool : pAllocator->pools)
+	{
+		for (MemoryBlock* pBlock : pool.blocks)
+		{
+			if (pBlock->tlsf.allocationsCount > 0)
+			{
+				printf("Memory allocator: %u allocations leaked in block of %llu bytes.\n",
+					   pBlock->tlsf.allocationsCount,
+					   (unsigned long long)pBlock->size);
+			}
+			destroyMemoryBlock(*pAllocator, pBlock);
+		}
+		pool.blocks.clear();
+	}
+
+	delete pAllocator;
+}
+
+MemoryAllocation allocateMemory(MemoryAllocator*			pAllocator,
+								const VkMemoryRequirements& requirements,
+								VkMemoryPropertyFlags		properties,
+								AllocationKind				kind)
+{
+	std::lock_guard<std::mutex> lock(pAllocator->mutex);
+
+	u32 memoryTypeIndex = findMemoryType(*pAllocator, requirements.memoryTypeBits, properties);
+	u32 heapIndex		= pAllocator->memoryProperties.memoryTypes[memoryTypeIndex].heapIndex;
+
+	// Without a granularity constraint, linear and optimal resources can safely share blocks
+	if (pAllocator->bufferImageGranularity <= 1)
+	{
+		kind = AllocationKind::LINEAR;
+	}
+
+	MemoryPool&	 pool	   = pAllocator->pools[memoryTypeIndex * 2 + u32(kind)];
+	VkDeviceSize blockSize = pAllocator->blockSizes[heapIndex];
+
+	MemoryBlock* pBlock = nullptr;
+	u32			 node	= INVALID_NODE;
+
+	if (requirements.size > blockSize / 2)
+	{
+		pBlock = createMemoryBlock(*pAllocator, memoryTypeIndex, requirements.size, true);
+		pool.blocks.push_back(pBlock);
+		node = tlsfAllocateWhole(pBlock->tlsf);
+	}
+	else
+	{
+		for (MemoryBlock* pCandidate : pool.blocks)
+		{
+			if (!pCandidate->dedicated && tlsfAllocate(pCandidate->tlsf, requirements.size, requirements.alignment, &node))
+			{
+				pBlock = pCandidate;
+				break;
+			}
+		}
+
+		if (pBlock == nullptr)
+		{
+			pBlock = createMemoryBlock(*pAllocator, memoryTypeIndex, blockSize, false);
+			pool.blocks.push_back(pBlock);
+			ASSERT(tlsfAllocate(pBlock->tlsf, requirements.size, requirements.alignment, &node));
+		}
+	}
+
+	const TlsfNode& tlsfNode = pBlock->tlsf.nodes[node];
+
+	MemoryAllocation allocation = {};
+	allocation.memory			= pBlock->memory;
+	allocation.offset			= tlsfNode.offset;
+	allocation.size				= tlsfNode.size;
+	allocation.pMapped			= pBlock->pMapped != nullptr ? pBlock->pMapped + tlsfNode.offset : nullptr;
+	allocation.memoryTypeIndex	= memoryTypeIndex;
+	allocation.pBlock			= pBlock;
+	allocation.node				= node;
+
+	return allocation;
+}
+
+void freeMemory(MemoryAllocator* pAllocator, MemoryAllocation& allocation)
+{
+	if (allocation.pBlock == nullptr)
+	{
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock(pAllocator->mutex);
+
+	MemoryBlock* pBlock = allocation.pBlock;
+	tlsfFree(pBlock->tlsf, allocation.node);
+
+	if (pBlock->tlsf.allocationsCount == 0)
+	{
+		for (MemoryPool& pool : pAllocator->pools)
+		{
+			auto blockIt = std::find(pool.blocks.begin(), pool.blocks.end(), pBlock);
+			if (blockIt == pool.blocks.end())
+			{
+				continue;
+			}
+
+			// Keep a single empty block per pool around so that alloc/free patterns do not thrash vkAllocateMemory
+			u32 emptyBlocksCount = 0;
+			for (MemoryBlock* pOther : pool.blocks)
+			{
+				emptyBlocksCount += (!pOther->dedicated && pOther->tlsf.allocationsCount == 0) ? 1 : 0;
+			}
+
+			if (pBlock->dedicated || emptyBlocksCount > 1)
+			{
+				pool.blocks.erase(blockIt);
+				destroyMemoryBlock(*pAllocator, pBlock);
+			}
+			break;
+		}
+	}
+
+	allocation = {};
+}
+
+void createAllocatedBuffer(MemoryAllocator*			 pAllocator,
+						   const VkBufferCreateInfo& bufferInfo,
+						   VkMemoryPropertyFlags	 properties,
+						   AllocatedBuffer*			 pBuffer)
+{
+	VK_ASSERT(vkCreateBuffer(pAllocator->device, &bufferInfo, nullptr, &pBuffer->buffer));
+
+	VkMemoryRequirements requirements;
+	vkGetBufferMemoryRequirements(pAllocator->device, pBuffer->buffer, &requirements);
+
+	pBuffer->allocation = allocateMemory(pAllocator, requirements, properties, AllocationKind::LINEAR);
+	VK_ASSERT(vkBindBufferMemory(
+		pAllocator->device, pBuffer->buffer, pBuffer->allocation.memory, pBuffer->allocation.offset));
+}
+
+void destroyAllocatedBuffer(MemoryAllocator* pAllocator, AllocatedBuffer& buffer)
+{
+	vkDestroyBuffer(pAllocator->device, buffer.buffer, nullptr);
+	freeMemory(pAllocator, buffer.allocation);
+	buffer.buffer = VK_NULL_HANDLE;
+}
+
+void createAllocatedImage(MemoryAllocator*		  pAllocator,
+						  const VkImageCreateInfo& imageInfo,
+						  VkMemoryPropertyFlags	   properties,
+						  AllocatedImage*		   pImage)
+{
+	VK_ASSERT(vkCreateImage(pAllocator->device, &imageInfo, nullptr, &pImage->image));
+
+	VkMemoryRequirements requirements;
+	vkGetImageMemoryRequirements(pAllocator->device, pImage->image, &requirements);
+
+	AllocationKind kind = imageInfo.tiling == VK_IMAGE_TILING_OPTIMAL ? AllocationKind::OPTIMAL : AllocationKind::LINEAR;
+	pImage->allocation	= allocateMemory(pAllocator, requirements, properties, kind);
+	VK_ASSERT(
+		vkBindImageMemory(pAllocator->device, pImage->image, pImage->allocation.memory, pImage->allocation.offset));
+}
+
+void destroyAllocatedImage(MemoryAllocator* pAllocator, AllocatedImage& image)
+{
+	vkDestroyImage(pAllocator->device, image.image, nullptr);
+	freeMemory(pAllocator, image.allocation);
+	image.image = VK_NULL_HANDLE;
+}
+
+MemoryStatistics getMemoryStatistics(MemoryAllocator* pAllocator)
+{
+	std::lock_guard<std::mutex> lock(pAllocator->mutex);
+
+	MemoryStatistics statistics	  = {};
+	statistics.vkAllocationsCount = pAllocator->vkAllocationsCount;
+
+	for (const MemoryPool& pool : pAllocator->pools)
+	{
+		for (const MemoryBlock* pBlock : pool.blocks)
+		{
+			statistics.blocksCount++;
+			statistics.dedicatedBlocksCount += pBlock->dedicated ? 1 : 0;
+			statistics.allocationsCount += pBlock->tlsf.allocationsCount;
+			statistics.blockBytes += pBlock->size;
+			statistics.freeBytes += pBlock->tlsf.freeBytes;
+			statistics.largestFreeRange = std::max(statistics.largestFreeRange, tlsfLargestFreeRange(pBlock->tlsf));
+		}
+	}
+
+	statistics.usedBytes	 = statistics.blockBytes - statistics.freeBytes;
+	statistics.fragmentation = statistics.freeBytes > 0
+								   ? 1.0f - f32(f64(statistics.largestFreeRange) / f64(statistics.freeBytes))
+								   : 0.0f;
+
+	return statistics;
+}
+
+void printMemoryStatistics(MemoryAllocator* pAllocator)
+{
+	MemoryStatistics statistics = getMemoryStatistics(pAllocator);
+
+	printf("Device memory:\n");
+	printf(" Blocks:        %u (%u dedicated), %u vkAllocateMemory calls alive\n",
+		   statistics.blocksCount,
+		   statistics.dedicatedBlocksCount,
+		   statistics.vkAllocationsCount);
+	printf(" Allocations:   %u\n", statistics.allocationsCount);
+	printf(" Used / Total:  %.2f / %.2f MB\n",
+		   f64(statistics.usedBytes) / (1024.0 * 1024.0),
+		   f64(statistics.blockBytes) / (1024.0 * 1024.0));
+	printf(" Largest free:  %.2f MB\n", f64(statistics.largestFreeRange) / (1024.0 * 1024.0));
+	printf(" Fragmentation: %.1f%%\n", statistics.fragmentation * 100.0f);
+}
+
+void createFrameAllocator(MemoryAllocator* pAllocator,
+						  VkDeviceSize	   frameCapacity,
+						  u32			   framesCount,
+						  FrameAllocator*  pFrameAllocator)
+{
+	VkBufferCreateInfo bufferInfo = {};
+	bufferInfo.sType			  = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+	bufferInfo.size				  = frameCapacity * framesCount;
+	bufferInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+	bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+	createAllocatedBuffer(pAllocator,
+						  bufferInfo,
+						  VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+						  &pFrameAllocator->buffer);
+	ASSERT(pFrameAllocator->buffer.allocation.pMapped != nullptr);
+
+	pFrameAllocator->pMapped	   = (u8*)pFrameAllocator->buffer.allocation.pMapped;
+	pFrameAllocator->frameCapacity = frameCapacity;
+	pFrameAllocator->framesCount   = framesCount;
+	pFrameAllocator->frameIndex	   = 0;
+	pFrameAllocator->head		   = 0;
+	pFrameAllocator->peakUsed	   = 0;
+}
+
+void destroyFrameAllocator(MemoryAllocator* pAllocator, FrameAllocator& frameAllocator)
+{
+	destroyAllocatedBuffer(pAllocator, frameAllocator.buffer);
+	frameAllocator.pMapped = nullptr;
+}
+
+void resetFrameAllocator(FrameAllocator& frameAllocator, u32 frameIndex)
+{
+	ASSERT(frameIndex < frameAllocator.framesCount);
+
+	frameAllocator.frameIndex = frameIndex;
+	frameAllocator.head		  = 0;
+}
+
+b8 allocateTransient(FrameAllocator&	  frameAllocator,
+					 VkDeviceSize		  size,
+					 VkDeviceSize		  alignment,
+					 TransientAllocation* pAllocation)
+{
+	VkDeviceSize offset = alignUp(frameAllocator.head, alignment);
+	if (offset + size > frameAllocator.frameCapacity)
+	{
+		return false;
+	}
+
+	frameAllocator.head		= offset + size;
+	frameAllocator.peakUsed = std::max(frameAllocator.peakUsed, frameAllocator.head);
+
+	VkDeviceSize bufferOffset = VkDeviceSize(frameAllocator.frameIndex) * frameAllocator.frameCapacity + offset;
+	pAllocation->buffer		  = frameAllocator.buffer.buffer;
+	pAllocation->offset		  = bufferOffset;
+	pAllocation->pData		  = frameAllocator.pMapped + bufferOffset;
+
+	return true;
+}
@@ -0,0 +1,126 @@
+#pragma once
+
+#include "common.h"
+
+/**
+ * Sub-allocates device memory out of large per-memory-type blocks. Every block is managed by a TLSF
+ * (two-level segregated fit) allocator, so allocation and release are O(1) regardless of the number of live
+ * allocations. Buffers/linear images and optimal images are kept in separate pools whenever
+ * `bufferImageGranularity` is bigger than 1, which keeps them from ever sharing a granularity page.
+ *
+ * @example
+ * ```c++
+ * MemoryAllocator* pAllocator = createMemoryAllocator(physicalDevice, device);
+ * AllocatedBuffer  vertexBuffer;
+ * createAllocatedBuffer(pAllocator, bufferInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &vertexBuffer);
+ * ...
+ * destroyAllocatedBuffer(pAllocator, vertexBuffer);
+ * destroyMemoryAllocator(pAllocator);
+ * ```
+ */
+
+enum class AllocationKind
+{
+	LINEAR,	 // buffers and linear-tiling images
+	OPTIMAL, // optimal-tiling images
+};
+
+struct MemoryBlock;
+struct MemoryAllocator;
+
+struct MemoryAllocation
+{
+	VkDeviceMemory memory;
+	VkDeviceSize   offset;
+	VkDeviceSize   size;
+	void*		   pMapped; // nullptr when the memory is not host visible
+	u32			   memoryTypeIndex;
+
+	MemoryBlock* pBlock;
+	u32			 node;
+};
+
+struct AllocatedBuffer
+{
+	VkBuffer		 buffer;
+	MemoryAllocation allocation;
+};
+
+struct AllocatedImage
+{
+	VkImage			 image;
+	MemoryAllocation allocation;
+};
+
+struct MemoryStatistics
+{
+	u32			 blocksCount;
+	u32			 dedicatedBlocksCount;
+	u32			 allocationsCount;
+	u32			 vkAllocationsCount;
+	VkDeviceSize blockBytes;
+	VkDeviceSize usedBytes;
+	VkDeviceSize freeBytes;
+	VkDeviceSize largestFreeRange;
+	f32			 fragmentation; // 1 - largestFreeRange / freeBytes, 0 means all free memory is contiguous
+};
+
+MemoryAllocator* createMemoryAllocator(VkPhysicalDevice physicalDevice,
+									   VkDevice			device,
+									   VkDeviceSize		preferredBlockSize = 64ull * 1024 * 1024);
+void			 destroyMemoryAllocator(MemoryAllocator* pAllocator);
+
+MemoryAllocation allocateMemory(MemoryAllocator*			pAllocator,
+								const VkMemoryRequirements& requirements,
+								VkMemoryPropertyFlags		properties,
+								AllocationKind				kind);
+void			 freeMemory(MemoryAllocator* pAllocator, MemoryAllocation& allocation);
+
+void createAllocatedBuffer(MemoryAllocator*			 pAllocator,
+						   const VkBufferCreateInfo& bufferInfo,
+						   VkMemoryPropertyFlags	 properties,
+						   AllocatedBuffer*			 pBuffer);
+void destroyAllocatedBuffer(MemoryAllocator* pAllocator, AllocatedBuffer& buffer);
+
+void createAllocatedImage(MemoryAllocator*		  pAllocator,
+						  const VkImageCreateInfo& imageInfo,
+						  VkMemoryPropertyFlags	   properties,
+						  AllocatedImage*		   pImage);
+void destroyAllocatedImage(MemoryAllocator* pAllocator, AllocatedImage& image);
+
+MemoryStatistics getMemoryStatistics(MemoryAllocator* pAllocator);
+void			 printMemoryStatistics(MemoryAllocator* pAllocator);
+
+/**
+ * Linear allocator for data which only lives for one frame (staging copies, per-frame constants). The backing
+ * buffer is host visible, persistently mapped and split into one region per frame in flight; a region is simply
+ * rewound by `resetFrameAllocator` once the fence of that frame has signaled.
+ */
+struct FrameAllocator
+{
+	AllocatedBuffer buffer;
+	u8*				pMapped;
+	VkDeviceSize	frameCapacity;
+	u32				framesCount;
+	u32				frameIndex;
+	VkDeviceSize	head;
+	VkDeviceSize	peakUsed;
+};
+
+struct TransientAllocation
+{
+	VkBuffer	 buffer;
+	VkDeviceSize offset;
+	void*		 pData;
+};
+
+void createFrameAllocator(MemoryAllocator* pAllocator,
+						  VkDeviceSize	   frameCapacity,
+						  u32			   framesCount,
+						  FrameAllocator*  pFrameAllocator);
+void destroyFrameAllocator(MemoryAllocator* pAllocator, FrameAllocator& frameAllocator);
+void resetFrameAllocator(FrameAllocator& frameAllocator, u32 frameIndex);
+b8	 allocateTransient(FrameAllocator&		frameAllocator,
+					   VkDeviceSize			size,
+					   VkDeviceSize			alignment,
+					   TransientAllocation* pAllocation);
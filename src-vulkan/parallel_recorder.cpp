@@ -0,0 +1,340 @@
+#include "parallel_recorder.h"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+using Clock = std::chrono::steady_clock;
+
+struct RecorderPool
+{
+	VkCommandPool				 commandPool;
+	std::vector<VkCommandBuffer> commandBuffers;
+	u32							 usedCount; // buffers handed out since the last reset
+};
+
+struct RecorderThread
+{
+	std::vector<RecorderPool> pools; // one per frame in flight
+	VkCommandBuffer			  recorded;
+	f64						  recordMsSum;
+};
+
+struct ParallelRecorder
+{
+	VkDevice device;
+	u32		 frameIndex;
+	u32		 threadsCount;
+
+	std::vector<RecorderThread> threads; // index 0 is the thread calling recordParallel
+	std::vector<std::thread>	workers;
+
+	std::mutex				mutex;
+	std::condition_variable workCondition;
+	std::condition_variable doneCondition;
+	u64						generation;
+	u32						pendingCount;
+	b8						quitting;
+
+	const VkCommandBufferInheritanceInfo* pInheritanceInfo;
+	u32									  drawsCount;
+	RecordDrawsFunc						  recordFunc;
+	void*								  pUserData;
+
+	u64				 framesMeasured;
+	f64				 wallMsSum;
+	std::vector<f64> scalingWallMs; // average wall time per threads count, 0 when never measured
+};
+
+static VkCommandBuffer acquireSecondaryBuffer(ParallelRecorder& recorder, RecorderPool& pool)
+{
+	if (pool.usedCount == pool.commandBuffers.size())
+	{
+		VkCommandBufferAllocateInfo allocInfo = {};
+		allocInfo.sType						  = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+		allocInfo.commandPool				  = pool.commandPool;
+		allocInfo.level						  = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+		allocInfo.commandBufferCount		  = 1;
+
+		VkCommandBuffer commandBuffer;
+		VK_ASSERT(vkAllocateCommandBuffers(recorder.device, &allocInfo, &commandBuffer));
+		pool.commandBuffers.push_back(commandBuffer);
+	}
+
+	return pool.commandBuffers[pool.usedCount++];
+}
+
+static void storeScalingSample(ParallelRecorder& recorder)
+{
+	if (recorder.framesMeasured > 0)
+	{
+		recorder.scalingWallMs[recorder.threadsCount] = recorder.wallMsSum / f64(recorder.framesMeasured);
+	}
+}
+
+static void recordSlice(ParallelRecorder& recorder, u32 threadIndex)
+{
+	Clock::time_point start	 = Clock::now();
+	RecorderThread&	  thread = recorder.threads[threadIndex];
+
+	u32 sliceSize = (recorder.drawsCount + recorder.threadsCount - 1) / recorder.threadsCount;
+	u32 firstDraw = std::min(threadIndex * sliceSize, recorder.drawsCount);
+	u32 drawCount = std::min(sliceSize, recorder.drawsCount - firstDraw);
+
+	VkCommandBuffer commandBuffer = acquireSecondaryBuffer(recorder, thread.pools[recorder.frameIndex]);
+
+	VkCommandBufferBeginInfo beginInfo = {};
+	beginInfo.sType					   = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+	beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+	beginInfo.pInheritanceInfo = recorder.pInheritanceInfo;
+	VK_ASSERT(vkBeginCommandBuffer(commandBuffer, &beginInfo));
+
+	if (drawCount > 0)
+	{
+		recorder.recordFunc(commandBuffer, firstDraw, drawCount, recorder.pUserData);
+	}
+
+	VK_ASSERT(vkEndCommandBuffer(commandBuffer));
+
+	thread.recorded = commandBuffer;
+	thread.recordMsSum += std::chrono::duration<f64, std::milli>(Clock::now() - start).count();
+}
+
+static void workerLoop(ParallelRecorder* pRecorder, u32 threadIndex)
+{
+	u64 seenGeneration = 0;
+
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> lock(pRecorder->mutex);
+			pRecorder->workCondition.wait(
+				lock, [&]() { return pRecorder->quitting || pRecorder->generation != seenGeneration; });
+
+			if (pRecorder->quitting)
+			{
+				return;
+			}
+			seenGeneration = pRecorder->generation;
+
+			if (threadIndex >= pRecorder->threadsCount)
+			{
+				continue;
+			}
+		}
+
+		recordSlice(*pRecorder, threadIndex);
+
+		std::lock_guard<std::mutex> lock(pRecorder->mutex);
+		if (--pRecorder->pendingCount == 0)
+		{
+			pRecorder->doneCondition.notify_one();
+		}
+	}
+}
+
+ParallelRecorder* createParallelRecorder(const ParallelRecorderCreateInfo& createInfo)
+{
+	u32 maxThreadsCount = createInfo.maxThreadsCount;
+	if (maxThreadsCount == 0)
+	{
+		maxThreadsCount = std::max(1u, std::thread::hardware_concurrency());
+	}
+
+	ParallelRecorder* pRecorder = new ParallelRecorder();
+	pRecorder->device			= createInfo.device;
+	pRecorder->threadsCount		= maxThreadsCount;
+	pRecorder->threads.resize(maxThreadsCount);
+	pRecorder->scalingWallMs.resize(maxThreadsCount + 1, 0.0);
+
+	for (RecorderThread& thread : pRecorder->threads)
+	{
+		thread.pools.resize(createInfo.framesInFlight);
+		for (RecorderPool& pool : thread.pools)
+		{
+			VkCommandPoolCreateInfo poolInfo = {};
+			poolInfo.sType					 = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+			poolInfo.flags					 = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+			poolInfo.queueFamilyIndex		 = createInfo.queueFamilyIndex;
+			VK_ASSERT(vkCreateCommandPool(pRecorder->device, &poolInfo, nullptr, &pool.commandPool));
+		}
+	}
+
+	for (u32 threadIndex = 1u; threadIndex < maxThreadsCount; ++threadIndex)
+	{
+		pRecorder->workers.emplace_back(workerLoop, pRecorder, threadIndex);
+	}
+
+	printf("Parallel recorder created with %u threads.\n", maxThreadsCount);
+
+	return pRecorder;
+}
+
+void destroyParallelRecorder(ParallelRecorder* pRecorder)
+{
+	{
+		std::lock_guard<std::mutex> lock(pRecorder->mutex);
+		pRecorder->quitting = true;
+	}
+	pRecorder->workCondition.notify_all();
+
+	for (std::thread& worker : pRecorder->workers)
+	{
+		worker.join();
+	}
+
+	for (RecorderThread& thread : pRecorder->threads)
+	{
+		for (RecorderPool& pool : thread.pools)
+		{
+			vkDestroyCommandPool(pRecorder->device, pool.commandPool, nullptr);
+		}
+	}
+
+	delete pRecorder;
+}
+
+u32 getRecorderMaxThreadsCount(ParallelRecorder* pRecorder)
+{
+	return u32(pRecorder->threads.size());
+}
+
+void setRecorderThreadsCount(ParallelRecorder* pRecorder, u32 threadsCount)
+{
+	storeScalingSample(*pRecorder);
+	pRecorder->threadsCount = std::clamp(threadsCount, 1u, u32(pRecorder->threads.size()));
+	resetRecorderTimings(pRecorder);
+}
+
+void beginRecorderFrame(ParallelRecorder* pRecorder, u32 frameIndex)
+{
+	pRecorder->frameIndex = frameIndex;
+
+	for (RecorderThread& thread : pRecorder->threads)
+	{
+		RecorderPool& pool = thread.pools[frameIndex];
+		if (pool.usedCount > 0)
+		{
+			VK_ASSERT(vkResetCommandPool(pRecorder->device, pool.commandPool, 0));
+			pool.usedCount = 0;
+		}
+	}
+}
+
+void recordParallel(ParallelRecorder*					  pRecorder,
+					VkCommandBuffer						  primaryCommandBuffer,
+					const VkCommandBufferInheritanceInfo& inheritanceInfo,
+					u32									  drawsCount,
+					RecordDrawsFunc						  recordFunc,
+					void*								  pUserData)
+{
+	Clock::time_point start = Clock::now();
+
+	{
+		std::lock_guard<std::mutex> lock(pRecorder->mutex);
+		pRecorder->pInheritanceInfo = &inheritanceInfo;
+		pRecorder->drawsCount		= drawsCount;
+		pRecorder->recordFunc		= recordFunc;
+		pRecorder->pUserData		= pUserData;
+		pRecorder->pendingCount		= pRecorder->threadsCount - 1;
+		pRecorder->generation++;
+	}
+	pRecorder->workCondition.notify_all();
+
+	recordSlice(*pRecorder, 0);
+
+	{
+		std::unique_lock<std::mutex> lock(pRecorder->mutex);
+		pRecorder->doneCondition.wait(lock, [&]() { return pRecorder->pendingCount == 0; });
+	}
+
+	std::vector<VkCommandBuffer> secondaryBuffers(pRecorder->threadsCount);
+	for (u32 threadIndex = 0u; threadIndex < pRecorder->threadsCount; ++threadIndex)
+	{
+		secondaryBuffers[threadIndex] = pRecorder->threads[threadIndex].recorded;
+	}
+	vkCmdExecuteCommands(primaryCommandBuffer, u32(secondaryBuffers.size()), secondaryBuffers.data());
+
+	pRecorder->wallMsSum += std::chrono::duration<f64, std::milli>(Clock::now() - start).count();
+	pRecorder->framesMeasured++;
+}
+
+RecorderTimings getRecorderTimings(ParallelRecorder* pRecorder)
+{
+	RecorderTimings timings = {};
+	timings.threadsCount	= pRecorder->threadsCount;
+	timings.framesMeasured	= pRecorder->framesMeasured;
+	timings.threadMs.resize(pRecorder->threadsCount);
+
+	if (pRecorder->framesMeasured > 0)
+	{
+		timings.wallMs = pRecorder->wallMsSum / f64(pRecorder->framesMeasured);
+		for (u32 threadIndex = 0u; threadIndex < pRecorder->threadsCount; ++threadIndex)
+		{
+			timings.threadMs[threadIndex] =
+				pRecorder->threads[threadIndex].recordMsSum / f64(pRecorder->framesMeasured);
+		}
+	}
+
+	return timings;
+}
+
+void printRecorderTimings(ParallelRecorder* pRecorder)
+{
+	RecorderTimings timings = getRecorderTimings(pRecorder);
+	if (timings.framesMeasured == 0)
+	{
+		printf("Parallel recording: no frame measured.\n");
+		return;
+	}
+
+	printf("Parallel recording with %u threads over %llu frames: %.3f ms per frame\n",
+		   timings.threadsCount,
+		   timings.framesMeasured,
+		   timings.wallMs);
+	for (u32 threadIndex = 0u; threadIndex < timings.threadsCount; ++threadIndex)
+	{
+		printf(" Thread %u: %.3f ms\n", threadIndex, timings.threadMs[threadIndex]);
+	}
+}
+
+void printRecorderScaling(ParallelRecorder* pRecorder)
+{
+	storeScalingSample(*pRecorder);
+
+	f64 singleThreadMs = pRecorder->scalingWallMs[1];
+	printf("Parallel recording scaling (%u hardware threads):\n", std::thread::hardware_concurrency());
+	for (u32 threadsCount = 1u; threadsCount < u32(pRecorder->scalingWallMs.size()); ++threadsCount)
+	{
+		f64 wallMs = pRecorder->scalingWallMs[threadsCount];
+		if (wallMs <= 0.0)
+		{
+			continue;
+		}
+
+		if (singleThreadMs > 0.0)
+		{
+			f64 speedup = singleThreadMs / wallMs;
+			printf(" %2u threads: %.3f ms, speedup %.2fx, efficiency %.0f%%\n",
+				   threadsCount,
+				   wallMs,
+				   speedup,
+				   100.0 * speedup / f64(threadsCount));
+		}
+		else
+		{
+			printf(" %2u threads: %.3f ms\n", threadsCount, wallMs);
+		}
+	}
+}
+
+void resetRecorderTimings(ParallelRecorder* pRecorder)
+{
+	pRecorder->framesMeasured = 0;
+	pRecorder->wallMsSum	  = 0.0;
+	for (RecorderThread& thread : pRecorder->threads)
+	{
+		thread.recordMsSum = 0.0;
+	}
+}
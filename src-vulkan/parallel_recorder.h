@@ -0,0 +1,59 @@
+#pragma once
+
+#include "common.h"
+
+/**
+ * Records a draw list in parallel into secondary command buffers. Every thread (the calling thread included) owns
+ * one command pool per frame in flight, so no pool is ever touched by two threads, and pools are reset as a whole
+ * at the start of their frame instead of freeing buffers. Each thread records a contiguous slice of the draws, the
+ * primary command buffer then runs all slices in order with `vkCmdExecuteCommands`.
+ *
+ * @example
+ * ```c++
+ * beginRecorderFrame(pRecorder, frameIndex);
+ * vkCmdBeginRenderPass(primary, &renderPassInfo, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+ * recordParallel(pRecorder, primary, inheritanceInfo, drawsCount, recordDraws, pScene);
+ * vkCmdEndRenderPass(primary);
+ * ```
+ */
+
+struct ParallelRecorder;
+
+struct ParallelRecorderCreateInfo
+{
+	VkDevice device;
+	u32		 queueFamilyIndex;
+	u32		 framesInFlight;
+	u32		 maxThreadsCount; // 0 uses the hardware concurrency
+};
+
+// Records draws [firstDraw, firstDraw + drawsCount) into a secondary command buffer that is already begun.
+typedef void (*RecordDrawsFunc)(VkCommandBuffer commandBuffer, u32 firstDraw, u32 drawsCount, void* pUserData);
+
+struct RecorderTimings
+{
+	u32				 threadsCount;
+	u64				 framesMeasured;
+	f64				 wallMs;	 // average time spent in recordParallel
+	std::vector<f64> threadMs; // average recording time of every thread
+};
+
+ParallelRecorder* createParallelRecorder(const ParallelRecorderCreateInfo& createInfo);
+void			  destroyParallelRecorder(ParallelRecorder* pRecorder);
+
+u32	 getRecorderMaxThreadsCount(ParallelRecorder* pRecorder);
+void setRecorderThreadsCount(ParallelRecorder* pRecorder, u32 threadsCount);
+
+// Resets the command pools of `frameIndex`, the frame's previous submission must have completed.
+void beginRecorderFrame(ParallelRecorder* pRecorder, u32 frameIndex);
+void recordParallel(ParallelRecorder*					  pRecorder,
+					VkCommandBuffer						  primaryCommandBuffer,
+					const VkCommandBufferInheritanceInfo& inheritanceInfo,
+					u32									  drawsCount,
+					RecordDrawsFunc						  recordFunc,
+					void*								  pUserData);
+
+RecorderTimings getRecorderTimings(ParallelRecorder* pRecorder);
+void			printRecorderTimings(ParallelRecorder* pRecorder);
+void			printRecorderScaling(ParallelRecorder* pRecorder); // speedup of every threads count measured so far
+void			resetRecorderTimings(ParallelRecorder* pRecorder);
@@ -0,0 +1,234 @@
+#include "pipeline_cache.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <thread>
+
+#define PIPELINE_CACHE_MAGIC   0x4E54544Cu // "NTTL"
+#define PIPELINE_CACHE_VERSION 1u
+
+struct PipelineCacheFileHeader
+{
+	u32 magic;
+	u32 version;
+	u32 vendorID;
+	u32 deviceID;
+	u32 driverVersion;
+	u8	pipelineCacheUUID[VK_UUID_SIZE];
+	u64 dataSize;
+	u64 dataHash;
+};
+
+static u64 hashBytes(const u8* pData, u64 size)
+{
+	// FNV-1a
+	u64 hash = 0xcbf29ce484222325ull;
+	for (u64 i = 0; i < size; ++i)
+	{
+		hash ^= pData[i];
+		hash *= 0x100000001b3ull;
+	}
+	return hash;
+}
+
+static void fillHeader(const PipelineCacheInfo& info, PipelineCacheFileHeader* pHeader)
+{
+	memset(pHeader, 0, sizeof(PipelineCacheFileHeader));
+	pHeader->magic		   = PIPELINE_CACHE_MAGIC;
+	pHeader->version	   = PIPELINE_CACHE_VERSION;
+	pHeader->vendorID	   = info.vendorID;
+	pHeader->deviceID	   = info.deviceID;
+	pHeader->driverVersion = info.driverVersion;
+	memcpy(pHeader->pipelineCacheUUID, info.pipelineCacheUUID, VK_UUID_SIZE);
+}
+
+static b8 isCacheDataValid(const PipelineCacheFileHeader& expected,
+						   const PipelineCacheFileHeader& header,
+						   const std::vector<u8>&		  data)
+{
+	if (header.magic != expected.magic || header.version != expected.version || header.vendorID != expected.vendorID ||
+		header.deviceID != expected.deviceID || header.driverVersion != expected.driverVersion ||
+		memcmp(header.pipelineCacheUUID, expected.pipelineCacheUUID, VK_UUID_SIZE) != 0)
+	{
+		return false;
+	}
+
+	if (header.dataSize != data.size() || hashBytes(data.data(), data.size()) != header.dataHash)
+	{
+		return false;
+	}
+
+	// The driver's own header (VkPipelineCacheHeaderVersionOne) has to agree with the device as well
+	if (data.size() < 16 + VK_UUID_SIZE)
+	{
+		return false;
+	}
+
+	u32 headerLength, headerVersion, vendorID, deviceID;
+	memcpy(&headerLength, data.data() + 0, sizeof(u32));
+	memcpy(&headerVersion, data.data() + 4, sizeof(u32));
+	memcpy(&vendorID, data.data() + 8, sizeof(u32));
+	memcpy(&deviceID, data.data() + 12, sizeof(u32));
+
+	return headerLength >= 16 + VK_UUID_SIZE && headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE &&
+		   vendorID == expected.vendorID && deviceID == expected.deviceID &&
+		   memcmp(data.data() + 16, expected.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+}
+
+VkPipelineCache createPersistentPipelineCache(VkPhysicalDevice	 physicalDevice,
+											  VkDevice			 device,
+											  const std::string& directory,
+											  b8				 loadFromDisk,
+											  PipelineCacheInfo* pInfo)
+{
+	VkPhysicalDeviceProperties properties;
+	vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+
+	char uuid[VK_UUID_SIZE * 2 + 1];
+	for (u32 i = 0; i < VK_UUID_SIZE; ++i)
+	{
+		snprintf(uuid + i * 2, 3, "%02x", properties.pipelineCacheUUID[i]);
+	}
+
+	char fileName[256];
+	snprintf(fileName,
+			 sizeof(fileName),
+			 "pipeline_cache_%04x_%04x_%08x_%s.bin",
+			 properties.vendorID,
+			 properties.deviceID,
+			 properties.driverVersion,
+			 uuid);
+
+	pInfo->filePath		  = directory + "/" + fileName;
+	pInfo->loadedFromDisk = false;
+	pInfo->loadedBytes	  = 0;
+	pInfo->vendorID		  = properties.vendorID;
+	pInfo->deviceID		  = properties.deviceID;
+	pInfo->driverVersion  = properties.driverVersion;
+	memcpy(pInfo->pipelineCacheUUID, properties.pipelineCacheUUID, VK_UUID_SIZE);
+
+	PipelineCacheFileHeader expectedHeader;
+	fillHeader(*pInfo, &expectedHeader);
+
+	std::vector<u8> data;
+	if (loadFromDisk)
+	{
+		std::ifstream file(pInfo->filePath, std::ios::in | std::ios::binary);
+		PipelineCacheFileHeader header;
+
+		if (file.is_open() && file.read((char*)&header, sizeof(header)) && header.dataSize < (1ull << 32))
+		{
+			data.resize(header.dataSize);
+			file.read((char*)data.data(), std::streamsize(data.size()));
+
+			if (!file || !isCacheDataValid(expectedHeader, header, data))
+			{
+				printf("Pipeline cache %s is invalid, starting from an empty cache.\n", pInfo->filePath.c_str());
+				data.clear();
+			}
+		}
+	}
+
+	VkPipelineCacheCreateInfo cacheInfo = {};
+	cacheInfo.sType						= VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+	cacheInfo.initialDataSize			= data.size();
+	cacheInfo.pInitialData				= data.empty() ? nullptr : data.data();
+
+	VkPipelineCache pipelineCache;
+	VK_ASSERT(vkCreatePipelineCache(device, &cacheInfo, nullptr, &pipelineCache));
+
+	pInfo->loadedFromDisk = !data.empty();
+	pInfo->loadedBytes	  = data.size();
+
+	return pipelineCache;
+}
+
+void savePersistentPipelineCache(VkDevice device, VkPipelineCache pipelineCache, const PipelineCacheInfo& info)
+{
+	size_t dataSize = 0;
+	VK_ASSERT(vkGetPipelineCacheData(device, pipelineCache, &dataSize, nullptr));
+
+	std::vector<u8> data(dataSize);
+	VK_ASSERT(vkGetPipelineCacheData(device, pipelineCache, &dataSize, data.data()));
+	data.resize(dataSize);
+
+	PipelineCacheFileHeader header;
+	fillHeader(info, &header);
+	header.dataSize = data.size();
+	header.dataHash = hashBytes(data.data(), data.size());
+
+	std::string temporaryPath = info.filePath + ".tmp";
+	{
+		std::ofstream file(temporaryPath, std::ios::out | std::ios::binary | std::ios::trunc);
+		if (!file.is_open())
+		{
+			printf("Failed to write pipeline cache to %s\n", temporaryPath.c_str());
+			return;
+		}
+
+		file.write((const char*)&header, sizeof(header));
+		file.write((const char*)data.data(), std::streamsize(data.size()));
+		file.flush();
+		if (!file)
+		{
+			printf("Failed to write pipeline cache to %s\n", temporaryPath.c_str());
+			std::remove(temporaryPath.c_str());
+			return;
+		}
+	}
+
+	if (std::rename(temporaryPath.c_str(), info.filePath.c_str()) != 0)
+	{
+		printf("Failed to replace pipeline cache %s\n", info.filePath.c_str());
+		std::remove(temporaryPath.c_str());
+		return;
+	}
+
+	printf("Pipeline cache saved (%zu bytes) to %s\n", data.size(), info.filePath.c_str());
+}
+
+void createGraphicsPipelinesParallel(VkDevice							 device,
+									 VkPipelineCache					 pipelineCache,
+									 const VkGraphicsPipelineCreateInfo* pCreateInfos,
+									 u32								 createInfosCount,
+									 VkPipeline*						 pPipelines,
+									 u32								 threadsCount)
+{
+	if (threadsCount == 0)
+	{
+		threadsCount = std::max(1u, std::thread::hardware_concurrency());
+	}
+	threadsCount = std::min(threadsCount, createInfosCount);
+
+	if (threadsCount <= 1)
+	{
+		VK_ASSERT(vkCreateGraphicsPipelines(device, pipelineCache, createInfosCount, pCreateInfos, nullptr, pPipelines));
+		return;
+	}
+
+	// VkPipelineCache is internally synchronized, every thread can feed the same cache
+	std::vector<std::thread> threads;
+	std::vector<VkResult>	 results(threadsCount, VK_SUCCESS);
+	u32						 batchSize = (createInfosCount + threadsCount - 1) / threadsCount;
+
+	for (u32 threadIndex = 0u; threadIndex < threadsCount; ++threadIndex)
+	{
+		u32 first = threadIndex * batchSize;
+		u32 count = std::min(batchSize, createInfosCount - first);
+
+		threads.emplace_back([=, &results]() {
+			results[threadIndex] =
+				vkCreateGraphicsPipelines(device, pipelineCache, count, pCreateInfos + first, nullptr, pPipelines + first);
+		});
+	}
+
+	for (std::thread& thread : threads)
+	{
+		thread.join();
+	}
+
+	for (VkResult result : results)
+	{
+		VK_ASSERT(result);
+	}
+}
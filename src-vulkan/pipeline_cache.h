@@ -0,0 +1,38 @@
+#pragma once
+
+#include "common.h"
+#include <string>
+
+/**
+ * `VkPipelineCache` persisted between runs. The cache file lives in `directory` and its name is derived from the
+ * vendor ID, device ID, driver version and `pipelineCacheUUID`, so a driver update simply starts a new file. The
+ * content is validated (own header, checksum and the Vulkan cache header) before being handed to the driver, and
+ * written back atomically (temporary file + rename) so a crash never leaves a truncated cache behind.
+ */
+
+struct PipelineCacheInfo
+{
+	std::string filePath;
+	b8			loadedFromDisk;
+	u64			loadedBytes;
+
+	u32 vendorID;
+	u32 deviceID;
+	u32 driverVersion;
+	u8	pipelineCacheUUID[VK_UUID_SIZE];
+};
+
+VkPipelineCache createPersistentPipelineCache(VkPhysicalDevice	 physicalDevice,
+											  VkDevice			 device,
+											  const std::string& directory,
+											  b8				 loadFromDisk,
+											  PipelineCacheInfo* pInfo);
+void			savePersistentPipelineCache(VkDevice device, VkPipelineCache pipelineCache, const PipelineCacheInfo& info);
+
+// Splits the create infos over `threadsCount` threads, each calling vkCreateGraphicsPipelines on the shared cache.
+void createGraphicsPipelinesParallel(VkDevice							  device,
+									 VkPipelineCache					  pipelineCache,
+									 const VkGraphicsPipelineCreateInfo* pCreateInfos,
+									 u32								  createInfosCount,
+									 VkPipeline*						  pPipelines,
+									 u32								  threadsCount = 0);
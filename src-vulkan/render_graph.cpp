@@ -0,0 +1,657 @@
+#include "render_graph.h"
+#include <algorithm>
+
+struct GraphAccessInfo
+{
+	VkPipelineStageFlags stageMask;
+	VkAccessFlags		 accessMask;
+	VkImageLayout		 layout;
+	VkImageUsageFlags	 usage;
+};
+
+struct GraphImageAccess
+{
+	GraphResource resource;
+	GraphAccess	  access;
+	b8			  write;
+};
+
+struct GraphPassNode
+{
+	const char*					  name;
+	GraphPassFunc				  passFunc;
+	void*						  pUserData;
+	std::vector<GraphImageAccess> accesses;
+	b8							  live;
+};
+
+// What the last accesses to some memory left behind, shared by all the images aliasing the same memory
+struct HazardState
+{
+	VkPipelineStageFlags writeStageMask;
+	VkAccessFlags		 writeAccessMask;
+	VkPipelineStageFlags readStageMask;	   // readers since the last write
+	VkPipelineStageFlags visibleStageMask; // stages the last write has been made visible to
+	VkAccessFlags		 visibleAccessMask;
+};
+
+struct GraphResourceNode
+{
+	const char*		  name;
+	b8				  imported;
+	GraphImportInfo	  importInfo;
+	VkFormat		  format;
+	VkExtent2D		  extent;
+	VkImageUsageFlags usage;
+	u32				  firstPass; // live pass indices, ~0u when unused
+	u32				  lastPass;
+	u32				  physicalIndex;
+
+	VkImageLayout layout;
+	HazardState	  importedState;
+};
+
+struct PhysicalImage
+{
+	VkImage				 image;
+	VkImageView			 imageView;
+	VkMemoryRequirements requirements;
+	u32					 slotIndex;
+	u32					 firstPass;
+	u32					 lastPass;
+};
+
+struct MemorySlot
+{
+	MemoryAllocation	 allocation;
+	VkMemoryRequirements requirements;
+	std::vector<u32>	 physicalIndices;
+	HazardState			 state; // carried over from frame to frame, frames in flight share the memory
+};
+
+// One entry per live transient, a compilation with the same signature reuses the physical images
+struct TransientSignature
+{
+	VkFormat		  format;
+	VkExtent2D		  extent;
+	VkImageUsageFlags usage;
+	u32				  firstPass;
+	u32				  lastPass;
+
+	b8 operator==(const TransientSignature& other) const
+	{
+		return format == other.format && extent.width == other.extent.width &&
+			   extent.height == other.extent.height && usage == other.usage && firstPass == other.firstPass &&
+			   lastPass == other.lastPass;
+	}
+};
+
+struct RenderGraph
+{
+	VkDevice		 device;
+	MemoryAllocator* pMemoryAllocator;
+	DeletionQueue*	 pDeletionQueue;
+
+	// Nodes are reused from frame to frame so redeclaring the graph does not allocate
+	std::vector<GraphPassNode>	   passes;
+	u32							   passesCount;
+	std::vector<GraphResourceNode> resources;
+	std::vector<u32>			   livePasses;
+
+	std::vector<PhysicalImage>		physicalImages;
+	std::vector<MemorySlot>			memorySlots;
+	std::vector<TransientSignature> signature;
+	std::vector<TransientSignature> compiledSignature;
+
+	std::vector<VkImageMemoryBarrier> barriers;
+
+	RenderGraphStatistics statistics;
+};
+
+static GraphAccessInfo getAccessInfo(GraphAccess access)
+{
+	switch (access)
+	{
+	case GraphAccess::COLOR_ATTACHMENT_WRITE:
+		return {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+				VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+				VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+				VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT};
+	case GraphAccess::SAMPLED_FRAGMENT:
+		return {VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+				VK_ACCESS_SHADER_READ_BIT,
+				VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+				VK_IMAGE_USAGE_SAMPLED_BIT};
+	case GraphAccess::SAMPLED_COMPUTE:
+		return {VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+				VK_ACCESS_SHADER_READ_BIT,
+				VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+				VK_IMAGE_USAGE_SAMPLED_BIT};
+	case GraphAccess::STORAGE_READ_COMPUTE:
+		return {VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+				VK_ACCESS_SHADER_READ_BIT,
+				VK_IMAGE_LAYOUT_GENERAL,
+				VK_IMAGE_USAGE_STORAGE_BIT};
+	case GraphAccess::STORAGE_WRITE_COMPUTE:
+		return {VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+				VK_ACCESS_SHADER_WRITE_BIT,
+				VK_IMAGE_LAYOUT_GENERAL,
+				VK_IMAGE_USAGE_STORAGE_BIT};
+	case GraphAccess::TRANSFER_READ:
+		return {VK_PIPELINE_STAGE_TRANSFER_BIT,
+				VK_ACCESS_TRANSFER_READ_BIT,
+				VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+				VK_IMAGE_USAGE_TRANSFER_SRC_BIT};
+	case GraphAccess::TRANSFER_WRITE:
+		return {VK_PIPELINE_STAGE_TRANSFER_BIT,
+				VK_ACCESS_TRANSFER_WRITE_BIT,
+				VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+				VK_IMAGE_USAGE_TRANSFER_DST_BIT};
+	}
+
+	ASSERT(false);
+	return {};
+}
+
+static void addAccess(RenderGraph* pGraph, GraphPass pass, GraphResource resource, GraphAccess access, b8 write)
+{
+	ASSERT(pass < pGraph->passesCount && resource < pGraph->resources.size());
+	pGraph->passes[pass].accesses.push_back({resource, access, write});
+}
+
+static void releasePhysicalImages(RenderGraph* pGraph)
+{
+	for (PhysicalImage& physicalImage : pGraph->physicalImages)
+	{
+		deferDestroyImageView(pGraph->pDeletionQueue, physicalImage.imageView);
+		deferDestroyImage(pGraph->pDeletionQueue, physicalImage.image);
+	}
+	for (MemorySlot& slot : pGraph->memorySlots)
+	{
+		deferFreeMemory(pGraph->pDeletionQueue, slot.allocation);
+	}
+
+	pGraph->physicalImages.clear();
+	pGraph->memorySlots.clear();
+	pGraph->compiledSignature.clear();
+}
+
+// Greedy interval packing: biggest images first, each one goes to the first memory slot whose images are all
+// dead while it is alive
+static void createPhysicalImages(RenderGraph* pGraph)
+{
+	std::vector<u32> transients;
+	for (u32 resourceIndex = 0u; resourceIndex < pGraph->resources.size(); ++resourceIndex)
+	{
+		GraphResourceNode& resource = pGraph->resources[resourceIndex];
+		if (resource.imported || resource.firstPass == ~0u)
+		{
+			continue;
+		}
+
+		PhysicalImage physicalImage = {};
+		physicalImage.firstPass		= resource.firstPass;
+		physicalImage.lastPass		= resource.lastPass;
+
+		VkImageCreateInfo imageInfo = {};
+		imageInfo.sType				= VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+		imageInfo.imageType			= VK_IMAGE_TYPE_2D;
+		imageInfo.format			= resource.format;
+		imageInfo.extent			= {resource.extent.width, resource.extent.height, 1};
+		imageInfo.mipLevels			= 1;
+		imageInfo.arrayLayers		= 1;
+		imageInfo.samples			= VK_SAMPLE_COUNT_1_BIT;
+		imageInfo.tiling			= VK_IMAGE_TILING_OPTIMAL;
+		imageInfo.usage				= resource.usage;
+		imageInfo.sharingMode		= VK_SHARING_MODE_EXCLUSIVE;
+		imageInfo.initialLayout		= VK_IMAGE_LAYOUT_UNDEFINED;
+		VK_ASSERT(vkCreateImage(pGraph->device, &imageInfo, nullptr, &physicalImage.image));
+		vkGetImageMemoryRequirements(pGraph->device, physicalImage.image, &physicalImage.requirements);
+
+		resource.physicalIndex = u32(pGraph->physicalImages.size());
+		transients.push_back(resource.physicalIndex);
+		pGraph->physicalImages.push_back(physicalImage);
+	}
+
+	std::sort(transients.begin(), transients.end(), [pGraph](u32 lhs, u32 rhs) {
+		return pGraph->physicalImages[lhs].requirements.size > pGraph->physicalImages[rhs].requirements.size;
+	});
+
+	for (u32 physicalIndex : transients)
+	{
+		PhysicalImage& physicalImage = pGraph->physicalImages[physicalIndex];
+
+		u32 slotIndex = 0u;
+		for (; slotIndex < pGraph->memorySlots.size(); ++slotIndex)
+		{
+			MemorySlot& slot = pGraph->memorySlots[slotIndex];
+			if ((slot.requirements.memoryTypeBits & physicalImage.requirements.memoryTypeBits) == 0)
+			{
+				continue;
+			}
+
+			b8 overlaps = false;
+			for (u32 otherIndex : slot.physicalIndices)
+			{
+				const PhysicalImage& other = pGraph->physicalImages[otherIndex];
+				overlaps |= physicalImage.firstPass <= other.lastPass && other.firstPass <= physicalImage.lastPass;
+			}
+			if (!overlaps)
+			{
+				break;
+			}
+		}
+
+		if (slotIndex == pGraph->memorySlots.size())
+		{
+			MemorySlot slot					  = {};
+			slot.requirements.memoryTypeBits = ~0u;
+			slot.requirements.alignment		  = 1;
+			pGraph->memorySlots.push_back(slot);
+		}
+
+		MemorySlot& slot = pGraph->memorySlots[slotIndex];
+		slot.requirements.size		= std::max(slot.requirements.size, physicalImage.requirements.size);
+		slot.requirements.alignment = std::max(slot.requirements.alignment, physicalImage.requirements.alignment);
+		slot.requirements.memoryTypeBits &= physicalImage.requirements.memoryTypeBits;
+		slot.physicalIndices.push_back(physicalIndex);
+		physicalImage.slotIndex = slotIndex;
+	}
+
+	for (MemorySlot& slot : pGraph->memorySlots)
+	{
+		slot.allocation = allocateMemory(
+			pGraph->pMemoryAllocator, slot.requirements, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, AllocationKind::OPTIMAL);
+	}
+
+	for (GraphResourceNode& resource : pGraph->resources)
+	{
+		if (resource.imported || resource.firstPass == ~0u)
+		{
+			continue;
+		}
+
+		PhysicalImage&	  physicalImage = pGraph->physicalImages[resource.physicalIndex];
+		const MemorySlot& slot			= pGraph->memorySlots[physicalImage.slotIndex];
+		VK_ASSERT(
+			vkBindImageMemory(pGraph->device, physicalImage.image, slot.allocation.memory, slot.allocation.offset));
+
+		VkImageViewCreateInfo viewInfo			 = {};
+		viewInfo.sType							 = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+		viewInfo.image							 = physicalImage.image;
+		viewInfo.viewType						 = VK_IMAGE_VIEW_TYPE_2D;
+		viewInfo.format							 = resource.format;
+		viewInfo.subresourceRange.aspectMask	 = VK_IMAGE_ASPECT_COLOR_BIT;
+		viewInfo.subresourceRange.baseMipLevel	 = 0;
+		viewInfo.subresourceRange.levelCount	 = 1;
+		viewInfo.subresourceRange.baseArrayLayer = 0;
+		viewInfo.subresourceRange.layerCount	 = 1;
+		VK_ASSERT(vkCreateImageView(pGraph->device, &viewInfo, nullptr, &physicalImage.imageView));
+	}
+}
+
+RenderGraph* createRenderGraph(const RenderGraphCreateInfo& createInfo)
+{
+	RenderGraph* pGraph		 = new RenderGraph();
+	pGraph->device			 = createInfo.device;
+	pGraph->pMemoryAllocator = createInfo.pMemoryAllocator;
+	pGraph->pDeletionQueue	 = createInfo.pDeletionQueue;
+
+	return pGraph;
+}
+
+void destroyRenderGraph(RenderGraph* pGraph)
+{
+	releasePhysicalImages(pGraph);
+	delete pGraph;
+}
+
+void beginRenderGraph(RenderGraph* pGraph)
+{
+	pGraph->passesCount = 0;
+	pGraph->resources.clear();
+}
+
+GraphResource importGraphImage(RenderGraph* pGraph, const char* name, const GraphImportInfo& importInfo)
+{
+	GraphResourceNode resource = {};
+	resource.name			   = name;
+	resource.imported		   = true;
+	resource.importInfo		   = importInfo;
+	resource.format			   = importInfo.format;
+	resource.extent			   = importInfo.extent;
+	pGraph->resources.push_back(resource);
+
+	return GraphResource(pGraph->resources.size() - 1);
+}
+
+GraphResource createTransientImage(RenderGraph* pGraph, const char* name, VkFormat format, VkExtent2D extent)
+{
+	GraphResourceNode resource = {};
+	resource.name			   = name;
+	resource.format			   = format;
+	resource.extent			   = extent;
+	pGraph->resources.push_back(resource);
+
+	return GraphResource(pGraph->resources.size() - 1);
+}
+
+GraphPass addGraphPass(RenderGraph* pGraph, const char* name, GraphPassFunc passFunc, void* pUserData)
+{
+	if (pGraph->passesCount == pGraph->passes.size())
+	{
+		pGraph->passes.emplace_back();
+	}
+
+	GraphPassNode& pass = pGraph->passes[pGraph->passesCount];
+	pass.name			= name;
+	pass.passFunc		= passFunc;
+	pass.pUserData		= pUserData;
+	pass.live			= false;
+	pass.accesses.clear();
+
+	return pGraph->passesCount++;
+}
+
+void readGraphImage(RenderGraph* pGraph, GraphPass pass, GraphResource resource, GraphAccess access)
+{
+	addAccess(pGraph, pass, resource, access, false);
+}
+
+void writeGraphImage(RenderGraph* pGraph, GraphPass pass, GraphResource resource, GraphAccess access)
+{
+	addAccess(pGraph, pass, resource, access, true);
+}
+
+b8 compileRenderGraph(RenderGraph* pGraph)
+{
+	RenderGraphStatistics& statistics = pGraph->statistics;
+	statistics						  = {};
+	statistics.passesCount			  = pGraph->passesCount;
+
+	// Walk backwards from the outputs: a pass lives if something alive (or an imported image) needs what it writes
+	std::vector<b8> neededResources(pGraph->resources.size(), false);
+	for (u32 passIndex = pGraph->passesCount; passIndex-- > 0;)
+	{
+		GraphPassNode& pass = pGraph->passes[passIndex];
+		for (const GraphImageAccess& access : pass.accesses)
+		{
+			pass.live |= access.write && (neededResources[access.resource] || pGraph->resources[access.resource].imported);
+		}
+
+		if (!pass.live)
+		{
+			statistics.culledPassesCount++;
+			continue;
+		}
+
+		for (const GraphImageAccess& access : pass.accesses)
+		{
+			neededResources[access.resource] = neededResources[access.resource] || !access.write;
+		}
+	}
+
+	pGraph->livePasses.clear();
+	for (GraphResourceNode& resource : pGraph->resources)
+	{
+		resource.firstPass = ~0u;
+		resource.lastPass  = ~0u;
+	}
+
+	for (u32 passIndex = 0u; passIndex < pGraph->passesCount; ++passIndex)
+	{
+		GraphPassNode& pass = pGraph->passes[passIndex];
+		if (!pass.live)
+		{
+			continue;
+		}
+
+		u32 liveIndex = u32(pGraph->livePasses.size());
+		pGraph->livePasses.push_back(passIndex);
+
+		for (const GraphImageAccess& access : pass.accesses)
+		{
+			GraphResourceNode& resource = pGraph->resources[access.resource];
+			if (resource.firstPass == ~0u)
+			{
+				// Transient content is undefined until written
+				ASSERT(resource.imported || access.write);
+				resource.firstPass = liveIndex;
+			}
+			resource.lastPass = liveIndex;
+			resource.usage |= getAccessInfo(access.access).usage;
+			statistics.accessesCount++;
+		}
+	}
+
+	pGraph->signature.clear();
+	for (const GraphResourceNode& resource : pGraph->resources)
+	{
+		if (!resource.imported && resource.firstPass != ~0u)
+		{
+			pGraph->signature.push_back(
+				{resource.format, resource.extent, resource.usage, resource.firstPass, resource.lastPass});
+		}
+		statistics.accessesCount += resource.imported && resource.importInfo.finalLayout != VK_IMAGE_LAYOUT_UNDEFINED;
+	}
+
+	b8 recreated = pGraph->signature != pGraph->compiledSignature;
+	if (recreated)
+	{
+		releasePhysicalImages(pGraph);
+		createPhysicalImages(pGraph);
+		pGraph->compiledSignature = pGraph->signature;
+	}
+	else
+	{
+		// Same layout, the resources map to the same physical images in the same order
+		u32 physicalIndex = 0u;
+		for (GraphResourceNode& resource : pGraph->resources)
+		{
+			if (!resource.imported && resource.firstPass != ~0u)
+			{
+				resource.physicalIndex = physicalIndex++;
+			}
+		}
+	}
+
+	for (const PhysicalImage& physicalImage : pGraph->physicalImages)
+	{
+		statistics.transientImagesCount++;
+		statistics.transientBytes += physicalImage.requirements.size;
+	}
+	for (const MemorySlot& slot : pGraph->memorySlots)
+	{
+		statistics.allocatedBytes += slot.requirements.size;
+	}
+
+	return recreated;
+}
+
+static HazardState& getHazardState(RenderGraph* pGraph, GraphResourceNode& resource)
+{
+	if (resource.imported)
+	{
+		return resource.importedState;
+	}
+	return pGraph->memorySlots[pGraph->physicalImages[resource.physicalIndex].slotIndex].state;
+}
+
+static void pushBarrier(RenderGraph*		 pGraph,
+						GraphResourceNode&	 resource,
+						VkAccessFlags		 srcAccessMask,
+						VkAccessFlags		 dstAccessMask,
+						VkImageLayout		 newLayout)
+{
+	VkImageMemoryBarrier barrier			= {};
+	barrier.sType							= VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+	barrier.srcAccessMask					= srcAccessMask;
+	barrier.dstAccessMask					= dstAccessMask;
+	barrier.oldLayout						= resource.layout;
+	barrier.newLayout						= newLayout;
+	barrier.srcQueueFamilyIndex				= VK_QUEUE_FAMILY_IGNORED;
+	barrier.dstQueueFamilyIndex				= VK_QUEUE_FAMILY_IGNORED;
+	barrier.image							= resource.imported ? resource.importInfo.image
+																: pGraph->physicalImages[resource.physicalIndex].image;
+	barrier.subresourceRange.aspectMask		= VK_IMAGE_ASPECT_COLOR_BIT;
+	barrier.subresourceRange.baseMipLevel	= 0;
+	barrier.subresourceRange.levelCount		= 1;
+	barrier.subresourceRange.baseArrayLayer = 0;
+	barrier.subresourceRange.layerCount		= 1;
+	pGraph->barriers.push_back(barrier);
+
+	resource.layout = newLayout;
+}
+
+static void flushBarriers(RenderGraph*		   pGraph,
+						  VkCommandBuffer	   commandBuffer,
+						  VkPipelineStageFlags srcStageMask,
+						  VkPipelineStageFlags dstStageMask)
+{
+	if (pGraph->barriers.empty())
+	{
+		return;
+	}
+
+	vkCmdPipelineBarrier(commandBuffer,
+						 srcStageMask != 0 ? srcStageMask : VkPipelineStageFlags(VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT),
+						 dstStageMask,
+						 0,
+						 0,
+						 nullptr,
+						 0,
+						 nullptr,
+						 u32(pGraph->barriers.size()),
+						 pGraph->barriers.data());
+
+	pGraph->statistics.barriersCount += u32(pGraph->barriers.size());
+	pGraph->statistics.barrierBatchesCount++;
+	pGraph->barriers.clear();
+}
+
+void executeRenderGraph(RenderGraph* pGraph, VkCommandBuffer commandBuffer)
+{
+	pGraph->statistics.barriersCount	   = 0;
+	pGraph->statistics.barrierBatchesCount = 0;
+
+	// Transients start undefined, their first use discards whatever the memory held before
+	for (GraphResourceNode& resource : pGraph->resources)
+	{
+		if (resource.imported)
+		{
+			resource.layout						   = resource.importInfo.initialLayout;
+			resource.importedState				   = {};
+			resource.importedState.writeStageMask = resource.importInfo.initialStageMask;
+		}
+		else
+		{
+			resource.layout = VK_IMAGE_LAYOUT_UNDEFINED;
+		}
+	}
+
+	for (u32 passIndex : pGraph->livePasses)
+	{
+		GraphPassNode&		 pass		  = pGraph->passes[passIndex];
+		VkPipelineStageFlags srcStageMask = 0;
+		VkPipelineStageFlags dstStageMask = 0;
+
+		for (const GraphImageAccess& access : pass.accesses)
+		{
+			GraphResourceNode& resource	  = pGraph->resources[access.resource];
+			HazardState&	   state	  = getHazardState(pGraph, resource);
+			GraphAccessInfo	   accessInfo = getAccessInfo(access.access);
+
+			if (access.write || resource.layout != accessInfo.layout)
+			{
+				// Write after read/write, or layout transition (which is a write as well)
+				srcStageMask |= state.writeStageMask | state.readStageMask;
+				dstStageMask |= accessInfo.stageMask;
+				pushBarrier(pGraph, resource, state.writeAccessMask, accessInfo.accessMask, accessInfo.layout);
+
+				state.writeStageMask	= accessInfo.stageMask;
+				state.writeAccessMask	= access.write ? accessInfo.accessMask : 0;
+				state.readStageMask		= access.write ? 0 : accessInfo.stageMask;
+				state.visibleStageMask	= access.write ? 0 : accessInfo.stageMask;
+				state.visibleAccessMask = access.write ? 0 : accessInfo.accessMask;
+			}
+			else
+			{
+				// Read after write: only needed once per reading stage, reads after reads need nothing. A layout
+				// transition done by an earlier read leaves no write access behind, the reads at other stages still
+				// have to wait for it
+				b8 visible = (accessInfo.stageMask & ~state.visibleStageMask) == 0 &&
+							 (accessInfo.accessMask & ~state.visibleAccessMask) == 0;
+				if (!visible)
+				{
+					srcStageMask |= state.writeStageMask;
+					dstStageMask |= accessInfo.stageMask;
+					pushBarrier(pGraph, resource, state.writeAccessMask, accessInfo.accessMask, accessInfo.layout);
+				}
+
+				state.readStageMask |= accessInfo.stageMask;
+				state.visibleStageMask |= accessInfo.stageMask;
+				state.visibleAccessMask |= accessInfo.accessMask;
+			}
+		}
+
+		flushBarriers(pGraph, commandBuffer, srcStageMask, dstStageMask);
+		pass.passFunc(commandBuffer, pGraph, pass.pUserData);
+	}
+
+	VkPipelineStageFlags srcStageMask = 0;
+	for (GraphResourceNode& resource : pGraph->resources)
+	{
+		if (resource.imported && resource.importInfo.finalLayout != VK_IMAGE_LAYOUT_UNDEFINED &&
+			resource.importInfo.finalLayout != resource.layout)
+		{
+			srcStageMask |= resource.importedState.writeStageMask | resource.importedState.readStageMask;
+			pushBarrier(pGraph, resource, resource.importedState.writeAccessMask, 0, resource.importInfo.finalLayout);
+		}
+	}
+	flushBarriers(pGraph, commandBuffer, srcStageMask, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT);
+}
+
+VkImage getGraphImage(RenderGraph* pGraph, GraphResource resource)
+{
+	const GraphResourceNode& node = pGraph->resources[resource];
+	return node.imported ? node.importInfo.image : pGraph->physicalImages[node.physicalIndex].image;
+}
+
+VkImageView getGraphImageView(RenderGraph* pGraph, GraphResource resource)
+{
+	const GraphResourceNode& node = pGraph->resources[resource];
+	return node.imported ? node.importInfo.imageView : pGraph->physicalImages[node.physicalIndex].imageView;
+}
+
+VkExtent2D getGraphImageExtent(RenderGraph* pGraph, GraphResource resource)
+{
+	return pGraph->resources[resource].extent;
+}
+
+RenderGraphStatistics getRenderGraphStatistics(RenderGraph* pGraph)
+{
+	return pGraph->statistics;
+}
+
+void printRenderGraphStatistics(RenderGraph* pGraph)
+{
+	const RenderGraphStatistics& statistics = pGraph->statistics;
+
+	printf("Render graph: %u passes (%u culled), %u barriers in %u batches (%u with a barrier per access), "
+		   "%u transient images: %.2f MB aliased into %.2f MB (%.2f MB saved)\n",
+		   statistics.passesCount - statistics.culledPassesCount,
+		   statistics.culledPassesCount,
+		   statistics.barriersCount,
+		   statistics.barrierBatchesCount,
+		   statistics.accessesCount,
+		   statistics.transientImagesCount,
+		   f64(statistics.transientBytes) / (1024.0 * 1024.0),
+		   f64(statistics.allocatedBytes) / (1024.0 * 1024.0),
+		   f64(statistics.transientBytes - statistics.allocatedBytes) / (1024.0 * 1024.0));
+
+	for (u32 passIndex = 0u; passIndex < pGraph->passesCount; ++passIndex)
+	{
+		const GraphPassNode& pass = pGraph->passes[passIndex];
+		printf(" %s%s\n", pass.name, pass.live ? "" : " (culled)");
+	}
+}
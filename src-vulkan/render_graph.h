@@ -0,0 +1,107 @@
+#pragma once
+
+#include "common.h"
+#include "deletion_queue.h"
+#include "memory_allocator.h"
+
+/**
+ * Frame graph over images. Every frame the passes are declared again together with the images they read and
+ * write, then the graph is compiled and executed:
+ *  - passes whose results never reach an imported image are culled,
+ *  - layout transitions and pipeline barriers are derived from the declared accesses, a barrier is only emitted
+ *    for a hazard (read after read in the same layout needs none) and all barriers in front of a pass are batched,
+ *  - transient images only live between their first and last use, images whose lifetimes do not overlap are bound
+ *    to the same memory. Usage flags of transient images are derived from their accesses.
+ * Physical images are kept from frame to frame for as long as the compiled layout does not change, otherwise they
+ * are handed to the deletion queue. Transient images start every frame with undefined content.
+ *
+ * @example
+ * ```c++
+ * beginRenderGraph(pGraph);
+ * GraphResource backbuffer = importGraphImage(pGraph, "backbuffer", backbufferInfo);
+ * GraphResource color		= createTransientImage(pGraph, "color", format, extent);
+ *
+ * GraphPass scene = addGraphPass(pGraph, "scene", recordScene, pScene);
+ * writeGraphImage(pGraph, scene, color, GraphAccess::COLOR_ATTACHMENT_WRITE);
+ *
+ * GraphPass blit = addGraphPass(pGraph, "blit", recordBlit, pScene);
+ * readGraphImage(pGraph, blit, color, GraphAccess::TRANSFER_READ);
+ * writeGraphImage(pGraph, blit, backbuffer, GraphAccess::TRANSFER_WRITE);
+ *
+ * compileRenderGraph(pGraph);
+ * executeRenderGraph(pGraph, commandBuffer);
+ * ```
+ */
+
+struct RenderGraph;
+
+typedef u32 GraphResource;
+typedef u32 GraphPass;
+
+#define GRAPH_INVALID_RESOURCE (~0u)
+
+enum class GraphAccess
+{
+	COLOR_ATTACHMENT_WRITE,
+	SAMPLED_FRAGMENT,
+	SAMPLED_COMPUTE,
+	STORAGE_READ_COMPUTE,
+	STORAGE_WRITE_COMPUTE,
+	TRANSFER_READ,
+	TRANSFER_WRITE,
+};
+
+typedef void (*GraphPassFunc)(VkCommandBuffer commandBuffer, RenderGraph* pGraph, void* pUserData);
+
+struct RenderGraphCreateInfo
+{
+	VkDevice		 device;
+	MemoryAllocator* pMemoryAllocator;
+	DeletionQueue*	 pDeletionQueue; // receives physical images replaced by a recompilation
+};
+
+// Image owned outside of the graph, the passes writing to it are the outputs of the graph
+struct GraphImportInfo
+{
+	VkImage				 image;
+	VkImageView			 imageView;
+	VkFormat			 format;
+	VkExtent2D			 extent;
+	VkImageLayout		 initialLayout;
+	VkPipelineStageFlags initialStageMask; // stages to wait for before the first access (e.g. a semaphore wait)
+	VkImageLayout		 finalLayout;
+};
+
+struct RenderGraphStatistics
+{
+	u32			 passesCount;
+	u32			 culledPassesCount;
+	u32			 barriersCount;		 // image barriers emitted
+	u32			 barrierBatchesCount; // vkCmdPipelineBarrier calls
+	u32			 accessesCount;		 // barriers a naive barrier-per-access scheme would emit
+	u32			 transientImagesCount;
+	VkDeviceSize transientBytes; // sum of the transient images sizes
+	VkDeviceSize allocatedBytes; // memory actually bound to them
+};
+
+RenderGraph* createRenderGraph(const RenderGraphCreateInfo& createInfo);
+void		 destroyRenderGraph(RenderGraph* pGraph);
+
+void		  beginRenderGraph(RenderGraph* pGraph);
+GraphResource importGraphImage(RenderGraph* pGraph, const char* name, const GraphImportInfo& importInfo);
+GraphResource createTransientImage(RenderGraph* pGraph, const char* name, VkFormat format, VkExtent2D extent);
+
+GraphPass addGraphPass(RenderGraph* pGraph, const char* name, GraphPassFunc passFunc, void* pUserData);
+void	  readGraphImage(RenderGraph* pGraph, GraphPass pass, GraphResource resource, GraphAccess access);
+void	  writeGraphImage(RenderGraph* pGraph, GraphPass pass, GraphResource resource, GraphAccess access);
+
+// Returns true when the physical images had to be (re)created
+b8	 compileRenderGraph(RenderGraph* pGraph);
+void executeRenderGraph(RenderGraph* pGraph, VkCommandBuffer commandBuffer);
+
+VkImage		getGraphImage(RenderGraph* pGraph, GraphResource resource);
+VkImageView getGraphImageView(RenderGraph* pGraph, GraphResource resource);
+VkExtent2D	getGraphImageExtent(RenderGraph* pGraph, GraphResource resource);
+
+RenderGraphStatistics getRenderGraphStatistics(RenderGraph* pGraph);
+void				  printRenderGraphStatistics(RenderGraph* pGraph);
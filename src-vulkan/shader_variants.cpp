@@ -0,0 +1,141 @@
+#include "shader_variants.h"
+#include <fstream>
+#include <map>
+
+struct ShaderSpecialization
+{
+	std::vector<VkSpecializationMapEntry> entries;
+	std::vector<VkBool32>				  values;
+	VkSpecializationInfo				  info;
+};
+
+struct ShaderVariantCache
+{
+	VkDevice	device;
+	std::string directory;
+
+	std::map<std::string, VkShaderModule> modules;		   // keyed by the variant file name
+	std::map<u64, ShaderSpecialization>	  specializations; // keyed by declared features << 32 | enabled features
+
+	u32 lookupsCount;
+};
+
+static VkShaderModule loadShaderModule(VkDevice device, const std::string& path)
+{
+	std::ifstream file(path, std::ios::in | std::ios::binary | std::ios::ate);
+	if (!file.is_open())
+	{
+		fprintf(stderr, "Shader variant not found: %s\n", path.c_str());
+		ASSERT(false);
+	}
+
+	std::vector<u32> code(size_t(file.tellg()) / sizeof(u32));
+	file.seekg(0);
+	file.read((char*)code.data(), std::streamsize(code.size() * sizeof(u32)));
+
+	VkShaderModuleCreateInfo moduleInfo = {};
+	moduleInfo.sType					= VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+	moduleInfo.codeSize					= code.size() * sizeof(u32);
+	moduleInfo.pCode					= code.data();
+
+	VkShaderModule shaderModule;
+	VK_ASSERT(vkCreateShaderModule(device, &moduleInfo, nullptr, &shaderModule));
+	return shaderModule;
+}
+
+static const VkSpecializationInfo* getSpecialization(ShaderVariantCache* pCache, u32 declared, u32 enabled)
+{
+	if (declared == 0)
+	{
+		return nullptr;
+	}
+
+	u64					  key			 = (u64(declared) << 32) | enabled;
+	ShaderSpecialization& specialization = pCache->specializations[key];
+	if (specialization.entries.empty())
+	{
+		// Every declared constant is given explicitly, so the shader defaults never matter
+		for (u32 bit = 0u; bit < 32u; ++bit)
+		{
+			if ((declared & (1u << bit)) == 0)
+			{
+				continue;
+			}
+
+			VkSpecializationMapEntry entry = {};
+			entry.constantID			   = bit;
+			entry.offset				   = u32(specialization.values.size() * sizeof(VkBool32));
+			entry.size					   = sizeof(VkBool32);
+			specialization.entries.push_back(entry);
+			specialization.values.push_back((enabled & (1u << bit)) != 0 ? VK_TRUE : VK_FALSE);
+		}
+
+		specialization.info.mapEntryCount = u32(specialization.entries.size());
+		specialization.info.pMapEntries	  = specialization.entries.data();
+		specialization.info.dataSize	  = specialization.values.size() * sizeof(VkBool32);
+		specialization.info.pData		  = specialization.values.data();
+	}
+
+	return &specialization.info;
+}
+
+ShaderVariantCache* createShaderVariantCache(const ShaderVariantCacheCreateInfo& createInfo)
+{
+	ShaderVariantCache* pCache = new ShaderVariantCache();
+	pCache->device			   = createInfo.device;
+	pCache->directory		   = createInfo.directory;
+
+	return pCache;
+}
+
+void destroyShaderVariantCache(ShaderVariantCache* pCache)
+{
+	for (const auto& [fileName, shaderModule] : pCache->modules)
+	{
+		vkDestroyShaderModule(pCache->device, shaderModule, nullptr);
+	}
+
+	delete pCache;
+}
+
+u32 getDeclaredShaderFeatures(const ShaderPermutations& permutations)
+{
+	return permutations.preprocessorFeatures | permutations.specializationFeatures;
+}
+
+VkPipelineShaderStageCreateInfo getShaderVariantStage(ShaderVariantCache*		pCache,
+													  const ShaderPermutations& permutations,
+													  u32						features)
+{
+	// The build enumerates the preprocessor combinations as plain integers, their bits have to come first
+	ASSERT((permutations.preprocessorFeatures & (permutations.preprocessorFeatures + 1)) == 0);
+	ASSERT((permutations.preprocessorFeatures & permutations.specializationFeatures) == 0);
+
+	u32			preprocessorMask = features & permutations.preprocessorFeatures;
+	std::string fileName		 = std::string(permutations.name) + "." + std::to_string(preprocessorMask) + ".spv";
+
+	VkShaderModule& shaderModule = pCache->modules[fileName];
+	if (shaderModule == VK_NULL_HANDLE)
+	{
+		shaderModule = loadShaderModule(pCache->device, pCache->directory + "/" + fileName);
+	}
+	pCache->lookupsCount++;
+
+	VkPipelineShaderStageCreateInfo stage = {};
+	stage.sType							  = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+	stage.stage							  = permutations.stage;
+	stage.module						  = shaderModule;
+	stage.pName							  = "main";
+	stage.pSpecializationInfo			  = getSpecialization(
+		 pCache, permutations.specializationFeatures, features & permutations.specializationFeatures);
+
+	return stage;
+}
+
+void printShaderVariantStatistics(ShaderVariantCache* pCache)
+{
+	printf("Shader variants: %u stages from %u modules and %u specializations\n",
+		   pCache->lookupsCount,
+		   u32(pCache->modules.size()),
+		   u32(pCache->specializations.size()));
+}
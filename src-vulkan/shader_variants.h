@@ -0,0 +1,54 @@
+#pragma once
+
+#include "common.h"
+#include <string>
+
+/**
+ * Shader permutations declared per shader as a set of feature bits:
+ *  - preprocessor features change the shader interface (inputs, resources), every combination is compiled at build
+ *    time by `ntt_vulkan_compile_variants` into `<name>.<mask>.spv`, bit i being the i-th define given to the macro,
+ *  - specialization features only select code paths, they are boolean specialization constants whose `constant_id`
+ *    is the feature bit index, so one SPIR-V file serves all of their combinations and the driver folds the branches.
+ * A variant is looked up by the bitmask of the features it enables, bits the shader does not declare are ignored.
+ * Modules and specialization data are loaded once and live as long as the cache.
+ *
+ * @example
+ * ```c++
+ * const ShaderPermutations fragmentPermutations = {"bindless.frag", VK_SHADER_STAGE_FRAGMENT_BIT, WIREFRAME, TINT};
+ *
+ * ShaderVariantCache* pCache = createShaderVariantCache({device, STRINGIFY(BUILD_DIR) "/shaders"});
+ * stages[1] = getShaderVariantStage(pCache, fragmentPermutations, WIREFRAME | TINT);
+ * vkCreateGraphicsPipelines(...);
+ * destroyShaderVariantCache(pCache);
+ * ```
+ */
+
+struct ShaderVariantCache;
+
+struct ShaderVariantCacheCreateInfo
+{
+	VkDevice	device;
+	std::string directory; // output directory of ntt_vulkan_compile_variants
+};
+
+struct ShaderPermutations
+{
+	const char*			  name; // source file name, e.g. "simple.frag"
+	VkShaderStageFlagBits stage;
+	u32					  preprocessorFeatures;	  // low bits, in the order of the defines given to the macro
+	u32					  specializationFeatures; // constant_id = feature bit index
+};
+
+ShaderVariantCache* createShaderVariantCache(const ShaderVariantCacheCreateInfo& createInfo);
+// Destroys the cached modules, the pipelines created from them are not affected
+void destroyShaderVariantCache(ShaderVariantCache* pCache);
+
+// Features the shader declares, the variants of `permutations` are indexed by subsets of this mask
+u32 getDeclaredShaderFeatures(const ShaderPermutations& permutations);
+
+// Stage of the variant enabling `features`, valid until the cache is destroyed
+VkPipelineShaderStageCreateInfo getShaderVariantStage(ShaderVariantCache*		pCache,
+													  const ShaderPermutations& permutations,
+													  u32						features);
+
+void printShaderVariantStatistics(ShaderVariantCache* pCache);
@@ -0,0 +1,532 @@
+#include "upload_service.h"
+#include <algorithm>
+#include <cstring>
+#include <deque>
+#include <mutex>
+
+struct UploadBatch
+{
+	VkCommandBuffer commandBuffer;
+	uint64_t		timelineValue;
+	VkDeviceSize	ringEnd; // ring head once this batch has been recorded, released when the batch completes
+	b8				acquired;
+
+	std::vector<VkBufferMemoryBarrier> bufferBarriers;
+	std::vector<VkImageMemoryBarrier>  imageBarriers;
+	VkPipelineStageFlags			   dstStageMask;
+};
+
+struct UploadService
+{
+	VkDevice		 device;
+	MemoryAllocator* pAllocator;
+	VkQueue			 transferQueue;
+	u32				 transferFamilyIndex;
+	u32				 graphicsFamilyIndex;
+
+	VkCommandPool commandPool;
+	VkSemaphore	  timeline;
+	u64			  nextTimelineValue;
+	u64			  graphicsWaitedValue;
+
+	AllocatedBuffer stagingRing;
+	u8*				pStagingData;
+	VkDeviceSize	ringSize;
+	VkDeviceSize	ringHead;
+	VkDeviceSize	ringTail;
+
+	UploadBatch*			  pRecording;
+	std::deque<UploadBatch*>  inFlight;
+	std::vector<UploadBatch*> freeBatches;
+
+	UploadStatistics statistics;
+
+	std::mutex mutex;
+};
+
+static inline VkDeviceSize alignUp(VkDeviceSize value, VkDeviceSize alignment)
+{
+	return (value + alignment - 1) & ~(alignment - 1);
+}
+
+static inline b8 needsOwnershipTransfer(const UploadService& service)
+{
+	return service.transferFamilyIndex != service.graphicsFamilyIndex;
+}
+
+static u64 getCompletedValue(UploadService& service)
+{
+	uint64_t completedValue = 0;
+	VK_ASSERT(vkGetSemaphoreCounterValue(service.device, service.timeline, &completedValue));
+	return completedValue;
+}
+
+static void reclaimBatches(UploadService& service)
+{
+	u64 completedValue = getCompletedValue(service);
+
+	// Batches complete in submission order, so the ring tail follows the newest completed batch
+	for (UploadBatch* pBatch : service.inFlight)
+	{
+		if (pBatch->timelineValue > completedValue)
+		{
+			break;
+		}
+		service.ringTail = pBatch->ringEnd;
+	}
+
+	// A batch is only recycled once the graphics queue has taken its acquire barriers
+	while (!service.inFlight.empty())
+	{
+		UploadBatch* pBatch = service.inFlight.front();
+		if (pBatch->timelineValue > completedValue || !pBatch->acquired)
+		{
+			break;
+		}
+
+		service.inFlight.pop_front();
+		service.freeBatches.push_back(pBatch);
+	}
+
+	if (service.ringHead == service.ringTail)
+	{
+		service.ringHead = 0;
+		service.ringTail = 0;
+	}
+}
+
+static UploadBatch* getRecordingBatch(UploadService& service)
+{
+	if (service.pRecording != nullptr)
+	{
+		return service.pRecording;
+	}
+
+	UploadBatch* pBatch = nullptr;
+	if (!service.freeBatches.empty())
+	{
+		pBatch = service.freeBatches.back();
+		service.freeBatches.pop_back();
+		VK_ASSERT(vkResetCommandBuffer(pBatch->commandBuffer, 0));
+	}
+	else
+	{
+		pBatch = new UploadBatch();
+
+		VkCommandBufferAllocateInfo allocInfo = {};
+		allocInfo.sType						  = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+		allocInfo.commandPool				  = service.commandPool;
+		allocInfo.level						  = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+		allocInfo.commandBufferCount		  = 1;
+		VK_ASSERT(vkAllocateCommandBuffers(service.device, &allocInfo, &pBatch->commandBuffer));
+	}
+
+	pBatch->timelineValue = 0;
+	pBatch->acquired	  = !needsOwnershipTransfer(service);
+	pBatch->dstStageMask  = 0;
+	pBatch->bufferBarriers.clear();
+	pBatch->imageBarriers.clear();
+
+	VkCommandBufferBeginInfo beginInfo = {};
+	beginInfo.sType					   = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+	beginInfo.flags					   = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+	VK_ASSERT(vkBeginCommandBuffer(pBatch->commandBuffer, &beginInfo));
+
+	service.pRecording = pBatch;
+	return pBatch;
+}
+
+static u64 submitRecordingBatch(UploadService& service)
+{
+	UploadBatch* pBatch = service.pRecording;
+	if (pBatch == nullptr)
+	{
+		return service.nextTimelineValue - 1;
+	}
+
+	VK_ASSERT(vkEndCommandBuffer(pBatch->commandBuffer));
+
+	pBatch->timelineValue = service.nextTimelineValue++;
+	pBatch->ringEnd		  = service.ringHead;
+
+	VkTimelineSemaphoreSubmitInfo timelineInfo = {};
+	timelineInfo.sType						   = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+	timelineInfo.signalSemaphoreValueCount	   = 1;
+	timelineInfo.pSignalSemaphoreValues		   = &pBatch->timelineValue;
+
+	VkSubmitInfo submitInfo			= {};
+	submitInfo.sType				= VK_STRUCTURE_TYPE_SUBMIT_INFO;
+	submitInfo.pNext				= &timelineInfo;
+	submitInfo.commandBufferCount	= 1;
+	submitInfo.pCommandBuffers		= &pBatch->commandBuffer;
+	submitInfo.signalSemaphoreCount = 1;
+	submitInfo.pSignalSemaphores	= &service.timeline;
+	VK_ASSERT(vkQueueSubmit(service.transferQueue, 1, &submitInfo, VK_NULL_HANDLE));
+
+	service.inFlight.push_back(pBatch);
+	service.pRecording = nullptr;
+	service.statistics.batchesSubmitted++;
+
+	return pBatch->timelineValue;
+}
+
+static void waitForTimeline(UploadService& service, uint64_t value)
+{
+	VkSemaphoreWaitInfo waitInfo = {};
+	waitInfo.sType				 = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+	waitInfo.semaphoreCount		 = 1;
+	waitInfo.pSemaphores		 = &service.timeline;
+	waitInfo.pValues			 = &value;
+	VK_ASSERT(vkWaitSemaphores(service.device, &waitInfo, UINT64_MAX));
+}
+
+// Reserves `size` bytes of the staging ring, submitting and waiting for older batches when it is full.
+static VkDeviceSize allocateStaging(UploadService& service, VkDeviceSize size, VkDeviceSize alignment)
+{
+	ASSERT(size < service.ringSize);
+
+	for (;;)
+	{
+		reclaimBatches(service);
+
+		// head == tail means the ring is empty, the wrapped case never lets head catch up with tail
+		VkDeviceSize offset = alignUp(service.ringHead, alignment);
+		if (service.ringHead >= service.ringTail)
+		{
+			if (offset + size <= service.ringSize)
+			{
+				service.ringHead = offset + size;
+				return offset;
+			}
+
+			if (size < service.ringTail)
+			{
+				service.ringHead = size;
+				return 0;
+			}
+		}
+		else if (offset + size < service.ringTail)
+		{
+			service.ringHead = offset + size;
+			return offset;
+		}
+
+		// No room left: push the pending copies out and wait for the oldest unfinished batch
+		submitRecordingBatch(service);
+		service.statistics.ringStalls++;
+
+		u64 completedValue = getCompletedValue(service);
+		for (UploadBatch* pBatch : service.inFlight)
+		{
+			if (pBatch->timelineValue > completedValue)
+			{
+				waitForTimeline(service, pBatch->timelineValue);
+				break;
+			}
+		}
+	}
+}
+
+UploadService* createUploadService(const UploadServiceCreateInfo& createInfo)
+{
+	UploadService* pService		  = new UploadService();
+	pService->device			  = createInfo.device;
+	pService->pAllocator		  = createInfo.pAllocator;
+	pService->transferQueue		  = createInfo.transferQueue;
+	pService->transferFamilyIndex = createInfo.transferFamilyIndex;
+	pService->graphicsFamilyIndex = createInfo.graphicsFamilyIndex;
+	pService->ringSize			  = createInfo.stagingRingSize;
+	pService->nextTimelineValue	  = 1;
+	pService->graphicsWaitedValue = 0;
+	pService->pRecording		  = nullptr;
+
+	VkCommandPoolCreateInfo poolInfo = {};
+	poolInfo.sType					 = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+	poolInfo.queueFamilyIndex		 = createInfo.transferFamilyIndex;
+	poolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT | VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+	VK_ASSERT(vkCreateCommandPool(pService->device, &poolInfo, nullptr, &pService->commandPool));
+
+	VkSemaphoreTypeCreateInfo semaphoreTypeInfo = {};
+	semaphoreTypeInfo.sType						= VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+	semaphoreTypeInfo.semaphoreType				= VK_SEMAPHORE_TYPE_TIMELINE;
+	semaphoreTypeInfo.initialValue				= 0;
+
+	VkSemaphoreCreateInfo semaphoreInfo = {};
+	semaphoreInfo.sType					= VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+	semaphoreInfo.pNext					= &semaphoreTypeInfo;
+	VK_ASSERT(vkCreateSemaphore(pService->device, &semaphoreInfo, nullptr, &pService->timeline));
+
+	VkBufferCreateInfo bufferInfo = {};
+	bufferInfo.sType			  = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+	bufferInfo.size				  = createInfo.stagingRingSize;
+	bufferInfo.usage			  = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+	bufferInfo.sharingMode		  = VK_SHARING_MODE_EXCLUSIVE;
+	createAllocatedBuffer(pService->pAllocator,
+						  bufferInfo,
+						  VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+						  &pService->stagingRing);
+	pService->pStagingData = (u8*)pService->stagingRing.allocation.pMapped;
+	ASSERT(pService->pStagingData != nullptr);
+
+	pService->statistics.ringSize = createInfo.stagingRingSize;
+
+	return pService;
+}
+
+void destroyUploadService(UploadService* pService)
+{
+	submitRecordingBatch(*pService);
+	waitForTimeline(*pService, pService->nextTimelineValue - 1);
+
+	for (UploadBatch* pBatch : pService->inFlight)
+	{
+		delete pBatch;
+	}
+	for (UploadBatch* pBatch : pService->freeBatches)
+	{
+		delete pBatch;
+	}
+
+	destroyAllocatedBuffer(pService->pAllocator, pService->stagingRing);
+	vkDestroySemaphore(pService->device, pService->timeline, nullptr);
+	vkDestroyCommandPool(pService->device, pService->commandPool, nullptr);
+
+	delete pService;
+}
+
+u64 uploadBuffer(UploadService* pService, VkBuffer dstBuffer, VkDeviceSize dstOffset, const void* pData, VkDeviceSize size)
+{
+	std::lock_guard<std::mutex> lock(pService->mutex);
+
+	// Buffers bigger than the ring are streamed in ring-sized chunks
+	VkDeviceSize chunkLimit = pService->ringSize / 2;
+	VkDeviceSize copied		= 0;
+
+	while (copied < size)
+	{
+		VkDeviceSize chunkSize	   = std::min(size - copied, chunkLimit);
+		VkDeviceSize stagingOffset = allocateStaging(*pService, chunkSize, 16);
+		memcpy(pService->pStagingData + stagingOffset, (const u8*)pData + copied, chunkSize);
+
+		UploadBatch* pBatch = getRecordingBatch(*pService);
+
+		VkBufferCopy region = {};
+		region.srcOffset	= stagingOffset;
+		region.dstOffset	= dstOffset + copied;
+		region.size			= chunkSize;
+		vkCmdCopyBuffer(pBatch->commandBuffer, pService->stagingRing.buffer, dstBuffer, 1, &region);
+
+		copied += chunkSize;
+	}
+
+	UploadBatch* pBatch = getRecordingBatch(*pService);
+
+	VkBufferMemoryBarrier barrier = {};
+	barrier.sType				  = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+	barrier.srcAccessMask		  = VK_ACCESS_TRANSFER_WRITE_BIT;
+	barrier.dstAccessMask		  = 0;
+	barrier.srcQueueFamilyIndex	  = VK_QUEUE_FAMILY_IGNORED;
+	barrier.dstQueueFamilyIndex	  = VK_QUEUE_FAMILY_IGNORED;
+	barrier.buffer				  = dstBuffer;
+	barrier.offset				  = dstOffset;
+	barrier.size				  = size;
+
+	if (needsOwnershipTransfer(*pService))
+	{
+		barrier.srcQueueFamilyIndex = pService->transferFamilyIndex;
+		barrier.dstQueueFamilyIndex = pService->graphicsFamilyIndex;
+		vkCmdPipelineBarrier(pBatch->commandBuffer,
+							 VK_PIPELINE_STAGE_TRANSFER_BIT,
+							 VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+							 0,
+							 0,
+							 nullptr,
+							 1,
+							 &barrier,
+							 0,
+							 nullptr);
+
+		barrier.srcAccessMask = 0;
+		barrier.dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT |
+								VK_ACCESS_UNIFORM_READ_BIT | VK_ACCESS_SHADER_READ_BIT;
+		pBatch->bufferBarriers.push_back(barrier);
+		pBatch->dstStageMask |= VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT;
+	}
+
+	pService->statistics.bytesUploaded += size;
+	return pService->nextTimelineValue;
+}
+
+u64 uploadImage(UploadService*		 pService,
+				VkImage				 dstImage,
+				VkExtent3D			 extent,
+				VkDeviceSize		 texelSize,
+				const void*			 pData,
+				VkImageLayout		 finalLayout,
+				VkPipelineStageFlags dstStageMask)
+{
+	std::lock_guard<std::mutex> lock(pService->mutex);
+
+	VkDeviceSize rowSize = VkDeviceSize(extent.width) * texelSize;
+	VkDeviceSize size	 = rowSize * extent.height * extent.depth;
+
+	UploadBatch* pBatch = getRecordingBatch(*pService);
+
+	VkImageMemoryBarrier barrier			= {};
+	barrier.sType							= VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+	barrier.srcAccessMask					= 0;
+	barrier.dstAccessMask					= VK_ACCESS_TRANSFER_WRITE_BIT;
+	barrier.oldLayout						= VK_IMAGE_LAYOUT_UNDEFINED;
+	barrier.newLayout						= VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+	barrier.srcQueueFamilyIndex				= VK_QUEUE_FAMILY_IGNORED;
+	barrier.dstQueueFamilyIndex				= VK_QUEUE_FAMILY_IGNORED;
+	barrier.image							= dstImage;
+	barrier.subresourceRange.aspectMask		= VK_IMAGE_ASPECT_COLOR_BIT;
+	barrier.subresourceRange.baseMipLevel	= 0;
+	barrier.subresourceRange.levelCount		= 1;
+	barrier.subresourceRange.baseArrayLayer = 0;
+	barrier.subresourceRange.layerCount		= 1;
+	vkCmdPipelineBarrier(pBatch->commandBuffer,
+						 VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+						 VK_PIPELINE_STAGE_TRANSFER_BIT,
+						 0,
+						 0,
+						 nullptr,
+						 0,
+						 nullptr,
+						 1,
+						 &barrier);
+
+	// Images bigger than the ring are streamed in chunks of whole rows of one slice, one copy per chunk. Chunks may
+	// land in different batches, they still execute in order on the transfer queue
+	VkDeviceSize chunkLimit	  = pService->ringSize / 2;
+	u32			 rowsPerChunk = u32(std::min<VkDeviceSize>(chunkLimit / rowSize, extent.height));
+	ASSERT(rowsPerChunk > 0);
+
+	const u8* pRows = (const u8*)pData;
+	for (u32 z = 0u; z < extent.depth; ++z)
+	{
+		for (u32 y = 0u; y < extent.height; y += rowsPerChunk)
+		{
+			u32			 rowsCount	   = std::min(rowsPerChunk, extent.height - y);
+			VkDeviceSize chunkSize	   = rowSize * rowsCount;
+			VkDeviceSize stagingOffset = allocateStaging(*pService, chunkSize, std::max<VkDeviceSize>(texelSize, 16));
+			memcpy(pService->pStagingData + stagingOffset, pRows, chunkSize);
+			pRows += chunkSize;
+
+			VkBufferImageCopy region			   = {};
+			region.bufferOffset					   = stagingOffset;
+			region.imageSubresource.aspectMask	   = VK_IMAGE_ASPECT_COLOR_BIT;
+			region.imageSubresource.mipLevel	   = 0;
+			region.imageSubresource.baseArrayLayer = 0;
+			region.imageSubresource.layerCount	   = 1;
+			region.imageOffset					   = {0, i32(y), i32(z)};
+			region.imageExtent					   = {extent.width, rowsCount, 1};
+			vkCmdCopyBufferToImage(getRecordingBatch(*pService)->commandBuffer,
+								   pService->stagingRing.buffer,
+								   dstImage,
+								   VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+								   1,
+								   &region);
+		}
+	}
+
+	pBatch = getRecordingBatch(*pService);
+
+	// The layout transition happens once, as part of the release/acquire pair when ownership moves
+	barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	barrier.dstAccessMask = 0;
+	barrier.oldLayout	  = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+	barrier.newLayout	  = finalLayout;
+
+	if (needsOwnershipTransfer(*pService))
+	{
+		barrier.srcQueueFamilyIndex = pService->transferFamilyIndex;
+		barrier.dstQueueFamilyIndex = pService->graphicsFamilyIndex;
+	}
+
+	vkCmdPipelineBarrier(pBatch->commandBuffer,
+						 VK_PIPELINE_STAGE_TRANSFER_BIT,
+						 VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+						 0,
+						 0,
+						 nullptr,
+						 0,
+						 nullptr,
+						 1,
+						 &barrier);
+
+	if (needsOwnershipTransfer(*pService))
+	{
+		barrier.srcAccessMask = 0;
+		barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+		pBatch->imageBarriers.push_back(barrier);
+		pBatch->dstStageMask |= dstStageMask;
+	}
+
+	pService->statistics.bytesUploaded += size;
+	return pService->nextTimelineValue;
+}
+
+u64 flushUploads(UploadService* pService)
+{
+	std::lock_guard<std::mutex> lock(pService->mutex);
+	return submitRecordingBatch(*pService);
+}
+
+UploadWait acquireUploads(UploadService* pService, VkCommandBuffer graphicsCommandBuffer)
+{
+	std::lock_guard<std::mutex> lock(pService->mutex);
+
+	UploadWait wait = {};
+	wait.semaphore	= VK_NULL_HANDLE;
+
+	u64 lastSubmittedValue = pService->nextTimelineValue - 1;
+	if (lastSubmittedValue > pService->graphicsWaitedValue)
+	{
+		wait.semaphore				  = pService->timeline;
+		wait.value					  = lastSubmittedValue;
+		pService->graphicsWaitedValue = lastSubmittedValue;
+	}
+
+	std::vector<VkBufferMemoryBarrier> bufferBarriers;
+	std::vector<VkImageMemoryBarrier>  imageBarriers;
+
+	for (UploadBatch* pBatch : pService->inFlight)
+	{
+		if (!pBatch->acquired)
+		{
+			bufferBarriers.insert(bufferBarriers.end(), pBatch->bufferBarriers.begin(), pBatch->bufferBarriers.end());
+			imageBarriers.insert(imageBarriers.end(), pBatch->imageBarriers.begin(), pBatch->imageBarriers.end());
+			wait.stageMask |= pBatch->dstStageMask;
+			pBatch->acquired = true;
+		}
+	}
+
+	if (wait.semaphore != VK_NULL_HANDLE && wait.stageMask == 0)
+	{
+		wait.stageMask = VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+	}
+
+	if (!bufferBarriers.empty() || !imageBarriers.empty())
+	{
+		vkCmdPipelineBarrier(graphicsCommandBuffer,
+							 VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+							 wait.stageMask,
+							 0,
+							 0,
+							 nullptr,
+							 u32(bufferBarriers.size()),
+							 bufferBarriers.data(),
+							 u32(imageBarriers.size()),
+							 imageBarriers.data());
+	}
+
+	return wait;
+}
+
+UploadStatistics getUploadStatistics(UploadService* pService)
+{
+	std::lock_guard<std::mutex> lock(pService->mutex);
+	return pService->statistics;
+}
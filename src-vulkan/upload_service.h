@@ -0,0 +1,73 @@
+#pragma once
+
+#include "common.h"
+#include "memory_allocator.h"
+
+/**
+ * Streams buffer and image data to the GPU on the dedicated transfer queue. Copies are batched through a staging
+ * ring buffer and every submitted batch signals the upload timeline semaphore with an increasing value, which is
+ * returned as a ticket. The graphics queue waits on that semaphore (see `acquireUploads`) instead of the CPU
+ * blocking on the copies.
+ *
+ * When the transfer and graphics families differ, resources are released by the transfer queue and acquired
+ * back on the graphics queue (queue family ownership transfer).
+ *
+ * @example
+ * ```c++
+ * u64 ticket = uploadBuffer(pUploadService, vertexBuffer, 0, vertices.data(), verticesSize);
+ * flushUploads(pUploadService);
+ * ...
+ * // while recording the frame on the graphics queue
+ * UploadWait wait = acquireUploads(pUploadService, commandBuffer);
+ * // add wait.semaphore / wait.value to the graphics submission
+ * ```
+ */
+
+struct UploadService;
+
+struct UploadServiceCreateInfo
+{
+	VkDevice		 device;
+	MemoryAllocator* pAllocator;
+	VkDeviceSize	 stagingRingSize;
+
+	u32		transferFamilyIndex;
+	VkQueue transferQueue;
+	u32		graphicsFamilyIndex;
+};
+
+struct UploadWait
+{
+	VkSemaphore			 semaphore; // VK_NULL_HANDLE when there is nothing to wait for
+	u64					 value;
+	VkPipelineStageFlags stageMask;
+};
+
+struct UploadStatistics
+{
+	u64			 batchesSubmitted;
+	u64			 bytesUploaded;
+	u64			 ringStalls; // times the CPU had to wait for the transfer queue to free ring space
+	VkDeviceSize ringSize;
+};
+
+UploadService* createUploadService(const UploadServiceCreateInfo& createInfo);
+void		   destroyUploadService(UploadService* pService);
+
+u64 uploadBuffer(UploadService* pService, VkBuffer dstBuffer, VkDeviceSize dstOffset, const void* pData, VkDeviceSize size);
+u64 uploadImage(UploadService*	pService,
+				VkImage			dstImage,
+				VkExtent3D		extent,
+				VkDeviceSize	texelSize,
+				const void*		pData,
+				VkImageLayout	finalLayout,
+				VkPipelineStageFlags dstStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+
+// Submits everything recorded since the last flush, returns the timeline value the batch signals.
+u64 flushUploads(UploadService* pService);
+
+// Records the ownership acquire barriers of all flushed batches into a graphics command buffer and returns the
+// semaphore wait the graphics submission needs.
+UploadWait acquireUploads(UploadService* pService, VkCommandBuffer graphicsCommandBuffer);
+
+UploadStatistics getUploadStatistics(UploadService* pService);
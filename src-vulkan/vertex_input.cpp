@@ -0,0 +1,12 @@
+#include "vertex_input.h"
+
+VkPipelineVertexInputStateCreateInfo getVertexInputState(const VertexInputDescription& description)
+{
+	VkPipelineVertexInputStateCreateInfo vertexInput = {};
+	vertexInput.sType								 = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+	vertexInput.vertexBindingDescriptionCount		 = 1;
+	vertexInput.pVertexBindingDescriptions			 = &description.binding;
+	vertexInput.vertexAttributeDescriptionCount		 = description.attributesCount;
+	vertexInput.pVertexAttributeDescriptions		 = description.attributes;
+	return vertexInput;
+}
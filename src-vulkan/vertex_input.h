@@ -0,0 +1,89 @@
+#pragma once
+
+#include "common.h"
+#include "vertex_layout.h"
+
+/**
+ * Vertex input state of a pipeline built from the `VERTEX_LAYOUT` of a vertex struct, the same description the OpenGL
+ * backend creates its vertex formats from. The binding and attribute descriptions are computed at compile time, so a
+ * `static constexpr` description is plain constant data the pipeline creation points into.
+ *
+ * @example
+ * ```c++
+ * static constexpr VertexInputDescription meshInput = getVertexInputDescription<MeshVertex>(0);
+ *
+ * VkPipelineVertexInputStateCreateInfo vertexInput = getVertexInputState(meshInput);
+ * pipelineInfo.pVertexInputState					= &vertexInput;
+ * ```
+ */
+
+#define VERTEX_INPUT_MAX_ATTRIBUTES 16
+
+struct VertexInputDescription
+{
+	VkVertexInputBindingDescription	  binding;
+	VkVertexInputAttributeDescription attributes[VERTEX_INPUT_MAX_ATTRIBUTES];
+	u32								  attributesCount;
+};
+
+constexpr VkFormat getVertexAttributeVkFormat(ntt::VertexAttributeType type)
+{
+	switch (type)
+	{
+	case ntt::VertexAttributeType::FLOAT:
+		return VK_FORMAT_R32_SFLOAT;
+	case ntt::VertexAttributeType::VEC2:
+		return VK_FORMAT_R32G32_SFLOAT;
+	case ntt::VertexAttributeType::VEC3:
+		return VK_FORMAT_R32G32B32_SFLOAT;
+	case ntt::VertexAttributeType::VEC4:
+		return VK_FORMAT_R32G32B32A32_SFLOAT;
+	case ntt::VertexAttributeType::HALF2:
+		return VK_FORMAT_R16G16_SFLOAT;
+	case ntt::VertexAttributeType::HALF4:
+		return VK_FORMAT_R16G16B16A16_SFLOAT;
+	case ntt::VertexAttributeType::BYTE4_NORM:
+		return VK_FORMAT_R8G8B8A8_SNORM;
+	case ntt::VertexAttributeType::UBYTE4_NORM:
+		return VK_FORMAT_R8G8B8A8_UNORM;
+	case ntt::VertexAttributeType::SHORT2_NORM:
+		return VK_FORMAT_R16G16_SNORM;
+	case ntt::VertexAttributeType::SHORT4_NORM:
+		return VK_FORMAT_R16G16B16A16_SNORM;
+	case ntt::VertexAttributeType::USHORT2_NORM:
+		return VK_FORMAT_R16G16_UNORM;
+	case ntt::VertexAttributeType::USHORT4_NORM:
+		return VK_FORMAT_R16G16B16A16_UNORM;
+	case ntt::VertexAttributeType::INT_2_10_10_10_NORM:
+		return VK_FORMAT_A2B10G10R10_SNORM_PACK32; // x in the low bits like GL_INT_2_10_10_10_REV
+	case ntt::VertexAttributeType::UINT_2_10_10_10_NORM:
+		return VK_FORMAT_A2B10G10R10_UNORM_PACK32;
+	case ntt::VertexAttributeType::UBYTE4:
+		return VK_FORMAT_R8G8B8A8_UINT;
+	case ntt::VertexAttributeType::USHORT4:
+		return VK_FORMAT_R16G16B16A16_UINT;
+	}
+	return VK_FORMAT_UNDEFINED;
+}
+
+// Per vertex attributes at locations 0 to attributesCount - 1, in the order of the layout
+template <typename TVertex>
+constexpr VertexInputDescription getVertexInputDescription(u32 binding)
+{
+	using Layout = ntt::VertexLayout<TVertex>;
+	static_assert(Layout::attributesCount <= VERTEX_INPUT_MAX_ATTRIBUTES, "Too many vertex attributes");
+
+	VertexInputDescription description = {};
+	description.binding				   = {binding, Layout::stride, VK_VERTEX_INPUT_RATE_VERTEX};
+	description.attributesCount		   = Layout::attributesCount;
+	for (u32 location = 0; location < Layout::attributesCount; ++location)
+	{
+		const ntt::VertexLayoutAttribute& attribute = Layout::attributes[location];
+		VkFormat						  format	= getVertexAttributeVkFormat(attribute.type);
+		description.attributes[location]			= {location, binding, format, attribute.offset};
+	}
+	return description;
+}
+
+// Points into description, which has to outlive the pipeline creation
+VkPipelineVertexInputStateCreateInfo getVertexInputState(const VertexInputDescription& description);
@@ -0,0 +1,232 @@
+#include "asset_archive_format.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <lz4.h>
+#include <lz4hc.h>
+#include <string>
+#include <vector>
+#include <zstd.h>
+
+// Packs a directory into an AssetArchive, see asset_archive.h for the layout
+//  AssetPacker <assetsDirectory> <archivePath> [--codec=none|lz4|zstd]
+
+// Compressed entries are only kept when they save at least an eighth, otherwise decompressing costs more than it saves
+#define ASSET_PACKER_MIN_SAVING 8
+#define ASSET_PACKER_ZSTD_LEVEL 19
+
+using namespace ntt;
+
+struct PackedEntry
+{
+	std::string			 path; // relative, '/' separated
+	std::vector<uint8_t> stored;
+	uint64_t			 size;
+	AssetCodec			 codec;
+	uint32_t			 slot;
+};
+
+static bool readWholeFile(const std::filesystem::path& path, std::vector<uint8_t>& content)
+{
+	std::ifstream file(path, std::ios::in | std::ios::binary | std::ios::ate);
+	if (!file.is_open())
+	{
+		return false;
+	}
+
+	content.resize(size_t(file.tellg()));
+	file.seekg(0);
+	file.read((char*)content.data(), std::streamsize(content.size()));
+	return bool(file);
+}
+
+static std::vector<uint8_t> compress(AssetCodec codec, const std::vector<uint8_t>& content)
+{
+	std::vector<uint8_t> stored;
+	if (codec == AssetCodec::LZ4)
+	{
+		// High compression, the archive is built once and read on every start
+		stored.resize(size_t(LZ4_compressBound(int32_t(content.size()))));
+		int32_t size = LZ4_compress_HC((const char*)content.data(),
+									   (char*)stored.data(),
+									   int32_t(content.size()),
+									   int32_t(stored.size()),
+									   LZ4HC_CLEVEL_MAX);
+		stored.resize(size > 0 ? size_t(size) : 0);
+	}
+	else if (codec == AssetCodec::ZSTD)
+	{
+		stored.resize(ZSTD_compressBound(content.size()));
+		size_t size =
+			ZSTD_compress(stored.data(), stored.size(), content.data(), content.size(), ASSET_PACKER_ZSTD_LEVEL);
+		stored.resize(ZSTD_isError(size) ? 0 : size);
+	}
+	return stored;
+}
+
+static uint64_t alignUp(uint64_t offset)
+{
+	return (offset + ASSET_ARCHIVE_ALIGNMENT - 1) & ~(ASSET_ARCHIVE_ALIGNMENT - 1);
+}
+
+static void writePadding(std::ofstream& file, uint64_t offset)
+{
+	static const char zeros[ASSET_ARCHIVE_ALIGNMENT] = {};
+	file.write(zeros, std::streamsize(alignUp(offset) - offset));
+}
+
+int main(int argc, char** argv)
+{
+	if (argc < 3)
+	{
+		fprintf(stderr, "Usage: %s <assetsDirectory> <archivePath> [--codec=none|lz4|zstd]\n", argv[0]);
+		return 1;
+	}
+
+	std::filesystem::path directory	  = argv[1];
+	std::string			  archivePath = argv[2];
+	AssetCodec			  codec		  = AssetCodec::NONE;
+	for (int32_t argIndex = 3; argIndex < argc; ++argIndex)
+	{
+		if (strcmp(argv[argIndex], "--codec=lz4") == 0)
+		{
+			codec = AssetCodec::LZ4;
+		}
+		else if (strcmp(argv[argIndex], "--codec=zstd") == 0)
+		{
+			codec = AssetCodec::ZSTD;
+		}
+		else if (strcmp(argv[argIndex], "--codec=none") != 0)
+		{
+			fprintf(stderr, "Unknown option: %s\n", argv[argIndex]);
+			return 1;
+		}
+	}
+
+	// Sorted, so the same assets always give the same archive
+	std::vector<std::filesystem::path> files;
+	for (const std::filesystem::directory_entry& file : std::filesystem::recursive_directory_iterator(directory))
+	{
+		if (file.is_regular_file())
+		{
+			files.push_back(file.path());
+		}
+	}
+	std::sort(files.begin(), files.end());
+
+	std::vector<PackedEntry> entries;
+	for (const std::filesystem::path& file : files)
+	{
+		PackedEntry entry;
+		entry.path	= std::filesystem::relative(file, directory).generic_string();
+		entry.codec = AssetCodec::NONE;
+		if (!readWholeFile(file, entry.stored))
+		{
+			fprintf(stderr, "Failed to read %s\n", file.string().c_str());
+			return 1;
+		}
+		entry.size = entry.stored.size();
+
+		if (codec != AssetCodec::NONE && entry.size > 0)
+		{
+			std::vector<uint8_t> compressed = compress(codec, entry.stored);
+			if (!compressed.empty() && compressed.size() <= entry.size - entry.size / ASSET_PACKER_MIN_SAVING)
+			{
+				entry.stored = std::move(compressed);
+				entry.codec	 = codec;
+			}
+		}
+		entries.push_back(std::move(entry));
+	}
+
+	// Directory at most half full, so the probe sequences stay short
+	uint32_t slotsCount = 16u;
+	while (slotsCount < entries.size() * 2)
+	{
+		slotsCount *= 2;
+	}
+
+	std::vector<AssetArchiveEntry> slots(slotsCount, AssetArchiveEntry{});
+	std::vector<char>			   names;
+	for (uint32_t entryIndex = 0u; entryIndex < uint32_t(entries.size()); ++entryIndex)
+	{
+		uint64_t hash = hashAssetPath(entries[entryIndex].path);
+		uint32_t slot = uint32_t(hash) & (slotsCount - 1);
+		while (slots[slot].pathHash != 0)
+		{
+			// The reader compares the names anyway, equal hashes only cost a string compare but are worth knowing
+			if (slots[slot].pathHash == hash)
+			{
+				fprintf(stderr,
+						"Hash collision: %s and %s\n",
+						entries[entryIndex].path.c_str(),
+						&names[slots[slot].nameOffset]);
+				return 1;
+			}
+			slot = (slot + 1) & (slotsCount - 1);
+		}
+
+		entries[entryIndex].slot = slot;
+		slots[slot].pathHash	 = hash;
+		slots[slot].storedSize	 = entries[entryIndex].stored.size();
+		slots[slot].size		 = entries[entryIndex].size;
+		slots[slot].codec		 = entries[entryIndex].codec;
+		slots[slot].nameOffset	 = uint32_t(names.size());
+		names.insert(names.end(), entries[entryIndex].path.begin(), entries[entryIndex].path.end());
+		names.push_back('\0');
+	}
+
+	AssetArchiveHeader header = {};
+	header.magic			  = ASSET_ARCHIVE_MAGIC;
+	header.version			  = ASSET_ARCHIVE_VERSION;
+	header.entriesCount		  = uint32_t(entries.size());
+	header.slotsCount		  = slotsCount;
+	header.namesSize		  = names.size();
+	header.dataOffset		  = alignUp(sizeof(header) + slots.size() * sizeof(AssetArchiveEntry) + names.size());
+
+	// Entries are laid out in path order, which is also the order preload reads them in
+	uint64_t offset = header.dataOffset;
+	for (const PackedEntry& entry : entries)
+	{
+		slots[entry.slot].offset = offset;
+		offset					 = alignUp(offset + entry.stored.size());
+	}
+
+	std::ofstream file(archivePath, std::ios::out | std::ios::binary | std::ios::trunc);
+	if (!file.is_open())
+	{
+		fprintf(stderr, "Failed to create %s\n", archivePath.c_str());
+		return 1;
+	}
+
+	file.write((const char*)&header, sizeof(header));
+	file.write((const char*)slots.data(), std::streamsize(slots.size() * sizeof(AssetArchiveEntry)));
+	file.write(names.data(), std::streamsize(names.size()));
+	writePadding(file, uint64_t(file.tellp()));
+
+	uint64_t storedTotal = 0;
+	uint64_t sizeTotal	 = 0;
+	for (const PackedEntry& entry : entries)
+	{
+		file.write((const char*)entry.stored.data(), std::streamsize(entry.stored.size()));
+		writePadding(file, entry.stored.size());
+		storedTotal += entry.stored.size();
+		sizeTotal += entry.size;
+	}
+
+	if (!file)
+	{
+		fprintf(stderr, "Failed to write %s\n", archivePath.c_str());
+		return 1;
+	}
+
+	printf("Packed %u assets into %s: %llu bytes stored for %llu bytes, %llu bytes on disk\n",
+		   uint32_t(entries.size()),
+		   archivePath.c_str(),
+		   (unsigned long long)storedTotal,
+		   (unsigned long long)sizeTotal,
+		   (unsigned long long)offset);
+	return 0;
+}